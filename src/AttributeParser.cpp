@@ -0,0 +1,496 @@
+/**
+ * \file AttributeParser.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "AttributeParser.h"
+#include "JUtf8String.h"
+#include "parsing/ParseFailureException.h"
+
+namespace mimic
+{
+
+namespace
+{
+struct known_attribute
+{
+  const char* name;
+  AttributeParser::kind kind;
+  u2 first_version;
+};
+
+const known_attribute known_attributes[] = {
+  {"ConstantValue", AttributeParser::attr_constant_value, 45},
+  {"Code", AttributeParser::attr_code, 45},
+  {"StackMapTable", AttributeParser::attr_stack_map_table, 50},
+  {"Exceptions", AttributeParser::attr_exceptions, 45},
+  {"InnerClasses", AttributeParser::attr_inner_classes, 45},
+  {"EnclosingMethod", AttributeParser::attr_enclosing_method, 49},
+  {"Synthetic", AttributeParser::attr_synthetic, 45},
+  {"Signature", AttributeParser::attr_signature, 49},
+  {"SourceFile", AttributeParser::attr_source_file, 45},
+  {"SourceDebugExtension", AttributeParser::attr_source_debug_extension, 49},
+  {"LineNumberTable", AttributeParser::attr_line_number_table, 45},
+  {"LocalVariableTable", AttributeParser::attr_local_variable_table, 45},
+  {"LocalVariableTypeTable", AttributeParser::attr_local_variable_type_table, 49},
+  {"Deprecated", AttributeParser::attr_deprecated, 45},
+  {"RuntimeVisibleAnnotations", AttributeParser::attr_runtime_visible_annotations, 49},
+  {"RuntimeInvisibleAnnotations", AttributeParser::attr_runtime_invisible_annotations, 49},
+  {"RuntimeVisibleParameterAnnotations", AttributeParser::attr_runtime_visible_parameter_annotations, 49},
+  {"RuntimeInvisibleParameterAnnotations", AttributeParser::attr_runtime_invisible_parameter_annotations, 49},
+  {"RuntimeVisibleTypeAnnotations", AttributeParser::attr_runtime_visible_type_annotations, 52},
+  {"RuntimeInvisibleTypeAnnotations", AttributeParser::attr_runtime_invisible_type_annotations, 52},
+  {"AnnotationDefault", AttributeParser::attr_annotation_default, 49},
+  {"BootstrapMethods", AttributeParser::attr_bootstrap_methods, 51},
+  {"MethodParameters", AttributeParser::attr_method_parameters, 52}
+};
+
+const std::size_t known_count = sizeof(known_attributes) / sizeof(known_attributes[0]);
+
+/**
+ * A perfect hash table of the known attribute names. The multiplier is
+ * searched for when the table is built, so that the top bits of each name's
+ * hash times the multiplier are different for every known name.
+ */
+struct name_table
+{
+  static const unsigned bits = 7;
+
+  u8 multiplier;
+  std::array<Symbol, 1 << bits> names;
+  std::array<AttributeParser::kind, 1 << bits> kinds;
+  /** The name of each kind, by kind */
+  std::array<Symbol, known_count + 1> by_kind;
+
+  std::size_t slot(std::size_t hash) const
+  {
+    return static_cast<std::size_t>((static_cast<u8>(hash) * multiplier) >> (64 - bits));
+  }
+
+  name_table() : multiplier(0x9E3779B97F4A7C15ULL)
+  {
+    for (auto& attribute : known_attributes)
+      by_kind[attribute.kind] = Symbol::intern(JUtf8String(attribute.name));
+    for (u4 attempt = 0;; attempt++)
+    {
+      if (attempt == 1 << 20)
+        throw std::logic_error("No perfect hash found for the attribute names");
+      names.fill(Symbol());
+      kinds.fill(AttributeParser::attr_unknown);
+      bool collided = false;
+      for (auto& attribute : known_attributes)
+      {
+        std::size_t s = slot(by_kind[attribute.kind].hash());
+        if (kinds[s] != AttributeParser::attr_unknown)
+        {
+          collided = true;
+          break;
+        }
+        names[s] = by_kind[attribute.kind];
+        kinds[s] = attribute.kind;
+      }
+      if (!collided)
+        return;
+      multiplier = multiplier * 6364136223846793005ULL + 1442695040888963407ULL;
+      multiplier |= 1;
+    }
+  }
+};
+
+const name_table& names()
+{
+  static const name_table table;
+  return table;
+}
+
+/**
+ * Nested annotations and arrays are decoded recursively, so limit how deep
+ * they can go rather than let a malicious class file exhaust the stack
+ */
+const unsigned max_element_depth = 256;
+
+std::vector<u1> readRemaining(parsing::ByteConsumer& bc)
+{
+  return bc.readBytes(static_cast<u4>(bc.bytesRemaining()));
+}
+}
+
+AttributeParser::kind AttributeParser::kindOf(const Symbol& name)
+{
+  auto& table = names();
+  std::size_t s = table.slot(name.hash());
+  return table.names[s] == name ? table.kinds[s] : attr_unknown;
+}
+
+AttributeParser::kind AttributeParser::kindOf(parsing::ByteView name)
+{
+  auto& table = names();
+  std::size_t s = table.slot(JUtf8String::hashOf(name));
+  return table.names[s].view() == name ? table.kinds[s] : attr_unknown;
+}
+
+Symbol AttributeParser::nameOf(kind attribute)
+{
+  return names().by_kind.at(attribute);
+}
+
+u2 AttributeParser::firstVersion(kind attribute)
+{
+  for (auto& known : known_attributes)
+  {
+    if (known.kind == attribute)
+      return known.first_version;
+  }
+  return 0;
+}
+
+void AttributeParser::lengthMismatch()
+{
+  throw parsing::parse_failure("Attribute length does not match its contents");
+}
+
+attributes::annotation_element_value AttributeParser::readElementValue(parsing::ByteConsumer& bc, unsigned depth)
+{
+  if (depth > max_element_depth)
+    throw parsing::parse_failure("Annotation element values are nested too deeply");
+  attributes::annotation_element_value element;
+  element.type_tag = bc.readU1();
+  switch (element.type_tag)
+  {
+  case 'B':
+  case 'C':
+  case 'D':
+  case 'F':
+  case 'I':
+  case 'J':
+  case 'S':
+  case 'Z':
+  case 's':
+  case 'c':
+    element.value = bc.readU2();
+    break;
+  case 'e':
+  {
+    u2 type_name_index = bc.readU2();
+    element.value = std::make_tuple(type_name_index, bc.readU2());
+    break;
+  }
+  case '@':
+    element.value = std::make_shared<const attributes::annotation>(readAnnotation(bc, depth + 1));
+    break;
+  case '[':
+  {
+    std::vector<attributes::annotation_element_value> values;
+    u2 num_values = bc.readU2();
+    values.reserve(num_values);
+    for (u2 i = 0; i < num_values; i++)
+      values.push_back(readElementValue(bc, depth + 1));
+    element.value = std::move(values);
+    break;
+  }
+  default:
+    throw parsing::parse_failure("Invalid annotation element value tag");
+  }
+  return element;
+}
+
+attributes::annotation AttributeParser::readAnnotation(parsing::ByteConsumer& bc, unsigned depth)
+{
+  attributes::annotation result;
+  result.type_index = bc.readU2();
+  u2 num_element_value_pairs = bc.readU2();
+  result.elements.reserve(num_element_value_pairs);
+  for (u2 i = 0; i < num_element_value_pairs; i++)
+  {
+    u2 element_name_index = bc.readU2();
+    result.elements.push_back(attributes::element_value_pair{element_name_index, readElementValue(bc, depth)});
+  }
+  return result;
+}
+
+std::vector<attributes::annotation> AttributeParser::readAnnotations(parsing::ByteConsumer& bc)
+{
+  std::vector<attributes::annotation> annotations;
+  u2 num_annotations = bc.readU2();
+  annotations.reserve(num_annotations);
+  for (u2 i = 0; i < num_annotations; i++)
+    annotations.push_back(readAnnotation(bc, 0));
+  return annotations;
+}
+
+std::vector<attributes::local_variable_info> AttributeParser::readLocalVariables(parsing::ByteConsumer& bc)
+{
+  std::vector<attributes::local_variable_info> table;
+  u2 length = bc.readU2();
+  table.reserve(length);
+  for (u2 i = 0; i < length; i++)
+  {
+    attributes::local_variable_info info;
+    info.start_pc = bc.readU2();
+    info.length = bc.readU2();
+    info.name_index = bc.readU2();
+    info.descriptor_index = bc.readU2();
+    info.index = bc.readU2();
+    table.push_back(info);
+  }
+  return table;
+}
+
+attributes::constant_value AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                 const attributes::constant_value*)
+{
+  return attributes::constant_value{name_index, bc.readU2()};
+}
+
+attributes::stack_map_table AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                  const attributes::stack_map_table*)
+{
+  return attributes::stack_map_table{name_index, readRemaining(bc)};
+}
+
+attributes::exceptions AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                             const attributes::exceptions*)
+{
+  attributes::exceptions result{name_index, {}};
+  u2 number_of_exceptions = bc.readU2();
+  result.exception_index_table.reserve(number_of_exceptions);
+  for (u2 i = 0; i < number_of_exceptions; i++)
+    result.exception_index_table.push_back(bc.readU2());
+  return result;
+}
+
+attributes::inner_classes AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                const attributes::inner_classes*)
+{
+  attributes::inner_classes result{name_index, {}};
+  u2 number_of_classes = bc.readU2();
+  result.classes.reserve(number_of_classes);
+  for (u2 i = 0; i < number_of_classes; i++)
+  {
+    attributes::inner_class_info info;
+    info.inner_class_info_index = bc.readU2();
+    info.outer_class_info_index = bc.readU2();
+    info.inner_name_index = bc.readU2();
+    info.inner_class_access_flags = bc.readU2();
+    result.classes.push_back(info);
+  }
+  return result;
+}
+
+attributes::enclosing_method AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                   const attributes::enclosing_method*)
+{
+  u2 class_index = bc.readU2();
+  return attributes::enclosing_method{name_index, class_index, bc.readU2()};
+}
+
+attributes::synthetic AttributeParser::read(u2 name_index, parsing::ByteConsumer&, const attributes::synthetic*)
+{
+  return attributes::synthetic{name_index};
+}
+
+attributes::signature AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                            const attributes::signature*)
+{
+  return attributes::signature{name_index, bc.readU2()};
+}
+
+attributes::source_file AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                              const attributes::source_file*)
+{
+  return attributes::source_file{name_index, bc.readU2()};
+}
+
+attributes::source_debug_extension AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                         const attributes::source_debug_extension*)
+{
+  return attributes::source_debug_extension{name_index, JUtf8String(readRemaining(bc))};
+}
+
+attributes::line_number_table AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                    const attributes::line_number_table*)
+{
+  attributes::line_number_table result{name_index, {}};
+  u2 length = bc.readU2();
+  result.table.reserve(length);
+  for (u2 i = 0; i < length; i++)
+  {
+    u2 start_pc = bc.readU2();
+    result.table.push_back(attributes::line_number_info{start_pc, bc.readU2()});
+  }
+  return result;
+}
+
+attributes::local_variable_table AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                       const attributes::local_variable_table*)
+{
+  return attributes::local_variable_table{name_index, readLocalVariables(bc)};
+}
+
+attributes::local_variable_type_table AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                            const attributes::local_variable_type_table*)
+{
+  // The same layout as LocalVariableTable, with a signature in place of the descriptor
+  attributes::local_variable_type_table result{name_index, {}};
+  for (auto& variable : readLocalVariables(bc))
+  {
+    result.table.push_back(attributes::local_variable_type_info{variable.start_pc, variable.length,
+                                                                variable.name_index, variable.descriptor_index,
+                                                                variable.index});
+  }
+  return result;
+}
+
+attributes::deprecated AttributeParser::read(u2 name_index, parsing::ByteConsumer&, const attributes::deprecated*)
+{
+  return attributes::deprecated{name_index};
+}
+
+attributes::runtime_visible_annotations AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                              const attributes::runtime_visible_annotations*)
+{
+  return attributes::runtime_visible_annotations{name_index, readAnnotations(bc)};
+}
+
+attributes::runtime_invisible_annotations AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                                const attributes::runtime_invisible_annotations*)
+{
+  return attributes::runtime_invisible_annotations{name_index, readAnnotations(bc)};
+}
+
+attributes::runtime_visible_parameter_annotations AttributeParser::read(
+    u2 name_index, parsing::ByteConsumer& bc, const attributes::runtime_visible_parameter_annotations*)
+{
+  attributes::runtime_visible_parameter_annotations result{name_index, {}};
+  u1 num_parameters = bc.readU1();
+  for (u1 i = 0; i < num_parameters; i++)
+    result.parameter_annotations.push_back(readAnnotations(bc));
+  return result;
+}
+
+attributes::runtime_invisible_parameter_annotations AttributeParser::read(
+    u2 name_index, parsing::ByteConsumer& bc, const attributes::runtime_invisible_parameter_annotations*)
+{
+  attributes::runtime_invisible_parameter_annotations result{name_index, {}};
+  u1 num_parameters = bc.readU1();
+  for (u1 i = 0; i < num_parameters; i++)
+    result.parameter_annotations.push_back(readAnnotations(bc));
+  return result;
+}
+
+attributes::runtime_visible_type_annotations AttributeParser::read(
+    u2 name_index, parsing::ByteConsumer& bc, const attributes::runtime_visible_type_annotations*)
+{
+  auto info = readRemaining(bc);
+  u4 length = static_cast<u4>(info.size());
+  return attributes::runtime_visible_type_annotations{name_index, length, std::move(info)};
+}
+
+attributes::runtime_invisible_type_annotations AttributeParser::read(
+    u2 name_index, parsing::ByteConsumer& bc, const attributes::runtime_invisible_type_annotations*)
+{
+  return attributes::runtime_invisible_type_annotations{name_index, readRemaining(bc)};
+}
+
+attributes::annotation_default AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                     const attributes::annotation_default*)
+{
+  return attributes::annotation_default{name_index, readElementValue(bc, 0)};
+}
+
+attributes::bootstrap_methods AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                    const attributes::bootstrap_methods*)
+{
+  attributes::bootstrap_methods result{name_index, {}};
+  u2 num_bootstrap_methods = bc.readU2();
+  result.info.reserve(num_bootstrap_methods);
+  for (u2 i = 0; i < num_bootstrap_methods; i++)
+  {
+    attributes::bootstrap_method_info method;
+    method.bootstrap_method_ref = bc.readU2();
+    u2 num_bootstrap_arguments = bc.readU2();
+    method.bootstrap_arguments.reserve(num_bootstrap_arguments);
+    for (u2 j = 0; j < num_bootstrap_arguments; j++)
+      method.bootstrap_arguments.push_back(bc.readU2());
+    result.info.push_back(std::move(method));
+  }
+  return result;
+}
+
+attributes::method_parameters AttributeParser::read(u2 name_index, parsing::ByteConsumer& bc,
+                                                    const attributes::method_parameters*)
+{
+  attributes::method_parameters result{name_index, {}};
+  u1 parameters_count = bc.readU1();
+  for (u1 i = 0; i < parameters_count; i++)
+  {
+    u2 parameter_name_index = bc.readU2();
+    result.parameters.push_back(std::make_tuple(parameter_name_index, bc.readU2()));
+  }
+  return result;
+}
+
+/*
+ * The lazily decoded attributes
+ */
+namespace attributes
+{
+template <> stack_map_table lazy<stack_map_table>::decode() const
+{
+  return AttributeParser::decode<stack_map_table>(attribute_name_index, info);
+}
+
+template <> source_debug_extension lazy<source_debug_extension>::decode() const
+{
+  return AttributeParser::decode<source_debug_extension>(attribute_name_index, info);
+}
+
+template <> local_variable_table lazy<local_variable_table>::decode() const
+{
+  return AttributeParser::decode<local_variable_table>(attribute_name_index, info);
+}
+
+template <> local_variable_type_table lazy<local_variable_type_table>::decode() const
+{
+  return AttributeParser::decode<local_variable_type_table>(attribute_name_index, info);
+}
+
+template <> runtime_visible_annotations lazy<runtime_visible_annotations>::decode() const
+{
+  return AttributeParser::decode<runtime_visible_annotations>(attribute_name_index, info);
+}
+
+template <> runtime_invisible_annotations lazy<runtime_invisible_annotations>::decode() const
+{
+  return AttributeParser::decode<runtime_invisible_annotations>(attribute_name_index, info);
+}
+
+template <> runtime_visible_parameter_annotations lazy<runtime_visible_parameter_annotations>::decode() const
+{
+  return AttributeParser::decode<runtime_visible_parameter_annotations>(attribute_name_index, info);
+}
+
+template <> runtime_invisible_parameter_annotations lazy<runtime_invisible_parameter_annotations>::decode() const
+{
+  return AttributeParser::decode<runtime_invisible_parameter_annotations>(attribute_name_index, info);
+}
+
+template <> runtime_visible_type_annotations lazy<runtime_visible_type_annotations>::decode() const
+{
+  return AttributeParser::decode<runtime_visible_type_annotations>(attribute_name_index, info);
+}
+
+template <> runtime_invisible_type_annotations lazy<runtime_invisible_type_annotations>::decode() const
+{
+  return AttributeParser::decode<runtime_invisible_type_annotations>(attribute_name_index, info);
+}
+
+template <> annotation_default lazy<annotation_default>::decode() const
+{
+  return AttributeParser::decode<annotation_default>(attribute_name_index, info);
+}
+}
+
+}
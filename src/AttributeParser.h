@@ -0,0 +1,153 @@
+/**
+ * \file AttributeParser.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_ATTRIBUTEPARSER_H_
+#define SRC_MIMIC_ATTRIBUTEPARSER_H_
+
+#include "Common.h"
+#include "class_attributes.h"
+#include "code_attributes.h"
+#include "field_attributes.h"
+#include "method_attributes.h"
+#include "Symbol.h"
+#include "parsing/ByteConsumer.h"
+#include "parsing/ByteView.h"
+
+namespace mimic
+{
+
+/**
+ * Recognises attributes by name, and decodes their info into the types in
+ * the attributes namespace
+ *
+ * https://docs.oracle.com/javase/specs/jvms/se8/html/jvms-4.html#jvms-4.7
+ */
+class AttributeParser
+{
+public:
+  /** The attributes this parser knows about */
+  enum kind : u1
+  {
+    attr_unknown,
+    attr_constant_value,
+    attr_code,
+    attr_stack_map_table,
+    attr_exceptions,
+    attr_inner_classes,
+    attr_enclosing_method,
+    attr_synthetic,
+    attr_signature,
+    attr_source_file,
+    attr_source_debug_extension,
+    attr_line_number_table,
+    attr_local_variable_table,
+    attr_local_variable_type_table,
+    attr_deprecated,
+    attr_runtime_visible_annotations,
+    attr_runtime_invisible_annotations,
+    attr_runtime_visible_parameter_annotations,
+    attr_runtime_invisible_parameter_annotations,
+    attr_runtime_visible_type_annotations,
+    attr_runtime_invisible_type_annotations,
+    attr_annotation_default,
+    attr_bootstrap_methods,
+    attr_method_parameters
+  };
+
+  /**
+   * Looks up an attribute name in a perfect hash table of the known names,
+   * so that recognising a name takes one multiply and one comparison
+   *
+   * @param name the attribute's name
+   * @return the kind of attribute, or attr_unknown
+   */
+  static kind kindOf(const Symbol& name);
+
+  /**
+   * As kindOf(const Symbol&), for a name that hasn't been interned
+   *
+   * @param name the bytes of the attribute's name
+   * @return the kind of attribute, or attr_unknown
+   */
+  static kind kindOf(parsing::ByteView name);
+
+  /**
+   * @param attribute a kind of attribute other than attr_unknown
+   * @return the attribute's name
+   */
+  static Symbol nameOf(kind attribute);
+
+  /**
+   * @param attribute a kind of attribute
+   * @return the first class file major version that defines the attribute.
+   *         Older class files may use the name for something else.
+   */
+  static u2 firstVersion(kind attribute);
+
+  /**
+   * Decodes the info of an attribute
+   *
+   * @param attribute_name_index the index of the attribute's name
+   * @param info the attribute's info, which must be used up exactly
+   * @return the decoded attribute
+   * @throws parse_failure if the attribute is malformed
+   */
+  template <typename T> static T decode(u2 attribute_name_index, parsing::ByteView info)
+  {
+    parsing::ByteConsumer bc(info.data(), info.size());
+    T attribute = read(attribute_name_index, bc, static_cast<const T*>(nullptr));
+    if (bc.bytesRemaining() != 0)
+      lengthMismatch();
+    return attribute;
+  }
+
+private:
+  [[noreturn]] static void lengthMismatch();
+
+  static attributes::annotation_element_value readElementValue(parsing::ByteConsumer& bc, unsigned depth);
+  static attributes::annotation readAnnotation(parsing::ByteConsumer& bc, unsigned depth);
+  static std::vector<attributes::annotation> readAnnotations(parsing::ByteConsumer& bc);
+  static std::vector<attributes::local_variable_info> readLocalVariables(parsing::ByteConsumer& bc);
+
+  /* decode() overloads for each attribute type, other than Code, which
+   * ClassFile decodes as it holds attributes of its own */
+  static attributes::constant_value read(u2, parsing::ByteConsumer&, const attributes::constant_value*);
+  static attributes::stack_map_table read(u2, parsing::ByteConsumer&, const attributes::stack_map_table*);
+  static attributes::exceptions read(u2, parsing::ByteConsumer&, const attributes::exceptions*);
+  static attributes::inner_classes read(u2, parsing::ByteConsumer&, const attributes::inner_classes*);
+  static attributes::enclosing_method read(u2, parsing::ByteConsumer&, const attributes::enclosing_method*);
+  static attributes::synthetic read(u2, parsing::ByteConsumer&, const attributes::synthetic*);
+  static attributes::signature read(u2, parsing::ByteConsumer&, const attributes::signature*);
+  static attributes::source_file read(u2, parsing::ByteConsumer&, const attributes::source_file*);
+  static attributes::source_debug_extension read(u2, parsing::ByteConsumer&,
+                                                 const attributes::source_debug_extension*);
+  static attributes::line_number_table read(u2, parsing::ByteConsumer&, const attributes::line_number_table*);
+  static attributes::local_variable_table read(u2, parsing::ByteConsumer&,
+                                               const attributes::local_variable_table*);
+  static attributes::local_variable_type_table read(u2, parsing::ByteConsumer&,
+                                                    const attributes::local_variable_type_table*);
+  static attributes::deprecated read(u2, parsing::ByteConsumer&, const attributes::deprecated*);
+  static attributes::runtime_visible_annotations read(u2, parsing::ByteConsumer&,
+                                                      const attributes::runtime_visible_annotations*);
+  static attributes::runtime_invisible_annotations read(u2, parsing::ByteConsumer&,
+                                                        const attributes::runtime_invisible_annotations*);
+  static attributes::runtime_visible_parameter_annotations read(
+      u2, parsing::ByteConsumer&, const attributes::runtime_visible_parameter_annotations*);
+  static attributes::runtime_invisible_parameter_annotations read(
+      u2, parsing::ByteConsumer&, const attributes::runtime_invisible_parameter_annotations*);
+  static attributes::runtime_visible_type_annotations read(u2, parsing::ByteConsumer&,
+                                                           const attributes::runtime_visible_type_annotations*);
+  static attributes::runtime_invisible_type_annotations read(
+      u2, parsing::ByteConsumer&, const attributes::runtime_invisible_type_annotations*);
+  static attributes::annotation_default read(u2, parsing::ByteConsumer&, const attributes::annotation_default*);
+  static attributes::bootstrap_methods read(u2, parsing::ByteConsumer&, const attributes::bootstrap_methods*);
+  static attributes::method_parameters read(u2, parsing::ByteConsumer&, const attributes::method_parameters*);
+};
+
+}
+
+#endif /* SRC_MIMIC_ATTRIBUTEPARSER_H_ */
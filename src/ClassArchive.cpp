@@ -0,0 +1,609 @@
+/**
+ * \file ClassArchive.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "ClassArchive.h"
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+#include "parsing/ByteConsumer.h"
+
+namespace mimic
+{
+
+namespace
+{
+const char archive_magic[8] = {'M', 'I', 'M', 'I', 'C', 'A', 'R', 'C'};
+const u4 byte_order_mark = 0x01020304;
+/** Changes whenever the layout, or anything it depends on such as the string hash, changes */
+const u4 archive_version = 5;
+
+struct header
+{
+  char magic[8];
+  u4 byte_order;
+  u4 version;
+  u4 class_count;
+  u4 table_capacity;
+  u4 table_offset;
+  u4 name_table_offset;
+  u8 archive_size;
+};
+
+struct table_entry
+{
+  Sha256::digest digest;
+  u4 source_size;
+  /** 0 for an empty slot, as no record can start at the header */
+  u4 record_offset;
+};
+
+/** An entry of the table of classes by name, which has as many slots as the table by digest */
+struct name_entry
+{
+  u8 name_hash;
+  /** The modification time of the class file, checked with its size before the class is used */
+  u8 source_modified;
+  /** Offset of the name's size from the start of the archive */
+  u4 name_offset;
+  /** 0 for an empty slot */
+  u4 record_offset;
+  u4 source_size;
+  u4 reserved;
+};
+
+/*
+ * Each class' record is laid out as:
+ *
+ *   record_header
+ *   u4 payloads[constant_pool_count]
+ *   u4 utf8_offsets[utf8_count]   offset of each Utf8 slot's size from the start of the archive
+ *   u1 tags[constant_pool_count]
+ *   u1 uses[utf8_count]           how each Utf8 slot is used as a descriptor
+ *   u2 interfaces[interfaces_count], padded to a u2 boundary
+ *   u2 fields[fields_count][3]    flags, name index, descriptor index
+ *   u2 methods[methods_count][3]
+ *   attribute sections of each field, then each method, then the class, each
+ *   a u4 size followed by the section as it was in the class file, starting
+ *   with its attributes_count
+ */
+struct record_header
+{
+  u2 minor_version;
+  u2 major_version;
+  u2 constant_pool_count;
+  u2 flags;
+  u2 this_class;
+  u2 super_class;
+  u2 interfaces_count;
+  u2 fields_count;
+  u2 methods_count;
+  u2 reserved;
+  u4 utf8_count;
+};
+
+/**
+ * Appends plain values to the archive being written
+ */
+class output
+{
+public:
+  std::vector<u1> bytes;
+
+  template <typename T> void put(const T& value)
+  {
+    const u1* p = reinterpret_cast<const u1*>(&value);
+    bytes.insert(bytes.end(), p, p + sizeof(T));
+  }
+
+  template <typename T> void putAll(const T* values, std::size_t count)
+  {
+    const u1* p = reinterpret_cast<const u1*>(values);
+    bytes.insert(bytes.end(), p, p + sizeof(T) * count);
+  }
+
+  void align(std::size_t alignment)
+  {
+    bytes.resize((bytes.size() + alignment - 1) & ~(alignment - 1), 0);
+  }
+
+  u4 offset() const
+  {
+    if (bytes.size() > 0xffffffffu)
+      throw std::runtime_error("Class archive is larger than 4GB");
+    return static_cast<u4>(bytes.size());
+  }
+
+  template <typename T> void putAt(std::size_t offset, const T& value)
+  {
+    std::memcpy(bytes.data() + offset, &value, sizeof(T));
+  }
+};
+
+/**
+ * Reads plain values from a mapped archive. The archive is only aligned
+ * where it needs to be, so everything is copied out.
+ *
+ * Nothing is read past the end of the archive, whatever the offsets and
+ * counts in it say.
+ */
+class input
+{
+public:
+  input(const u1* position, const u1* end) : position(position), end(end) {}
+
+  template <typename T> T get()
+  {
+    need(sizeof(T));
+    T value;
+    std::memcpy(&value, position, sizeof(T));
+    position += sizeof(T);
+    return value;
+  }
+
+  template <typename T> void getAll(std::vector<T>& values, std::size_t count)
+  {
+    need(sizeof(T) * count);
+    values.resize(count);
+    if (count != 0)
+      std::memcpy(values.data(), position, sizeof(T) * count);
+    position += sizeof(T) * count;
+  }
+
+  /**
+   * @return the bytes of a run written as a u4 size followed by the bytes
+   */
+  parsing::ByteView sized()
+  {
+    u4 size = get<u4>();
+    need(size);
+    parsing::ByteView bytes(position, size);
+    position += size;
+    return bytes;
+  }
+
+  void align(std::size_t alignment, const u1* base)
+  {
+    std::size_t offset = position - base;
+    std::size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+    need(aligned - offset);
+    position = base + aligned;
+  }
+
+private:
+  const u1* position;
+  const u1* end;
+
+  /**
+   * @throws parse_failure if fewer than size bytes are left
+   */
+  void need(std::size_t size) const
+  {
+    if (std::size_t(end - position) < size)
+      throw parsing::parse_failure("Class archive is truncated or corrupt");
+  }
+};
+
+std::size_t tableCapacity(std::size_t classes)
+{
+  // No more than half full, so probes stay short
+  std::size_t capacity = 2;
+  while (capacity < classes * 2)
+    capacity *= 2;
+  return capacity;
+}
+
+template <typename Info> void putMembers(output& out, const std::vector<Info>& members)
+{
+  for (auto& member : members)
+  {
+    out.put(static_cast<u2>(member.flags));
+    out.put(member.name_index);
+    out.put(member.descriptor_index);
+  }
+}
+
+/**
+ * Skips an attributes section
+ *
+ * @param bc positioned at the section's attributes_count
+ * @return the whole section, including attributes_count
+ */
+parsing::ByteView skipAttributes(parsing::ByteConsumer& bc)
+{
+  auto start = bc.position();
+  u2 attributes_count = bc.readU2();
+  for (u2 i = 0; i < attributes_count; i++)
+  {
+    bc.readU2();
+    bc.readBytes(bc.readU4());
+  }
+  return bc.viewFrom(start);
+}
+
+template <typename Info> void getMembers(input& in, std::vector<Info>& members, u2 count)
+{
+  members.resize(count);
+  for (auto& member : members)
+  {
+    member.flags = static_cast<ClassFile::access_flags>(in.get<u2>());
+    member.name_index = in.get<u2>();
+    member.descriptor_index = in.get<u2>();
+  }
+}
+}
+
+std::size_t ClassArchive::homeSlot(const Sha256::digest& digest, std::size_t capacity)
+{
+  u8 bits;
+  std::memcpy(&bits, digest.data(), sizeof(bits));
+  return bits & (capacity - 1);
+}
+
+std::vector<std::vector<u1>> ClassArchive::attributeSections(parsing::ByteView source)
+{
+  std::vector<std::vector<u1>> sections;
+  parsing::ByteConsumer bc(source.data(), source.size());
+  bc.readU4();
+  u2 minor_version = bc.readU2();
+  u2 major_version = bc.readU2();
+  u2 constant_pool_count = bc.readU2();
+  ConstantPool::index(bc, constant_pool_count, major_version, minor_version);
+  bc.readBytes(6);
+  bc.readBytes(2 * bc.readU2());
+  for (int members = 0; members < 2; members++)
+  {
+    u2 count = bc.readU2();
+    for (u2 i = 0; i < count; i++)
+    {
+      bc.readBytes(6);
+      sections.push_back(skipAttributes(bc));
+    }
+  }
+  sections.push_back(skipAttributes(bc));
+  return sections;
+}
+
+u8 ClassArchive::modificationTime(const fs::path& path)
+{
+  auto since_epoch = fs::last_write_time(path).time_since_epoch();
+  u8 modified = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
+  // 0 marks a class that can't be found by name
+  return modified ? modified : 1;
+}
+
+void ClassArchive::Writer::add(parsing::ByteView source, u8 modified)
+{
+  auto digest = Sha256::hash(source);
+  for (auto& existing : classes)
+  {
+    if (existing.digest != digest || existing.source.size() != source.size())
+      continue;
+    if (std::memcmp(existing.source.data(), source.data(), source.size()) != 0)
+      throw std::runtime_error("Two different class files have the same SHA-256 digest");
+    return;
+  }
+  parsing::ByteConsumer bc(source.data(), source.size());
+  ClassFile clazz(bc, ConstantPool::eager);
+  classes.push_back(pending{digest, modified, source, std::move(clazz), attributeSections(source)});
+}
+
+void ClassArchive::Writer::write(const fs::path& path) const
+{
+  output out;
+  std::size_t capacity = tableCapacity(classes.size());
+  out.put(header());
+  u4 table_offset = out.offset();
+  out.bytes.resize(out.bytes.size() + capacity * sizeof(table_entry), 0);
+  u4 name_table_offset = out.offset();
+  out.bytes.resize(out.bytes.size() + capacity * sizeof(name_entry), 0);
+
+  // Every distinct string, once
+  std::unordered_map<Symbol, u4> symbols;
+  for (auto& c : classes)
+  {
+    for (auto& entry : c.clazz.constant_pool.utf8_entries)
+    {
+      if (symbols.count(entry.symbol))
+        continue;
+      out.align(alignof(symbol_header));
+      symbol_header sh = {};
+      sh.hash = entry.symbol.hash();
+      sh.length = entry.symbol.length();
+      out.put(sh);
+      symbols.emplace(entry.symbol, out.offset());
+      u2 size = entry.symbol.size();
+      out.put(static_cast<u1>(size >> 8));
+      out.put(static_cast<u1>(size));
+      out.putAll(entry.symbol.view().data(), size);
+    }
+  }
+
+  for (auto& c : classes)
+  {
+    const ClassFile& clazz = c.clazz;
+    const ConstantPool& cp = clazz.constant_pool;
+    out.align(4);
+    u4 record_offset = out.offset();
+    record_header rh = {};
+    rh.minor_version = clazz.minor_version;
+    rh.major_version = clazz.major_version;
+    rh.constant_pool_count = static_cast<u2>(cp.tags.size());
+    rh.flags = clazz.flags;
+    rh.this_class = clazz.this_class;
+    rh.super_class = clazz.super_class;
+    rh.interfaces_count = static_cast<u2>(clazz.interfaces.size());
+    rh.fields_count = static_cast<u2>(clazz.fields.size());
+    rh.methods_count = static_cast<u2>(clazz.methods.size());
+    rh.utf8_count = static_cast<u4>(cp.utf8_entries.size());
+    out.put(rh);
+    out.putAll(cp.payloads.data(), cp.payloads.size());
+    std::vector<u1> uses(cp.utf8_entries.size(), ConstantPool::not_descriptor);
+    for (auto& entry : cp.utf8_entries)
+      out.put(symbols[entry.symbol]);
+    // Record how each string was decoded, so that it's decoded the same way
+    for (u2 i = 1; i < cp.tags.size(); i++)
+    {
+      if (cp.tags[i] != ConstantPool::Utf8)
+        continue;
+      auto type = cp.getType(i);
+      if (type == ConstantPool::cp_methodDescriptor)
+        uses[cp.payloads[i]] = ConstantPool::method_descriptor;
+      else if (type == ConstantPool::cp_fieldDescriptor)
+        uses[cp.payloads[i]] = ConstantPool::field_descriptor;
+    }
+    out.putAll(cp.tags.data(), cp.tags.size());
+    out.putAll(uses.data(), uses.size());
+    out.align(2);
+    out.putAll(clazz.interfaces.data(), clazz.interfaces.size());
+    putMembers(out, clazz.fields);
+    putMembers(out, clazz.methods);
+    for (auto& section : c.attribute_sections)
+    {
+      out.put(static_cast<u4>(section.size()));
+      out.putAll(section.data(), section.size());
+    }
+
+    std::size_t slot = homeSlot(c.digest, capacity);
+    while (true)
+    {
+      table_entry existing;
+      std::memcpy(&existing, out.bytes.data() + table_offset + slot * sizeof(table_entry), sizeof(existing));
+      if (existing.record_offset == 0)
+        break;
+      slot = (slot + 1) & (capacity - 1);
+    }
+    out.putAt(table_offset + slot * sizeof(table_entry),
+              table_entry{c.digest, static_cast<u4>(c.source.size()), record_offset});
+
+    if (c.modified == 0)
+      continue;
+    // Strings are only stored once, so a name already in the table has the same offset
+    Symbol name = cp.getSymbol(cp.get<const ConstantPool::Class_info>(clazz.this_class).name_index);
+    u4 name_offset = symbols[name];
+    slot = name.hash() & (capacity - 1);
+    while (true)
+    {
+      name_entry existing;
+      std::memcpy(&existing, out.bytes.data() + name_table_offset + slot * sizeof(name_entry), sizeof(existing));
+      if (existing.record_offset == 0)
+      {
+        name_entry added = {};
+        added.name_hash = name.hash();
+        added.source_modified = c.modified;
+        added.name_offset = name_offset;
+        added.record_offset = record_offset;
+        added.source_size = static_cast<u4>(c.source.size());
+        out.putAt(name_table_offset + slot * sizeof(name_entry), added);
+        break;
+      }
+      if (existing.name_offset == name_offset)
+        break;
+      slot = (slot + 1) & (capacity - 1);
+    }
+  }
+
+  header h = {};
+  std::memcpy(h.magic, archive_magic, sizeof(h.magic));
+  h.byte_order = byte_order_mark;
+  h.version = archive_version;
+  h.class_count = static_cast<u4>(classes.size());
+  h.table_capacity = static_cast<u4>(capacity);
+  h.table_offset = table_offset;
+  h.name_table_offset = name_table_offset;
+  h.archive_size = out.bytes.size();
+  out.putAt(0, h);
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(out.bytes.data()), out.bytes.size());
+  if (!file)
+    throw std::runtime_error("Unable to write " + path.string());
+}
+
+ClassArchive::ClassArchive(const fs::path& path)
+  : mapping(parsing::MappedFile::open(path)), class_count(0), table_capacity(0), table(nullptr), names(nullptr)
+{
+  header h;
+  if (mapping->size() < sizeof(h))
+    throw parsing::parse_failure("Not a class archive");
+  std::memcpy(&h, mapping->data(), sizeof(h));
+  if (std::memcmp(h.magic, archive_magic, sizeof(h.magic)) != 0)
+    throw parsing::parse_failure("Not a class archive");
+  if (h.byte_order != byte_order_mark || h.version != archive_version)
+    throw parsing::parse_failure("Class archive was written by a different version or platform");
+  if (h.archive_size != mapping->size() || h.table_capacity == 0
+      || (h.table_capacity & (h.table_capacity - 1)) != 0
+      || h.table_offset + u8(h.table_capacity) * sizeof(table_entry) > h.archive_size
+      || h.name_table_offset + u8(h.table_capacity) * sizeof(name_entry) > h.archive_size)
+    throw parsing::parse_failure("Class archive is truncated or corrupt");
+  class_count = h.class_count;
+  table_capacity = h.table_capacity;
+  table = mapping->data() + h.table_offset;
+  names = mapping->data() + h.name_table_offset;
+}
+
+optional<ClassFile> ClassArchive::find(const JUtf8String& name, u8 size, u8 modified) const
+{
+  u8 hash = name.hash();
+  std::size_t slot = hash & (table_capacity - 1);
+  for (std::size_t probes = 0; probes < table_capacity; probes++, slot = (slot + 1) & (table_capacity - 1))
+  {
+    name_entry entry;
+    std::memcpy(&entry, names + slot * sizeof(name_entry), sizeof(entry));
+    if (entry.record_offset == 0)
+      break;
+    if (entry.name_hash != hash || stringAt(entry.name_offset, *mapping) != name.view())
+      continue;
+    // Only one class is archived under each name, so a changed class file isn't found at all
+    if (entry.source_size != size || entry.source_modified != modified)
+      break;
+    return materialise(entry.record_offset);
+  }
+  return optional<ClassFile>();
+}
+
+optional<ClassFile> ClassArchive::load(parsing::ByteView source) const
+{
+  auto digest = Sha256::hash(source);
+  // A table with no empty slot, which only a corrupt archive has, is probed once through
+  std::size_t slot = homeSlot(digest, table_capacity);
+  for (std::size_t probes = 0; probes < table_capacity; probes++, slot = (slot + 1) & (table_capacity - 1))
+  {
+    table_entry entry;
+    std::memcpy(&entry, table + slot * sizeof(table_entry), sizeof(entry));
+    if (entry.record_offset == 0)
+      break;
+    if (entry.digest == digest && entry.source_size == source.size())
+      return materialise(entry.record_offset);
+  }
+  return optional<ClassFile>();
+}
+
+parsing::ByteView ClassArchive::stringAt(u4 offset, const parsing::MappedFile& mapping)
+{
+  const u1* base = mapping.data();
+  std::size_t size = mapping.size();
+  if (offset < sizeof(symbol_header) || offset > size - 2)
+    throw parsing::parse_failure("Class archive is truncated or corrupt");
+  std::size_t length = (base[offset] << 8) | base[offset + 1];
+  if (length > size - offset - 2)
+    throw parsing::parse_failure("Class archive is truncated or corrupt");
+  return parsing::ByteView(base + offset + 2, length);
+}
+
+void ClassArchive::checkConstantPool(const ConstantPool& cp, const std::vector<u4>& offsets,
+                                     const parsing::MappedFile& mapping)
+{
+  for (u4 offset : offsets)
+    stringAt(offset, mapping);
+  std::size_t count = cp.tags.size();
+  auto refers = [count](u4 index) { return index != 0 && index < count; };
+  bool valid = count != 0 && cp.tags[0] == ConstantPool::Invalid;
+  for (std::size_t i = 1; i < count && valid; i++)
+  {
+    u4 payload = cp.payloads[i];
+    switch (cp.tags[i])
+    {
+    case ConstantPool::Utf8:
+      valid = payload < offsets.size();
+      break;
+    case ConstantPool::Integer:
+    case ConstantPool::Float:
+      break;
+    case ConstantPool::Long:
+    case ConstantPool::Double:
+      // The upper half is skipped, as it's only valid here
+      valid = i + 1 < count && cp.tags[++i] == ConstantPool::Invalid;
+      break;
+    case ConstantPool::Class:
+    case ConstantPool::String:
+    case ConstantPool::MethodType:
+      valid = refers(payload);
+      break;
+    case ConstantPool::Fieldref:
+    case ConstantPool::Methodref:
+    case ConstantPool::InterfaceMethodref:
+    case ConstantPool::NameAndType:
+      valid = refers(ConstantPool::high(payload)) && refers(ConstantPool::low(payload));
+      break;
+    case ConstantPool::MethodHandle:
+      valid = ConstantPool::high(payload) >= ConstantPool::getField
+              && ConstantPool::high(payload) <= ConstantPool::invokeInterface && refers(ConstantPool::low(payload));
+      break;
+    case ConstantPool::InvokeDynamic:
+      // The bootstrap method index is checked once the class' attributes have been read
+      valid = refers(ConstantPool::low(payload));
+      break;
+    default:
+      valid = false;
+    }
+  }
+  if (!valid)
+    throw parsing::parse_failure("Class archive is truncated or corrupt");
+}
+
+ClassFile ClassArchive::materialise(u4 record_offset) const
+{
+  const u1* base = mapping->data();
+  if (record_offset >= mapping->size())
+    throw parsing::parse_failure("Class archive is truncated or corrupt");
+  input in(base + record_offset, base + mapping->size());
+  auto rh = in.get<record_header>();
+  ClassFile clazz(mapping);
+  clazz.minor_version = rh.minor_version;
+  clazz.major_version = rh.major_version;
+  clazz.constant_pool_count = rh.constant_pool_count;
+  clazz.flags = static_cast<ClassFile::access_flags>(rh.flags);
+  clazz.this_class = rh.this_class;
+  clazz.super_class = rh.super_class;
+
+  ConstantPool& cp = clazz.constant_pool;
+  auto entries = std::make_shared<ConstantPool::lazy_entries>();
+  in.getAll(cp.payloads, rh.constant_pool_count);
+  in.getAll(entries->offsets, rh.utf8_count);
+  in.getAll(cp.tags, rh.constant_pool_count);
+  in.getAll(entries->uses, rh.utf8_count);
+  checkConstantPool(cp, entries->offsets, *mapping);
+  entries->data = base;
+  entries->length = mapping->size();
+  entries->backing = mapping;
+  entries->major_version = rh.major_version;
+  entries->minor_version = rh.minor_version;
+  entries->lazy = true;
+  entries->trusted = true;
+  entries->decoded.reset(new std::atomic<const ConstantPool::utf8_entry*>[rh.utf8_count]());
+  entries->validated.reset(new std::atomic<bool>[cp.tags.size()]);
+  for (std::size_t i = 0; i < cp.tags.size(); i++)
+    entries->validated[i].store(true, std::memory_order_relaxed);
+  cp.deferred = std::move(entries);
+
+  in.align(2, base);
+  in.getAll(clazz.interfaces, rh.interfaces_count);
+  getMembers(in, clazz.fields, rh.fields_count);
+  getMembers(in, clazz.methods, rh.methods_count);
+  // The attributes are parsed again, but straight from the mapping, so the lazy ones stay there
+  for (auto& field : clazz.fields)
+  {
+    auto section = in.sized();
+    parsing::ByteConsumer bc(section.data(), section.size(), mapping);
+    clazz.parseFieldAttributesSection(bc, field.attrs, bc.readU2());
+  }
+  for (auto& method : clazz.methods)
+  {
+    auto section = in.sized();
+    parsing::ByteConsumer bc(section.data(), section.size(), mapping);
+    clazz.parseMethodAttributesSection(bc, method.attrs, bc.readU2());
+  }
+  auto section = in.sized();
+  parsing::ByteConsumer bc(section.data(), section.size(), mapping);
+  clazz.parseClassAttributesSection(bc, clazz.attrs, bc.readU2());
+  clazz.validateBootstrapMethods();
+  // Code isn't archived decoded either
+  clazz.decodeInstructions();
+  return clazz;
+}
+
+}
@@ -0,0 +1,209 @@
+/**
+ * \file ClassArchive.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_CLASSARCHIVE_H_
+#define SRC_MIMIC_CLASSARCHIVE_H_
+
+#include "Common.h"
+#include "ClassFile.h"
+#include "Sha256.h"
+#include "parsing/ByteView.h"
+#include "parsing/MappedFile.h"
+
+namespace mimic
+{
+
+/**
+ * A file of classes which have already been parsed and validated, which can
+ * be mapped at startup so that the classes' constant pools and member tables
+ * can be used without parsing them again
+ *
+ * The archive holds each distinct string used by its classes once, with its
+ * hash and length worked out, followed by each class' constant pool tags and
+ * payloads and its interface, field and method tables. Everything refers to
+ * everything else by offset from the start of the file, so the archive can be
+ * mapped read-only at any address. A class loaded from the archive has a lazy
+ * constant pool that reads its strings straight from the mapping. Only the
+ * pool's shape is checked when a class is loaded: its entries were validated
+ * when the archive was written, and aren't validated again.
+ *
+ * Classes can be found by name together with the size and modification time
+ * of their class files, which is how a class path with an archive finds them:
+ * it only has to look at a class file's attributes, not read it, and a class
+ * file that has been rewritten since the archive was written isn't found, and
+ * is parsed as usual. Classes can also be found by the SHA-256 digest and size
+ * of the .class file they were parsed from, which needs the whole file but
+ * doesn't depend on its modification time.
+ *
+ * The format depends on the byte order and word size of the machine that
+ * wrote it, and on the version of this code; an archive that doesn't match
+ * is rejected when opened.
+ *
+ * Attributes aren't archived in decoded form: they're stored as they were in
+ * the class file and parsed again every time a class is loaded, so that the
+ * bulky ones that are only decoded when asked for are read straight from the
+ * mapping. Each method's code is likewise decoded into an InstructionStream
+ * again on every load, which checks it as it goes.
+ */
+class ClassArchive
+{
+public:
+  /**
+   * Stored before each string in the archive, which is then laid out as a
+   * class file's Utf8 entry is: a big-endian u2 size followed by the bytes
+   */
+  struct symbol_header
+  {
+    u8 hash;
+    u2 length;
+    u2 reserved[3];
+  };
+
+  /**
+   * Collects classes and writes them to an archive
+   */
+  class Writer
+  {
+  public:
+    /**
+     * Parses and validates a class, and adds it to the archive. A class file
+     * identical to one already added is ignored.
+     *
+     * @param source the contents of a .class file
+     * @param modified the class file's modification time, as modificationTime()
+     *        gives it, or 0 if the class isn't to be found by name
+     * @throws parse_failure or runtime_error if the class is invalid
+     * @throws runtime_error if a different class file with the same digest
+     *         has already been added
+     */
+    void add(parsing::ByteView source, u8 modified = 0);
+
+    /**
+     * @return the number of classes added
+     */
+    std::size_t getClassCount() const { return classes.size(); };
+
+    /**
+     * Writes the archive
+     *
+     * @param path the file to write, which is replaced if it exists
+     * @throws runtime_error if the archive can't be written
+     */
+    void write(const fs::path& path) const;
+
+  private:
+    struct pending
+    {
+      Sha256::digest digest;
+      u8 modified;
+      /** The class file, to tell a digest collision from the same class added twice */
+      std::vector<u1> source;
+      ClassFile clazz;
+      /** The attributes sections of each field, each method and the class, in that order */
+      std::vector<std::vector<u1>> attribute_sections;
+    };
+
+    std::vector<pending> classes;
+  };
+
+  ClassArchive() = delete;
+  ClassArchive(const ClassArchive&) = delete;
+  ClassArchive& operator=(const ClassArchive&) = delete;
+
+  /**
+   * Maps an archive
+   *
+   * @param path the archive
+   * @throws runtime_error if the archive can't be mapped
+   * @throws parse_failure if the file isn't an archive this code can read
+   */
+  explicit ClassArchive(const fs::path& path);
+
+  static std::shared_ptr<const ClassArchive> open(const fs::path& path)
+  {
+    return std::make_shared<const ClassArchive>(path);
+  }
+
+  /**
+   * @return the number of classes in the archive
+   */
+  std::size_t getClassCount() const { return class_count; };
+
+  /**
+   * @param path a file
+   * @return the file's modification time as a count of nanoseconds, never 0
+   * @throws filesystem_error if the file's attributes can't be read
+   */
+  static u8 modificationTime(const fs::path& path);
+
+  /**
+   * Finds a class in the archive by name, without reading its class file. If
+   * classes from more than one class file with the same name were archived,
+   * only the first one added can be found.
+   *
+   * @param name the class' binary name, e.g. java/lang/Object
+   * @param size the size of the class' .class file
+   * @param modified the class file's modification time, from modificationTime()
+   * @return the class, or nothing if the archive doesn't hold a class with that
+   *         name parsed from a class file of that size and modification time
+   */
+  optional<ClassFile> find(const JUtf8String& name, u8 size, u8 modified) const;
+
+  /**
+   * Loads a class from the archive, if it's there
+   *
+   * @param source the current contents of the class' .class file
+   * @return the class, or nothing if the archive doesn't hold a class
+   *         parsed from exactly those contents
+   */
+  optional<ClassFile> load(parsing::ByteView source) const;
+
+private:
+  std::shared_ptr<const parsing::MappedFile> mapping;
+  u4 class_count;
+  u4 table_capacity;
+  /** The hash table of classes, open-addressed by digest */
+  const u1* table;
+  /** The hash table of classes, open-addressed by the hash of their names */
+  const u1* names;
+
+  /** @return the slot of the table a class' entry is first looked for in */
+  static std::size_t homeSlot(const Sha256::digest& digest, std::size_t capacity);
+
+  ClassFile materialise(u4 record_offset) const;
+
+  /**
+   * @param offset the offset of a string's size from the start of the archive
+   * @return the string's bytes
+   * @throws parse_failure if the string or the symbol_header before it isn't
+   *         within the archive
+   */
+  static parsing::ByteView stringAt(u4 offset, const parsing::MappedFile& mapping);
+
+  /**
+   * Checks the shape of a class' constant pool before it's trusted, as its
+   * entries aren't validated again when they are used: that every tag is
+   * one a class file can have, that each Long and Double is followed by its
+   * unusable upper half, that every index an entry holds is within the pool,
+   * and that every Utf8 entry is within the archive
+   *
+   * @param offsets the offset of each Utf8 slot's size
+   * @throws parse_failure if any of those isn't so
+   */
+  static void checkConstantPool(const ConstantPool& cp, const std::vector<u4>& offsets,
+                                const parsing::MappedFile& mapping);
+
+  /**
+   * @param source a class file that has already been parsed successfully
+   * @return the attributes sections of each field, each method and the class
+   */
+  static std::vector<std::vector<u1>> attributeSections(parsing::ByteView source);
+};
+
+}
+
+#endif /* SRC_MIMIC_CLASSARCHIVE_H_ */
@@ -6,53 +6,89 @@
  */
 
 #include "ClassFile.h"
+#include <cstring>
 #include "ClassValidator.h"
+#include "ParseTrace.h"
 #include "parsing/ByteConsumer.h"
+#include "parsing/MappedFile.h"
 
 namespace mimic
 {
 
-ClassFile::ClassFile(parsing::ByteConsumer& bc)
+ClassFile::ClassFile(parsing::ByteConsumer& bc, ConstantPool::decoding decoding)
 {
-  magic = bc.readU4();
-  std::cout << "magic: " << std::setw(8) << std::hex << magic << std::dec << std::endl;
-  if (magic != 0xCAFEBABE)
+  parse(bc, decoding);
+}
+
+ClassFile::ClassFile(const fs::path& path, ConstantPool::decoding decoding)
+{
+  auto mapping = parsing::MappedFile::open(path);
+  parsing::ByteConsumer bc(mapping->data(), mapping->size(), mapping);
+  parse(bc, decoding);
+}
+
+void ClassFile::parse(parsing::ByteConsumer& bc, ConstantPool::decoding decoding)
+{
+  backing = bc.getBacking();
+  u4 trace = ParseTrace::beginClass(bc.position());
+  try
   {
-    std::stringstream ss;
-    ss << "Invalid magic number: ";
-    ss << std::hex << std::setw(2) << magic;
-    throw parsing::parse_failure(ss.str().c_str());
-  }
-  minor_version = bc.readU2();
-  major_version = bc.readU2();
-  std::cout << "version: " << major_version << "." << minor_version << std::endl;
-  constant_pool_count = bc.readU2();
-  std::cout << "constant pool count: " << constant_pool_count << std::endl;
-  constant_pool = ConstantPool(bc, constant_pool_count);
-  ClassValidator::validateConstantPool(constant_pool, major_version, minor_version);
-  flags = static_cast<access_flags>(bc.readU2());
-  std::cout << "access flags: " << flags << std::endl;
-  this_class = bc.readU2();
-  std::cout << "this: " << this_class << std::endl;
-  super_class = bc.readU2();
-  std::cout << "super: " << super_class << std::endl;
-  u2 interfaces_count = bc.readU2();
-  std::cout << "interfaces count: " << interfaces_count << std::endl;
-  for (u2 i = 0; i < interfaces_count; i++) {
-    interfaces.push_back(bc.readU2());
+    magic = bc.readU4();
+    if (magic != 0xCAFEBABE)
+    {
+      std::stringstream ss;
+      ss << "Invalid magic number: ";
+      ss << std::hex << std::setw(2) << magic;
+      throw parsing::parse_failure(ss.str().c_str());
+    }
+    minor_version = bc.readU2();
+    major_version = bc.readU2();
+    ParseTrace::record(trace, ParseTrace::version, bc.position() - 4, (major_version << 16) | minor_version);
+    constant_pool_count = bc.readU2();
+    ParseTrace::record(trace, ParseTrace::constant_pool, bc.position(), constant_pool_count);
+    /* Only index the pool for now, as which Utf8 entries are descriptors
+     * isn't known until the fields and methods have been read */
+    constant_pool = ConstantPool::index(bc, constant_pool_count, major_version, minor_version);
+    flags = static_cast<access_flags>(bc.readU2());
+    this_class = bc.readU2();
+    super_class = bc.readU2();
+    u2 interfaces_count = bc.readU2();
+    ParseTrace::record(trace, ParseTrace::interfaces, bc.position(), interfaces_count);
+    for (u2 i = 0; i < interfaces_count; i++) {
+      interfaces.push_back(bc.readU2());
+    }
+    u2 fields_count = bc.readU2();
+    ParseTrace::record(trace, ParseTrace::fields, bc.position(), fields_count);
+    parseFieldInfoSection(bc, fields_count);
+    u2 methods_count = bc.readU2();
+    ParseTrace::record(trace, ParseTrace::methods, bc.position(), methods_count);
+    parseMethodInfoSection(bc, methods_count);
+    if (decoding == ConstantPool::eager)
+    {
+      constant_pool.decodeAll();
+      ClassValidator::validateConstantPool(constant_pool, major_version, minor_version);
+    }
+    else
+    {
+      // Lazy pools validate each entry as it's decoded
+      constant_pool.retain();
+    }
+    ParseTrace::record(trace, ParseTrace::constant_pool_validated, bc.position(), constant_pool_count);
+    u2 attributes_count = bc.readU2();
+    ParseTrace::record(trace, ParseTrace::attributes, bc.position(), attributes_count);
+    parseClassAttributesSection(bc, attrs, attributes_count);
+    validateBootstrapMethods();
+    decodeInstructions();
+    if (bc.bytesRemaining() != 0) {
+      throw parsing::parse_failure("Trailing bytes at end of class file");
+    }
   }
-  u2 fields_count = bc.readU2();
-  std::cout << "fields count: " << fields_count << std::endl;
-  parseFieldInfoSection(bc, fields_count);
-  u2 methods_count = bc.readU2();
-  std::cout << "methods count: " << methods_count << std::endl;
-  parseMethodInfoSection(bc, methods_count);
-  u2 attributes_count = bc.readU2();
-  std::cout << "attributes count: " << attributes_count << std::endl;
-  parseClassAttributesSection(bc, attrs, attributes_count);
-  if (bc.bytesRemaining() != 0) {
-    throw parsing::parse_failure("Trailing bytes at end of class file");
+  catch (...)
+  {
+    ParseTrace::record(trace, ParseTrace::class_failed, bc.position());
+    throw;
   }
+  ParseTrace::record(trace, ParseTrace::class_end, bc.position());
 }
 
 void ClassFile::parseFieldInfoSection(parsing::ByteConsumer& bc,
@@ -63,6 +99,7 @@ void ClassFile::parseFieldInfoSection(parsing::ByteConsumer& bc,
     info.flags = static_cast<access_flags>(bc.readU2());
     info.name_index = bc.readU2();
     info.descriptor_index = bc.readU2();
+    constant_pool.markDescriptor(info.descriptor_index, ConstantPool::field_descriptor);
     u2 attributes_count = bc.readU2();
     parseFieldAttributesSection(bc, info.attrs, attributes_count);
     fields.push_back(info);
@@ -77,6 +114,7 @@ void ClassFile::parseMethodInfoSection(parsing::ByteConsumer& bc,
     info.flags = static_cast<access_flags>(bc.readU2());
     info.name_index = bc.readU2();
     info.descriptor_index = bc.readU2();
+    constant_pool.markDescriptor(info.descriptor_index, ConstantPool::method_descriptor);
     u2 attributes_count = bc.readU2();
     parseMethodAttributesSection(bc, info.attrs, attributes_count);
     methods.push_back(info);
@@ -87,11 +125,53 @@ void ClassFile::parseClassAttributesSection(parsing::ByteConsumer& bc,
                                             std::vector<attributes::class_attr_type>& attributes,
                                             u2 attributes_count)
 {
+  attributes.reserve(attributes_count);
   for(u2 i = 0; i < attributes_count; i++) {
     u2 attribute_name_index = bc.readU2();
     u4 attribute_length = bc.readU4();
-    std::vector<u1> info = bc.readBytes(attribute_length);
-    //attributes.push_back(info);
+    parsing::ByteView info = bc.readBytes(attribute_length);
+    switch (attributeKind(attribute_name_index))
+    {
+    case AttributeParser::attr_inner_classes:
+      attributes.push_back(AttributeParser::decode<attributes::inner_classes>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_enclosing_method:
+      attributes.push_back(AttributeParser::decode<attributes::enclosing_method>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_synthetic:
+      attributes.push_back(AttributeParser::decode<attributes::synthetic>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_signature:
+      attributes.push_back(AttributeParser::decode<attributes::signature>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_source_file:
+      attributes.push_back(AttributeParser::decode<attributes::source_file>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_source_debug_extension:
+      attributes.push_back(deferred<attributes::source_debug_extension>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_deprecated:
+      attributes.push_back(AttributeParser::decode<attributes::deprecated>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_visible_annotations:
+      attributes.push_back(deferred<attributes::runtime_visible_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_invisible_annotations:
+      attributes.push_back(deferred<attributes::runtime_invisible_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_visible_type_annotations:
+      attributes.push_back(deferred<attributes::runtime_visible_type_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_invisible_type_annotations:
+      attributes.push_back(deferred<attributes::runtime_invisible_type_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_bootstrap_methods:
+      attributes.push_back(AttributeParser::decode<attributes::bootstrap_methods>(attribute_name_index, info));
+      break;
+    default:
+      // Attributes that aren't recognised, or don't belong to a class, are ignored
+      break;
+    }
   }
 }
 
@@ -99,11 +179,34 @@ void ClassFile::parseCodeAttributesSection(parsing::ByteConsumer& bc,
                                            std::vector<attributes::code_attr_type>& attributes,
                                            u2 attributes_count)
 {
+  attributes.reserve(attributes_count);
   for(u2 i = 0; i < attributes_count; i++) {
     u2 attribute_name_index = bc.readU2();
     u4 attribute_length = bc.readU4();
-    std::vector<u1> info = bc.readBytes(attribute_length);
-    //attributes.push_back(info);
+    parsing::ByteView info = bc.readBytes(attribute_length);
+    switch (attributeKind(attribute_name_index))
+    {
+    case AttributeParser::attr_stack_map_table:
+      attributes.push_back(deferred<attributes::stack_map_table>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_line_number_table:
+      attributes.push_back(AttributeParser::decode<attributes::line_number_table>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_local_variable_table:
+      attributes.push_back(deferred<attributes::local_variable_table>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_local_variable_type_table:
+      attributes.push_back(deferred<attributes::local_variable_type_table>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_visible_type_annotations:
+      attributes.push_back(deferred<attributes::runtime_visible_type_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_invisible_type_annotations:
+      attributes.push_back(deferred<attributes::runtime_invisible_type_annotations>(bc, attribute_name_index, info));
+      break;
+    default:
+      break;
+    }
   }
 }
 
@@ -111,11 +214,40 @@ void ClassFile::parseFieldAttributesSection(parsing::ByteConsumer& bc,
                                             std::vector<attributes::field_attr_type>& attributes,
                                             u2 attributes_count)
 {
+  attributes.reserve(attributes_count);
   for(u2 i = 0; i < attributes_count; i++) {
     u2 attribute_name_index = bc.readU2();
     u4 attribute_length = bc.readU4();
-    std::vector<u1> info = bc.readBytes(attribute_length);
-    //attributes.push_back(info);
+    parsing::ByteView info = bc.readBytes(attribute_length);
+    switch (attributeKind(attribute_name_index))
+    {
+    case AttributeParser::attr_constant_value:
+      attributes.push_back(AttributeParser::decode<attributes::constant_value>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_synthetic:
+      attributes.push_back(AttributeParser::decode<attributes::synthetic>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_signature:
+      attributes.push_back(AttributeParser::decode<attributes::signature>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_deprecated:
+      attributes.push_back(AttributeParser::decode<attributes::deprecated>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_visible_annotations:
+      attributes.push_back(deferred<attributes::runtime_visible_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_invisible_annotations:
+      attributes.push_back(deferred<attributes::runtime_invisible_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_visible_type_annotations:
+      attributes.push_back(deferred<attributes::runtime_visible_type_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_invisible_type_annotations:
+      attributes.push_back(deferred<attributes::runtime_invisible_type_annotations>(bc, attribute_name_index, info));
+      break;
+    default:
+      break;
+    }
   }
 }
 
@@ -123,11 +255,140 @@ void ClassFile::parseMethodAttributesSection(parsing::ByteConsumer& bc,
                                              std::vector<attributes::method_attr_type>& attributes,
                                              u2 attributes_count)
 {
+  attributes.reserve(attributes_count);
   for(u2 i = 0; i < attributes_count; i++) {
     u2 attribute_name_index = bc.readU2();
     u4 attribute_length = bc.readU4();
-    std::vector<u1> info = bc.readBytes(attribute_length);
-    //attributes.push_back(info);
+    parsing::ByteView info = bc.readBytes(attribute_length);
+    switch (attributeKind(attribute_name_index))
+    {
+    case AttributeParser::attr_code:
+      attributes.push_back(parseCode(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_exceptions:
+      attributes.push_back(AttributeParser::decode<attributes::exceptions>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_synthetic:
+      attributes.push_back(AttributeParser::decode<attributes::synthetic>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_signature:
+      attributes.push_back(AttributeParser::decode<attributes::signature>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_deprecated:
+      attributes.push_back(AttributeParser::decode<attributes::deprecated>(attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_visible_annotations:
+      attributes.push_back(deferred<attributes::runtime_visible_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_invisible_annotations:
+      attributes.push_back(deferred<attributes::runtime_invisible_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_visible_parameter_annotations:
+      attributes.push_back(
+          deferred<attributes::runtime_visible_parameter_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_invisible_parameter_annotations:
+      attributes.push_back(
+          deferred<attributes::runtime_invisible_parameter_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_visible_type_annotations:
+      attributes.push_back(deferred<attributes::runtime_visible_type_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_runtime_invisible_type_annotations:
+      attributes.push_back(deferred<attributes::runtime_invisible_type_annotations>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_annotation_default:
+      attributes.push_back(deferred<attributes::annotation_default>(bc, attribute_name_index, info));
+      break;
+    case AttributeParser::attr_method_parameters:
+      attributes.push_back(AttributeParser::decode<attributes::method_parameters>(attribute_name_index, info));
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+attributes::code ClassFile::parseCode(parsing::ByteConsumer& bc, u2 attribute_name_index, parsing::ByteView info)
+{
+  // Read the code's own attributes from the same buffer, so they can be retained in the same way
+  parsing::ByteConsumer in(info.data(), info.size(), bc.getBacking());
+  attributes::code code;
+  code.attribute_name_index = attribute_name_index;
+  code.max_stack = in.readU2();
+  code.max_locals = in.readU2();
+  u4 code_length = in.readU4();
+  if (code_length == 0 || code_length > 65535)
+    throw parsing::parse_failure("Invalid code length");
+  code.code = in.readBytes(code_length);
+  u2 exception_table_length = in.readU2();
+  code.exception_table.reserve(exception_table_length);
+  for (u2 i = 0; i < exception_table_length; i++)
+  {
+    attributes::exception_info handler;
+    handler.start_pc = in.readU2();
+    handler.end_pc = in.readU2();
+    handler.handler_pc = in.readU2();
+    handler.catch_type = in.readU2();
+    code.exception_table.push_back(handler);
+  }
+  u2 attributes_count = in.readU2();
+  parseCodeAttributesSection(in, code.attrs, attributes_count);
+  if (in.bytesRemaining() != 0)
+    throw parsing::parse_failure("Attribute length does not match its contents");
+  return code;
+}
+
+AttributeParser::kind ClassFile::attributeKind(u2 name_index) const
+{
+  const ConstantPool& cp = constant_pool;
+  if (name_index == 0 || name_index >= cp.size() || cp.tags[name_index] != ConstantPool::Utf8)
+    throw parsing::parse_failure("Attribute name is not a Utf8 entry");
+  /* Until the pool has been decoded or retained it isn't known which
+   * entries are descriptors, so match the entry's bytes without decoding it */
+  AttributeParser::kind kind = cp.deferred && !cp.deferred->lazy
+                                 ? AttributeParser::kindOf(cp.rawUtf8(name_index))
+                                 : AttributeParser::kindOf(cp.getSymbol(name_index));
+  return major_version >= AttributeParser::firstVersion(kind) ? kind : AttributeParser::attr_unknown;
+}
+
+parsing::ByteView ClassFile::retain(const parsing::ByteConsumer& bc, parsing::ByteView info)
+{
+  if (bc.getBacking() || info.empty())
+    return info;
+  if (!copies)
+    copies = std::make_shared<std::vector<std::unique_ptr<u1[]>>>();
+  std::unique_ptr<u1[]> copy(new u1[info.size()]);
+  std::memcpy(copy.get(), info.data(), info.size());
+  copies->push_back(std::move(copy));
+  return parsing::ByteView(copies->back().get(), info.size());
+}
+
+void ClassFile::validateBootstrapMethods() const
+{
+  const attributes::bootstrap_methods* methods = nullptr;
+  for (auto& attribute : attrs)
+  {
+    methods = getIf<attributes::bootstrap_methods>(attribute);
+    if (methods)
+      break;
+  }
+  ClassValidator::validateBootstrapMethods(constant_pool, methods);
+}
+
+void ClassFile::decodeInstructions()
+{
+  for (auto& method : methods)
+  {
+    for (auto& attribute : method.attrs)
+    {
+      auto code = getIf<attributes::code>(attribute);
+      if (code)
+      {
+        method.instructions = std::make_shared<const InstructionStream>(*code, constant_pool, major_version);
+        break;
+      }
+    }
   }
 }
 
@@ -9,11 +9,13 @@
 #define SRC_MIMIC_CLASSFILE_H_
 
 #include "Common.h"
+#include "AttributeParser.h"
 #include "class_attributes.h"
 #include "code_attributes.h"
 #include "field_attributes.h"
 #include "method_attributes.h"
 #include "ConstantPool.h"
+#include "InstructionStream.h"
 #include "parsing/ByteConsumer.h"
 #include "parsing/ParseFailureException.h"
 
@@ -33,15 +35,18 @@ public:
     acc_protected = 0x0004,
     acc_static = 0x0008,
     acc_final = 0x0010,
+    acc_super = 0x0020,
     acc_synchronized = 0x0020,
     acc_bridge = 0x0040,
     acc_volatile = 0x0040,
     acc_transient = 0x0080,
     acc_varargs = 0x0080,
     acc_native = 0x0100,
+    acc_interface = 0x0200,
     acc_abstract = 0x0400,
     acc_strict = 0x0800,
     acc_synthetic = 0x1000,
+    acc_annotation = 0x2000,
     acc_enum = 0x4000
   };
 
@@ -59,37 +64,59 @@ public:
     u2 name_index;
     u2 descriptor_index;
     std::vector<attributes::method_attr_type> attrs;
+    /** The method's code, decoded for running, or null if it has none */
+    std::shared_ptr<const InstructionStream> instructions;
   } method_info;
 
   ClassFile() = delete;
-  ClassFile(const ClassFile&);
-  ClassFile(const ClassFile&&);
+  ClassFile(const ClassFile&) = default;
+  ClassFile(ClassFile&&) = default;
+  ClassFile& operator=(const ClassFile&) = default;
+  ClassFile& operator=(ClassFile&&) = default;
   /**
    * Parses the Class file
    *
    * @param ByteConsumer containing the class data
+   * @param decoding whether to decode the constant pool eagerly or lazily
    * @return the parsed ClassFile
    */
-  ClassFile(parsing::ByteConsumer&);
+  ClassFile(parsing::ByteConsumer&, ConstantPool::decoding decoding = ConstantPool::eager);
+
+  /**
+   * Memory-maps and parses a .class file. The mapping is held for the
+   * lifetime of the ClassFile and constant pool strings refer directly into it.
+   *
+   * @param path the path of the .class file
+   * @param decoding whether to decode the constant pool eagerly or lazily
+   * @return the parsed ClassFile
+   */
+  ClassFile(const fs::path& path, ConstantPool::decoding decoding = ConstantPool::eager);
   virtual ~ClassFile();
 
-  auto getMajorVersion() { return major_version; };
-  auto getMinorVersion() { return minor_version; };
-  auto getConstantPoolCount() { return constant_pool_count; };
-  auto getConstantPool() { return constant_pool; };
-  auto getAccessFlags() { return flags; };
-  auto getThisClass() { return this_class; };
-  auto getSuperClass() { return super_class; };
-  auto getInterfaceCount() { return interfaces.size(); };
-  auto getInterfaces() { return interfaces; };
-  auto getFieldCount() { return fields.size(); };
-  auto getFields() { return fields; };
-  auto getMethodsCount() { return methods.size(); };
-  auto getMethods() { return methods; };
-  auto getAttributesCount() { return attrs.size(); };
-  auto getAttributes() { return attrs; };
+  /*
+   * The accessors below return references into the ClassFile rather than
+   * copies, so they are only valid for as long as it is. Take a copy
+   * explicitly if one is really needed.
+   */
+  u2 getMajorVersion() const { return major_version; };
+  u2 getMinorVersion() const { return minor_version; };
+  u2 getConstantPoolCount() const { return constant_pool_count; };
+  const ConstantPool& getConstantPool() const { return constant_pool; };
+  access_flags getAccessFlags() const { return flags; };
+  u2 getThisClass() const { return this_class; };
+  u2 getSuperClass() const { return super_class; };
+  std::size_t getInterfaceCount() const { return interfaces.size(); };
+  const std::vector<u2>& getInterfaces() const { return interfaces; };
+  std::size_t getFieldCount() const { return fields.size(); };
+  const std::vector<field_info>& getFields() const { return fields; };
+  std::size_t getMethodsCount() const { return methods.size(); };
+  const std::vector<method_info>& getMethods() const { return methods; };
+  std::size_t getAttributesCount() const { return attrs.size(); };
+  const std::vector<attributes::class_attr_type>& getAttributes() const { return attrs; };
 
 private:
+  friend class ClassArchive;
+
   u4 magic;
   u2 minor_version;
   u2 major_version;
@@ -102,13 +129,60 @@ private:
   std::vector<field_info> fields;
   std::vector<method_info> methods;
   std::vector<attributes::class_attr_type> attrs;
+  /** Owner of the memory the class was parsed from, if it was retained */
+  std::shared_ptr<const void> backing;
+  /**
+   * Copies of the lazily decoded attributes' info, when the class was parsed
+   * from memory that couldn't be retained
+   */
+  std::shared_ptr<std::vector<std::unique_ptr<u1[]>>> copies;
 
+  /**
+   * Constructs an empty ClassFile for ClassArchive to fill in
+   *
+   * @param backing the owner of the memory the class will refer to
+   */
+  explicit ClassFile(std::shared_ptr<const void> backing)
+    : magic(0xCAFEBABE), minor_version(0), major_version(0), constant_pool_count(0),
+      flags(static_cast<access_flags>(0)), this_class(0), super_class(0), backing(std::move(backing))
+  {
+  }
+
+  void parse(parsing::ByteConsumer&, ConstantPool::decoding);
   void parseFieldInfoSection(parsing::ByteConsumer&, u2);
   void parseMethodInfoSection(parsing::ByteConsumer&, u2);
   void parseClassAttributesSection(parsing::ByteConsumer&, std::vector<attributes::class_attr_type>&, u2);
   void parseCodeAttributesSection(parsing::ByteConsumer&, std::vector<attributes::code_attr_type>&, u2);
   void parseFieldAttributesSection(parsing::ByteConsumer&, std::vector<attributes::field_attr_type>&, u2);
   void parseMethodAttributesSection(parsing::ByteConsumer&, std::vector<attributes::method_attr_type>&, u2);
+  attributes::code parseCode(parsing::ByteConsumer&, u2, parsing::ByteView);
+  void validateBootstrapMethods() const;
+  /** Decodes the code of each method, once the constant pool is complete */
+  void decodeInstructions();
+
+  /**
+   * @param name_index the attribute_name_index of an attribute
+   * @return the kind of attribute, or attr_unknown if it isn't one this
+   *         class' version defines
+   * @throws parse_failure if name_index isn't a Utf8 entry
+   */
+  AttributeParser::kind attributeKind(u2 name_index) const;
+
+  /**
+   * Keeps the info of a lazily decoded attribute for as long as the class,
+   * by copying it if the ByteConsumer's buffer can't be retained
+   *
+   * @param bc the ByteConsumer the info was read from
+   * @param info the attribute's info
+   * @return a view of the info that lives as long as the class
+   */
+  parsing::ByteView retain(const parsing::ByteConsumer& bc, parsing::ByteView info);
+
+  template <typename T> attributes::lazy<T> deferred(const parsing::ByteConsumer& bc, u2 name_index,
+                                                     parsing::ByteView info)
+  {
+    return attributes::lazy<T>{name_index, retain(bc, info)};
+  }
 };
 
 }
@@ -0,0 +1,173 @@
+/**
+ * \file ClassFileLoader.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "ClassFileLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace mimic
+{
+
+namespace
+{
+/**
+ * The files waiting to be loaded by one thread. The owner takes work from
+ * the back and thieves take it from the front, so they rarely want the same
+ * entry.
+ */
+struct work_queue
+{
+  std::mutex lock;
+  std::deque<std::size_t> indices;
+
+  bool take(std::size_t& index)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (indices.empty())
+      return false;
+    index = indices.back();
+    indices.pop_back();
+    return true;
+  }
+
+  bool steal(std::size_t& index)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (indices.empty())
+      return false;
+    index = indices.front();
+    indices.pop_front();
+    return true;
+  }
+};
+
+void loadOne(ClassFileLoader::result& result, ConstantPool::decoding decoding, const ClassArchive* archive)
+{
+  try
+  {
+    if (!archive)
+    {
+      result.clazz = ClassFile(result.path, decoding);
+      return;
+    }
+    auto mapping = parsing::MappedFile::open(result.path);
+    result.clazz = archive->load(mapping->view());
+    if (result.clazz)
+    {
+      result.archived = true;
+      return;
+    }
+    parsing::ByteConsumer bc(mapping->data(), mapping->size(), mapping);
+    result.clazz = ClassFile(bc, decoding);
+  }
+  catch (std::exception& e)
+  {
+    result.error = e.what();
+  }
+}
+
+/**
+ * Loads the files queued for one thread, then steals from the others until
+ * there's nothing left anywhere
+ */
+void work(std::vector<work_queue>& queues, std::size_t self, std::vector<ClassFileLoader::result>& results,
+          ConstantPool::decoding decoding, const ClassArchive* archive)
+{
+  std::size_t index;
+  for (;;)
+  {
+    if (queues[self].take(index))
+    {
+      loadOne(results[index], decoding, archive);
+      continue;
+    }
+    bool stolen = false;
+    for (std::size_t i = 1; i < queues.size() && !stolen; i++)
+      stolen = queues[(self + i) % queues.size()].steal(index);
+    // Nothing is ever added to a queue, so once every queue is empty we're done
+    if (!stolen)
+      return;
+    loadOne(results[index], decoding, archive);
+  }
+}
+}
+
+ClassFileLoader::ClassFileLoader(unsigned threads, ConstantPool::decoding decoding)
+  : threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())), decoding(decoding)
+{
+}
+
+ClassFileLoader::report ClassFileLoader::load(const std::vector<fs::path>& paths) const
+{
+  auto start = std::chrono::steady_clock::now();
+  report loaded;
+  loaded.results.resize(paths.size());
+  for (std::size_t i = 0; i < paths.size(); i++)
+    loaded.results[i].path = paths[i];
+
+  std::size_t workers = std::min<std::size_t>(threads, paths.size());
+  if (workers <= 1)
+  {
+    for (auto& result : loaded.results)
+      loadOne(result, decoding, archive.get());
+  }
+  else
+  {
+    // Deal out contiguous runs, so files from one directory tend to be
+    // loaded by the same thread
+    std::vector<work_queue> queues(workers);
+    for (std::size_t i = 0; i < paths.size(); i++)
+      queues[i * workers / paths.size()].indices.push_front(i);
+    std::vector<std::thread> pool;
+    try
+    {
+      // The calling thread does its share too
+      for (std::size_t i = 1; i < workers; i++)
+        pool.emplace_back(work, std::ref(queues), i, std::ref(loaded.results), decoding, archive.get());
+      work(queues, 0, loaded.results, decoding, archive.get());
+    }
+    catch (...)
+    {
+      // Destroying a thread that hasn't been joined terminates the program
+      for (auto& thread : pool)
+        thread.join();
+      throw;
+    }
+    for (auto& thread : pool)
+      thread.join();
+  }
+
+  loaded.loaded = std::count_if(loaded.results.begin(), loaded.results.end(),
+                                [](const result& r) { return r.loaded(); });
+  loaded.failed = loaded.results.size() - loaded.loaded;
+  loaded.archived = std::count_if(loaded.results.begin(), loaded.results.end(),
+                                  [](const result& r) { return r.archived; });
+  loaded.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return loaded;
+}
+
+ClassFileLoader::report ClassFileLoader::loadDirectory(const fs::path& directory) const
+{
+  return load(findClassFiles(directory));
+}
+
+std::vector<fs::path> ClassFileLoader::findClassFiles(const fs::path& directory)
+{
+  std::vector<fs::path> paths;
+  for (auto& entry : fs::recursive_directory_iterator(directory))
+  {
+    if (fs::is_regular_file(entry.path()) && entry.path().extension() == ".class")
+      paths.push_back(entry.path());
+  }
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+}
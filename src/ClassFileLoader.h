@@ -0,0 +1,112 @@
+/**
+ * \file ClassFileLoader.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_CLASSFILELOADER_H_
+#define SRC_MIMIC_CLASSFILELOADER_H_
+
+#include "Common.h"
+#include <string>
+#include "ClassArchive.h"
+#include "ClassFile.h"
+
+namespace mimic
+{
+
+/**
+ * Parses and validates many class files at once across a pool of threads
+ *
+ * Files are shared out between the threads up front, and a thread which
+ * runs out of work steals from the others, so a few large classes don't
+ * hold everything up. Results always come back in the order the paths were
+ * given, whichever thread parsed them.
+ *
+ * If given a ClassArchive, classes found in it are loaded from it instead of
+ * being parsed. Archived classes always have lazy constant pools.
+ */
+class ClassFileLoader
+{
+public:
+  /**
+   * The outcome of loading one file
+   */
+  struct result
+  {
+    fs::path path;
+    /** The parsed class, or nothing if it couldn't be loaded */
+    optional<ClassFile> clazz;
+    /** Why the class couldn't be loaded, or empty if it was */
+    std::string error;
+    /** Whether the class came from the archive */
+    bool archived = false;
+
+    bool loaded() const { return bool(clazz); };
+  };
+
+  /**
+   * The outcome of loading a set of files
+   */
+  struct report
+  {
+    /** One result per path, in the order the paths were given */
+    std::vector<result> results;
+    std::size_t loaded;
+    std::size_t failed;
+    /** How many of the classes loaded came from the archive */
+    std::size_t archived;
+    /** Wall clock time taken */
+    double seconds;
+
+    double classesPerSecond() const { return seconds > 0 ? results.size() / seconds : 0; };
+  };
+
+  /**
+   * @param threads the number of threads to parse with, or 0 to use one per
+   *        hardware thread
+   * @param decoding whether to decode constant pools eagerly or lazily
+   */
+  explicit ClassFileLoader(unsigned threads = 0, ConstantPool::decoding decoding = ConstantPool::eager);
+
+  /**
+   * Loads class files
+   *
+   * @param paths the files to load
+   * @return the results, in the same order as paths
+   */
+  report load(const std::vector<fs::path>& paths) const;
+
+  /**
+   * Loads every .class file under a directory
+   *
+   * @param directory the directory to search, including subdirectories
+   * @return the results, ordered by path
+   */
+  report loadDirectory(const fs::path& directory) const;
+
+  /**
+   * @param directory the directory to search, including subdirectories
+   * @return the paths of the .class files found, sorted so that the order
+   *         doesn't depend on the file system
+   */
+  static std::vector<fs::path> findClassFiles(const fs::path& directory);
+
+  unsigned getThreads() const { return threads; };
+
+  /**
+   * @param archive an archive to load classes from where possible, or
+   *        nullptr to always parse them
+   */
+  void setArchive(std::shared_ptr<const ClassArchive> archive) { this->archive = std::move(archive); };
+
+private:
+  unsigned threads;
+  ConstantPool::decoding decoding;
+  std::shared_ptr<const ClassArchive> archive;
+};
+
+}
+
+#endif /* SRC_MIMIC_CLASSFILELOADER_H_ */
@@ -0,0 +1,73 @@
+/**
+ * \file ClassPath.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "ClassPath.h"
+
+namespace mimic
+{
+
+ClassPath::ClassPath(const std::string& path)
+{
+  std::size_t start = 0;
+  for (;;)
+  {
+    std::size_t end = path.find(':', start);
+    std::string element = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    if (!element.empty())
+      add(fs::path(element));
+    if (end == std::string::npos)
+      break;
+    start = end + 1;
+  }
+}
+
+ClassPath::ClassPath(const std::vector<fs::path>& entries)
+{
+  for (auto& path : entries)
+    add(path);
+}
+
+void ClassPath::add(const fs::path& path)
+{
+  entry e;
+  e.path = path;
+  if (fs::is_regular_file(path))
+    e.archive = std::make_shared<const parsing::ZipArchive>(path);
+  entries.push_back(std::move(e));
+}
+
+std::shared_ptr<const ClassFile> ClassPath::find(const std::string& name) const
+{
+  for (auto& e : entries)
+  {
+    if (e.archive)
+    {
+      auto found = e.archive->findClass(name);
+      if (found)
+      {
+        auto bc = e.archive->open(*found);
+        return std::make_shared<const ClassFile>(*bc);
+      }
+    }
+    else
+    {
+      fs::path file = e.path / fs::path(name + ".class");
+      if (!fs::is_regular_file(file))
+        continue;
+      if (archive)
+      {
+        auto archived = archive->find(JUtf8String(name), fs::file_size(file), ClassArchive::modificationTime(file));
+        if (archived)
+          return std::make_shared<const ClassFile>(std::move(*archived));
+      }
+      return std::make_shared<const ClassFile>(file);
+    }
+  }
+  return nullptr;
+}
+
+}
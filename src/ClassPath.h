@@ -0,0 +1,78 @@
+/**
+ * \file ClassPath.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_CLASSPATH_H_
+#define SRC_MIMIC_CLASSPATH_H_
+
+#include "Common.h"
+#include <string>
+#include "ClassArchive.h"
+#include "ClassFile.h"
+#include "parsing/ZipArchive.h"
+
+namespace mimic
+{
+
+/**
+ * Finds classes by name in a list of directories and jar files, searched in
+ * order as java's -classpath option describes
+ */
+class ClassPath
+{
+public:
+  ClassPath() = default;
+
+  /**
+   * @param path directories and jar or ZIP files, separated by ':'. Empty
+   *        entries are ignored.
+   * @throws runtime_error if an archive can't be opened
+   */
+  explicit ClassPath(const std::string& path);
+
+  /**
+   * @param entries directories and jar or ZIP files
+   * @throws runtime_error if an archive can't be opened
+   */
+  explicit ClassPath(const std::vector<fs::path>& entries);
+
+  /**
+   * Finds and parses a class. A class file in a directory is loaded from the
+   * class archive instead if one has been set and holds the class, parsed from
+   * a file of the same size and modification time.
+   *
+   * @param name the class' binary name, e.g. java/lang/Object
+   * @return the class, or null if no entry has it
+   * @throws parse_failure if the class is found but can't be parsed
+   */
+  std::shared_ptr<const ClassFile> find(const std::string& name) const;
+
+  std::size_t size() const { return entries.size(); };
+
+  /**
+   * @param archive an archive to load classes found in directories from where
+   *        their class files haven't changed since it was written, or null to
+   *        always parse them
+   */
+  void setArchive(std::shared_ptr<const ClassArchive> archive) { this->archive = std::move(archive); };
+
+private:
+  struct entry
+  {
+    fs::path path;
+    /** The open archive, or null for a directory */
+    std::shared_ptr<const parsing::ZipArchive> archive;
+  };
+
+  std::vector<entry> entries;
+  std::shared_ptr<const ClassArchive> archive;
+
+  void add(const fs::path& path);
+};
+
+}
+
+#endif /* SRC_MIMIC_CLASSPATH_H_ */
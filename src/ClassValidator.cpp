@@ -6,181 +6,547 @@
  */
 
 #include "ClassValidator.h"
+#include <algorithm>
 #include "FieldDescriptor.h"
 
 namespace mimic {
 
-#ifndef HAVE_VARIANT
-class ConstantPoolVisitor : public boost::static_visitor<void>
+namespace
 {
-public:
-  ConstantPoolVisitor(ConstantPool& cp, const u2 major_version, const u2 minor_version)
-   : cp(cp), major_version(major_version), minor_version(minor_version) {};
-  void operator() (const ConstantPool::tag& invalid) const {};
-  void operator() (const ConstantPool::Class_info& info) const
+typedef ConstantPool::cp_type_index cp_type_index;
+
+constexpr u4 bit(cp_type_index type)
+{
+  return u4(1) << type;
+}
+
+/** Any of the alternatives a Utf8 entry can be decoded as */
+constexpr u4 any_utf8 = bit(ConstantPool::cp_utf8) | bit(ConstantPool::cp_fieldDescriptor)
+                        | bit(ConstantPool::cp_methodDescriptor);
+
+/** The bit for the cp_type alternative of each fixed-size entry, by tag */
+const u4 tag_types[] = {
+  0,                                           // Invalid
+  0,                                           // Utf8, which depends on how it was decoded
+  0,
+  bit(ConstantPool::cp_integer),
+  bit(ConstantPool::cp_float),
+  bit(ConstantPool::cp_long),
+  bit(ConstantPool::cp_double),
+  bit(ConstantPool::cp_class),
+  bit(ConstantPool::cp_string),
+  bit(ConstantPool::cp_fieldref),
+  bit(ConstantPool::cp_methodref),
+  bit(ConstantPool::cp_interfaceMethodref),
+  bit(ConstantPool::cp_nameAndType),
+  0,
+  0,
+  bit(ConstantPool::cp_methodHandle),
+  bit(ConstantPool::cp_methodType),
+  0,
+  bit(ConstantPool::cp_invokeDynamic)
+};
+
+/**
+ * The types of entry that an entry's indices may refer to, as masks of
+ * cp_type_index bits
+ */
+struct reference_rule
+{
+  /** Legal targets of the first of a pair of indices, e.g. a Fieldref's class */
+  u4 first;
+  /** Legal targets of the second of a pair of indices, or of the only index */
+  u4 second;
+  /** Legal descriptors of the NameAndType referred to by a member reference */
+  u4 descriptor;
+};
+
+/** The reference rules of each type of entry that refers to others, by cp_type_index */
+const reference_rule reference_rules[] = {
+  { 0, 0, 0 },                                                                     // cp_tag
+  { 0, any_utf8, 0 },                                                              // cp_class
+  { 0, 0, 0 },                                                                     // cp_double
+  { bit(ConstantPool::cp_class), bit(ConstantPool::cp_nameAndType),
+    bit(ConstantPool::cp_fieldDescriptor) },                                       // cp_fieldref
+  { 0, 0, 0 },                                                                     // cp_float
+  { 0, 0, 0 },                                                                     // cp_integer
+  { bit(ConstantPool::cp_class), bit(ConstantPool::cp_nameAndType),
+    bit(ConstantPool::cp_methodDescriptor) },                                      // cp_interfaceMethodref
+  { 0, bit(ConstantPool::cp_nameAndType), bit(ConstantPool::cp_methodDescriptor) },  // cp_invokeDynamic
+  { 0, 0, 0 },                                                                     // cp_long
+  { 0, 0, 0 },                                                                     // cp_methodHandle, by kind
+  { 0, bit(ConstantPool::cp_methodDescriptor), 0 },                                // cp_methodType
+  { bit(ConstantPool::cp_class), bit(ConstantPool::cp_nameAndType),
+    bit(ConstantPool::cp_methodDescriptor) },                                      // cp_methodref
+  { any_utf8, bit(ConstantPool::cp_fieldDescriptor) | bit(ConstantPool::cp_methodDescriptor), 0 },  // cp_nameAndType
+  { 0, any_utf8, 0 }                                                               // cp_string
+};
+
+/** How the name of the method a method handle refers to is restricted */
+enum handle_name
+{
+  any_name,
+  /** Must not be <init> or <clinit> */
+  not_initialiser,
+  /** Must be <init> */
+  initialiser
+};
+
+/** What a method handle of a given kind may refer to */
+struct handle_rule
+{
+  /** Legal targets of the reference from version 52 on */
+  u4 targets;
+  /** Legal targets of the reference before version 52 */
+  u4 old_targets;
+  handle_name name;
+};
+
+/** The rules for each kind of method handle, by reference_kind */
+const handle_rule handle_rules[] = {
+  { 0, 0, any_name },
+  // getField, getStatic, putField, putStatic
+  { bit(ConstantPool::cp_fieldref), bit(ConstantPool::cp_fieldref), any_name },
+  { bit(ConstantPool::cp_fieldref), bit(ConstantPool::cp_fieldref), any_name },
+  { bit(ConstantPool::cp_fieldref), bit(ConstantPool::cp_fieldref), any_name },
+  { bit(ConstantPool::cp_fieldref), bit(ConstantPool::cp_fieldref), any_name },
+  // invokeVirtual
+  { bit(ConstantPool::cp_methodref), bit(ConstantPool::cp_methodref), not_initialiser },
+  // invokeStatic, invokeSpecial
+  { bit(ConstantPool::cp_methodref) | bit(ConstantPool::cp_interfaceMethodref),
+    bit(ConstantPool::cp_methodref), not_initialiser },
+  { bit(ConstantPool::cp_methodref) | bit(ConstantPool::cp_interfaceMethodref),
+    bit(ConstantPool::cp_methodref), not_initialiser },
+  // newInvokeSpecial
+  { bit(ConstantPool::cp_methodref), bit(ConstantPool::cp_methodref), initialiser },
+  // invokeInterface
+  { bit(ConstantPool::cp_interfaceMethodref), bit(ConstantPool::cp_interfaceMethodref), not_initialiser }
+};
+
+/** The first class file version with MethodHandle, MethodType and InvokeDynamic entries */
+const u2 invokedynamic_version = 51;
+/** The first class file version whose method handles may refer to interface methods */
+const u2 interface_handle_version = 52;
+
+template <typename Visitor> void visit(const Visitor& visitor, const ConstantPool::cp_type& entry)
+{
+#ifdef HAVE_CXX_VARIANT
+  std::visit(visitor, entry);
+#else
+  boost::apply_visitor(visitor, entry);
+#endif
+}
+
+/** The classes of byte that matter to names, as bits */
+enum byte_class : u1
+{
+  /** Not allowed in unqualified names: '.', ';', '[' and '/' */
+  not_unqualified = 1,
+  /** Not allowed anywhere in class names: '.', ';' and '[' */
+  not_class_name = 2,
+  /** Separates the identifiers of a class name */
+  separator = 4,
+  /** Only allowed in the method names <init> and <clinit> */
+  angle_bracket = 8
+};
+
+/**
+ * The byte_class bits of every byte. Bytes of multi-byte characters are all
+ * at least 0x80, so they can be classified on their own like ASCII.
+ */
+const std::array<u1, 256> byte_classes = []() {
+  std::array<u1, 256> classes{};
+  for (u1 byte : { '.', ';', '[' })
+    classes[byte] = not_unqualified | not_class_name;
+  classes['/'] = not_unqualified | separator;
+  classes['<'] = angle_bracket;
+  classes['>'] = angle_bracket;
+  return classes;
+}();
+
+/**
+ * @return true if the bytes make a binary class or interface name, checking
+ *         them in one pass
+ */
+bool isClassName(parsing::ByteView name)
+{
+  if (name.empty())
+    return false;
+  // Treating the start as following a separator catches a leading one
+  u1 previous = separator;
+  for (u1 byte : name)
   {
-    auto nameType = cp.getType(info.name_index);
-    if (nameType == ConstantPool::cp_type_index::cp_utf8)
-      ClassValidator::validateClassOrInterfaceName(cp.get<const JUtf8String>(info.name_index));
-    else if (nameType != ConstantPool::cp_type_index::cp_fieldDescriptor)
-      throw std::runtime_error("Invalid  name reference");
+    u1 current = byte_classes[byte];
+    if ((current & not_class_name) || (current & previous & separator))
+      return false;
+    previous = current;
   }
-  void operator() (const ConstantPool::Double_info& info) const
+  return !(previous & separator);
+}
+
+/**
+ * @return true if the bytes make an unqualified name
+ */
+bool isUnqualifiedName(parsing::ByteView name)
+{
+  u1 seen = 0;
+  for (u1 byte : name)
+    seen |= byte_classes[byte];
+  return !name.empty() && !(seen & not_unqualified);
+}
+
+/**
+ * @return true if the name contains '<' or '>', which method names may only
+ *         do if they're <init> or <clinit>
+ */
+bool hasAngleBrackets(parsing::ByteView name)
+{
+  u1 seen = 0;
+  for (u1 byte : name)
+    seen |= byte_classes[byte];
+  return seen & angle_bracket;
+}
+
+const Symbol& initialiserName()
+{
+  static const Symbol init = Symbol::intern(JUtf8String("<init>"));
+  return init;
+}
+}
+
+class ClassValidator::EntryChecker
+{
+public:
+  typedef void result_type;
+
+  EntryChecker(const ConstantPool& cp, u2 index, u2 major_version, std::vector<error>& errors)
+    : cp(cp), index(index), major_version(major_version), errors(errors) {};
+  void operator() (const ConstantPool::Class_info& info) const
   {
-    // Nothing to do
+    if (!refersTo(info.name_index, reference_rules[ConstantPool::cp_class].second))
+      return fail("Invalid name reference");
+    if (typeBit(cp, info.name_index) == bit(ConstantPool::cp_fieldDescriptor)
+        && cp.get<const FieldDescriptor>(info.name_index).isArray())
+      return;
+    Symbol name = cp.getSymbol(info.name_index);
+    // Array classes are named by their descriptors, which must have parsed
+    if (name.size() != 0 && name.view()[0] == FieldDescriptor::type::jarray)
+      return fail("Invalid array class name");
+    if (!isValidClassOrInterfaceName(name))
+      return fail("Invalid class or interface name");
   }
   void operator() (const ConstantPool::Fieldref_info& info) const
   {
-    std::cout << "fieldref" << std::endl;
-  }
-  void operator() (const ConstantPool::Float_info& info) const
-  {
-    // Nothing to do
-  }
-  void operator() (const ConstantPool::Integer_info& info) const
-  {
-    // Nothing to do
+    checkMember(info.class_index, info.name_and_type_index, reference_rules[ConstantPool::cp_fieldref]);
   }
   void operator() (const ConstantPool::InterfaceMethodref_info& info) const
   {
-    std::cout << "interfacemethodref" << std::endl;
+    if (checkMember(info.class_index, info.name_and_type_index,
+                    reference_rules[ConstantPool::cp_interfaceMethodref])
+        && hasAngleBrackets(nameOf(info.name_and_type_index).view()))
+      fail("Invalid interface method name");
   }
   void operator() (const ConstantPool::InvokeDynamic_info& info) const
   {
-    // TODO: Validate the bootstrap method index once attributes are done
-    if (cp.getType(info.name_and_type_index) != ConstantPool::cp_type_index::cp_nameAndType)
-      throw std::runtime_error("Invalid name & type index");
-  }
-  void operator() (const ConstantPool::Long_info& info) const
-  {
-    // Nothing to do
+    // The bootstrap method index is checked with the class' attributes, by validateBootstrapMethods()
+    if (major_version < invokedynamic_version)
+      return fail("InvokeDynamic entry before class file version 51");
+    if (checkMember(0, info.name_and_type_index, reference_rules[ConstantPool::cp_invokeDynamic])
+        && hasAngleBrackets(nameOf(info.name_and_type_index).view()))
+      fail("Invalid dynamic method name");
   }
   void operator() (const ConstantPool::MethodHandle_info& info) const
   {
-    if (info.kind > 9 || info.kind < 1)
-      throw std::range_error("Reference kind out of valid range");
-    switch(info.kind)
-    {
-      case ConstantPool::reference_kind::getField:
-      [[fallthrough]]
-      case ConstantPool::reference_kind::getStatic:
-      [[fallthrough]]
-      case ConstantPool::reference_kind::putField:
-      [[fallthrough]]
-      case ConstantPool::reference_kind::putStatic:
-      {
-        if(cp.getType(info.reference_index) != ConstantPool::cp_type_index::cp_fieldref)
-        {
-          throw std::runtime_error("Invalid method handle reference");
-        }
-        break;
-      }
-      case ConstantPool::reference_kind::invokeVirtual:
-      [[fallthrough]]
-      case ConstantPool::reference_kind::newInvokeSpecial:
-      {
-        if(cp.getType(info.reference_index) != ConstantPool::cp_type_index::cp_methodref)
-        {
-          throw std::runtime_error("Invalid method handle reference");
-        }
-        break;
-      }
-      case ConstantPool::reference_kind::invokeStatic:
-      [[fallthrough]]
-      case ConstantPool::reference_kind::invokeSpecial:
-      {
-        switch (cp.getType(info.reference_index))
-        {
-        case ConstantPool::cp_type_index::cp_interfaceMethodref:
-          if (major_version < 52)
-            throw std::runtime_error("Invalid method handle reference");
-          break;
-        case ConstantPool::cp_type_index::cp_methodref:
-          break;
-        default:
-          throw std::runtime_error("Invalid method handle reference");
-        }
-        break;
-      }
-      case ConstantPool::reference_kind::invokeInterface:
-      {
-        if(cp.getType(info.reference_index) != ConstantPool::cp_type_index::cp_interfaceMethodref)
-        {
-          throw std::runtime_error("Invalid method handle reference");
-        }
-      }
-    }
+    if (major_version < invokedynamic_version)
+      return fail("MethodHandle entry before class file version 51");
+    if (info.kind < ConstantPool::getField || info.kind > ConstantPool::invokeInterface)
+      return fail("Reference kind out of valid range");
+    const handle_rule& rule = handle_rules[info.kind];
+    u4 targets = major_version >= interface_handle_version ? rule.targets : rule.old_targets;
+    if (!refersTo(info.reference_index, targets))
+      return fail("Invalid method handle reference");
+    if (rule.name == any_name)
+      return;
+    // Methodrefs and InterfaceMethodrefs are laid out alike
+    u2 nat_index = refersTo(info.reference_index, bit(ConstantPool::cp_methodref))
+        ? cp.get<const ConstantPool::Methodref_info>(info.reference_index).name_and_type_index
+        : cp.get<const ConstantPool::InterfaceMethodref_info>(info.reference_index).name_and_type_index;
+    Symbol name;
+    // A broken reference is reported when it's checked as an entry of its own
+    if (!nameOf(nat_index, name))
+      return;
+    bool init = name == initialiserName();
+    if (rule.name == initialiser && !init)
+      fail("Method handle for newInvokeSpecial must refer to <init>");
+    else if (rule.name == not_initialiser && (init || hasAngleBrackets(name.view())))
+      fail("Method handle must not refer to an initialisation method");
   }
   void operator() (const ConstantPool::MethodType_info& info) const
   {
-    if (cp.getType(info.descriptor_index) != ConstantPool::cp_type_index::cp_methodDescriptor)
-      throw std::runtime_error("Invalid name reference");
+    if (major_version < invokedynamic_version)
+      return fail("MethodType entry before class file version 51");
+    if (!refersTo(info.descriptor_index, reference_rules[ConstantPool::cp_methodType].second))
+      fail("Invalid method descriptor reference");
   }
   void operator() (const ConstantPool::Methodref_info& info) const
   {
-    std::cout << "methodref" << std::endl;
+    if (!checkMember(info.class_index, info.name_and_type_index, reference_rules[ConstantPool::cp_methodref]))
+      return;
+    auto nat = cp.get<const ConstantPool::NameAndType_info>(info.name_and_type_index);
+    Symbol name = cp.getSymbol(nat.name_index);
+    if (name == initialiserName())
+    {
+      auto& descriptor = cp.get<const MethodDescriptor>(nat.descriptor_index);
+      if (descriptor.getShape().getReturnKind() != SignatureShape::kind_void)
+        fail("<init> must return void");
+    }
+    else if (hasAngleBrackets(name.view()))
+    {
+      fail("Invalid method name");
+    }
   }
   void operator() (const ConstantPool::NameAndType_info& info) const
   {
-    auto name_type = cp.getType(info.name_index);
-    auto descriptor_type = cp.getType(info.descriptor_index);
-    if (descriptor_type != ConstantPool::cp_type_index::cp_methodDescriptor
-        && descriptor_type != ConstantPool::cp_type_index::cp_fieldDescriptor)
-      throw std::runtime_error("Invalid descriptor reference");
-    if (name_type != ConstantPool::cp_type_index::cp_utf8)
-      throw std::runtime_error("Invalid name reference");
+    const reference_rule& rule = reference_rules[ConstantPool::cp_nameAndType];
+    if (!refersTo(info.name_index, rule.first))
+      return fail("Invalid name reference");
+    if (!refersTo(info.descriptor_index, rule.second))
+      return fail("Invalid descriptor reference");
+    // A name can share its entry with a descriptor with the same text
+    if (!isValidUnqualifiedName(cp.getSymbol(info.name_index)))
+      fail("Invalid name");
   }
   void operator() (const ConstantPool::String_info& info) const
   {
-    if(cp.getType(info.string_index) != ConstantPool::cp_type_index::cp_utf8)
-    {
-      throw std::runtime_error("Invalid string reference");
-    }
-  }
-  void operator() (const JUtf8String& info) const
-  {
-    // Nothing to do. Strings are validated on construction
+    if (!refersTo(info.string_index, reference_rules[ConstantPool::cp_string].second))
+      fail("Invalid string reference");
   }
+  // Numeric constants and Utf8 entries have nothing to refer to
   template <typename T> void operator() (const T&) const {}
 private:
-  ConstantPool& cp;
+  const ConstantPool& cp;
+  const u2 index;
   const u2 major_version;
-  const u2 minor_version;
+  std::vector<error>& errors;
+
+  void fail(const char* reason) const
+  {
+    errors.push_back(error{index, reason});
+  }
+
+  /**
+   * @return true if the entry at target is one of the types in the mask
+   */
+  bool refersTo(u2 target, u4 types) const
+  {
+    return (typeBit(cp, target) & types) != 0;
+  }
+
+  /**
+   * @param nat_index the index of a NameAndType entry
+   * @param name set to the name the entry refers to, which is the empty
+   *        symbol if the name is a descriptor built without its text
+   * @return false if there is no NameAndType entry at nat_index, or it
+   *         doesn't refer to a name
+   */
+  bool nameOf(u2 nat_index, Symbol& name) const
+  {
+    if (!refersTo(nat_index, bit(ConstantPool::cp_nameAndType)))
+      return false;
+    u2 name_index = cp.get<const ConstantPool::NameAndType_info>(nat_index).name_index;
+    if (!refersTo(name_index, any_utf8))
+      return false;
+    name = cp.getSymbol(name_index);
+    return true;
+  }
+
+  /**
+   * @param nat_index the index of a NameAndType entry that has been checked
+   * @return the name the entry refers to
+   */
+  Symbol nameOf(u2 nat_index) const
+  {
+    Symbol name;
+    nameOf(nat_index, name);
+    return name;
+  }
+
+  /**
+   * Checks the class and NameAndType indices of a member reference, and the
+   * type of descriptor the NameAndType refers to. The NameAndType itself is
+   * checked as an entry of its own.
+   *
+   * @param class_index the index of the class, or 0 if the entry has none
+   * @return true if the references are valid
+   */
+  bool checkMember(u2 class_index, u2 nat_index, const reference_rule& rule) const
+  {
+    if (rule.first && !refersTo(class_index, rule.first))
+    {
+      fail("Invalid class reference");
+      return false;
+    }
+    if (!refersTo(nat_index, rule.second))
+    {
+      fail("Invalid name & type reference");
+      return false;
+    }
+    auto nat = cp.get<const ConstantPool::NameAndType_info>(nat_index);
+    if (!refersTo(nat.name_index, any_utf8))
+      return false;
+    if (!refersTo(nat.descriptor_index, rule.descriptor))
+    {
+      fail(rule.descriptor == bit(ConstantPool::cp_fieldDescriptor) ? "Field reference without a field descriptor"
+                                                                     : "Method reference without a method descriptor");
+      return false;
+    }
+    return true;
+  }
 };
-#endif
+
+ClassValidator::validation_failure::validation_failure(std::vector<error> errors)
+  : std::runtime_error([&errors]() {
+      std::stringstream ss;
+      ss << "Invalid constant pool entry #" << errors.front().index << ": " << errors.front().reason;
+      if (errors.size() > 1)
+        ss << " (and " << errors.size() - 1 << " more)";
+      return ss.str();
+    }()),
+    errors(std::move(errors))
+{
+}
+
+bool ClassValidator::isValidClassOrInterfaceName(const JUtf8String& str)
+{
+  return isClassName(str.view());
+}
+
+bool ClassValidator::isValidClassOrInterfaceName(const Symbol& name)
+{
+  u1 marks = name.getMarks();
+  if (!(marks & class_name_checked))
+  {
+    // Threads racing to check the same symbol all get the same answer
+    marks = class_name_checked | (isClassName(name.view()) ? class_name_valid : 0);
+    name.addMarks(marks);
+  }
+  return marks & class_name_valid;
+}
+
+bool ClassValidator::isValidUnqualifiedName(const JUtf8String& str)
+{
+  return isUnqualifiedName(str.view());
+}
+
+bool ClassValidator::isValidUnqualifiedName(const Symbol& name)
+{
+  u1 marks = name.getMarks();
+  if (!(marks & unqualified_name_checked))
+  {
+    marks = unqualified_name_checked | (isUnqualifiedName(name.view()) ? unqualified_name_valid : 0);
+    name.addMarks(marks);
+  }
+  return marks & unqualified_name_valid;
+}
 
 void ClassValidator::validateClassOrInterfaceName(const JUtf8String str)
 {
-  if (str.contains(JUtf8String(".")))
+  if (!isValidClassOrInterfaceName(str))
     throw std::runtime_error("Invalid character in class or identifier name");
-  auto identifiers = str.split(JUtf8String("/"));
-  for (auto i = identifiers.begin(); i < identifiers.end(); ++i)
-    validateUnqualifiedName(*i);
 }
 
 void ClassValidator::validateUnqualifiedName(const JUtf8String str)
 {
-  if (str.contains(std::vector<JUtf8String>{JUtf8String("."), JUtf8String(";"), JUtf8String("["), JUtf8String("/")}))
+  if (!isValidUnqualifiedName(str))
     throw std::runtime_error("Invalid character in unqualified name");
 }
 
-void ClassValidator::validateConstantPool(ConstantPool& cp, u2 major_version, u2 minor_version)
+std::vector<ClassValidator::error> ClassValidator::checkConstantPool(const ConstantPool& cp, u2 major_version,
+                                                                     u2 /* minor_version */)
 {
-  for (auto entry : cp.pool)
+  std::vector<error> errors;
+  for (u2 i = 1; i < cp.size(); i++)
   {
-#ifdef HAVE_VARIANT
-// TODO once checks have been written using Boost visitor
-    //~ std::visit([](auto&& arg) {
-            //~ using T = std::decay_t<decltype(arg)>;
-            //~ if constexpr (std::is_same_v<T, ConstantPool::Class_info>)
-                //~ std::cout << "Class " << arg << '\n';
-            //~ else 
-                //~ static_assert(always_false<T>::value, "non-exhaustive visitor!");
-        //~ }, entry);
+    /* Utf8 entries are checked as they're decoded, and the upper halves of
+     * Longs and Doubles have nothing to check */
+    u1 entry_tag = cp.tags[i];
+    if (entry_tag == ConstantPool::Utf8 || entry_tag == ConstantPool::Invalid)
+      continue;
+    visit(EntryChecker(cp, i, major_version, errors), cp.unpack(i));
+  }
+  return errors;
+}
+
+void ClassValidator::validateConstantPool(const ConstantPool& cp, u2 major_version, u2 minor_version)
+{
+  auto errors = checkConstantPool(cp, major_version, minor_version);
+  if (!errors.empty())
+    throw validation_failure(std::move(errors));
+}
+
+void ClassValidator::validateConstantPoolEntry(const ConstantPool& cp, u2 index,
+                                               u2 major_version, u2 /* minor_version */)
+{
+  std::vector<error> errors;
+  visit(EntryChecker(cp, index, major_version, errors), cp.unpack(index));
+  if (!errors.empty())
+    throw validation_failure(std::move(errors));
+}
+
+void ClassValidator::validateBootstrapMethods(const ConstantPool& cp, const attributes::bootstrap_methods* methods)
+{
+  const u4 loadable = bit(ConstantPool::cp_integer) | bit(ConstantPool::cp_float) | bit(ConstantPool::cp_long)
+                      | bit(ConstantPool::cp_double) | bit(ConstantPool::cp_class) | bit(ConstantPool::cp_string)
+                      | bit(ConstantPool::cp_methodHandle) | bit(ConstantPool::cp_methodType);
+  std::vector<error> errors;
+  std::size_t count = methods ? methods->info.size() : 0;
+  for (u2 i = 1; i < cp.size(); i++)
+  {
+    if (cp.tags[i] == ConstantPool::InvokeDynamic && ConstantPool::high(cp.payloads[i]) >= count)
+      errors.push_back(error{i, "Invalid bootstrap method index"});
+  }
+  if (methods)
+  {
+    for (auto& method : methods->info)
+    {
+      if (fixedTypeBit(cp, method.bootstrap_method_ref) != bit(ConstantPool::cp_methodHandle))
+        errors.push_back(error{method.bootstrap_method_ref, "Bootstrap method is not a MethodHandle"});
+      for (u2 argument : method.bootstrap_arguments)
+      {
+        if (!(fixedTypeBit(cp, argument) & loadable))
+          errors.push_back(error{argument, "Bootstrap argument is not a loadable constant"});
+      }
+    }
+  }
+  if (!errors.empty())
+  {
+    // The entries are checked in two passes, so put the problems back in order
+    std::stable_sort(errors.begin(), errors.end(),
+                     [](const error& a, const error& b) { return a.index < b.index; });
+    throw validation_failure(std::move(errors));
+  }
+}
+
+u4 ClassValidator::fixedTypeBit(const ConstantPool& cp, u2 index)
+{
+  if (index == 0 || index >= cp.size())
+    return 0;
+  // Utf8's entry in the table is 0 too
+  return tag_types[cp.tags[index]];
+}
+
+u4 ClassValidator::typeBit(const ConstantPool& cp, u2 index)
+{
+  if (index == 0 || index >= cp.size())
+    return 0;
+  u1 entry_tag = cp.tags[index];
+  if (entry_tag != ConstantPool::Utf8)
+    return tag_types[entry_tag];
+#ifdef HAVE_CXX_VARIANT
+  return u4(1) << cp.text(index).index();
 #else
-    boost::apply_visitor( ConstantPoolVisitor(cp, major_version, minor_version), entry );
+  return u4(1) << cp.text(index).which();
 #endif
-  }
 }
 
 }
@@ -9,13 +9,41 @@
 #define SRC_MIMIC_CLASS_VALIDATOR_H_
 
 #include "Common.h"
+#include "class_attributes.h"
 #include "ConstantPool.h"
 #include "JUtf8String.h"
+#include "Symbol.h"
 
 namespace mimic {
 class ClassValidator
 {
 public:
+  /** A problem found with an entry of a constant pool */
+  struct error
+  {
+    /** The index of the entry */
+    u2 index;
+    /** What is wrong with it */
+    const char* reason;
+  };
+
+  /**
+   * Exception thrown when a constant pool fails validation, holding every
+   * problem that was found
+   */
+  class validation_failure : public std::runtime_error
+  {
+  public:
+    validation_failure(std::vector<error> errors);
+
+    /**
+     * @return the problems found, in order of entry index
+     */
+    const std::vector<error>& getErrors() const { return errors; };
+  private:
+    std::vector<error> errors;
+  };
+
   /**
    * Checks that the given binary class or interface name does not
    * contain any '.' characters, and that the identifiers are valid
@@ -35,15 +63,106 @@ public:
    */
   static void validateUnqualifiedName(const JUtf8String str);
 
+  /**
+   * @param str a binary class or interface name
+   * @return true if the name is not empty, and each of its identifiers is an
+   *         unqualified name
+   */
+  static bool isValidClassOrInterfaceName(const JUtf8String& str);
+
+  /**
+   * As isValidClassOrInterfaceName(const JUtf8String&), but only checks each
+   * symbol the first time it's asked about
+   */
+  static bool isValidClassOrInterfaceName(const Symbol& name);
+
+  /**
+   * @param str an unqualified name
+   * @return true if the name is not empty and contains none of '.', ';',
+   *         '[', or '/'
+   */
+  static bool isValidUnqualifiedName(const JUtf8String& str);
+
+  /**
+   * As isValidUnqualifiedName(const JUtf8String&), but only checks each
+   * symbol the first time it's asked about
+   */
+  static bool isValidUnqualifiedName(const Symbol& name);
+
+  /**
+   * Checks every entry of a constant pool, including that each entry refers
+   * to entries of the right types, without stopping at the first problem
+   *
+   * @param cp the ConstantPool object to check
+   * @param major_version The class' major version number
+   * @param minor_version The class' minor version number
+   * @return the problems found, in order of entry index
+   */
+  static std::vector<error> checkConstantPool(const ConstantPool& cp, u2 major_version, u2 minor_version);
+
   /**
    * Validates the contents of the provided constant pool
    *
    * @param cp the ConstantPool object to validate
    * @param major_version The class' major version number
    * @param minor_version The class' minor version number
-   * @throws runtime_error if validation failed
+   * @throws validation_failure holding every problem found if validation failed
+   */
+  static void validateConstantPool(const ConstantPool& cp, u2 major_version, u2 minor_version);
+
+  /**
+   * Validates a single fixed-size entry of a constant pool. Utf8 entries are
+   * checked as they are decoded, and by the entries that refer to them.
+   *
+   * @param cp the ConstantPool object the entry belongs to
+   * @param index the index of the entry to validate
+   * @param major_version The class' major version number
+   * @param minor_version The class' minor version number
+   * @throws validation_failure if validation failed
+   */
+  static void validateConstantPoolEntry(const ConstantPool& cp, u2 index,
+                                        u2 major_version, u2 minor_version);
+
+  /**
+   * Checks the class' bootstrap methods against its constant pool: that
+   * each InvokeDynamic entry refers to a bootstrap method, that each
+   * bootstrap method is a MethodHandle and that its arguments are loadable
+   * constants. Only looks at the pool's fixed-size entries, so doesn't
+   * decode anything.
+   *
+   * @param cp the class' constant pool
+   * @param methods the class' BootstrapMethods attribute, or null if it has none
+   * @throws validation_failure holding every problem found, in order of
+   *         entry index, if validation failed
+   */
+  static void validateBootstrapMethods(const ConstantPool& cp, const attributes::bootstrap_methods* methods);
+
+private:
+  /** Visits the entries of a pool, checking each one */
+  class EntryChecker;
+
+  /** The Symbol marks that remember which names have been checked */
+  enum name_marks : u1
+  {
+    class_name_checked = 1,
+    class_name_valid = 2,
+    unqualified_name_checked = 4,
+    unqualified_name_valid = 8
+  };
+
+  /**
+   * @param cp a constant pool
+   * @param index the index of an entry of the pool
+   * @return the bit for the cp_type alternative of the entry, or 0 if there
+   *         is no usable entry at index
+   */
+  static u4 typeBit(const ConstantPool& cp, u2 index);
+
+  /**
+   * As typeBit(), but without decoding anything: a Utf8 entry counts as no
+   * usable entry
    */
-  static void validateConstantPool(ConstantPool& cp, u2 major_version, u2 minor_version);
+  static u4 fixedTypeBit(const ConstantPool& cp, u2 index);
 };
 };
 
@@ -60,6 +60,23 @@ typedef uint8_t u1;
 typedef uint16_t u2;
 typedef uint32_t u4;
 typedef uint64_t u8;
+typedef int8_t s1;
+typedef int16_t s2;
+typedef int32_t s4;
+typedef int64_t s8;
+
+/**
+ * @param value a variant
+ * @return the variant's value if it holds a T, else null
+ */
+template <typename T, typename Variant> const T* getIf(const Variant& value)
+{
+#ifdef HAVE_CXX_VARIANT
+  return std::get_if<T>(&value);
+#else
+  return boost::get<T>(&value);
+#endif
+}
 
 }
 
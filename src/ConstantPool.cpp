@@ -6,97 +6,423 @@
  */
 
 #include "ConstantPool.h"
+#include "ClassArchive.h"
+#include "ClassValidator.h"
+#include <algorithm>
+#include <cstring>
 
 namespace mimic
 {
+
+namespace
+{
+ConstantPool::cp_type_index alternative(const ConstantPool::cp_type& entry)
+{
+#ifdef HAVE_CXX_VARIANT
+  return static_cast<ConstantPool::cp_type_index>(entry.index());
+#else
+  return static_cast<ConstantPool::cp_type_index>(entry.which());
+#endif
+}
+
+/** Interns the text of a Utf8 entry */
+Symbol symbolOf(const ConstantPool::cp_type& entry)
+{
+  switch (alternative(entry))
+  {
+  case ConstantPool::cp_fieldDescriptor:
+  case ConstantPool::cp_methodDescriptor:
+    // Descriptors don't keep their text, so there's nothing to intern
+    return Symbol();
+  default:
+#ifdef HAVE_CXX_VARIANT
+    return Symbol::intern(std::get<const JUtf8String>(entry));
+#else
+    return Symbol::intern(boost::get<const JUtf8String>(entry));
+#endif
+  }
+}
+
+/** Packs a decoded fixed-size entry into a tag and payload */
+class EntryPacker
+{
+public:
+  typedef void result_type;
+
+  EntryPacker(std::vector<u1>& tags, std::vector<u4>& payloads, u2 index)
+    : tags(tags), payloads(payloads), index(index) {};
+  void operator() (const ConstantPool::tag&) const {}
+  void operator() (const ConstantPool::Class_info& info) const
+  {
+    pack(ConstantPool::Class, info.name_index);
+  }
+  void operator() (const ConstantPool::Double_info& info) const
+  {
+    pack(ConstantPool::Double, static_cast<u4>(info.bytes >> 32));
+    payloads[index + 1] = static_cast<u4>(info.bytes);
+  }
+  void operator() (const ConstantPool::Fieldref_info& info) const
+  {
+    pack(ConstantPool::Fieldref, info.class_index, info.name_and_type_index);
+  }
+  void operator() (const ConstantPool::Float_info& info) const
+  {
+    pack(ConstantPool::Float, info.bytes);
+  }
+  void operator() (const ConstantPool::Integer_info& info) const
+  {
+    pack(ConstantPool::Integer, info.bytes);
+  }
+  void operator() (const ConstantPool::InterfaceMethodref_info& info) const
+  {
+    pack(ConstantPool::InterfaceMethodref, info.class_index, info.name_and_type_index);
+  }
+  void operator() (const ConstantPool::InvokeDynamic_info& info) const
+  {
+    pack(ConstantPool::InvokeDynamic, info.bootstrap_method_attr_index, info.name_and_type_index);
+  }
+  void operator() (const ConstantPool::Long_info& info) const
+  {
+    pack(ConstantPool::Long, static_cast<u4>(info.value >> 32));
+    payloads[index + 1] = static_cast<u4>(info.value);
+  }
+  void operator() (const ConstantPool::MethodHandle_info& info) const
+  {
+    pack(ConstantPool::MethodHandle, info.kind, info.reference_index);
+  }
+  void operator() (const ConstantPool::MethodType_info& info) const
+  {
+    pack(ConstantPool::MethodType, info.descriptor_index);
+  }
+  void operator() (const ConstantPool::Methodref_info& info) const
+  {
+    pack(ConstantPool::Methodref, info.class_index, info.name_and_type_index);
+  }
+  void operator() (const ConstantPool::NameAndType_info& info) const
+  {
+    pack(ConstantPool::NameAndType, info.name_index, info.descriptor_index);
+  }
+  void operator() (const ConstantPool::String_info& info) const
+  {
+    pack(ConstantPool::String, info.string_index);
+  }
+  // Utf8 entries go in the side table instead
+  template <typename T> void operator() (const T&) const {}
+private:
+  std::vector<u1>& tags;
+  std::vector<u4>& payloads;
+  const u2 index;
+
+  void pack(ConstantPool::tag entry_tag, u4 payload) const
+  {
+    tags[index] = entry_tag;
+    payloads[index] = payload;
+  }
+  void pack(ConstantPool::tag entry_tag, u2 high, u2 low) const
+  {
+    pack(entry_tag, (static_cast<u4>(high) << 16) | low);
+  }
+};
+}
+
+ConstantPool::ConstantPool(const std::vector<cp_type>& entries)
+  : tags(entries.size(), Invalid), payloads(entries.size(), 0)
+{
+  for (u2 i = 0; i < entries.size(); i++)
+  {
+    if (alternative(entries[i]) >= cp_utf8)
+    {
+      tags[i] = Utf8;
+      payloads[i] = static_cast<u4>(utf8_entries.size());
+      utf8_entries.push_back(utf8_entry{symbolOf(entries[i]), entries[i]});
+      continue;
+    }
+#ifdef HAVE_CXX_VARIANT
+    std::visit(EntryPacker(tags, payloads, i), entries[i]);
+#else
+    boost::apply_visitor(EntryPacker(tags, payloads, i), entries[i]);
+#endif
+  }
+}
+
 ConstantPool::ConstantPool(parsing::ByteConsumer& bc, u2 constant_pool_count)
 {
-  // Set pool[0] to an invalid entry as 0 is an invalid index
-  pool.push_back(Invalid);
-  /* Constant pool entries can refer to entries with a higher index than themselves,i
-   * so we can't verify until we've parsed everything */
+  *this = index(bc, constant_pool_count, 0, 0);
+  decodeAll();
+}
+
+ConstantPool::ConstantPool(parsing::ByteConsumer& bc, u2 constant_pool_count, decoding mode,
+                           u2 major_version, u2 minor_version)
+{
+  *this = index(bc, constant_pool_count, major_version, minor_version);
+  if (mode == eager)
+    decodeAll();
+  else
+    retain();
+}
+
+ConstantPool ConstantPool::index(parsing::ByteConsumer& bc, u2 constant_pool_count,
+                                 u2 major_version, u2 minor_version)
+{
+  ConstantPool cp;
+  // Entry 0 is an invalid entry as 0 is an invalid index
+  cp.tags.assign(std::max<u2>(constant_pool_count, 1), Invalid);
+  cp.payloads.assign(cp.tags.size(), 0);
+  auto entries = std::make_shared<lazy_entries>();
+  entries->major_version = major_version;
+  entries->minor_version = minor_version;
+  /* Entries can refer to entries with a higher index than themselves, so
+   * descriptor uses are collected by index and moved to slots at the end */
+  std::vector<u1> uses(cp.tags.size(), not_descriptor);
+  auto markUse = [&uses](u2 index, descriptor_use how) {
+    if (index < uses.size())
+      uses[index] |= how;
+  };
+  uintmax_t start = bc.position();
   for (u2 i = 1; i < constant_pool_count; i++)
   {
     u1 cp_tag = bc.readU1();
+    cp.tags[i] = cp_tag;
     switch (cp_tag)
     {
-    case Class:
-    {
-      u2 name_index = bc.readU2();
-      pool.push_back(Class_info{name_index});
-      break;
-    }
-    case Fieldref:
-      pool.push_back(Fieldref_info{bc.readU2(), bc.readU2()});
+    case Utf8:
+      cp.payloads[i] = static_cast<u4>(entries->offsets.size());
+      entries->offsets.push_back(static_cast<u4>(bc.position() - start));
+      bc.readBytes(bc.readU2());
       break;
-    case Methodref:
-      pool.push_back(Methodref_info{bc.readU2(), bc.readU2()});
+    case Class:
+      cp.payloads[i] = bc.readU2();
+      markUse(cp.payloads[i], class_name);
       break;
-    case InterfaceMethodref:
-      pool.push_back(InterfaceMethodref_info{bc.readU2(), bc.readU2()});
+    case MethodType:
+      cp.payloads[i] = bc.readU2();
+      markUse(cp.payloads[i], method_descriptor);
       break;
     case String:
-      pool.push_back(String_info{bc.readU2()});
-      break;
-    case Integer:
-      pool.push_back(Integer_info{bc.readU4()});
+      cp.payloads[i] = bc.readU2();
       break;
-    case Float:
-      pool.push_back(Float_info{bc.readU4()});
-      break;
-    case Long:
-    {
-      Long_info info(bc.readU4(), bc.readU4());
-      pool.push_back(info);
-      pool.push_back(Invalid);
-      break;
-    }
-    case Double:
+    case MethodHandle:
     {
-      Double_info info(bc.readU4(), bc.readU4());
-      pool.push_back(info);
-      pool.push_back(Invalid);
+      u1 kind = bc.readU1();
+      cp.payloads[i] = (static_cast<u4>(kind) << 16) | bc.readU2();
       break;
     }
     case NameAndType:
-      pool.push_back(NameAndType_info{bc.readU2(), bc.readU2()});
-      break;
-    case Utf8:
-    {
-      u2 numberOfBytes = bc.readU2();
-      JUtf8String str(bc.readBytes(numberOfBytes));
-      try
-      {
-        pool.push_back(FieldDescriptor(str));
-      }
-      catch (const std::exception&)
-      {
-        try
-        {
-          pool.push_back(MethodDescriptor(str));
-        }
-        catch (const std::exception&)
-        {
-          pool.push_back(str);
-        }
-      }
-      break;
-    }
-    case MethodHandle:
-      pool.push_back(MethodHandle_info{static_cast<reference_kind>(bc.readU1()), bc.readU2()});
-      break;
-    case MethodType:
-      pool.push_back(MethodType_info{bc.readU2()});
+      cp.payloads[i] = bc.readU4();
+      markUse(low(cp.payloads[i]), static_cast<descriptor_use>(field_descriptor | method_descriptor));
       break;
+    case Integer:
+    case Float:
+    case Fieldref:
+    case Methodref:
+    case InterfaceMethodref:
     case InvokeDynamic:
-      pool.push_back(InvokeDynamic_info{bc.readU2(), bc.readU2()});
+      // Pairs of u2s are already in the order payloads pack them
+      cp.payloads[i] = bc.readU4();
+      break;
+    case Long:
+    case Double:
+      // Longs and doubles take up two entries
+      if (i + 1 >= constant_pool_count)
+        throw parsing::parse_failure("Long or double constant in last constant pool entry");
+      cp.payloads[i++] = bc.readU4();
+      cp.payloads[i] = bc.readU4();
       break;
     default:
       std::stringstream ss;
-      ss << "Unknown constant pool tag " << std::hex << std::setw(2) << cp_tag;
+      ss << "Unknown constant pool tag " << std::hex << std::setw(2) << static_cast<int>(cp_tag);
       throw parsing::parse_failure(ss.str().c_str());
     }
   }
+  entries->uses.resize(entries->offsets.size(), not_descriptor);
+  for (u2 i = 1; i < cp.tags.size(); i++)
+  {
+    if (cp.tags[i] == Utf8)
+      entries->uses[cp.payloads[i]] = uses[i];
+  }
+  auto bytes = bc.viewFrom(start);
+  entries->data = bytes.data();
+  entries->length = bytes.size();
+  entries->backing = bc.getBacking();
+  entries->decoded.reset(new std::atomic<const utf8_entry*>[entries->offsets.size()]());
+  cp.deferred = std::move(entries);
+  return cp;
+}
+
+void ConstantPool::retain()
+{
+  if (!deferred->backing)
+  {
+    // Everything but the Utf8 entries has already been decoded, so only keep those
+    std::vector<u1> copy;
+    for (auto& offset : deferred->offsets)
+    {
+      const u1* entry = deferred->data + offset;
+      std::size_t length = 2 + ((entry[0] << 8) | entry[1]);
+      offset = static_cast<u4>(copy.size());
+      copy.insert(copy.end(), entry, entry + length);
+    }
+    deferred->copy = std::move(copy);
+    deferred->data = deferred->copy.data();
+    deferred->length = deferred->copy.size();
+  }
+  deferred->validated.reset(new std::atomic<bool>[tags.size()]());
+  deferred->lazy = true;
+}
+
+void ConstantPool::decodeAll()
+{
+  std::vector<utf8_entry> entries;
+  entries.reserve(deferred->offsets.size());
+  for (u4 slot = 0; slot < deferred->offsets.size(); slot++)
+    entries.push_back(decodeUtf8(slot));
+  utf8_entries = std::move(entries);
+  deferred.reset();
+}
+
+ConstantPool::lazy_entries::~lazy_entries()
+{
+  if (!decoded)
+    return;
+  for (std::size_t i = 0; i < offsets.size(); i++)
+    delete decoded[i].load(std::memory_order_relaxed);
+}
+
+void ConstantPool::wrongType()
+{
+#ifdef HAVE_CXX_VARIANT
+  throw std::bad_variant_access();
+#else
+  throw boost::bad_get();
+#endif
+}
+
+void ConstantPool::validate(const u2& index) const
+{
+  ClassValidator::validateConstantPoolEntry(*this, index, deferred->major_version,
+                                            deferred->minor_version);
+  deferred->validated[index].store(true, std::memory_order_release);
+}
+
+ConstantPool::cp_type ConstantPool::unpack(const u2& index) const
+{
+  u4 payload = payloads[index];
+  switch (tags[index])
+  {
+  case Class:
+    return Class_info(payload);
+  case Fieldref:
+    return Fieldref_info(high(payload), low(payload));
+  case Methodref:
+    return Methodref_info(high(payload), low(payload));
+  case InterfaceMethodref:
+    return InterfaceMethodref_info(high(payload), low(payload));
+  case String:
+    return String_info(payload);
+  case Integer:
+    return Integer_info(payload);
+  case Float:
+    return Float_info(payload);
+  case Long:
+    return Long_info(payload, payloads[index + 1]);
+  case Double:
+    return Double_info(payload, payloads[index + 1]);
+  case NameAndType:
+    return NameAndType_info(high(payload), low(payload));
+  case MethodHandle:
+    return MethodHandle_info(static_cast<reference_kind>(high(payload)), low(payload));
+  case MethodType:
+    return MethodType_info(payload);
+  case InvokeDynamic:
+    return InvokeDynamic_info(high(payload), low(payload));
+  default:
+    return Invalid;
+  }
+}
+
+const ConstantPool::utf8_entry& ConstantPool::decode(u4 slot) const
+{
+  std::unique_ptr<const utf8_entry> entry(new utf8_entry(decodeUtf8(slot)));
+  /* decodeUtf8() has already checked the bytes, and whether the entry is used
+   * correctly is checked by the entries that refer to it */
+  // Another thread may have got there first, in which case use its entry
+  const utf8_entry* expected = nullptr;
+  if (deferred->decoded[slot].compare_exchange_strong(expected, entry.get(), std::memory_order_acq_rel))
+    return *entry.release();
+  return *expected;
+}
+
+ConstantPool::utf8_entry ConstantPool::decodeUtf8(u4 slot) const
+{
+  u4 offset = deferred->offsets[slot];
+  parsing::ByteConsumer bc(deferred->data + offset, deferred->length - offset);
+  auto bytes = bc.readBytes(bc.readU2());
+  Symbol symbol;
+  if (deferred->trusted)
+  {
+    ClassArchive::symbol_header header;
+    std::memcpy(&header, deferred->data + offset - sizeof(header), sizeof(header));
+    symbol = Symbol::intern(bytes, header.hash, header.length);
+  }
+  else
+  {
+    // Check the bytes before they go anywhere near the symbol table
+    JUtf8String::borrow(bytes);
+    symbol = Symbol::intern(bytes);
+  }
+  u1 uses = deferred->uses[slot];
+  u1 first = bytes.empty() ? 0 : bytes[0];
+  if ((uses & method_descriptor) && first == '(')
+  {
+    auto descriptor = MethodDescriptor::tryParse(symbol.view());
+    if (descriptor)
+      return utf8_entry{symbol, *descriptor};
+  }
+  else if ((uses & field_descriptor) || ((uses & class_name) && first == FieldDescriptor::type::jarray))
+  {
+    auto descriptor = FieldDescriptor::tryParse(symbol.view());
+    if (descriptor)
+      return utf8_entry{symbol, *descriptor};
+  }
+  // Anything that doesn't parse is left for validation to reject
+  return utf8_entry{symbol, symbol.string()};
+}
+
+ConstantPool::cp_type_index ConstantPool::typeOf(tag entry_tag)
+{
+  switch (entry_tag)
+  {
+  case Class:
+    return cp_class;
+  case Fieldref:
+    return cp_fieldref;
+  case Methodref:
+    return cp_methodref;
+  case InterfaceMethodref:
+    return cp_interfaceMethodref;
+  case String:
+    return cp_string;
+  case Integer:
+    return cp_integer;
+  case Float:
+    return cp_float;
+  case Long:
+    return cp_long;
+  case Double:
+    return cp_double;
+  case NameAndType:
+    return cp_nameAndType;
+  case Utf8:
+    return cp_utf8;
+  case MethodHandle:
+    return cp_methodHandle;
+  case MethodType:
+    return cp_methodType;
+  case InvokeDynamic:
+    return cp_invokeDynamic;
+  default:
+    return cp_tag;
+  }
 }
 
 }
@@ -8,10 +8,12 @@
 #ifndef SRC_MIMIC_CONSTANTPOOL_H_
 #define SRC_MIMIC_CONSTANTPOOL_H_
 
+#include <atomic>
 #include "Common.h"
 #include "FieldDescriptor.h"
 #include "MethodDescriptor.h"
 #include "JUtf8String.h"
+#include "Symbol.h"
 #include "parsing/ByteConsumer.h"
 
 namespace mimic
@@ -66,7 +68,7 @@ public:
   typedef struct Fieldref_info
   {
     Fieldref_info(u2 class_index, u2 name_and_type_index)
-    : name_and_type_index(name_and_type_index) {
+    : class_index(class_index), name_and_type_index(name_and_type_index) {
     }
     u2 class_index;
     u2 name_and_type_index;
@@ -76,7 +78,7 @@ public:
   typedef struct Methodref_info
   {
     Methodref_info(u2 class_index, u2 name_and_type_index)
-    : name_and_type_index(name_and_type_index) {
+    : class_index(class_index), name_and_type_index(name_and_type_index) {
     }
     u2 class_index;
     u2 name_and_type_index;
@@ -86,7 +88,7 @@ public:
   typedef struct InterfaceMethodref_info
   {
     InterfaceMethodref_info(u2 class_index, u2 name_and_type_index)
-    : name_and_type_index(name_and_type_index) {
+    : class_index(class_index), name_and_type_index(name_and_type_index) {
     }
     u2 class_index;
     u2 name_and_type_index;
@@ -171,7 +173,7 @@ public:
   typedef struct InvokeDynamic_info
   {
     InvokeDynamic_info(u2 bootstrap_method_attr_index, u2 name_and_type_index)
-    : name_and_type_index(name_and_type_index) {
+    : bootstrap_method_attr_index(bootstrap_method_attr_index), name_and_type_index(name_and_type_index) {
     }
     u2 bootstrap_method_attr_index;
     u2 name_and_type_index;
@@ -216,30 +218,74 @@ public:
     cp_methodDescriptor = 16
   };
 
+  /** How entries are decoded when parsing a constant pool */
+  enum decoding
+  {
+    /** Decode and validate every entry while parsing */
+    eager,
+    /**
+     * Only index the tag and offset of each entry while parsing. Entries are
+     * decoded and validated the first time they are accessed.
+     */
+    lazy
+  };
+
+  /**
+   * The ways in which a Utf8 entry can be referred to as a descriptor. Only
+   * entries referred to as descriptors are parsed as descriptors.
+   */
+  enum descriptor_use : u1
+  {
+    /** Not referred to as a descriptor */
+    not_descriptor = 0,
+    /** The descriptor of a field, or of a NameAndType */
+    field_descriptor = 1,
+    /** The descriptor of a method, MethodType, or of a NameAndType */
+    method_descriptor = 2,
+    /** The name of a Class, which is a field descriptor if it's an array class */
+    class_name = 4
+  };
+
   ConstantPool() {};
-  ConstantPool(std::vector<cp_type> other_pool) : pool(std::move(other_pool)) {};
+  ConstantPool(const std::vector<cp_type>& entries);
 
   /**
    * Parses the constant pool entries from a ByteConsumer
    *
+   * Utf8 entries are parsed as descriptors if the pool's NameAndType,
+   * MethodType or Class entries refer to them as such.
+   *
    * @param the ByteConsumer to use
    * @param the number of constant pool entries
    */
   ConstantPool(parsing::ByteConsumer&, u2);
 
   /**
+   * Parses the constant pool entries from a ByteConsumer
+   *
+   * A lazy pool keeps the raw bytes of its Utf8 entries, referring to the
+   * ByteConsumer's buffer if it has a backing owner or taking a single copy
+   * of them if not. Entries are validated against the given class version
+   * the first time they are accessed.
+   *
+   * @param the ByteConsumer to use
+   * @param the number of constant pool entries
+   * @param mode whether to decode Utf8 entries now or on first access
+   * @param major_version The class' major version number
+   * @param minor_version The class' minor version number
+   */
+  ConstantPool(parsing::ByteConsumer&, u2, decoding mode, u2 major_version, u2 minor_version);
+
+  /**
+   * Gets an entry of the pool. Utf8 and descriptor entries are returned by
+   * reference; every other type is unpacked and returned by value.
+   *
    * @param index the index of the constant pool entry to get
    * @return the constant pool entry at the specified index
    */
-  template <typename T> T& get(const u2& index) const
+  template <typename T> decltype(auto) get(const u2& index) const
   {
-    if (index >= pool.size() || index < 1)
-      throw std::range_error("Invalid constant pool index");
-#ifdef HAVE_VARIANT
-    return (std::get<T>(pool[index]));
-#else
-    return (boost::get<T>(pool[index]));
-#endif
+    return fetch(index, static_cast<T*>(nullptr));
   }
 
   /**
@@ -248,22 +294,298 @@ public:
    */
   cp_type_index getType(const u2& index) const
   {
-    if (index >= pool.size() || index < 1)
+    checkIndex(index);
+    // Only Utf8 entries need decoding to find out which alternative they are
+    if (tags[index] != Utf8)
+      return typeOf(static_cast<tag>(tags[index]));
+#ifdef HAVE_CXX_VARIANT
+    return static_cast<cp_type_index>(text(index).index());
+#else
+    return static_cast<cp_type_index>(text(index).which());
+#endif
+  }
+
+  /**
+   * @param index the index of a Utf8 entry, which may have been parsed as a descriptor
+   * @return the interned symbol for the entry's bytes
+   */
+  Symbol getSymbol(const u2& index) const
+  {
+    checkIndex(index);
+    if (tags[index] != Utf8)
+      wrongType();
+    return utf8(index).symbol;
+  }
+
+  /**
+   * @return the number of entries in the pool, including the unusable entry 0
+   */
+  std::size_t size() const { return tags.size(); };
+
+  /**
+   * @return true if Utf8 entries are decoded on first access
+   */
+  bool isLazy() const { return deferred && deferred->lazy; };
+
+private:
+  friend class ClassArchive;
+  friend class ClassFile;
+  friend class ClassValidator;
+
+  /** A decoded Utf8 entry */
+  struct utf8_entry
+  {
+    /** The entry's bytes, which any JUtf8String value borrows */
+    Symbol symbol;
+    cp_type value;
+  };
+
+  /** Raw Utf8 entries of an indexed pool, shared between copies of a lazy pool */
+  struct lazy_entries
+  {
+    ~lazy_entries();
+
+    /** Offset of each Utf8 entry's length from data, by slot */
+    std::vector<u4> offsets;
+    /** How each Utf8 entry is referred to, by slot; a combination of descriptor_use */
+    std::vector<u1> uses;
+    const u1* data = nullptr;
+    std::size_t length = 0;
+    /** Owner of data when it is retained from the class file */
+    std::shared_ptr<const void> backing;
+    /** Owned copy of the Utf8 entries' bytes when there is no backing */
+    std::vector<u1> copy;
+    u2 major_version = 0;
+    u2 minor_version = 0;
+    /** Set by retain(), after which entries are validated on access */
+    bool lazy = false;
+    /**
+     * Set for pools mapped from a ClassArchive. Their entries were validated
+     * when the archive was written, and each Utf8 entry is preceded by its
+     * hash and character count (see ClassArchive::symbol_header).
+     */
+    bool trusted = false;
+    /** Decoded Utf8 entries by slot, published once decoded and validated */
+    std::unique_ptr<std::atomic<const utf8_entry*>[]> decoded;
+    /** Whether each fixed-size entry has been validated, by index */
+    std::unique_ptr<std::atomic<bool>[]> validated;
+  };
+
+  /** The tag of each entry. Entry 0 and the upper halves of Longs and Doubles are Invalid. */
+  std::vector<u1> tags;
+  /**
+   * The contents of each fixed-size entry packed into 32 bits, with pairs of
+   * indices packed high half first. Longs and Doubles keep their low 32 bits
+   * in the payload of the following, unusable, index. Utf8 entries hold their
+   * slot in the side table.
+   */
+  std::vector<u4> payloads;
+  /** The side table of decoded Utf8 entries of an eager pool, by slot */
+  std::vector<utf8_entry> utf8_entries;
+  std::shared_ptr<lazy_entries> deferred;
+
+  void checkIndex(const u2& index) const
+  {
+    if (index >= size() || index < 1)
     {
       std::stringstream ss;
       ss << "Invalid constant pool index " << index;
       throw std::range_error(ss.str().c_str());
     }
-#ifdef HAVE_VARIANT
-    return static_cast<cp_type_index>(pool[index].index());
+  }
+
+  /**
+   * @param index the index of a fixed-size entry
+   * @param expected the tag the entry must have
+   * @return the entry's payload, once the entry has been validated
+   */
+  u4 packed(const u2& index, tag expected) const
+  {
+    checkIndex(index);
+    if (tags[index] != expected)
+      wrongType();
+    if (deferred && deferred->lazy && !deferred->validated[index].load(std::memory_order_acquire))
+      validate(index);
+    return payloads[index];
+  }
+
+  /**
+   * @param index the index of a Utf8 entry
+   * @return the entry, decoding it first if necessary
+   */
+  const utf8_entry& utf8(const u2& index) const
+  {
+    u4 slot = payloads[index];
+    if (deferred)
+    {
+      const utf8_entry* decoded = deferred->decoded[slot].load(std::memory_order_acquire);
+      return decoded ? *decoded : decode(slot);
+    }
+    return utf8_entries[slot];
+  }
+
+  const cp_type& text(const u2& index) const { return utf8(index).value; };
+
+  /**
+   * @param index the index of a Utf8 entry of a pool that has only been indexed
+   * @return the entry's bytes, which haven't been checked yet
+   */
+  parsing::ByteView rawUtf8(const u2& index) const
+  {
+    const u1* entry = deferred->data + deferred->offsets[payloads[index]];
+    return parsing::ByteView(entry + 2, (entry[0] << 8) | entry[1]);
+  }
+
+  static u2 high(u4 payload) { return static_cast<u2>(payload >> 16); };
+  static u2 low(u4 payload) { return static_cast<u2>(payload); };
+
+  /* get() overloads for each entry type. Entries other than Utf8 entries are
+   * rebuilt from their payloads. */
+  tag fetch(const u2& index, const tag*) const
+  {
+    packed(index, Invalid);
+    return Invalid;
+  }
+  Class_info fetch(const u2& index, const Class_info*) const
+  {
+    return Class_info(packed(index, Class));
+  }
+  Fieldref_info fetch(const u2& index, const Fieldref_info*) const
+  {
+    u4 payload = packed(index, Fieldref);
+    return Fieldref_info(high(payload), low(payload));
+  }
+  Methodref_info fetch(const u2& index, const Methodref_info*) const
+  {
+    u4 payload = packed(index, Methodref);
+    return Methodref_info(high(payload), low(payload));
+  }
+  InterfaceMethodref_info fetch(const u2& index, const InterfaceMethodref_info*) const
+  {
+    u4 payload = packed(index, InterfaceMethodref);
+    return InterfaceMethodref_info(high(payload), low(payload));
+  }
+  String_info fetch(const u2& index, const String_info*) const
+  {
+    return String_info(packed(index, String));
+  }
+  Integer_info fetch(const u2& index, const Integer_info*) const
+  {
+    return Integer_info(packed(index, Integer));
+  }
+  Float_info fetch(const u2& index, const Float_info*) const
+  {
+    return Float_info(packed(index, Float));
+  }
+  Long_info fetch(const u2& index, const Long_info*) const
+  {
+    return Long_info(packed(index, Long), payloads[index + 1]);
+  }
+  Double_info fetch(const u2& index, const Double_info*) const
+  {
+    return Double_info(packed(index, Double), payloads[index + 1]);
+  }
+  NameAndType_info fetch(const u2& index, const NameAndType_info*) const
+  {
+    u4 payload = packed(index, NameAndType);
+    return NameAndType_info(high(payload), low(payload));
+  }
+  MethodHandle_info fetch(const u2& index, const MethodHandle_info*) const
+  {
+    u4 payload = packed(index, MethodHandle);
+    return MethodHandle_info(static_cast<reference_kind>(high(payload)), low(payload));
+  }
+  MethodType_info fetch(const u2& index, const MethodType_info*) const
+  {
+    return MethodType_info(packed(index, MethodType));
+  }
+  InvokeDynamic_info fetch(const u2& index, const InvokeDynamic_info*) const
+  {
+    u4 payload = packed(index, InvokeDynamic);
+    return InvokeDynamic_info(high(payload), low(payload));
+  }
+  template <typename T> T& fetch(const u2& index, T*) const
+  {
+    checkIndex(index);
+    if (tags[index] != Utf8)
+      wrongType();
+#ifdef HAVE_CXX_VARIANT
+    return (std::get<T>(text(index)));
 #else
-    return static_cast<cp_type_index>(pool[index].which());
+    return (boost::get<T>(text(index)));
 #endif
   }
 
-private:
-  friend class ClassValidator;
-  std::vector<cp_type> pool;
+  /**
+   * @param index the index of a fixed-size entry
+   * @return the entry as a cp_type
+   */
+  cp_type unpack(const u2& index) const;
+
+  /**
+   * Throws the exception used by the variant for a get of the wrong type
+   */
+  [[noreturn]] static void wrongType();
+
+  /**
+   * Validates a fixed-size entry of a lazy pool and records that it's valid
+   */
+  void validate(const u2& index) const;
+
+  /**
+   * Indexes the entries of a constant pool, decoding everything but the Utf8
+   * entries. The returned pool refers to the ByteConsumer's buffer and must be
+   * finished with decodeAll() or retain() before the ByteConsumer goes away.
+   *
+   * @param bc the ByteConsumer to use
+   * @param constant_pool_count the number of constant pool entries
+   * @param major_version The class' major version number
+   * @param minor_version The class' minor version number
+   * @return the indexed pool
+   */
+  static ConstantPool index(parsing::ByteConsumer& bc, u2 constant_pool_count,
+                            u2 major_version, u2 minor_version);
+
+  /**
+   * Records that a Utf8 entry is referred to as a descriptor from outside the
+   * pool. Must be called before the entry is decoded. Invalid indices are
+   * ignored and left for validation to find.
+   *
+   * @param index the index of the entry
+   * @param use how the entry is referred to
+   */
+  void markDescriptor(u2 index, descriptor_use use)
+  {
+    if (deferred && index < tags.size() && tags[index] == Utf8)
+      deferred->uses[payloads[index]] |= use;
+  }
+
+  /**
+   * Keeps the Utf8 bytes of an indexed pool so that it can outlive its
+   * ByteConsumer, and validates entries on access from then on
+   */
+  void retain();
+
+  /**
+   * Decodes every Utf8 entry of an indexed pool, without validating them
+   */
+  void decodeAll();
+
+  /**
+   * Decodes, validates and caches a lazy Utf8 entry
+   */
+  const utf8_entry& decode(u4 slot) const;
+
+  /**
+   * Decodes the Utf8 entry in the given slot of an indexed pool
+   */
+  utf8_entry decodeUtf8(u4 slot) const;
+
+  /**
+   * @return the cp_type alternative used for entries with the given tag,
+   *         except for Utf8 entries which may be one of several
+   */
+  static cp_type_index typeOf(tag entry_tag);
 };
 
 }
@@ -6,77 +6,146 @@
  */
 
 #include "FieldDescriptor.h"
+#include <cstring>
 
 namespace mimic {
 
-FieldDescriptor::FieldDescriptor(const JUtf8String& str)
-  :descriptor_type(type::jarray), array_dimensions(0)
+namespace
 {
-  for (auto i = str.begin(); i != str.end(); ++i)
+/**
+ * @return the interned name of a primitive type, or the empty symbol if t
+ *         isn't primitive
+ */
+Symbol primitiveName(FieldDescriptor::type t)
+{
+  // Interned once, so parsing a primitive never touches the symbol table
+  static const struct names
   {
-    switch (*i)
+    Symbol byName[128];
+
+    names()
     {
-      case type::jbyte:
-        class_name = JUtf8String("byte");
-        descriptor_type = static_cast<type>(*i);
-        break;
-      case type::jchar:
-        class_name = JUtf8String("char");
-        descriptor_type = static_cast<type>(*i);
-        break;
-      case type::jdouble:
-        class_name = JUtf8String("double");
-        descriptor_type = static_cast<type>(*i);
-        break;
-      case type::jfloat:
-        class_name = JUtf8String("float");
-        descriptor_type = static_cast<type>(*i);
-        break;
-      case type::jint:
-        class_name = JUtf8String("int");
-        descriptor_type = static_cast<type>(*i);
-        break;
-      case type::jlong:
-        class_name = JUtf8String("long");
-        descriptor_type = static_cast<type>(*i);
-        break;
-      case type::jshort:
-        class_name = JUtf8String("short");
-        descriptor_type = static_cast<type>(*i);
-        break;
-      case type::jboolean:
-        class_name = JUtf8String("boolean");
-        descriptor_type = static_cast<type>(*i);
-        break;
-      case type::jclass:
-      {
-        descriptor_type = type::jclass;
-        auto nameEnd = str.find(JUtf8String(";"));
-        if (nameEnd == str.end())
-          throw parsing::parse_failure("No semicolon after class or interface name");
-        if (nameEnd == (i + 1))
-          throw parsing::parse_failure("Class name missing");
-        class_name = JUtf8String(++i, nameEnd);
-        i = ++nameEnd;
-        break;
-      }
-      case type::jarray:
-        if (descriptor_type == type::jarray && array_dimensions < MAX_ARRAY_DIMENSIONS)
-        {
-          array_dimensions++;
-          break;
-        }
-      [[fallthrough]]
-      default:
-        throw parsing::parse_failure("Invalid descriptor type");
+      const std::pair<u1, const char*> primitives[] = {
+        {FieldDescriptor::jbyte, "byte"}, {FieldDescriptor::jchar, "char"},
+        {FieldDescriptor::jdouble, "double"}, {FieldDescriptor::jfloat, "float"},
+        {FieldDescriptor::jint, "int"}, {FieldDescriptor::jlong, "long"},
+        {FieldDescriptor::jshort, "short"}, {FieldDescriptor::jboolean, "boolean"}};
+      for (auto& primitive : primitives)
+        byName[primitive.first] = Symbol::intern(parsing::ByteView(
+            reinterpret_cast<const u1*>(primitive.second), std::strlen(primitive.second)));
     }
+  } all;
+  return all.byName[t & 0x7f];
+}
+
+/**
+ * Interns a component type's name with a pair of brackets per dimension
+ * appended, e.g. java/lang/String[][]
+ */
+Symbol arrayName(parsing::ByteView component, u1 dimensions)
+{
+  std::size_t size = component.size() + 2 * dimensions;
+  // Only very deep or very long names need the heap
+  u1 buffer[256];
+  std::vector<u1> overflow;
+  u1* name = buffer;
+  if (size > sizeof(buffer))
+  {
+    overflow.resize(size);
+    name = overflow.data();
   }
-  std::stringstream ss;
-  for (int i = 0; i < array_dimensions; i++)
+  std::memcpy(name, component.data(), component.size());
+  for (std::size_t i = component.size(); i < size; i += 2)
   {
-    ss << "[]";
+    name[i] = '[';
+    name[i + 1] = ']';
+  }
+  return Symbol::intern(parsing::ByteView(name, size));
+}
+}
+
+FieldDescriptor::FieldDescriptor(parsing::ByteView bytes)
+  :descriptor_type(type::jarray), array_dimensions(0)
+{
+  const char* error = parse(bytes);
+  if (error)
+    throw parsing::parse_failure(error);
+}
+
+optional<FieldDescriptor> FieldDescriptor::tryParse(parsing::ByteView bytes)
+{
+  FieldDescriptor descriptor;
+  if (descriptor.parse(bytes))
+    return optional<FieldDescriptor>();
+  return descriptor;
+}
+
+const char* FieldDescriptor::parse(parsing::ByteView bytes)
+{
+  const u1* position = bytes.begin();
+  const char* error = parse(position, bytes.end());
+  if (error)
+    return error;
+  // Nothing may follow the component type
+  if (position != bytes.end())
+    return "Invalid descriptor type";
+  return nullptr;
+}
+
+const char* FieldDescriptor::parse(const u1*& position, const u1* last)
+{
+  // Every byte the grammar cares about is ASCII, and no byte of a multi-byte
+  // character is, so there's no need to decode characters
+  const u1* current = position;
+  while (current != last && *current == type::jarray)
+  {
+    if (array_dimensions == MAX_ARRAY_DIMENSIONS)
+      return "Invalid descriptor type";
+    array_dimensions++;
+    ++current;
+  }
+  if (current == last)
+    return array_dimensions ? "Array missing component type" : "Invalid descriptor type";
+  parsing::ByteView name;
+  switch (*current)
+  {
+    case type::jbyte:
+    case type::jchar:
+    case type::jdouble:
+    case type::jfloat:
+    case type::jint:
+    case type::jlong:
+    case type::jshort:
+    case type::jboolean:
+      descriptor_type = static_cast<type>(*current);
+      ++current;
+      if (array_dimensions == 0)
+      {
+        class_name = primitiveName(descriptor_type);
+        position = current;
+        return nullptr;
+      }
+      name = primitiveName(descriptor_type).view();
+      break;
+    case type::jclass:
+    {
+      descriptor_type = type::jclass;
+      const u1* name_start = current + 1;
+      auto name_end = static_cast<const u1*>(std::memchr(name_start, ';', last - name_start));
+      if (!name_end)
+        return "No semicolon after class or interface name";
+      if (name_end == name_start)
+        return "Class name missing";
+      name = parsing::ByteView(name_start, name_end - name_start);
+      current = name_end + 1;
+      break;
+    }
+    default:
+      return "Invalid descriptor type";
   }
-  ss >> class_name;
+  class_name = array_dimensions ? arrayName(name, array_dimensions) : Symbol::intern(name);
+  position = current;
+  return nullptr;
 }
 
 }
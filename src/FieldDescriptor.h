@@ -10,6 +10,7 @@
 
 #include "Common.h"
 #include "JUtf8String.h"
+#include "Symbol.h"
 #include "parsing/ParseFailureException.h"
 
 namespace mimic {
@@ -21,7 +22,7 @@ namespace mimic {
  */
 class FieldDescriptor {
 public:
-  enum type {
+  enum type : u1 {
     jbyte = 'B',
     jchar = 'C',
     jdouble = 'D',
@@ -34,13 +35,45 @@ public:
     jarray = '['
   };
 
-  FieldDescriptor(const JUtf8String& str);
+  /**
+   * Parses a field descriptor
+   *
+   * @param str the descriptor
+   * @throws parse_failure if str is not a valid field descriptor
+   */
+  FieldDescriptor(const JUtf8String& str) : FieldDescriptor(str.view()) {};
 
-  bool isPrimitive() { return descriptor_type != type::jclass && array_dimensions == 0; };
-  bool isArray() { return array_dimensions > 0; };
-  u1 getArrayDimensions() { return array_dimensions; };
-  type getType() { return descriptor_type; };
-  JUtf8String getClassName() { return class_name; };
+  /**
+   * Parses a field descriptor
+   *
+   * @param bytes the descriptor, which must be valid modified UTF-8
+   * @throws parse_failure if bytes is not a valid field descriptor
+   */
+  FieldDescriptor(parsing::ByteView bytes);
+
+  /**
+   * Parses a field descriptor without throwing
+   *
+   * @param str the descriptor
+   * @return the descriptor, or nothing if str is not a valid field descriptor
+   */
+  static optional<FieldDescriptor> tryParse(const JUtf8String& str) { return tryParse(str.view()); };
+
+  /**
+   * Parses a field descriptor without throwing or allocating, other than to
+   * intern a class name the first time it's seen
+   *
+   * @param bytes the descriptor, which must be valid modified UTF-8
+   * @return the descriptor, or nothing if bytes is not a valid field descriptor
+   */
+  static optional<FieldDescriptor> tryParse(parsing::ByteView bytes);
+
+  bool isPrimitive() const { return descriptor_type != type::jclass && array_dimensions == 0; };
+  bool isArray() const { return array_dimensions > 0; };
+  u1 getArrayDimensions() const { return array_dimensions; };
+  type getType() const { return descriptor_type; };
+  JUtf8String getClassName() const { return class_name.string(); };
+  Symbol getClassSymbol() const { return class_name; };
   bool operator ==(const FieldDescriptor& other) const
   {
     if (descriptor_type != other.descriptor_type)
@@ -53,12 +86,31 @@ public:
   }
 
 private:
-  u1 MAX_ARRAY_DIMENSIONS = 255;
+  static const u1 MAX_ARRAY_DIMENSIONS = 255;
+  Symbol class_name;
   type descriptor_type;
   u1 array_dimensions;
-  JUtf8String class_name;
 
-  FieldDescriptor() = delete;
+  friend class MethodDescriptor;
+
+  FieldDescriptor() : descriptor_type(type::jarray), array_dimensions(0) {};
+
+  /**
+   * Parses one field type into this object, as found on its own or in the
+   * parameter list of a method descriptor
+   *
+   * @param position the first byte of the type, moved past the type if it is
+   *        valid
+   * @param last the end of the bytes that may hold the type
+   * @return nullptr if successful, else a description of the problem
+   */
+  const char* parse(const u1*& position, const u1* last);
+
+  /**
+   * @param bytes the descriptor to parse into this object
+   * @return nullptr if successful, else a description of the problem
+   */
+  const char* parse(parsing::ByteView bytes);
 };
 
 }
@@ -0,0 +1,125 @@
+/**
+ * \file FieldLayout.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "FieldLayout.h"
+
+namespace mimic
+{
+
+const u4 FieldLayout::reference_size;
+const u4 FieldLayout::alignment;
+
+FieldLayout::FieldLayout(u4 start)
+  : end(start), used(start)
+{
+}
+
+std::vector<u4> FieldLayout::addFields(const std::vector<FieldDescriptor::type>& types)
+{
+  std::vector<u4> offsets(types.size());
+  auto addReferences = [&]() {
+    for (std::size_t i = 0; i < types.size(); i++)
+    {
+      if (isReference(types[i]))
+        offsets[i] = appendReference();
+    }
+  };
+  // Extend the superclass' references if nothing comes after them
+  bool references_first = !oops.empty() && oops.back().end() == end;
+  if (references_first)
+    addReferences();
+  for (u1 size : {8, 4, 2, 1})
+  {
+    for (std::size_t i = 0; i < types.size(); i++)
+    {
+      if (!isReference(types[i]) && sizeOf(types[i]) == size)
+        offsets[i] = allocate(size);
+    }
+  }
+  if (!references_first)
+    addReferences();
+  return offsets;
+}
+
+u4 FieldLayout::addField(FieldDescriptor::type type)
+{
+  return isReference(type) ? appendReference() : allocate(sizeOf(type));
+}
+
+u4 FieldLayout::reserve(u4 size, u4 align)
+{
+  return append(size, align);
+}
+
+FieldDescriptor::type FieldLayout::typeOf(const FieldDescriptor& descriptor)
+{
+  return descriptor.isArray() ? FieldDescriptor::jarray : descriptor.getType();
+}
+
+u1 FieldLayout::sizeOf(FieldDescriptor::type type)
+{
+  switch (type)
+  {
+  case FieldDescriptor::jbyte:
+  case FieldDescriptor::jboolean:
+    return 1;
+  case FieldDescriptor::jchar:
+  case FieldDescriptor::jshort:
+    return 2;
+  case FieldDescriptor::jint:
+  case FieldDescriptor::jfloat:
+    return 4;
+  case FieldDescriptor::jlong:
+  case FieldDescriptor::jdouble:
+    return 8;
+  default:
+    return reference_size;
+  }
+}
+
+u4 FieldLayout::allocate(u4 size)
+{
+  for (auto g = gaps.begin(); g != gaps.end(); ++g)
+  {
+    u4 offset = alignUp(g->offset, size);
+    u4 gap_end = g->offset + g->size;
+    if (offset + size > gap_end)
+      continue;
+    gap before{g->offset, offset - g->offset};
+    gap after{offset + size, gap_end - offset - size};
+    g = gaps.erase(g);
+    if (after.size)
+      g = gaps.insert(g, after);
+    if (before.size)
+      gaps.insert(g, before);
+    used += size;
+    return offset;
+  }
+  return append(size, size);
+}
+
+u4 FieldLayout::append(u4 size, u4 align)
+{
+  u4 offset = alignUp(end, align);
+  if (offset != end)
+    gaps.push_back(gap{end, offset - end});
+  end = offset + size;
+  used += size;
+  return offset;
+}
+
+u4 FieldLayout::appendReference()
+{
+  u4 offset = append(reference_size, reference_size);
+  if (!oops.empty() && oops.back().end() == offset)
+    oops.back().count++;
+  else
+    oops.push_back(oop_block{offset, 1});
+  return offset;
+}
+
+}
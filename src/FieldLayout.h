@@ -0,0 +1,144 @@
+/**
+ * \file FieldLayout.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_FIELDLAYOUT_H_
+#define SRC_MIMIC_FIELDLAYOUT_H_
+
+#include "Common.h"
+#include <vector>
+#include "FieldDescriptor.h"
+
+namespace mimic
+{
+
+/**
+ * Decides where fields go in an object or in a class' static storage
+ *
+ * A class' instance layout starts as a copy of its superclass', so inherited
+ * fields keep their offsets. Its own fields are packed by size, largest
+ * first, each aligned to its size, and smaller fields fill the gaps that
+ * aligning larger ones left, including gaps left by superclasses.
+ *
+ * References are kept together in runs so that the garbage collector can
+ * scan an object with one range per run. A class' references go straight
+ * after its superclass' if the superclass ended with its references, which
+ * extends the same run; otherwise they go after the class' other fields,
+ * where a subclass can extend them in turn.
+ *
+ * https://shipilev.net/jvm/objects-inside-out/#_field_packing
+ */
+class FieldLayout
+{
+public:
+  /** A run of references: count of them, from offset */
+  struct oop_block
+  {
+    u4 offset;
+    u4 count;
+
+    u4 end() const { return offset + count * reference_size; };
+  };
+
+  /** Bytes left unused between fields */
+  struct gap
+  {
+    u4 offset;
+    u4 size;
+  };
+
+  /** The size of a reference field */
+  static const u4 reference_size = sizeof(void*);
+  /** What objects and static storage are aligned to, and so what their size is rounded up to */
+  static const u4 alignment = 8;
+
+  /**
+   * Starts an empty layout
+   *
+   * @param start the offset of the first byte fields may use: the size of
+   *        the object header, or 0 for static storage
+   */
+  explicit FieldLayout(u4 start = 0);
+
+  /**
+   * Lays out all of a class' fields at once, so they can be packed
+   *
+   * @param types the type of each field
+   * @return the offset of each field, in the same order
+   */
+  std::vector<u4> addFields(const std::vector<FieldDescriptor::type>& types);
+
+  /**
+   * Lays out one field, after those already laid out or in a gap between
+   * them
+   *
+   * @param type the field's type
+   * @return the field's offset
+   */
+  u4 addField(FieldDescriptor::type type);
+
+  /**
+   * Reserves space at the end of the layout for state the virtual machine
+   * keeps in objects, which the garbage collector doesn't scan
+   *
+   * @param size the size of the state
+   * @param align what its offset must be a multiple of
+   * @return its offset
+   */
+  u4 reserve(u4 size, u4 align);
+
+  /** @return the size of the object or static storage, rounded up to the alignment */
+  u4 getSize() const { return alignUp(end, alignment); };
+  /** @return the end of the last field */
+  u4 getEnd() const { return end; };
+  /** @return the bytes taken by fields, the header and reserved space */
+  u4 getUsed() const { return used; };
+  /** @return the bytes of getSize() that nothing uses */
+  u4 getPadding() const { return getSize() - used; };
+  /** @return the runs of references, in increasing order of offset */
+  const std::vector<oop_block>& getOopMap() const { return oops; };
+  /** @return the gaps between fields that are still free, not counting the padding after the end */
+  const std::vector<gap>& getGaps() const { return gaps; };
+
+  /**
+   * @param type a field's type
+   * @return the bytes a field of the type takes
+   */
+  static u1 sizeOf(FieldDescriptor::type type);
+
+  /**
+   * @param descriptor a field's descriptor
+   * @return the type to lay the field out as: getType(), except that arrays
+   *         are jarray rather than their element type
+   */
+  static FieldDescriptor::type typeOf(const FieldDescriptor& descriptor);
+
+  static bool isReference(FieldDescriptor::type type)
+  {
+    return type == FieldDescriptor::jclass || type == FieldDescriptor::jarray;
+  }
+
+private:
+  u4 end;
+  u4 used;
+  std::vector<gap> gaps;
+  std::vector<oop_block> oops;
+
+  static u4 alignUp(u4 offset, u4 align) { return (offset + align - 1) / align * align; };
+
+  /** Places bytes in the first gap they fit in, or at the end */
+  u4 allocate(u4 size);
+
+  /** Places bytes at the end, aligned to align */
+  u4 append(u4 size, u4 align);
+
+  /** Places a reference at the end */
+  u4 appendReference();
+};
+
+}
+
+#endif /* SRC_MIMIC_FIELDLAYOUT_H_ */
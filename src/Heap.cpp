@@ -0,0 +1,181 @@
+/**
+ * \file Heap.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "Heap.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <sys/mman.h>
+
+namespace mimic
+{
+
+namespace
+{
+/** Heap ids start at 1, so that a thread's empty cache matches no heap */
+std::atomic<u8> next_id(1);
+}
+
+const std::size_t Heap::default_max_size;
+const std::size_t Heap::default_tlab_size;
+const std::size_t Heap::alignment;
+const std::size_t Heap::refill_waste_fraction;
+
+Heap::Heap(std::size_t max_size, std::size_t tlab_size)
+  : base(nullptr), max_size(max_size), tlab_size(tlab_size), eden(0), id(next_id++)
+{
+  if (max_size == 0 || max_size % alignment != 0 || tlab_size == 0 || tlab_size % alignment != 0)
+    throw std::runtime_error("The heap and TLAB sizes must be non-zero multiples of " + std::to_string(alignment));
+  // Only address space is reserved; pages are backed when first touched
+  void* mapping = ::mmap(nullptr, max_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                         -1, 0);
+  if (mapping == MAP_FAILED)
+    throw std::runtime_error("Unable to reserve a heap of " + std::to_string(max_size) + " bytes: "
+                             + std::strerror(errno));
+  base = static_cast<u1*>(mapping);
+}
+
+Heap::~Heap()
+{
+  ::munmap(base, max_size);
+}
+
+std::size_t Heap::getUsed() const
+{
+  return std::min(eden.load(std::memory_order_relaxed), max_size);
+}
+
+std::vector<Heap::thread_stats> Heap::getStats() const
+{
+  // The lock keeps threads from being added while the TLABs are walked
+  std::lock_guard<std::mutex> guard(lock);
+  std::vector<thread_stats> stats;
+  for (auto& t : tlabs)
+  {
+    stats.push_back(thread_stats{t->thread, t->objects.load(std::memory_order_relaxed),
+                                 t->bytes.load(std::memory_order_relaxed), t->tlabs.load(std::memory_order_relaxed),
+                                 t->outside.load(std::memory_order_relaxed),
+                                 t->waste.load(std::memory_order_relaxed)});
+  }
+  return stats;
+}
+
+void Heap::dumpStats(std::ostream& stream) const
+{
+  auto stats = getStats();
+  stream << "heap: " << getUsed() << " of " << max_size << " bytes used, TLABs of " << tlab_size << " bytes"
+         << std::endl;
+  for (std::size_t i = 0; i < stats.size(); i++)
+  {
+    auto& s = stats[i];
+    stream << "thread " << i + 1 << ": " << s.objects << " objects, " << s.bytes << " bytes, " << s.tlabs
+           << " TLABs, " << s.outside << " outside TLABs, " << s.waste << " bytes wasted" << std::endl;
+  }
+}
+
+std::size_t Heap::parseSize(const std::string& size)
+{
+  std::size_t end = 0;
+  unsigned long long value = 0;
+  try
+  {
+    value = std::stoull(size, &end);
+  }
+  catch (std::exception&)
+  {
+    end = 0;
+  }
+  if (end == 0 || size[0] == '-')
+    throw std::runtime_error("Invalid size " + size);
+  u1 shift = 0;
+  if (end + 1 == size.size())
+  {
+    switch (size[end])
+    {
+    case 'k':
+    case 'K':
+      shift = 10;
+      break;
+    case 'm':
+    case 'M':
+      shift = 20;
+      break;
+    case 'g':
+    case 'G':
+      shift = 30;
+      break;
+    default:
+      throw std::runtime_error("Invalid size " + size);
+    }
+  }
+  else if (end != size.size())
+  {
+    throw std::runtime_error("Invalid size " + size);
+  }
+  if (value > (~std::size_t(0) >> shift))
+    throw std::runtime_error("Invalid size " + size);
+  return std::size_t(value) << shift;
+}
+
+Heap::tlab& Heap::attach()
+{
+  std::lock_guard<std::mutex> guard(lock);
+  auto thread = std::this_thread::get_id();
+  for (auto& t : tlabs)
+  {
+    if (t->thread == thread)
+      return *t;
+  }
+  // An empty TLAB, so the first allocation takes one from eden
+  tlabs.emplace_back(new tlab());
+  tlabs.back()->thread = thread;
+  return *tlabs.back();
+}
+
+void* Heap::allocateSlow(tlab& t, std::size_t size)
+{
+  std::size_t left = std::size_t(t.end - t.top);
+  u1* p;
+  if (size > tlab_size || left > tlab_size / refill_waste_fraction)
+  {
+    // Too big for a TLAB, or too much of this one would be thrown away
+    p = claim(size);
+    if (!p)
+      return nullptr;
+    add(t.outside, 1);
+  }
+  else
+  {
+    u1* fresh = claim(tlab_size);
+    if (!fresh)
+      return nullptr;
+    add(t.waste, left);
+    add(t.tlabs, 1);
+    p = fresh;
+    t.top = fresh + size;
+    t.end = fresh + tlab_size;
+  }
+  add(t.objects, 1);
+  add(t.bytes, size);
+  return p;
+}
+
+u1* Heap::claim(std::size_t size)
+{
+  // Turn away what can't fit without moving eden, so that one huge request
+  // doesn't use up what's left for everything else
+  if (size > max_size - getUsed())
+    return nullptr;
+  std::size_t offset = eden.fetch_add(size, std::memory_order_relaxed);
+  if (offset > max_size || size > max_size - offset)
+    return nullptr;
+  return base + offset;
+}
+
+}
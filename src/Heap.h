@@ -0,0 +1,206 @@
+/**
+ * \file Heap.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_HEAP_H_
+#define SRC_MIMIC_HEAP_H_
+
+#include "Common.h"
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mimic
+{
+
+/**
+ * The Java heap: one contiguous range of address space, reserved up front,
+ * that objects are allocated from
+ *
+ * Each thread allocates from a thread-local allocation buffer (TLAB), a
+ * chunk of the heap that only it uses, by bumping a pointer, with no locks
+ * or atomic read-modify-writes. When its TLAB runs out a thread takes
+ * another from the shared eden, the part of the heap not yet handed out,
+ * with a single atomic fetch-add. Objects too big to be worth a TLAB, or
+ * that would throw away too much of the current one, are taken from eden the
+ * same way.
+ *
+ * Nothing is collected yet, so the heap only fills up. Memory is zero when
+ * it's first mapped and is never reused, so allocations don't need zeroing.
+ * Requests bigger than what's left of eden are turned away without taking
+ * anything. Two threads racing for the last of it can still both fail,
+ * leaving what's left unused.
+ *
+ * Allocation is safe from any number of threads.
+ */
+class Heap
+{
+public:
+  /** What's allocated for each thread, recorded by the thread as it allocates */
+  struct thread_stats
+  {
+    std::thread::id thread;
+    /** The objects allocated */
+    u8 objects;
+    /** The bytes allocated, including alignment */
+    u8 bytes;
+    /** The TLABs taken from eden */
+    u8 tlabs;
+    /** The objects allocated from eden directly */
+    u8 outside;
+    /** The bytes left unused at the end of retired TLABs */
+    u8 waste;
+  };
+
+  static const std::size_t default_max_size = std::size_t(256) << 20;
+  static const std::size_t default_tlab_size = std::size_t(64) << 10;
+  /** What every allocation's size is rounded up to */
+  static const std::size_t alignment = 8;
+  /**
+   * A TLAB is retired to make room for an object only when less than this
+   * fraction of it is left; otherwise the object comes from eden directly
+   */
+  static const std::size_t refill_waste_fraction = 64;
+
+  /**
+   * Reserves the heap's address space
+   *
+   * @param max_size the size of the heap in bytes
+   * @param tlab_size the size of each TLAB in bytes
+   * @throws runtime_error if the sizes aren't multiples of the alignment, or
+   *         the address space can't be reserved
+   */
+  explicit Heap(std::size_t max_size = default_max_size, std::size_t tlab_size = default_tlab_size);
+  ~Heap();
+
+  Heap(const Heap&) = delete;
+  Heap& operator=(const Heap&) = delete;
+
+  /**
+   * Allocates from the calling thread's TLAB
+   *
+   * @param size the bytes to allocate
+   * @return the zeroed memory, aligned to the alignment, or null if the heap
+   *         is full
+   */
+  void* allocate(std::size_t size)
+  {
+    // Rounding a size near SIZE_MAX up would wrap it round to a small one
+    if (size > max_size)
+      return nullptr;
+    tlab& t = current();
+    size = (size + alignment - 1) & ~(alignment - 1);
+    if (size <= std::size_t(t.end - t.top))
+    {
+      void* p = t.top;
+      t.top += size;
+      add(t.objects, 1);
+      add(t.bytes, size);
+      return p;
+    }
+    return allocateSlow(t, size);
+  }
+
+  std::size_t getMaxSize() const { return max_size; };
+  std::size_t getTlabSize() const { return tlab_size; };
+  /** @return the bytes of eden handed out so far, to TLABs or objects */
+  std::size_t getUsed() const;
+
+  /**
+   * Can be called while other threads are allocating
+   *
+   * @return the statistics of each thread that has allocated, in the order
+   *         they first did. A thread's figures are only consistent with each
+   *         other once it has stopped allocating.
+   */
+  std::vector<thread_stats> getStats() const;
+
+  /**
+   * Writes out how full the heap is and each thread's statistics
+   *
+   * @param stream where to write
+   */
+  void dumpStats(std::ostream& stream) const;
+
+  /**
+   * @param size a size in bytes with an optional k, m or g suffix, e.g. 64m
+   * @return the size in bytes
+   * @throws runtime_error if size isn't a valid size
+   */
+  static std::size_t parseSize(const std::string& size);
+
+private:
+  /**
+   * A thread's TLAB and its statistics. Only the thread updates them, but
+   * others read the statistics, so they're atomic.
+   */
+  struct tlab
+  {
+    u1* top;
+    u1* end;
+    std::thread::id thread;
+    std::atomic<u8> objects;
+    std::atomic<u8> bytes;
+    std::atomic<u8> tlabs;
+    std::atomic<u8> outside;
+    std::atomic<u8> waste;
+  };
+
+  /** The TLAB a thread used last, and the heap it's from */
+  struct cached_tlab
+  {
+    u8 heap;
+    tlab* t;
+  };
+
+  u1* base;
+  std::size_t max_size;
+  std::size_t tlab_size;
+  /** The offset of the start of eden */
+  std::atomic<std::size_t> eden;
+  /** Identifies the heap to threads' caches, which may outlive it */
+  u8 id;
+  mutable std::mutex lock;
+  std::vector<std::unique_ptr<tlab>> tlabs;
+
+  /** @return the calling thread's TLAB */
+  tlab& current()
+  {
+    thread_local cached_tlab cached = {0, nullptr};
+    if (cached.heap != id)
+    {
+      cached.t = &attach();
+      cached.heap = id;
+    }
+    return *cached.t;
+  }
+
+  /**
+   * Adds to one of a TLAB's counters. Only the owning thread writes them, so
+   * this needs no read-modify-write, and costs no more than a plain add.
+   */
+  static void add(std::atomic<u8>& counter, u8 value)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  /** Finds or creates the calling thread's TLAB */
+  tlab& attach();
+
+  /** Allocates when the TLAB is too full */
+  void* allocateSlow(tlab& t, std::size_t size);
+
+  /** Takes bytes from eden, or returns null if it's exhausted */
+  u1* claim(std::size_t size);
+};
+
+}
+
+#endif /* SRC_MIMIC_HEAP_H_ */
@@ -0,0 +1,435 @@
+/**
+ * \file InstructionStream.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "InstructionStream.h"
+#include <algorithm>
+#include <cstring>
+#include "parsing/ParseFailureException.h"
+
+namespace mimic
+{
+
+namespace
+{
+typedef ConstantPool::cp_type_index cp_type_index;
+
+constexpr u4 bit(cp_type_index type)
+{
+  return u4(1) << type;
+}
+
+/** The entries ldc and ldc_w may load */
+constexpr u4 loadable = bit(ConstantPool::cp_integer) | bit(ConstantPool::cp_float) | bit(ConstantPool::cp_string)
+                        | bit(ConstantPool::cp_class) | bit(ConstantPool::cp_methodType)
+                        | bit(ConstantPool::cp_methodHandle);
+/** The entries ldc2_w may load */
+constexpr u4 wide_loadable = bit(ConstantPool::cp_long) | bit(ConstantPool::cp_double);
+
+/** Class files from this version on may not use jsr or ret */
+const u2 no_subroutines_version = 51;
+/** Class files from this version on may invoke interface methods with invokespecial and invokestatic */
+const u2 interface_methods_version = 52;
+
+/** Marks a pc at which no instruction starts */
+const u4 no_instruction = ~u4(0);
+
+u2 u2At(const u1* p)
+{
+  return static_cast<u2>((p[0] << 8) | p[1]);
+}
+
+s4 s4At(const u1* p)
+{
+  return static_cast<s4>((u4(p[0]) << 24) | (u4(p[1]) << 16) | (u4(p[2]) << 8) | p[3]);
+}
+
+[[noreturn]] void fail(const char* reason, u4 pc)
+{
+  std::stringstream ss;
+  ss << reason << " at pc " << pc;
+  throw parsing::parse_failure(ss.str());
+}
+
+/**
+ * @param code a method's code
+ * @param pc the start of an instruction
+ * @return the length of the instruction, which may run past the end of the code
+ */
+u8 instructionLength(const std::vector<u1>& code, u4 pc)
+{
+  u1 op = code[pc];
+  if (!Bytecode::isValid(op))
+    fail("Invalid opcode", pc);
+  u1 length = Bytecode::length(op);
+  if (length != 0)
+    return length;
+  if (op == Bytecode::op_wide)
+  {
+    if (pc + 1 >= code.size())
+      fail("Instruction runs past the end of the code", pc);
+    u1 modified = code[pc + 1];
+    if (modified == Bytecode::op_iinc)
+      return 6;
+    if ((modified >= Bytecode::op_iload && modified <= Bytecode::op_aload)
+        || (modified >= Bytecode::op_istore && modified <= Bytecode::op_astore) || modified == Bytecode::op_ret)
+      return 4;
+    fail("Invalid wide instruction", pc);
+  }
+  // The operands of the switches start after padding to a multiple of 4 bytes from the start of the code
+  u8 operands = (pc + 4) & ~u8(3);
+  u8 fixed = op == Bytecode::op_tableswitch ? 12 : 8;
+  if (operands + fixed > code.size())
+    fail("Instruction runs past the end of the code", pc);
+  if (op == Bytecode::op_tableswitch)
+  {
+    s4 low = s4At(&code[operands + 4]);
+    s4 high = s4At(&code[operands + 8]);
+    if (low > high)
+      fail("Invalid tableswitch bounds", pc);
+    return operands + fixed + 4 * (s8(high) - low + 1) - pc;
+  }
+  s4 npairs = s4At(&code[operands + 4]);
+  if (npairs < 0)
+    fail("Invalid lookupswitch pair count", pc);
+  return operands + fixed + 8 * u8(npairs) - pc;
+}
+
+u4 floatBits(float value)
+{
+  u4 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+u8 doubleBits(double value)
+{
+  u8 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+}
+
+u4 InstructionStream::lookup_switch::target(s4 key) const
+{
+  auto found = std::lower_bound(keys.begin(), keys.end(), key);
+  return found != keys.end() && *found == key ? targets[found - keys.begin()] : default_target;
+}
+
+InstructionStream::InstructionStream(const attributes::code& code, const ConstantPool& cp, u2 major_version)
+  : max_stack(code.max_stack), max_locals(code.max_locals), call_sites(0)
+{
+  const std::vector<u1>& bytes = code.code;
+  // Find where each instruction starts first, so that branches can be checked and translated
+  std::vector<u4> starts(bytes.size(), no_instruction);
+  for (u4 pc = 0; pc < bytes.size();)
+  {
+    u8 length = instructionLength(bytes, pc);
+    if (pc + length > bytes.size())
+      fail("Instruction runs past the end of the code", pc);
+    starts[pc] = static_cast<u4>(pcs.size());
+    pcs.push_back(static_cast<u2>(pc));
+    pc += static_cast<u4>(length);
+  }
+
+  instructions.reserve(pcs.size());
+  for (u2 pc : pcs)
+  {
+    const u1* at = &bytes[pc];
+    auto target = [&](s8 offset) {
+      s8 destination = pc + offset;
+      if (destination < 0 || destination >= s8(bytes.size()) || starts[destination] == no_instruction)
+        fail("Invalid branch target", pc);
+      return starts[destination];
+    };
+    auto reference = [&](u2 index, u4 allowed) {
+      if (index == 0 || index >= cp.size() || !(bit(cp.getType(index)) & allowed))
+        fail("Invalid constant pool reference", pc);
+      return index;
+    };
+    auto wideConstant = [&](u8 bits) {
+      wide_constants.push_back(bits);
+      return static_cast<u2>(wide_constants.size() - 1);
+    };
+
+    instruction insn = {at[0], 0, 0, 0};
+    switch (at[0])
+    {
+    case Bytecode::op_iconst_m1:
+    case Bytecode::op_iconst_0:
+    case Bytecode::op_iconst_1:
+    case Bytecode::op_iconst_2:
+    case Bytecode::op_iconst_3:
+    case Bytecode::op_iconst_4:
+    case Bytecode::op_iconst_5:
+      insn.op = Bytecode::op_push_int;
+      insn.value = at[0] - Bytecode::op_iconst_0;
+      break;
+    case Bytecode::op_lconst_0:
+    case Bytecode::op_lconst_1:
+      insn.op = Bytecode::op_push_long;
+      insn.index = wideConstant(u8(at[0] - Bytecode::op_lconst_0));
+      break;
+    case Bytecode::op_fconst_0:
+    case Bytecode::op_fconst_1:
+    case Bytecode::op_fconst_2:
+      insn.op = Bytecode::op_push_float;
+      insn.value = static_cast<s4>(floatBits(static_cast<float>(at[0] - Bytecode::op_fconst_0)));
+      break;
+    case Bytecode::op_dconst_0:
+    case Bytecode::op_dconst_1:
+      insn.op = Bytecode::op_push_double;
+      insn.index = wideConstant(doubleBits(at[0] - Bytecode::op_dconst_0));
+      break;
+    case Bytecode::op_bipush:
+      insn.op = Bytecode::op_push_int;
+      insn.value = static_cast<s1>(at[1]);
+      break;
+    case Bytecode::op_sipush:
+      insn.op = Bytecode::op_push_int;
+      insn.value = static_cast<s2>(u2At(at + 1));
+      break;
+    case Bytecode::op_ldc:
+    case Bytecode::op_ldc_w:
+    {
+      u2 index = reference(at[0] == Bytecode::op_ldc ? at[1] : u2At(at + 1), loadable);
+      switch (cp.getType(index))
+      {
+      case ConstantPool::cp_integer:
+        insn.op = Bytecode::op_push_int;
+        insn.value = static_cast<s4>(cp.get<const ConstantPool::Integer_info>(index).bytes);
+        break;
+      case ConstantPool::cp_float:
+        insn.op = Bytecode::op_push_float;
+        insn.value = static_cast<s4>(cp.get<const ConstantPool::Float_info>(index).bytes);
+        break;
+      default:
+        insn.op = Bytecode::op_ldc;
+        insn.index = index;
+        break;
+      }
+      break;
+    }
+    case Bytecode::op_ldc2_w:
+    {
+      u2 index = reference(u2At(at + 1), wide_loadable);
+      if (cp.getType(index) == ConstantPool::cp_long)
+      {
+        insn.op = Bytecode::op_push_long;
+        insn.index = wideConstant(cp.get<const ConstantPool::Long_info>(index).value);
+      }
+      else
+      {
+        insn.op = Bytecode::op_push_double;
+        insn.index = wideConstant(cp.get<const ConstantPool::Double_info>(index).bytes);
+      }
+      break;
+    }
+    case Bytecode::op_iload:
+    case Bytecode::op_lload:
+    case Bytecode::op_fload:
+    case Bytecode::op_dload:
+    case Bytecode::op_aload:
+    case Bytecode::op_istore:
+    case Bytecode::op_lstore:
+    case Bytecode::op_fstore:
+    case Bytecode::op_dstore:
+    case Bytecode::op_astore:
+      insn.index = at[1];
+      break;
+    case Bytecode::op_ret:
+      if (major_version >= no_subroutines_version)
+        fail("ret in a class file of version 51 or later", pc);
+      insn.index = at[1];
+      break;
+    case Bytecode::op_iinc:
+      insn.index = at[1];
+      insn.value = static_cast<s1>(at[2]);
+      break;
+    case Bytecode::op_wide:
+      insn.op = at[1];
+      insn.index = u2At(at + 2);
+      if (insn.op == Bytecode::op_iinc)
+        insn.value = static_cast<s2>(u2At(at + 4));
+      else if (insn.op == Bytecode::op_ret && major_version >= no_subroutines_version)
+        fail("ret in a class file of version 51 or later", pc);
+      break;
+    case Bytecode::op_ifeq:
+    case Bytecode::op_ifne:
+    case Bytecode::op_iflt:
+    case Bytecode::op_ifge:
+    case Bytecode::op_ifgt:
+    case Bytecode::op_ifle:
+    case Bytecode::op_if_icmpeq:
+    case Bytecode::op_if_icmpne:
+    case Bytecode::op_if_icmplt:
+    case Bytecode::op_if_icmpge:
+    case Bytecode::op_if_icmpgt:
+    case Bytecode::op_if_icmple:
+    case Bytecode::op_if_acmpeq:
+    case Bytecode::op_if_acmpne:
+    case Bytecode::op_goto:
+    case Bytecode::op_ifnull:
+    case Bytecode::op_ifnonnull:
+      insn.value = static_cast<s4>(target(static_cast<s2>(u2At(at + 1))));
+      break;
+    case Bytecode::op_goto_w:
+      insn.op = Bytecode::op_goto;
+      insn.value = static_cast<s4>(target(s4At(at + 1)));
+      break;
+    case Bytecode::op_jsr:
+    case Bytecode::op_jsr_w:
+      if (major_version >= no_subroutines_version)
+        fail("jsr in a class file of version 51 or later", pc);
+      insn.op = Bytecode::op_jsr;
+      insn.value = static_cast<s4>(target(at[0] == Bytecode::op_jsr ? static_cast<s2>(u2At(at + 1))
+                                                                    : s4At(at + 1)));
+      break;
+    case Bytecode::op_tableswitch:
+    {
+      const u1* operands = &bytes[(pc + 4) & ~3u];
+      table_switch table;
+      table.default_target = target(s4At(operands));
+      table.low = s4At(operands + 4);
+      table.high = s4At(operands + 8);
+      table.targets.reserve(s8(table.high) - table.low + 1);
+      for (s8 key = table.low; key <= table.high; key++)
+        table.targets.push_back(target(s4At(operands + 12 + 4 * (key - table.low))));
+      insn.index = static_cast<u2>(table_switches.size());
+      table_switches.push_back(std::move(table));
+      break;
+    }
+    case Bytecode::op_lookupswitch:
+    {
+      const u1* operands = &bytes[(pc + 4) & ~3u];
+      lookup_switch table;
+      table.default_target = target(s4At(operands));
+      s4 npairs = s4At(operands + 4);
+      table.keys.reserve(npairs);
+      table.targets.reserve(npairs);
+      for (s4 i = 0; i < npairs; i++)
+      {
+        s4 key = s4At(operands + 8 + 8 * i);
+        if (i > 0 && key <= table.keys.back())
+          fail("lookupswitch keys are not in increasing order", pc);
+        table.keys.push_back(key);
+        table.targets.push_back(target(s4At(operands + 12 + 8 * i)));
+      }
+      insn.index = static_cast<u2>(lookup_switches.size());
+      lookup_switches.push_back(std::move(table));
+      break;
+    }
+    case Bytecode::op_getstatic:
+    case Bytecode::op_putstatic:
+    case Bytecode::op_getfield:
+    case Bytecode::op_putfield:
+      insn.index = reference(u2At(at + 1), bit(ConstantPool::cp_fieldref));
+      break;
+    case Bytecode::op_invokevirtual:
+      insn.index = reference(u2At(at + 1), bit(ConstantPool::cp_methodref));
+      insn.value = static_cast<s4>(call_sites++);
+      break;
+    case Bytecode::op_invokespecial:
+    case Bytecode::op_invokestatic:
+      insn.index = reference(u2At(at + 1), major_version >= interface_methods_version
+                                             ? bit(ConstantPool::cp_methodref)
+                                                 | bit(ConstantPool::cp_interfaceMethodref)
+                                             : bit(ConstantPool::cp_methodref));
+      break;
+    case Bytecode::op_invokeinterface:
+      insn.index = reference(u2At(at + 1), bit(ConstantPool::cp_interfaceMethodref));
+      insn.small = at[3];
+      if (at[3] == 0 || at[4] != 0)
+        fail("Invalid invokeinterface operands", pc);
+      insn.value = static_cast<s4>(call_sites++);
+      break;
+    case Bytecode::op_invokedynamic:
+      insn.index = reference(u2At(at + 1), bit(ConstantPool::cp_invokeDynamic));
+      if (at[3] != 0 || at[4] != 0)
+        fail("Invalid invokedynamic operands", pc);
+      break;
+    case Bytecode::op_new:
+    case Bytecode::op_anewarray:
+    case Bytecode::op_checkcast:
+    case Bytecode::op_instanceof:
+      insn.index = reference(u2At(at + 1), bit(ConstantPool::cp_class));
+      break;
+    case Bytecode::op_multianewarray:
+      insn.index = reference(u2At(at + 1), bit(ConstantPool::cp_class));
+      insn.small = at[3];
+      if (at[3] == 0)
+        fail("multianewarray of no dimensions", pc);
+      break;
+    case Bytecode::op_newarray:
+      // T_BOOLEAN to T_LONG
+      if (at[1] < 4 || at[1] > 11)
+        fail("Invalid newarray type", pc);
+      insn.small = at[1];
+      break;
+    default:
+      if (at[0] >= Bytecode::op_iload_0 && at[0] <= Bytecode::op_aload_3)
+      {
+        insn.op = static_cast<u1>(Bytecode::op_iload + (at[0] - Bytecode::op_iload_0) / 4);
+        insn.index = (at[0] - Bytecode::op_iload_0) % 4;
+      }
+      else if (at[0] >= Bytecode::op_istore_0 && at[0] <= Bytecode::op_astore_3)
+      {
+        insn.op = static_cast<u1>(Bytecode::op_istore + (at[0] - Bytecode::op_istore_0) / 4);
+        insn.index = (at[0] - Bytecode::op_istore_0) % 4;
+      }
+      break;
+    }
+    instructions.push_back(insn);
+  }
+
+  for (auto& entry : code.exception_table)
+  {
+    u4 start = entry.start_pc < bytes.size() ? starts[entry.start_pc] : no_instruction;
+    u4 end = entry.end_pc == bytes.size() ? static_cast<u4>(instructions.size())
+             : entry.end_pc < bytes.size() ? starts[entry.end_pc] : no_instruction;
+    u4 handler = entry.handler_pc < bytes.size() ? starts[entry.handler_pc] : no_instruction;
+    if (start == no_instruction || end == no_instruction || handler == no_instruction || start >= end)
+      fail("Invalid exception table entry", entry.start_pc);
+    if (entry.catch_type != 0 && (entry.catch_type >= cp.size() || cp.getType(entry.catch_type) != ConstantPool::cp_class))
+      fail("Invalid exception handler catch type", entry.handler_pc);
+    handlers.push_back(exception_handler{start, end, handler, entry.catch_type});
+  }
+
+  for (auto& attribute : code.attrs)
+  {
+    auto table = getIf<attributes::line_number_table>(attribute);
+    if (!table)
+      continue;
+    for (auto& line : table->table)
+    {
+      if (line.start_pc >= bytes.size())
+        fail("Invalid line number table entry", line.start_pc);
+      lines.push_back(line);
+    }
+  }
+  std::stable_sort(lines.begin(), lines.end(),
+                   [](const attributes::line_number_info& a, const attributes::line_number_info& b) {
+                     return a.start_pc < b.start_pc;
+                   });
+}
+
+u4 InstructionStream::indexAt(u2 pc) const
+{
+  auto found = std::lower_bound(pcs.begin(), pcs.end(), pc);
+  return found != pcs.end() && *found == pc ? static_cast<u4>(found - pcs.begin()) : static_cast<u4>(size());
+}
+
+u2 InstructionStream::lineOf(u4 index) const
+{
+  u2 pc = pcs[index];
+  auto after = std::upper_bound(lines.begin(), lines.end(), pc,
+                                [](u2 value, const attributes::line_number_info& line) {
+                                  return value < line.start_pc;
+                                });
+  return after == lines.begin() ? 0 : (after - 1)->line_number;
+}
+
+}
@@ -0,0 +1,167 @@
+/**
+ * \file InstructionStream.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_INSTRUCTIONSTREAM_H_
+#define SRC_MIMIC_INSTRUCTIONSTREAM_H_
+
+#include "Common.h"
+#include "Bytecode.h"
+#include "ConstantPool.h"
+#include "method_attributes.h"
+
+namespace mimic
+{
+
+/**
+ * A method's code, decoded once when its class is loaded into fixed-size
+ * instructions with their operands in native byte order, so that running it
+ * doesn't have to decode anything
+ *
+ * Instructions are addressed by their index in the stream rather than by pc,
+ * and branch targets are instruction indices. Several bytecodes are folded
+ * into one operation:
+ *
+ *  - xload_<n> and xstore_<n> become xload and xstore with index n, and the
+ *    wide forms of the local variable instructions become the normal ones
+ *  - iconst_<i>, bipush, sipush and ldc of an Integer become op_push_int, and
+ *    fconst_<f> and ldc of a Float become op_push_float, with the value in
+ *    value (as its bits, for a float)
+ *  - lconst_<l>, dconst_<d> and ldc2_w become op_push_long and op_push_double,
+ *    with the value in the stream's wide constants
+ *  - ldc_w becomes ldc, goto_w becomes goto and jsr_w becomes jsr
+ *  - tableswitch and lookupswitch refer to jump tables built up front
+ *
+ * Each invokevirtual and invokeinterface is given a call site number, from 0
+ * in the order they appear, so that the interpreter can keep an inline cache
+ * for each.
+ *
+ * Decoding also checks the static constraints on the code that it can check
+ * without type information: every opcode is valid, every branch lands on an
+ * instruction, and every constant pool reference is to the right kind of entry.
+ *
+ * https://docs.oracle.com/javase/specs/jvms/se8/html/jvms-4.html#jvms-4.9.1
+ */
+class InstructionStream
+{
+public:
+  /** A decoded instruction */
+  struct instruction
+  {
+    /** The operation, a Bytecode::opcode after folding */
+    u1 op;
+    /** newarray's atype, multianewarray's dimensions or invokeinterface's count */
+    u1 small;
+    /**
+     * A local variable index, a constant pool index, or the index of a jump
+     * table or wide constant
+     */
+    u2 index;
+    /**
+     * An int constant or float's bits, iinc's increment, a branch target, or
+     * an invokevirtual or invokeinterface's call site number
+     */
+    s4 value;
+  };
+
+  /** A tableswitch's jump table */
+  struct table_switch
+  {
+    s4 low;
+    s4 high;
+    u4 default_target;
+    /** The target for each key from low to high */
+    std::vector<u4> targets;
+
+    u4 target(s4 key) const
+    {
+      return key < low || key > high ? default_target : targets[static_cast<u4>(key - low)];
+    }
+  };
+
+  /** A lookupswitch's jump table */
+  struct lookup_switch
+  {
+    u4 default_target;
+    /** The keys in increasing order, searched by binary search */
+    std::vector<s4> keys;
+    /** The target for each key */
+    std::vector<u4> targets;
+
+    u4 target(s4 key) const;
+  };
+
+  /** An entry of the exception table, with instruction indices in place of pcs */
+  struct exception_handler
+  {
+    u4 start;
+    /** Exclusive. May be the number of instructions. */
+    u4 end;
+    u4 handler;
+    u2 catch_type;
+  };
+
+  /**
+   * Decodes a method's code
+   *
+   * @param code the method's Code attribute
+   * @param cp the constant pool of the method's class
+   * @param major_version the class' major version number
+   * @throws parse_failure if the code breaks one of the constraints checked
+   */
+  InstructionStream(const attributes::code& code, const ConstantPool& cp, u2 major_version);
+
+  std::size_t size() const { return instructions.size(); };
+  const instruction& operator[](std::size_t index) const { return instructions[index]; };
+  const std::vector<instruction>& getInstructions() const { return instructions; };
+  u2 getMaxStack() const { return max_stack; };
+  u2 getMaxLocals() const { return max_locals; };
+  const table_switch& getTableSwitch(u2 index) const { return table_switches[index]; };
+  const lookup_switch& getLookupSwitch(u2 index) const { return lookup_switches[index]; };
+  /** @return the bits of a long or double constant */
+  u8 getWideConstant(u2 index) const { return wide_constants[index]; };
+  const std::vector<exception_handler>& getExceptionHandlers() const { return handlers; };
+  /** @return the number of invokevirtual and invokeinterface instructions */
+  u4 getCallSiteCount() const { return call_sites; };
+
+  /**
+   * @param index the index of an instruction
+   * @return the pc of the bytecode the instruction was decoded from
+   */
+  u2 pcOf(u4 index) const { return pcs[index]; };
+
+  /**
+   * @param pc the pc of a bytecode
+   * @return the index of the instruction decoded from it, or size() if no
+   *         instruction starts at pc
+   */
+  u4 indexAt(u2 pc) const;
+
+  /**
+   * @param index the index of an instruction
+   * @return the source line of the instruction, from the code's
+   *         LineNumberTable attributes, or 0 if it isn't known
+   */
+  u2 lineOf(u4 index) const;
+
+private:
+  u2 max_stack;
+  u2 max_locals;
+  std::vector<instruction> instructions;
+  /** The pc of each instruction */
+  std::vector<u2> pcs;
+  std::vector<table_switch> table_switches;
+  std::vector<lookup_switch> lookup_switches;
+  std::vector<u8> wide_constants;
+  std::vector<exception_handler> handlers;
+  u4 call_sites;
+  /** Line number entries, by increasing start_pc */
+  std::vector<attributes::line_number_info> lines;
+};
+
+}
+
+#endif /* SRC_MIMIC_INSTRUCTIONSTREAM_H_ */
@@ -0,0 +1,1225 @@
+/**
+ * \file Interpreter.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "Interpreter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <pthread.h>
+#include "VirtualMachine.h"
+
+namespace mimic
+{
+
+namespace
+{
+const Symbol& clinitName()
+{
+  static const Symbol name = Symbol::intern(JUtf8String("<clinit>"));
+  return name;
+}
+
+const Symbol& initName()
+{
+  static const Symbol name = Symbol::intern(JUtf8String("<init>"));
+  return name;
+}
+
+const Symbol& voidDescriptor()
+{
+  static const Symbol descriptor = Symbol::intern(JUtf8String("()V"));
+  return descriptor;
+}
+
+std::string nameOf(const RuntimeClass::method& method)
+{
+  return method.owner->getName().str() + "." + method.name.str() + method.descriptor.str();
+}
+
+std::string javaName(const RuntimeClass* clazz)
+{
+  std::string name = clazz->getName().str();
+  std::replace(name.begin(), name.end(), '/', '.');
+  return name;
+}
+
+/*
+ * Finds the lowest address the running thread's native stack may grow down to
+ * while leaving reserve bytes free. Where the thread's stack bounds can't be
+ * asked for, allows a budget small enough for any thread's stack.
+ */
+const char* nativeStackLimit(const char* here, std::size_t reserve)
+{
+#if defined(__linux__)
+  pthread_attr_t attributes;
+  if (pthread_getattr_np(pthread_self(), &attributes) == 0)
+  {
+    void* base;
+    std::size_t size;
+    int status = pthread_attr_getstack(&attributes, &base, &size);
+    pthread_attr_destroy(&attributes);
+    const char* lowest = static_cast<const char*>(base);
+    if (status == 0 && here > lowest && static_cast<std::size_t>(here - lowest) > reserve)
+      return lowest + reserve;
+  }
+#endif
+  const std::size_t budget = 512 * 1024;
+  return here - std::min<std::uintptr_t>(budget, reinterpret_cast<std::uintptr_t>(here));
+}
+
+/*
+ * Java's integer arithmetic wraps around, which signed arithmetic in C++
+ * isn't allowed to, so it's done unsigned
+ */
+template <typename T> T add(T a, T b)
+{
+  typedef typename std::make_unsigned<T>::type U;
+  return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+}
+
+template <typename T> T subtract(T a, T b)
+{
+  typedef typename std::make_unsigned<T>::type U;
+  return static_cast<T>(static_cast<U>(a) - static_cast<U>(b));
+}
+
+template <typename T> T multiply(T a, T b)
+{
+  typedef typename std::make_unsigned<T>::type U;
+  return static_cast<T>(static_cast<U>(a) * static_cast<U>(b));
+}
+
+template <typename T> T negate(T a)
+{
+  typedef typename std::make_unsigned<T>::type U;
+  return static_cast<T>(U(0) - static_cast<U>(a));
+}
+
+template <typename T> T shiftLeft(T a, s4 b)
+{
+  typedef typename std::make_unsigned<T>::type U;
+  return static_cast<T>(static_cast<U>(a) << (b & (sizeof(T) * 8 - 1)));
+}
+
+template <typename T> T shiftRight(T a, s4 b)
+{
+  return a >> (b & (sizeof(T) * 8 - 1));
+}
+
+template <typename T> T unsignedShiftRight(T a, s4 b)
+{
+  typedef typename std::make_unsigned<T>::type U;
+  return static_cast<T>(static_cast<U>(a) >> (b & (sizeof(T) * 8 - 1)));
+}
+
+/** Converts as f2i, f2l, d2i and d2l do: NaN is 0, and out of range values saturate */
+template <typename T, typename F> T toIntegral(F value)
+{
+  if (value != value)
+    return 0;
+  if (value >= static_cast<F>(std::numeric_limits<T>::max()))
+    return std::numeric_limits<T>::max();
+  if (value <= static_cast<F>(std::numeric_limits<T>::min()))
+    return std::numeric_limits<T>::min();
+  return static_cast<T>(value);
+}
+
+/**
+ * Compares as fcmpl, fcmpg, dcmpl and dcmpg do
+ *
+ * @param unordered the result if either value is NaN
+ */
+template <typename F> s4 compare(F a, F b, s4 unordered)
+{
+  return a > b ? 1 : a == b ? 0 : a < b ? -1 : unordered;
+}
+
+/**
+ * Reads a field onto the operand stack
+ *
+ * @return the number of slots the value takes
+ */
+u1 loadField(char type, const u1* p, slot* to)
+{
+  switch (type)
+  {
+  case 'Z':
+  case 'B':
+    to->i = *reinterpret_cast<const s1*>(p);
+    return 1;
+  case 'C':
+    to->i = *reinterpret_cast<const u2*>(p);
+    return 1;
+  case 'S':
+    to->i = *reinterpret_cast<const s2*>(p);
+    return 1;
+  case 'I':
+    to->i = *reinterpret_cast<const s4*>(p);
+    return 1;
+  case 'F':
+    to->f = *reinterpret_cast<const float*>(p);
+    return 1;
+  case 'J':
+    to->j = *reinterpret_cast<const s8*>(p);
+    return 2;
+  case 'D':
+    to->d = *reinterpret_cast<const double*>(p);
+    return 2;
+  default:
+    to->a = *reinterpret_cast<Object* const*>(p);
+    return 1;
+  }
+}
+
+/**
+ * Writes a value from the operand stack to a field
+ */
+void storeField(char type, u1* p, const slot* from)
+{
+  switch (type)
+  {
+  case 'Z':
+    *reinterpret_cast<s1*>(p) = static_cast<s1>(from->i & 1);
+    break;
+  case 'B':
+    *reinterpret_cast<s1*>(p) = static_cast<s1>(from->i);
+    break;
+  case 'C':
+    *reinterpret_cast<u2*>(p) = static_cast<u2>(from->i);
+    break;
+  case 'S':
+    *reinterpret_cast<s2*>(p) = static_cast<s2>(from->i);
+    break;
+  case 'I':
+    *reinterpret_cast<s4*>(p) = from->i;
+    break;
+  case 'F':
+    *reinterpret_cast<float*>(p) = from->f;
+    break;
+  case 'J':
+    *reinterpret_cast<s8*>(p) = from->j;
+    break;
+  case 'D':
+    *reinterpret_cast<double*>(p) = from->d;
+    break;
+  default:
+    *reinterpret_cast<Object**>(p) = from->a;
+    break;
+  }
+}
+
+u1 slotsOf(char type)
+{
+  return type == 'J' || type == 'D' ? 2 : 1;
+}
+
+/**
+ * @return array, after checking that index is within it
+ */
+Array* checkIndex(VirtualMachine& vm, Object* array, s4 index)
+{
+  if (!array)
+    vm.raise("java/lang/NullPointerException");
+  auto a = static_cast<Array*>(array);
+  if (static_cast<u4>(index) >= static_cast<u4>(a->length))
+    vm.raise("java/lang/ArrayIndexOutOfBoundsException",
+             "Index " + std::to_string(index) + " out of bounds for length " + std::to_string(a->length));
+  return a;
+}
+
+Object* checkNull(VirtualMachine& vm, Object* object)
+{
+  if (!object)
+    vm.raise("java/lang/NullPointerException");
+  return object;
+}
+}
+
+Interpreter::Interpreter(VirtualMachine& vm, dispatch mode, std::size_t stack_slots)
+  : vm(vm), mode(mode), stack(new slot[stack_slots]), stack_end(stack.get() + stack_slots), depth(0),
+    native_limit(nullptr),
+    primitive_arrays()
+{
+  static const char* const names[] = {"[Z", "[C", "[F", "[D", "[B", "[S", "[I", "[J"};
+  for (u1 type = 4; type < 12; type++)
+    primitive_arrays[type] = vm.findClass(names[type - 4]);
+}
+
+bool Interpreter::hasThreadedDispatch()
+{
+#ifdef MIMIC_COMPUTED_GOTO
+  return true;
+#else
+  return false;
+#endif
+}
+
+slot Interpreter::call(const RuntimeClass::method& method, const std::vector<slot>& args)
+{
+  if (args.size() != method.argument_slots)
+    throw std::invalid_argument(nameOf(method) + " takes " + std::to_string(method.argument_slots)
+                                + " argument slots");
+  if (method.isStatic())
+    initialise(method.owner, stack.get());
+  std::copy(args.begin(), args.end(), stack.get());
+  invoke(method, stack.get());
+  return stack[0];
+}
+
+void Interpreter::invoke(const RuntimeClass::method& method, slot* args)
+{
+  char here;
+  if (depth == 0)
+    native_limit = nativeStackLimit(&here, native_stack_reserve);
+  if (depth >= max_depth || &here < native_limit)
+    vm.raise("java/lang/StackOverflowError");
+  struct frame
+  {
+    u4& depth;
+    explicit frame(u4& depth) : depth(depth) { depth++; }
+    ~frame() { depth--; }
+  } counted(depth);
+
+  if (method.native)
+  {
+    method.native(*this, args);
+    return;
+  }
+  if (!method.code)
+  {
+    throw std::runtime_error((method.isAbstract() ? "AbstractMethodError: " : "UnsatisfiedLinkError: ")
+                             + nameOf(method));
+  }
+#ifdef MIMIC_COMPUTED_GOTO
+  if (mode == dispatch_threaded)
+  {
+    execute<true>(method, args);
+    return;
+  }
+#endif
+  execute<false>(method, args);
+}
+
+void Interpreter::initialise(RuntimeClass* clazz, slot* free)
+{
+  switch (clazz->getState())
+  {
+  case RuntimeClass::initialised:
+  case RuntimeClass::initialising:
+    // A class being initialised may use itself
+    return;
+  case RuntimeClass::erroneous:
+    vm.raise("java/lang/NoClassDefFoundError", "Could not initialize class " + javaName(clazz));
+  case RuntimeClass::linked:
+    break;
+  }
+  clazz->setState(RuntimeClass::initialising);
+  try
+  {
+    if (clazz->getSuperClass())
+      initialise(clazz->getSuperClass(), free);
+    auto clinit = clazz->findDeclaredMethod(clinitName(), voidDescriptor());
+    if (clinit)
+      invoke(*clinit, free);
+  }
+  catch (...)
+  {
+    clazz->setState(RuntimeClass::erroneous);
+    throw;
+  }
+  clazz->setState(RuntimeClass::initialised);
+}
+
+RuntimeClass* Interpreter::resolveClass(RuntimeClass* current, u2 index)
+{
+  ResolvedReferences& references = current->getResolvedReferences();
+  if (RuntimeClass* resolved = references.get<RuntimeClass>(index))
+    return resolved;
+  auto& cp = current->getConstantPool();
+  RuntimeClass* clazz = vm.findClass(cp.getSymbol(cp.get<const ConstantPool::Class_info>(index).name_index));
+  references.set(index, clazz);
+  return clazz;
+}
+
+RuntimeClass* Interpreter::resolveArrayClass(RuntimeClass* current, u2 index)
+{
+  ResolvedReferences& references = current->getResolvedReferences();
+  if (RuntimeClass* resolved = references.getSecond<RuntimeClass>(index))
+    return resolved;
+  RuntimeClass* component = resolveClass(current, index);
+  std::string name = component->isArray() ? "[" + component->getName().str()
+                                          : "[L" + component->getName().str() + ";";
+  RuntimeClass* clazz = vm.findClass(name);
+  references.setSecond(index, clazz);
+  return clazz;
+}
+
+namespace
+{
+/**
+ * @return the class_index and name_and_type_index of a Fieldref, Methodref
+ *         or InterfaceMethodref
+ */
+std::pair<u2, u2> memberRef(const ConstantPool& cp, u2 index)
+{
+  switch (cp.getType(index))
+  {
+  case ConstantPool::cp_fieldref:
+  {
+    auto ref = cp.get<const ConstantPool::Fieldref_info>(index);
+    return std::make_pair(ref.class_index, ref.name_and_type_index);
+  }
+  case ConstantPool::cp_methodref:
+  {
+    auto ref = cp.get<const ConstantPool::Methodref_info>(index);
+    return std::make_pair(ref.class_index, ref.name_and_type_index);
+  }
+  default:
+  {
+    auto ref = cp.get<const ConstantPool::InterfaceMethodref_info>(index);
+    return std::make_pair(ref.class_index, ref.name_and_type_index);
+  }
+  }
+}
+}
+
+const RuntimeClass::method& Interpreter::resolveMethod(RuntimeClass* current, u2 index)
+{
+  ResolvedReferences& references = current->getResolvedReferences();
+  if (auto resolved = references.get<const RuntimeClass::method>(index))
+    return *resolved;
+  auto& cp = current->getConstantPool();
+  auto ref = memberRef(cp, index);
+  RuntimeClass* referenced = resolveClass(current, ref.first);
+  auto name_and_type = cp.get<const ConstantPool::NameAndType_info>(ref.second);
+  Symbol name = cp.getSymbol(name_and_type.name_index);
+  Symbol descriptor = cp.getSymbol(name_and_type.descriptor_index);
+  auto found = referenced->findMethod(name, descriptor);
+  if (!found)
+    throw std::runtime_error("NoSuchMethodError: " + referenced->getName().str() + "." + name.str()
+                             + descriptor.str());
+  references.set(index, found);
+  return *found;
+}
+
+const RuntimeClass::method& Interpreter::resolveSpecial(RuntimeClass* current, u2 index)
+{
+  ResolvedReferences& references = current->getResolvedReferences();
+  if (auto selected = references.getSecond<const RuntimeClass::method>(index))
+    return *selected;
+  const RuntimeClass::method* selected = &resolveMethod(current, index);
+  if (selected->isStatic())
+    throw std::runtime_error("IncompatibleClassChangeError: " + nameOf(*selected) + " is static");
+  // A call to a superclass' method from a subclass calls the closest override above the caller
+  RuntimeClass* referenced = resolveClass(current, memberRef(current->getConstantPool(), index).first);
+  if (selected->name != initName() && (current->getAccessFlags() & ClassFile::acc_super)
+      && !referenced->isInterface() && referenced != current && current->isSubclassOf(referenced))
+  {
+    selected = current->getSuperClass()->findMethod(selected->name, selected->descriptor);
+    if (!selected || selected->isAbstract())
+      throw std::runtime_error("AbstractMethodError: invokespecial in " + current->getName().str());
+  }
+  references.setSecond(index, selected);
+  return *selected;
+}
+
+const RuntimeClass::field& Interpreter::resolveField(RuntimeClass* current, u2 index)
+{
+  ResolvedReferences& references = current->getResolvedReferences();
+  if (auto resolved = references.get<const RuntimeClass::field>(index))
+    return *resolved;
+  auto& cp = current->getConstantPool();
+  auto ref = memberRef(cp, index);
+  RuntimeClass* referenced = resolveClass(current, ref.first);
+  auto name_and_type = cp.get<const ConstantPool::NameAndType_info>(ref.second);
+  Symbol name = cp.getSymbol(name_and_type.name_index);
+  Symbol descriptor = cp.getSymbol(name_and_type.descriptor_index);
+  auto found = referenced->findField(name, descriptor);
+  if (!found)
+    throw std::runtime_error("NoSuchFieldError: " + referenced->getName().str() + "." + name.str());
+  references.set(index, found);
+  return *found;
+}
+
+Object* Interpreter::resolveString(RuntimeClass* current, u2 index)
+{
+  ResolvedReferences& references = current->getResolvedReferences();
+  if (Object* resolved = references.get<Object>(index))
+    return resolved;
+  auto& cp = current->getConstantPool();
+  if (cp.getType(index) != ConstantPool::cp_string)
+    throw std::runtime_error("ldc of a Class, MethodType or MethodHandle isn't supported, in "
+                             + current->getName().str());
+  Object* string = vm.intern(cp.getSymbol(cp.get<const ConstantPool::String_info>(index).string_index));
+  references.set(index, string);
+  return string;
+}
+
+const RuntimeClass::method& Interpreter::select(const RuntimeClass::method& resolved, Object* receiver,
+                                                RuntimeClass::call_site& site)
+{
+  if (resolved.isStatic())
+    throw std::runtime_error("IncompatibleClassChangeError: " + nameOf(resolved) + " is static");
+  RuntimeClass* clazz = receiver->clazz;
+  const RuntimeClass::method* selected;
+  if (resolved.table_index == RuntimeClass::no_table_index)
+  {
+    // Private methods aren't overridden
+    selected = &resolved;
+  }
+  else if (resolved.owner->isInterface())
+  {
+    auto itable = clazz->getItable(resolved.owner);
+    if (!itable)
+      throw std::runtime_error("IncompatibleClassChangeError: " + clazz->getName().str()
+                               + " doesn't implement " + resolved.owner->getName().str());
+    selected = (*itable)[resolved.table_index];
+  }
+  else
+  {
+    selected = clazz->getVirtual(resolved.table_index);
+  }
+  if (!selected || selected->isAbstract())
+    throw std::runtime_error("AbstractMethodError: " + clazz->getName().str() + "." + resolved.name.str()
+                             + resolved.descriptor.str());
+  site.add(clazz, selected);
+  return *selected;
+}
+
+Array* Interpreter::allocateArrays(RuntimeClass* clazz, const slot* counts, u1 dimensions)
+{
+  Array* array = vm.allocateArray(clazz, counts[0].i);
+  if (dimensions > 1)
+  {
+    for (s4 i = 0; i < array->length; i++)
+      array->elements<Object*>()[i] = allocateArrays(clazz->getComponent(), counts + 1, dimensions - 1);
+  }
+  return array;
+}
+
+/*
+ * Each instruction's handler is labelled both as a case of the switch and
+ * with a label whose address goes in the table for threaded dispatch, so the
+ * same handlers serve both. Handlers leave ip at the next instruction to run
+ * and dispatch it.
+ */
+#ifdef MIMIC_COMPUTED_GOTO
+#define OP(name) case Bytecode::op_##name: L_##name:
+#define DISPATCH() do { if (threaded) goto *labels[ip->op]; goto dispatch; } while (0)
+#else
+#define OP(name) case Bytecode::op_##name:
+#define DISPATCH() goto dispatch
+#endif
+#define NEXT() do { ip++; DISPATCH(); } while (0)
+#define JUMP(target) do { ip = first + (target); DISPATCH(); } while (0)
+
+#define BINARY(name, field, expression) \
+  OP(name) { auto b = sp[-1].field; auto a = sp[-2].field; sp--; sp[-1].field = (expression); NEXT(); }
+#define BINARY_WIDE(name, field, expression) \
+  OP(name) { auto b = sp[-2].field; auto a = sp[-4].field; sp -= 2; sp[-2].field = (expression); NEXT(); }
+#define SHIFT_WIDE(name, expression) \
+  OP(name) { s4 b = sp[-1].i; s8 a = sp[-3].j; sp--; sp[-2].j = (expression); NEXT(); }
+#define BRANCH(name, condition) \
+  OP(name) { s4 a = sp[-1].i; sp--; if (condition) JUMP(ip->value); NEXT(); }
+#define COMPARE(name, field, condition) \
+  OP(name) { auto b = sp[-1].field; auto a = sp[-2].field; sp -= 2; if (condition) JUMP(ip->value); NEXT(); }
+#define ARRAY_LOAD(name, type, field) \
+  OP(name) { Array* array = checkIndex(vm, sp[-2].a, sp[-1].i); sp[-2].field = array->elements<type>()[sp[-1].i]; sp--; NEXT(); }
+#define ARRAY_LOAD_WIDE(name, type, field) \
+  OP(name) { Array* array = checkIndex(vm, sp[-2].a, sp[-1].i); sp[-2].field = array->elements<type>()[sp[-1].i]; NEXT(); }
+#define ARRAY_STORE(name, type, field) \
+  OP(name) { Array* array = checkIndex(vm, sp[-3].a, sp[-2].i); array->elements<type>()[sp[-2].i] = static_cast<type>(sp[-1].field); sp -= 3; NEXT(); }
+#define ARRAY_STORE_WIDE(name, type, field) \
+  OP(name) { Array* array = checkIndex(vm, sp[-4].a, sp[-3].i); array->elements<type>()[sp[-3].i] = sp[-2].field; sp -= 4; NEXT(); }
+
+template <bool threaded> void Interpreter::execute(const RuntimeClass::method& method, slot* locals)
+{
+  const InstructionStream& code = *method.code;
+  const InstructionStream::instruction* const first = code.getInstructions().data();
+  RuntimeClass* const current = method.owner;
+  slot* const stack_base = locals + code.getMaxLocals();
+  if (stack_base + code.getMaxStack() > stack_end)
+    vm.raise("java/lang/StackOverflowError");
+  const InstructionStream::instruction* ip = first;
+  slot* sp = stack_base;
+#ifdef MIMIC_COMPUTED_GOTO
+  static const void* const labels[256] = {
+    &&L_nop, &&L_aconst_null, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_ldc, &&L_invalid,
+    &&L_invalid, &&L_iload, &&L_lload, &&L_fload,
+    &&L_dload, &&L_aload, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_iaload, &&L_laload,
+    &&L_faload, &&L_daload, &&L_aaload, &&L_baload,
+    &&L_caload, &&L_saload, &&L_istore, &&L_lstore,
+    &&L_fstore, &&L_dstore, &&L_astore, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_iastore,
+    &&L_lastore, &&L_fastore, &&L_dastore, &&L_aastore,
+    &&L_bastore, &&L_castore, &&L_sastore, &&L_pop,
+    &&L_pop2, &&L_dup, &&L_dup_x1, &&L_dup_x2,
+    &&L_dup2, &&L_dup2_x1, &&L_dup2_x2, &&L_swap,
+    &&L_iadd, &&L_ladd, &&L_fadd, &&L_dadd,
+    &&L_isub, &&L_lsub, &&L_fsub, &&L_dsub,
+    &&L_imul, &&L_lmul, &&L_fmul, &&L_dmul,
+    &&L_idiv, &&L_ldiv, &&L_fdiv, &&L_ddiv,
+    &&L_irem, &&L_lrem, &&L_frem, &&L_drem,
+    &&L_ineg, &&L_lneg, &&L_fneg, &&L_dneg,
+    &&L_ishl, &&L_lshl, &&L_ishr, &&L_lshr,
+    &&L_iushr, &&L_lushr, &&L_iand, &&L_land,
+    &&L_ior, &&L_lor, &&L_ixor, &&L_lxor,
+    &&L_iinc, &&L_i2l, &&L_i2f, &&L_i2d,
+    &&L_l2i, &&L_l2f, &&L_l2d, &&L_f2i,
+    &&L_f2l, &&L_f2d, &&L_d2i, &&L_d2l,
+    &&L_d2f, &&L_i2b, &&L_i2c, &&L_i2s,
+    &&L_lcmp, &&L_fcmpl, &&L_fcmpg, &&L_dcmpl,
+    &&L_dcmpg, &&L_ifeq, &&L_ifne, &&L_iflt,
+    &&L_ifge, &&L_ifgt, &&L_ifle, &&L_if_icmpeq,
+    &&L_if_icmpne, &&L_if_icmplt, &&L_if_icmpge, &&L_if_icmpgt,
+    &&L_if_icmple, &&L_if_acmpeq, &&L_if_acmpne, &&L_goto,
+    &&L_jsr, &&L_ret, &&L_tableswitch, &&L_lookupswitch,
+    &&L_ireturn, &&L_lreturn, &&L_freturn, &&L_dreturn,
+    &&L_areturn, &&L_return, &&L_getstatic, &&L_putstatic,
+    &&L_getfield, &&L_putfield, &&L_invokevirtual, &&L_invokespecial,
+    &&L_invokestatic, &&L_invokeinterface, &&L_invokedynamic, &&L_new,
+    &&L_newarray, &&L_anewarray, &&L_arraylength, &&L_athrow,
+    &&L_checkcast, &&L_instanceof, &&L_monitorenter, &&L_monitorexit,
+    &&L_invalid, &&L_multianewarray, &&L_ifnull, &&L_ifnonnull,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_push_int,
+    &&L_push_float, &&L_push_long, &&L_push_double, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid,
+    &&L_invalid, &&L_invalid, &&L_invalid, &&L_invalid
+  };
+#endif
+
+  for (;;)
+  {
+    try
+    {
+      DISPATCH();
+    dispatch:
+      switch (ip->op)
+      {
+      OP(nop)
+        NEXT();
+      OP(aconst_null)
+        (sp++)->a = nullptr;
+        NEXT();
+      OP(push_int)
+        (sp++)->i = ip->value;
+        NEXT();
+      OP(push_float)
+      {
+        u4 bits = static_cast<u4>(ip->value);
+        std::memcpy(&(sp++)->f, &bits, sizeof(bits));
+        NEXT();
+      }
+      OP(push_long)
+        sp->j = static_cast<s8>(code.getWideConstant(ip->index));
+        sp += 2;
+        NEXT();
+      OP(push_double)
+      {
+        u8 bits = code.getWideConstant(ip->index);
+        std::memcpy(&sp->d, &bits, sizeof(bits));
+        sp += 2;
+        NEXT();
+      }
+      OP(ldc)
+        (sp++)->a = resolveString(current, ip->index);
+        NEXT();
+
+      OP(iload)
+      OP(fload)
+      OP(aload)
+        *sp++ = locals[ip->index];
+        NEXT();
+      OP(lload)
+      OP(dload)
+        *sp = locals[ip->index];
+        sp += 2;
+        NEXT();
+      OP(istore)
+      OP(fstore)
+      OP(astore)
+        locals[ip->index] = *--sp;
+        NEXT();
+      OP(lstore)
+      OP(dstore)
+        sp -= 2;
+        locals[ip->index] = *sp;
+        NEXT();
+
+      ARRAY_LOAD(iaload, s4, i)
+      ARRAY_LOAD_WIDE(laload, s8, j)
+      ARRAY_LOAD(faload, float, f)
+      ARRAY_LOAD_WIDE(daload, double, d)
+      ARRAY_LOAD(aaload, Object*, a)
+      ARRAY_LOAD(baload, s1, i)
+      ARRAY_LOAD(caload, u2, i)
+      ARRAY_LOAD(saload, s2, i)
+      ARRAY_STORE(iastore, s4, i)
+      ARRAY_STORE_WIDE(lastore, s8, j)
+      ARRAY_STORE(fastore, float, f)
+      ARRAY_STORE_WIDE(dastore, double, d)
+      ARRAY_STORE(castore, u2, i)
+      ARRAY_STORE(sastore, s2, i)
+      OP(bastore)
+      {
+        Array* array = checkIndex(vm, sp[-3].a, sp[-2].i);
+        s4 value = array->clazz->getElementType() == 'Z' ? sp[-1].i & 1 : sp[-1].i;
+        array->elements<s1>()[sp[-2].i] = static_cast<s1>(value);
+        sp -= 3;
+        NEXT();
+      }
+      OP(aastore)
+      {
+        Array* array = checkIndex(vm, sp[-3].a, sp[-2].i);
+        Object* value = sp[-1].a;
+        if (value && !value->clazz->isAssignableTo(array->clazz->getComponent()))
+          vm.raise("java/lang/ArrayStoreException", javaName(value->clazz));
+        array->elements<Object*>()[sp[-2].i] = value;
+        sp -= 3;
+        NEXT();
+      }
+
+      OP(pop)
+        sp--;
+        NEXT();
+      OP(pop2)
+        sp -= 2;
+        NEXT();
+      OP(dup)
+        sp[0] = sp[-1];
+        sp++;
+        NEXT();
+      OP(dup_x1)
+      {
+        slot v1 = sp[-1];
+        sp[-1] = sp[-2];
+        sp[-2] = v1;
+        sp[0] = v1;
+        sp++;
+        NEXT();
+      }
+      OP(dup_x2)
+      {
+        slot v1 = sp[-1];
+        sp[-1] = sp[-2];
+        sp[-2] = sp[-3];
+        sp[-3] = v1;
+        sp[0] = v1;
+        sp++;
+        NEXT();
+      }
+      OP(dup2)
+        sp[0] = sp[-2];
+        sp[1] = sp[-1];
+        sp += 2;
+        NEXT();
+      OP(dup2_x1)
+      {
+        slot v1 = sp[-1];
+        slot v2 = sp[-2];
+        sp[1] = v1;
+        sp[0] = v2;
+        sp[-1] = sp[-3];
+        sp[-2] = v1;
+        sp[-3] = v2;
+        sp += 2;
+        NEXT();
+      }
+      OP(dup2_x2)
+      {
+        slot v1 = sp[-1];
+        slot v2 = sp[-2];
+        sp[1] = v1;
+        sp[0] = v2;
+        sp[-1] = sp[-3];
+        sp[-2] = sp[-4];
+        sp[-3] = v1;
+        sp[-4] = v2;
+        sp += 2;
+        NEXT();
+      }
+      OP(swap)
+        std::swap(sp[-1], sp[-2]);
+        NEXT();
+
+      BINARY(iadd, i, add(a, b))
+      BINARY_WIDE(ladd, j, add(a, b))
+      BINARY(fadd, f, a + b)
+      BINARY_WIDE(dadd, d, a + b)
+      BINARY(isub, i, subtract(a, b))
+      BINARY_WIDE(lsub, j, subtract(a, b))
+      BINARY(fsub, f, a - b)
+      BINARY_WIDE(dsub, d, a - b)
+      BINARY(imul, i, multiply(a, b))
+      BINARY_WIDE(lmul, j, multiply(a, b))
+      BINARY(fmul, f, a * b)
+      BINARY_WIDE(dmul, d, a * b)
+      OP(idiv)
+      {
+        s4 b = sp[-1].i;
+        s4 a = sp[-2].i;
+        if (b == 0)
+          vm.raise("java/lang/ArithmeticException", "/ by zero");
+        sp--;
+        sp[-1].i = b == -1 ? negate(a) : a / b;
+        NEXT();
+      }
+      OP(ldiv)
+      {
+        s8 b = sp[-2].j;
+        s8 a = sp[-4].j;
+        if (b == 0)
+          vm.raise("java/lang/ArithmeticException", "/ by zero");
+        sp -= 2;
+        sp[-2].j = b == -1 ? negate(a) : a / b;
+        NEXT();
+      }
+      BINARY(fdiv, f, a / b)
+      BINARY_WIDE(ddiv, d, a / b)
+      OP(irem)
+      {
+        s4 b = sp[-1].i;
+        s4 a = sp[-2].i;
+        if (b == 0)
+          vm.raise("java/lang/ArithmeticException", "/ by zero");
+        sp--;
+        sp[-1].i = b == -1 ? 0 : a % b;
+        NEXT();
+      }
+      OP(lrem)
+      {
+        s8 b = sp[-2].j;
+        s8 a = sp[-4].j;
+        if (b == 0)
+          vm.raise("java/lang/ArithmeticException", "/ by zero");
+        sp -= 2;
+        sp[-2].j = b == -1 ? 0 : a % b;
+        NEXT();
+      }
+      BINARY(frem, f, std::fmod(a, b))
+      BINARY_WIDE(drem, d, std::fmod(a, b))
+      OP(ineg)
+        sp[-1].i = negate(sp[-1].i);
+        NEXT();
+      OP(lneg)
+        sp[-2].j = negate(sp[-2].j);
+        NEXT();
+      OP(fneg)
+        sp[-1].f = -sp[-1].f;
+        NEXT();
+      OP(dneg)
+        sp[-2].d = -sp[-2].d;
+        NEXT();
+      BINARY(ishl, i, shiftLeft(a, b))
+      SHIFT_WIDE(lshl, shiftLeft(a, b))
+      BINARY(ishr, i, shiftRight(a, b))
+      SHIFT_WIDE(lshr, shiftRight(a, b))
+      BINARY(iushr, i, unsignedShiftRight(a, b))
+      SHIFT_WIDE(lushr, unsignedShiftRight(a, b))
+      BINARY(iand, i, a & b)
+      BINARY_WIDE(land, j, a & b)
+      BINARY(ior, i, a | b)
+      BINARY_WIDE(lor, j, a | b)
+      BINARY(ixor, i, a ^ b)
+      BINARY_WIDE(lxor, j, a ^ b)
+      OP(iinc)
+        locals[ip->index].i = add(locals[ip->index].i, ip->value);
+        NEXT();
+
+      OP(i2l)
+      {
+        s4 value = sp[-1].i;
+        sp[-1].j = value;
+        sp++;
+        NEXT();
+      }
+      OP(i2f)
+      {
+        s4 value = sp[-1].i;
+        sp[-1].f = static_cast<float>(value);
+        NEXT();
+      }
+      OP(i2d)
+      {
+        s4 value = sp[-1].i;
+        sp[-1].d = value;
+        sp++;
+        NEXT();
+      }
+      OP(l2i)
+      {
+        s8 value = sp[-2].j;
+        sp[-2].i = static_cast<s4>(value);
+        sp--;
+        NEXT();
+      }
+      OP(l2f)
+      {
+        s8 value = sp[-2].j;
+        sp[-2].f = static_cast<float>(value);
+        sp--;
+        NEXT();
+      }
+      OP(l2d)
+      {
+        s8 value = sp[-2].j;
+        sp[-2].d = static_cast<double>(value);
+        NEXT();
+      }
+      OP(f2i)
+      {
+        float value = sp[-1].f;
+        sp[-1].i = toIntegral<s4>(value);
+        NEXT();
+      }
+      OP(f2l)
+      {
+        float value = sp[-1].f;
+        sp[-1].j = toIntegral<s8>(value);
+        sp++;
+        NEXT();
+      }
+      OP(f2d)
+      {
+        float value = sp[-1].f;
+        sp[-1].d = value;
+        sp++;
+        NEXT();
+      }
+      OP(d2i)
+      {
+        double value = sp[-2].d;
+        sp[-2].i = toIntegral<s4>(value);
+        sp--;
+        NEXT();
+      }
+      OP(d2l)
+      {
+        double value = sp[-2].d;
+        sp[-2].j = toIntegral<s8>(value);
+        NEXT();
+      }
+      OP(d2f)
+      {
+        double value = sp[-2].d;
+        sp[-2].f = static_cast<float>(value);
+        sp--;
+        NEXT();
+      }
+      OP(i2b)
+        sp[-1].i = static_cast<s1>(sp[-1].i);
+        NEXT();
+      OP(i2c)
+        sp[-1].i = static_cast<u2>(sp[-1].i);
+        NEXT();
+      OP(i2s)
+        sp[-1].i = static_cast<s2>(sp[-1].i);
+        NEXT();
+
+      OP(lcmp)
+      {
+        s8 b = sp[-2].j;
+        s8 a = sp[-4].j;
+        sp -= 3;
+        sp[-1].i = a > b ? 1 : a == b ? 0 : -1;
+        NEXT();
+      }
+      OP(fcmpl)
+      {
+        float b = sp[-1].f;
+        float a = sp[-2].f;
+        sp--;
+        sp[-1].i = compare(a, b, -1);
+        NEXT();
+      }
+      OP(fcmpg)
+      {
+        float b = sp[-1].f;
+        float a = sp[-2].f;
+        sp--;
+        sp[-1].i = compare(a, b, 1);
+        NEXT();
+      }
+      OP(dcmpl)
+      {
+        double b = sp[-2].d;
+        double a = sp[-4].d;
+        sp -= 3;
+        sp[-1].i = compare(a, b, -1);
+        NEXT();
+      }
+      OP(dcmpg)
+      {
+        double b = sp[-2].d;
+        double a = sp[-4].d;
+        sp -= 3;
+        sp[-1].i = compare(a, b, 1);
+        NEXT();
+      }
+
+      BRANCH(ifeq, a == 0)
+      BRANCH(ifne, a != 0)
+      BRANCH(iflt, a < 0)
+      BRANCH(ifge, a >= 0)
+      BRANCH(ifgt, a > 0)
+      BRANCH(ifle, a <= 0)
+      COMPARE(if_icmpeq, i, a == b)
+      COMPARE(if_icmpne, i, a != b)
+      COMPARE(if_icmplt, i, a < b)
+      COMPARE(if_icmpge, i, a >= b)
+      COMPARE(if_icmpgt, i, a > b)
+      COMPARE(if_icmple, i, a <= b)
+      COMPARE(if_acmpeq, a, a == b)
+      COMPARE(if_acmpne, a, a != b)
+      OP(ifnull)
+        sp--;
+        if (!sp->a)
+          JUMP(ip->value);
+        NEXT();
+      OP(ifnonnull)
+        sp--;
+        if (sp->a)
+          JUMP(ip->value);
+        NEXT();
+      OP(goto)
+        JUMP(ip->value);
+      OP(jsr)
+        // The return address is the index of the next instruction
+        (sp++)->i = static_cast<s4>(ip - first + 1);
+        JUMP(ip->value);
+      OP(ret)
+        JUMP(locals[ip->index].i);
+      OP(tableswitch)
+        sp--;
+        JUMP(code.getTableSwitch(ip->index).target(sp->i));
+      OP(lookupswitch)
+        sp--;
+        JUMP(code.getLookupSwitch(ip->index).target(sp->i));
+
+      OP(ireturn)
+      OP(freturn)
+      OP(areturn)
+        locals[0] = sp[-1];
+        return;
+      OP(lreturn)
+      OP(dreturn)
+        locals[0] = sp[-2];
+        return;
+      OP(return)
+        return;
+
+      OP(getstatic)
+      {
+        auto& field = resolveField(current, ip->index);
+        if (!field.isStatic())
+          throw std::runtime_error("IncompatibleClassChangeError: getstatic of an instance field");
+        if (field.owner->getState() != RuntimeClass::initialised)
+          initialise(field.owner, sp);
+        sp += loadField(field.type(), field.owner->getStatics() + field.offset, sp);
+        NEXT();
+      }
+      OP(putstatic)
+      {
+        auto& field = resolveField(current, ip->index);
+        if (!field.isStatic())
+          throw std::runtime_error("IncompatibleClassChangeError: putstatic of an instance field");
+        if (field.owner->getState() != RuntimeClass::initialised)
+          initialise(field.owner, sp);
+        sp -= slotsOf(field.type());
+        storeField(field.type(), field.owner->getStatics() + field.offset, sp);
+        NEXT();
+      }
+      OP(getfield)
+      {
+        auto& field = resolveField(current, ip->index);
+        if (field.isStatic())
+          throw std::runtime_error("IncompatibleClassChangeError: getfield of a static field");
+        Object* object = checkNull(vm, sp[-1].a);
+        sp += loadField(field.type(), &object->at<u1>(field.offset), sp - 1) - 1;
+        NEXT();
+      }
+      OP(putfield)
+      {
+        auto& field = resolveField(current, ip->index);
+        if (field.isStatic())
+          throw std::runtime_error("IncompatibleClassChangeError: putfield of a static field");
+        u1 slots = slotsOf(field.type());
+        Object* object = checkNull(vm, sp[-1 - slots].a);
+        storeField(field.type(), &object->at<u1>(field.offset), sp - slots);
+        sp -= slots + 1;
+        NEXT();
+      }
+
+      OP(invokevirtual)
+      OP(invokeinterface)
+      {
+        auto& resolved = resolveMethod(current, ip->index);
+        slot* args = sp - resolved.argument_slots;
+        Object* receiver = checkNull(vm, args[0].a);
+        auto& site = method.call_sites[ip->value];
+        const RuntimeClass::method* selected = site.find(receiver->clazz);
+        if (!selected)
+          selected = &select(resolved, receiver, site);
+        invoke(*selected, args);
+        sp = args + selected->resultSlots();
+        NEXT();
+      }
+      OP(invokespecial)
+      {
+        auto& selected = resolveSpecial(current, ip->index);
+        slot* args = sp - selected.argument_slots;
+        checkNull(vm, args[0].a);
+        invoke(selected, args);
+        sp = args + selected.resultSlots();
+        NEXT();
+      }
+      OP(invokestatic)
+      {
+        auto& resolved = resolveMethod(current, ip->index);
+        if (!resolved.isStatic())
+          throw std::runtime_error("IncompatibleClassChangeError: " + nameOf(resolved) + " isn't static");
+        if (resolved.owner->getState() != RuntimeClass::initialised)
+          initialise(resolved.owner, sp);
+        slot* args = sp - resolved.argument_slots;
+        invoke(resolved, args);
+        sp = args + resolved.resultSlots();
+        NEXT();
+      }
+      OP(invokedynamic)
+        throw std::runtime_error("invokedynamic isn't supported, in " + nameOf(method));
+
+      OP(new)
+      {
+        RuntimeClass* clazz = resolveClass(current, ip->index);
+        if (clazz->getAccessFlags() & (ClassFile::acc_interface | ClassFile::acc_abstract))
+          throw std::runtime_error("InstantiationError: " + clazz->getName().str());
+        if (clazz->getState() != RuntimeClass::initialised)
+          initialise(clazz, sp);
+        (sp++)->a = vm.allocate(clazz);
+        NEXT();
+      }
+      OP(newarray)
+        sp[-1].a = vm.allocateArray(primitive_arrays[ip->small], sp[-1].i);
+        NEXT();
+      OP(anewarray)
+      {
+        sp[-1].a = vm.allocateArray(resolveArrayClass(current, ip->index), sp[-1].i);
+        NEXT();
+      }
+      OP(multianewarray)
+      {
+        RuntimeClass* clazz = resolveClass(current, ip->index);
+        slot* counts = sp - ip->small;
+        for (u1 i = 0; i < ip->small; i++)
+        {
+          if (counts[i].i < 0)
+            vm.raise("java/lang/NegativeArraySizeException", std::to_string(counts[i].i));
+        }
+        Array* array = allocateArrays(clazz, counts, ip->small);
+        sp = counts;
+        (sp++)->a = array;
+        NEXT();
+      }
+      OP(arraylength)
+        sp[-1].i = static_cast<Array*>(checkNull(vm, sp[-1].a))->length;
+        NEXT();
+      OP(athrow)
+        throw thrown{checkNull(vm, sp[-1].a)};
+      OP(checkcast)
+      {
+        Object* object = sp[-1].a;
+        if (object)
+        {
+          RuntimeClass* target = resolveClass(current, ip->index);
+          if (!object->clazz->isAssignableTo(target))
+            vm.raise("java/lang/ClassCastException", "class " + javaName(object->clazz)
+                                                     + " cannot be cast to class " + javaName(target));
+        }
+        NEXT();
+      }
+      OP(instanceof)
+      {
+        Object* object = sp[-1].a;
+        sp[-1].i = object && object->clazz->isAssignableTo(resolveClass(current, ip->index));
+        NEXT();
+      }
+      OP(monitorenter)
+      OP(monitorexit)
+        // Only one thread runs Java code, so there's nothing to lock
+        checkNull(vm, sp[-1].a);
+        sp--;
+        NEXT();
+
+      default:
+#ifdef MIMIC_COMPUTED_GOTO
+      L_invalid:
+#endif
+        throw std::runtime_error(std::string("Unexpected ") + Bytecode::name(ip->op) + " in " + nameOf(method));
+      }
+    }
+    catch (thrown& t)
+    {
+      u4 index = static_cast<u4>(ip - first);
+      const InstructionStream::exception_handler* handler = nullptr;
+      for (auto& candidate : code.getExceptionHandlers())
+      {
+        if (index >= candidate.start && index < candidate.end
+            && (candidate.catch_type == 0
+                || t.exception->clazz->isAssignableTo(resolveClass(current, candidate.catch_type))))
+        {
+          handler = &candidate;
+          break;
+        }
+      }
+      if (!handler)
+        throw;
+      sp = stack_base;
+      (sp++)->a = t.exception;
+      ip = first + handler->handler;
+    }
+  }
+}
+
+#undef OP
+#undef DISPATCH
+#undef NEXT
+#undef JUMP
+#undef BINARY
+#undef BINARY_WIDE
+#undef SHIFT_WIDE
+#undef BRANCH
+#undef COMPARE
+#undef ARRAY_LOAD
+#undef ARRAY_LOAD_WIDE
+#undef ARRAY_STORE
+#undef ARRAY_STORE_WIDE
+
+}
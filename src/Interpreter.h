@@ -0,0 +1,184 @@
+/**
+ * \file Interpreter.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_INTERPRETER_H_
+#define SRC_MIMIC_INTERPRETER_H_
+
+#include "Common.h"
+#include "Object.h"
+#include "RuntimeClass.h"
+
+/*
+ * Threaded dispatch needs the labels as values extension, which GCC and Clang
+ * have. Define MIMIC_NO_COMPUTED_GOTO to build with only the switch.
+ */
+#if defined(__GNUC__) && !defined(MIMIC_NO_COMPUTED_GOTO)
+#define MIMIC_COMPUTED_GOTO 1
+#endif
+
+namespace mimic
+{
+
+class VirtualMachine;
+
+/**
+ * Runs methods' decoded code on one thread
+ *
+ * Each interpreter has its own stack: one contiguous block of slots that
+ * holds the locals and operand stack of every frame. A frame's locals start
+ * where its caller pushed the arguments, so calls don't copy them, and a
+ * method's result is left where its arguments were.
+ *
+ * Instructions are dispatched either by jumping straight from each handler to
+ * the next through a table of label addresses (threaded dispatch), or through
+ * a switch, where the compiler doesn't support taking the address of a label.
+ *
+ * Code isn't verified before it is run, so class files must come from a
+ * trusted compiler.
+ */
+class Interpreter
+{
+public:
+  enum dispatch
+  {
+    /** Jump from each instruction's handler straight to the next's */
+    dispatch_threaded,
+    /** Go back to a switch on the opcode after every instruction */
+    dispatch_switch
+  };
+
+  /**
+   * A Java exception on its way up the stack. Thrown as a C++ exception so
+   * that it unwinds through native methods as well as Java frames.
+   */
+  struct thrown
+  {
+    Object* exception;
+  };
+
+  /** 8 MiB of slots */
+  static const std::size_t default_stack_slots = 1 << 20;
+  /** The deepest calls may nest before StackOverflowError is thrown */
+  static const u4 max_depth = 4096;
+  /**
+   * How much of the native stack is kept free below the deepest call. Every
+   * Java call recurses on the native stack too, so a call that would leave
+   * less than this throws StackOverflowError, however few frames deep it is.
+   */
+  static const std::size_t native_stack_reserve = 256 * 1024;
+
+  /**
+   * @param vm the virtual machine to run in
+   * @param mode how to dispatch instructions. Threaded dispatch falls back
+   *        to the switch if it isn't available.
+   * @param stack_slots the size of the stack
+   */
+  explicit Interpreter(VirtualMachine& vm, dispatch mode = dispatch_threaded,
+                       std::size_t stack_slots = default_stack_slots);
+
+  /**
+   * @return true if threaded dispatch was compiled in
+   */
+  static bool hasThreadedDispatch();
+
+  /**
+   * Calls a method from outside any running Java code, initialising its class
+   * first if it's static
+   *
+   * @param method the method
+   * @param args the arguments, as they would be in the method's locals
+   * @return the result, or an unspecified value for a void method
+   * @throws thrown if the method throws an exception
+   * @throws runtime_error if a class or member can't be found or linked
+   */
+  slot call(const RuntimeClass::method& method, const std::vector<slot>& args);
+
+  /**
+   * Initialises a class, running the static initialisers of it and its
+   * superclasses if they haven't been run yet, from outside any running Java
+   * code
+   *
+   * @param clazz the class
+   */
+  void initialise(RuntimeClass* clazz) { initialise(clazz, stack.get()); };
+
+  VirtualMachine& getVM() const { return vm; };
+  dispatch getDispatch() const { return mode; };
+
+private:
+  VirtualMachine& vm;
+  dispatch mode;
+  std::unique_ptr<slot[]> stack;
+  slot* stack_end;
+  /** The number of frames on the stack */
+  u4 depth;
+  /**
+   * The lowest native stack address calls may reach, set when the outermost
+   * call is made, since that's when we know which thread is running
+   */
+  const char* native_limit;
+  /** The classes of arrays of primitives, by newarray's atype */
+  RuntimeClass* primitive_arrays[12];
+
+  /**
+   * Runs a method on the stack
+   *
+   * @param method the method to run
+   * @param args where the caller pushed the arguments, which become the
+   *        method's locals and then hold its result
+   */
+  void invoke(const RuntimeClass::method& method, slot* args);
+
+  /**
+   * @param free the first slot not in use by any frame
+   */
+  void initialise(RuntimeClass* clazz, slot* free);
+
+  template <bool threaded> void execute(const RuntimeClass::method& method, slot* locals);
+
+  /*
+   * Symbolic references are resolved the first time they are used, and then
+   * found in the current class' ResolvedReferences
+   *
+   * @param current the class whose constant pool has the reference
+   * @param index the reference's index in the constant pool
+   */
+  RuntimeClass* resolveClass(RuntimeClass* current, u2 index);
+  /** @return the class of arrays of the Class entry's class, for anewarray */
+  RuntimeClass* resolveArrayClass(RuntimeClass* current, u2 index);
+  const RuntimeClass::method& resolveMethod(RuntimeClass* current, u2 index);
+  /** @return the method invokespecial calls */
+  const RuntimeClass::method& resolveSpecial(RuntimeClass* current, u2 index);
+  const RuntimeClass::field& resolveField(RuntimeClass* current, u2 index);
+  /** @return the String entry's interned string, for ldc */
+  Object* resolveString(RuntimeClass* current, u2 index);
+
+  /**
+   * Finds the implementation invokevirtual or invokeinterface should run
+   * when its call site's inline cache misses, through the receiver class'
+   * vtable or itable, and adds it to the cache
+   *
+   * @param resolved the method the instruction refers to
+   * @param receiver the object the method is invoked on
+   * @param site the call site's inline cache
+   */
+  const RuntimeClass::method& select(const RuntimeClass::method& resolved, Object* receiver,
+                                     RuntimeClass::call_site& site);
+
+  /**
+   * Allocates the arrays of a multianewarray
+   *
+   * @param clazz the class of the outermost array
+   * @param counts the length of each dimension, outermost first
+   * @param dimensions the number of dimensions to allocate
+   */
+  Array* allocateArrays(RuntimeClass* clazz, const slot* counts, u1 dimensions);
+};
+
+}
+
+#endif /* SRC_MIMIC_INTERPRETER_H_ */
@@ -1,33 +1,167 @@
 
 #include "JUtf8String.h"
 #include "parsing/ParseFailureException.h"
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace mimic
 {
 
+namespace
+{
+const std::size_t max_needle_bytes = 16;
+
+/**
+ * @param first the first byte to search
+ * @param last one past the last byte to search
+ * @param needles the bytes to look for
+ * @param count the number of needles, up to max_needle_bytes
+ * @return the first byte which is one of needles, or last if there isn't one
+ */
+const u1* findAnyByte(const u1* first, const u1* last, const u1* needles, std::size_t count)
+{
+  const u1* position = first;
+#if defined(__AVX2__) || defined(__SSE2__)
+  __m128i broadcast[max_needle_bytes];
+  for (std::size_t i = 0; i < count; i++)
+    broadcast[i] = _mm_set1_epi8(static_cast<char>(needles[i]));
+  while (last - position >= 16)
+  {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+    __m128i found = _mm_cmpeq_epi8(bytes, broadcast[0]);
+    for (std::size_t i = 1; i < count; i++)
+      found = _mm_or_si128(found, _mm_cmpeq_epi8(bytes, broadcast[i]));
+    u4 mask = _mm_movemask_epi8(found);
+    if (mask != 0)
+      return position + __builtin_ctz(mask);
+    position += 16;
+  }
+#endif
+  bool wanted[256] = {};
+  for (std::size_t i = 0; i < count; i++)
+    wanted[needles[i]] = true;
+  while (position != last && !wanted[*position])
+    position++;
+  return position;
+}
+}
+
+const std::size_t JUtf8String::max_size;
+
 JUtf8String::JUtf8String(std::vector<u1> bytes)
-  : bytes(std::move(bytes))
+  : bytes(std::move(bytes)), hash_code(0)
+{
+  own();
+  validate();
+};
+
+JUtf8String::JUtf8String(const JUtf8String& other)
+  : bytes(other.bytes), first(other.first), last(other.last), characters(other.characters),
+    hash_code(other.hash_code.load(std::memory_order_relaxed))
 {
-  for (auto i = this->bytes.begin(); i != this->bytes.end(); ++i)
+  if (!other.isBorrowed())
+    own();
+}
+
+JUtf8String::JUtf8String(JUtf8String&& other)
+  : bytes(std::move(other.bytes)), first(other.first), last(other.last), characters(other.characters),
+    hash_code(other.hash_code.load(std::memory_order_relaxed))
+{
+  other.bytes.clear();
+  other.own();
+  other.characters = 0;
+  other.hash_code.store(0, std::memory_order_relaxed);
+}
+
+JUtf8String& JUtf8String::operator=(const JUtf8String& other)
+{
+  if (this != &other)
   {
-    u1 byte = *i;
-    if (byte == 0 || (byte >= 0xf0 && byte <= 0xff))
+    bytes = other.bytes;
+    if (other.isBorrowed())
+    {
+      first = other.first;
+      last = other.last;
+    }
+    else
     {
-      std::stringstream ss;
-      ss << "Illegal character: " << std::hex << std::setfill('0') << std::setw(2) << (int)byte << std::dec << std::endl;
-      throw parsing::parse_failure(ss.str().c_str());
+      own();
     }
+    characters = other.characters;
+    hash_code.store(other.hash_code.load(std::memory_order_relaxed), std::memory_order_relaxed);
   }
-};
+  return *this;
+}
+
+JUtf8String& JUtf8String::operator=(JUtf8String&& other)
+{
+  if (this != &other)
+  {
+    bytes = std::move(other.bytes);
+    first = other.first;
+    last = other.last;
+    characters = other.characters;
+    hash_code.store(other.hash_code.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.bytes.clear();
+    other.own();
+    other.characters = 0;
+    other.hash_code.store(0, std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+JUtf8String JUtf8String::borrow(parsing::ByteView bytes)
+{
+  checkSize(bytes.size());
+  JUtf8String str;
+  str.first = bytes.begin();
+  str.last = bytes.end();
+  str.validate();
+  return str;
+}
 
-u2 JUtf8String::length() const
+std::size_t JUtf8String::hashOf(parsing::ByteView bytes)
+{
+  // FNV-1a
+  u8 hash = 0xcbf29ce484222325;
+  for (u1 byte : bytes)
+  {
+    hash ^= byte;
+    hash *= 0x100000001b3;
+  }
+  return static_cast<std::size_t>(hash);
+}
+
+void JUtf8String::validate()
+{
+  std::size_t count;
+  const u1* invalid = ModifiedUtf8::validate(first, last, count);
+  if (invalid)
+  {
+    std::stringstream ss;
+    ss << "Illegal character: " << std::hex << std::setfill('0') << std::setw(2) << (int)*invalid << std::dec
+       << " at byte " << (invalid - first) << std::endl;
+    throw parsing::parse_failure(ss.str().c_str());
+  }
+  characters = static_cast<u2>(count);
+}
+
+void JUtf8String::checkSize(std::size_t size)
+{
+  if (size > max_size)
+    throw std::runtime_error("String of " + std::to_string(size) + " bytes is longer than "
+                             + std::to_string(max_size));
+}
+
+void JUtf8String::count()
 {
   u2 length = 0;
   for (auto i = begin(); i != end(); ++i)
   {
     length++;
   }
-  return length;
+  characters = length;
 }
 
 void JUtf8String::replaceChar(const std::vector<u1>::iterator& index, std::vector<u1> code_point_bytes)
@@ -52,76 +186,94 @@ void JUtf8String::replaceChar(const std::vector<u1>::iterator& index, std::vecto
     }
   }
   bytes.insert(index, code_point_bytes.begin(), code_point_bytes.end());
+  own();
+  count();
+  hash_code.store(0, std::memory_order_relaxed);
 }
 
-std::vector<JUtf8String> JUtf8String::split(JUtf8String delimiter) const
+std::vector<JUtf8String> JUtf8String::split(const JUtf8String& delimiter) const
 {
   std::vector<JUtf8String> response;
-  if (delimiter.length() == 0)
+  if (delimiter.size() == 0)
   {
     for (auto i = begin(); i != end(); ++i)
       response.push_back(JUtf8String(i, i + 1));
   }
   else
   {
-    auto strStart = begin();
-    for (auto i = begin(); i != end(); ++i)
+    const u1* start = first;
+    for (const u1* found = search(first, delimiter); found != last; found = search(start, delimiter))
     {
-      if (*i == *(delimiter.begin()))
-      {
-        auto delimiterLength = delimiter.length();
-        if (JUtf8String(i, i + delimiterLength) == delimiter)
-        {
-          response.push_back(JUtf8String(strStart, i));
-          i += delimiterLength;
-          strStart = i;
-        }
-      }
+      response.push_back(JUtf8String(JUtf8StringIterator(start, last), JUtf8StringIterator(found, last)));
+      start = found + delimiter.size();
     }
-    response.push_back(JUtf8String(strStart, end()));
+    response.push_back(JUtf8String(JUtf8StringIterator(start, last), end()));
   }
   return response;
 }
 
-JUtf8String::JUtf8StringIterator JUtf8String::find(JUtf8String needle) const
+JUtf8String::JUtf8StringIterator JUtf8String::find(const JUtf8String& needle) const
 {
-  if (needle.length() == 0)
+  if (needle.size() == 0)
     return end();
-  for (auto i = begin(); i != end(); ++i)
-  {
-    if (*i == *(needle.begin()))
-    {
-      auto needleLength = needle.length();
-      if (JUtf8String(i, i + needleLength) == needle)
-        return i;
-    }
-  }
-  return end();
+  return JUtf8StringIterator(search(first, needle), last, isAscii());
 }
 
-bool JUtf8String::contains(JUtf8String needle) const
+bool JUtf8String::contains(const JUtf8String& needle) const
 {
-  return contains(std::vector<JUtf8String>{needle});
+  return needle.size() != 0 && search(first, needle) != last;
 }
 
-bool JUtf8String::contains(std::vector<JUtf8String> needles) const
+bool JUtf8String::contains(const std::vector<JUtf8String>& needles) const
 {
-  if (needles.size() == 0)
-    return false;
-  for (auto i = begin(); i != end(); ++i)
+  // Single ASCII characters, such as those not allowed in names, are all looked for in one pass
+  u1 characters[max_needle_bytes];
+  std::size_t count = 0;
+  bool single_bytes = true;
+  for (auto& needle : needles)
   {
-    for (auto j = needles.begin(); j != needles.end(); ++j)
+    if (needle.size() == 0)
+      continue;
+    if (needle.size() != 1 || count == max_needle_bytes)
     {
-      auto needleLength = (*j).length();
-      if (needleLength == 0)
-        continue;
-      if ((*i == *(*j).begin()) && (JUtf8String(i, i + needleLength) == *j))
-      { 
-         return true;
-      }
+      single_bytes = false;
+      break;
     }
+    characters[count++] = *needle.first;
+  }
+  if (single_bytes)
+    return count != 0 && findAnyByte(first, last, characters, count) != last;
+  for (auto& needle : needles)
+  {
+    if (contains(needle))
+      return true;
   }
   return false;
 }
 
+const u1* JUtf8String::search(const u1* from, const JUtf8String& needle) const
+{
+  std::size_t needle_size = needle.size();
+  if (needle.isAscii() || isAscii())
+  {
+    /* ASCII bytes are never part of a multi-byte character, and a multi-byte
+     * needle can't be in an ASCII string, so any match starts on a character */
+    for (const u1* position = from; static_cast<std::size_t>(last - position) >= needle_size; position++)
+    {
+      position = static_cast<const u1*>(std::memchr(position, *needle.first, (last - position) - needle_size + 1));
+      if (position == nullptr)
+        return last;
+      if (std::memcmp(position + 1, needle.first + 1, needle_size - 1) == 0)
+        return position;
+    }
+    return last;
+  }
+  for (auto i = JUtf8StringIterator(from, last); i.b != last; ++i)
+  {
+    if (matches(i.b, needle))
+      return i.b;
+  }
+  return last;
+}
+
 }
@@ -9,19 +9,28 @@
 #define SRC_MIMIC_JUTF8STRING_H_
 
 #include "Common.h"
+#include <atomic>
 #include <codecvt>
+#include <cstring>
 #include <iterator>
 #include <locale>
+#include "ModifiedUtf8.h"
 #include "parsing/ByteConsumer.h"
+#include "parsing/ByteView.h"
 
 namespace mimic
 {
 
 class JUtf8StringIterator;
+class Symbol;
 
 /**
  * A modified UTF-8 string
  *
+ * The bytes are normally owned by the string, but a string can also be
+ * borrowed from memory that is guaranteed to outlive it (e.g. a memory-mapped
+ * class file), in which case no copy is made.
+ *
  * See https://docs.oracle.com/javase/specs/jvms/se8/html/jvms-4.html#jvms-4.4.7
  */
 class JUtf8String
@@ -29,20 +38,26 @@ class JUtf8String
 public:
   class JUtf8StringIterator: public std::forward_iterator_tag
   {
-    std::vector<u1>::const_iterator b, e;
-    
+    const u1* b;
+    const u1* e;
+    /** Set when iterating an ASCII-only string, where every character is one byte */
+    bool ascii;
+    friend class JUtf8String;
+
   public:
 
     using value_type = std::vector<u1>;
 
-    JUtf8StringIterator(std::vector<u1>::const_iterator b_, std::vector<u1>::const_iterator e_)
-    :b(b_), e(e_)
+    JUtf8StringIterator(const u1* b_, const u1* e_, bool ascii_ = false)
+    :b(b_), e(e_), ascii(ascii_)
     {}
     
     u4 operator*()
     {
+      if (ascii)
+        return *b;
       u4 code_point;
-      if (*b == 0xed)
+      if (ModifiedUtf8::isSurrogatePair(b, e))
       {
         code_point = ((*(b + 1) & 0x0f) << 16);
         code_point |= ((*(b + 2) & 0x3f) << 10);
@@ -83,13 +98,17 @@ public:
     JUtf8StringIterator operator+(int num)
     {
       JUtf8StringIterator result = *this;
-      for (int i = 0; i < num; i++)
-        ++result;
+      result += num;
       return result;
     }
 
     JUtf8StringIterator& operator+=(int num)
     {
+      if (ascii)
+      {
+        b = num < e - b ? b + num : e;
+        return *this;
+      }
       for (int i = 0; i < num; i++)
         ++(*this);
       return *this;
@@ -116,32 +135,26 @@ public:
     }
 
   private:
-    std::vector<u1>::const_iterator find_next()
+    const u1* find_next()
     {
-      auto current = b;
-      if (*current == 0xed)
-      {
-        current += 6;
-      }
-      else if ((*current & 0xe0) == 0xe0)
-      {
-        current += 3;
-      }
-      else if ((*current & 0xc0) == 0xc0)
-      {
-        current += 2;
-      }
-      else
-      {
-        current += 1;
-      }
+      if (ascii)
+        return b + 1;
+      auto current = b + ModifiedUtf8::sequenceLength(b, e);
       if (current > e)
         return e;
       return current;
     }
   };
 
-  JUtf8String() {};
+  /** The most bytes a string can have, as class files store its size in a u2 */
+  static const std::size_t max_size = 0xffff;
+
+  JUtf8String() : first(nullptr), last(nullptr), characters(0), hash_code(0) {};
+
+  JUtf8String(const JUtf8String& other);
+  JUtf8String(JUtf8String&& other);
+  JUtf8String& operator=(const JUtf8String& other);
+  JUtf8String& operator=(JUtf8String&& other);
 
   /**
    * Construct a JUtf8String from a std::vector<u1>
@@ -150,15 +163,39 @@ public:
    */
   JUtf8String(std::vector<u1> bytes);
 
+  /**
+   * Construct a JUtf8String which refers to bytes owned elsewhere, without
+   * copying them. The bytes must outlive the returned string and all copies
+   * of it.
+   *
+   * @param bytes The modified UTF-8 byte encoded string
+   * @return the borrowed string
+   * @throws runtime_error if there are more than max_size bytes
+   */
+  static JUtf8String borrow(parsing::ByteView bytes);
+
   /**
    * Construct a JUtf8String from a std::string
    *
    * @param str The string to convert
+   * @throws runtime_error if the string is more than max_size bytes once
+   *         encoded
    */
-  JUtf8String(std::string str) {
+  JUtf8String(std::string str) : JUtf8String() {
+    auto data = reinterpret_cast<const u1*>(str.data());
+    // ASCII other than null is encoded as itself
+    if (ModifiedUtf8::asciiPrefix(data, data + str.size()) == str.size())
+    {
+      checkSize(str.size());
+      bytes.assign(data, data + str.size());
+      own();
+      characters = static_cast<u2>(str.size());
+      return;
+    }
     std::stringstream ss;
     ss << str;
     ss >> *this;
+    checkSize(bytes.size());
   };
 
   /**
@@ -177,22 +214,62 @@ public:
    * @param end An iterator pointing to the last character of the new string
    */
   JUtf8String(JUtf8StringIterator begin, JUtf8StringIterator end)
+    : bytes(begin.b, end.b), hash_code(0)
   {
-    for (auto i = begin; i != end; ++i)
-    {
-      bytes.insert(bytes.end(), *i);
-    }
+    own();
+    count();
   };
 
   /**
    * @return the number of characters in the string (not the number of bytes)
    */
-  u2 length() const;
+  u2 length() const { return characters; };
+
+  /**
+   * @return the number of bytes in the string
+   */
+  std::size_t size() const { return last - first; };
+
+  /**
+   * @return a hash of the string's bytes, worked out on first use
+   */
+  std::size_t hash() const
+  {
+    std::size_t hash = hash_code.load(std::memory_order_relaxed);
+    if (hash == 0)
+    {
+      hash = hashOf(view());
+      hash_code.store(hash, std::memory_order_relaxed);
+    }
+    return hash;
+  }
+
+  /**
+   * @param bytes the bytes to hash
+   * @return the hash that a string of the given bytes would have
+   */
+  static std::size_t hashOf(parsing::ByteView bytes);
 
   /**
    * @return a copy of the internal byte buffer
    */
-  std::vector<u1> getBytes() { return bytes; };
+  std::vector<u1> getBytes() const { return std::vector<u1>(first, last); };
+
+  /**
+   * @return a view of the internal byte buffer, valid for the lifetime of
+   *         this string
+   */
+  parsing::ByteView view() const { return parsing::ByteView(first, last - first); };
+
+  /**
+   * @return true if every character is ASCII, and so a single byte
+   */
+  bool isAscii() const { return characters == size(); };
+
+  /**
+   * @return true if the bytes are borrowed rather than owned by this string
+   */
+  bool isBorrowed() const { return first != bytes.data(); };
 
   /**
    * Splits the string where the specified delimiter is found
@@ -200,7 +277,7 @@ public:
    * @param delimiter The string around which to split, if found
    * @return an array of strings
    */
-  std::vector<JUtf8String> split(JUtf8String delimiter) const;
+  std::vector<JUtf8String> split(const JUtf8String& delimiter) const;
 
   /**
    * Find a string within this string
@@ -209,7 +286,7 @@ public:
    * @return iterator pointing at the start of the found string if found,
    *         else end()
    */
-  JUtf8StringIterator find(JUtf8String needle) const;
+  JUtf8StringIterator find(const JUtf8String& needle) const;
 
   /**
    * Find if a string is within this string
@@ -217,7 +294,7 @@ public:
    * @param needle The string to search for
    * @return true if found, else false
    */
-  bool contains(JUtf8String needle) const;
+  bool contains(const JUtf8String& needle) const;
 
   /**
    * Find if one of a set of strings is within this string
@@ -225,30 +302,32 @@ public:
    * @param needles The strings to search for
    * @return true if a needle was found, else false
    */
-  bool contains(std::vector<JUtf8String> needles) const;
+  bool contains(const std::vector<JUtf8String>& needles) const;
 
   JUtf8StringIterator begin() const {
-    return JUtf8StringIterator(bytes.begin(), bytes.end());
+    return JUtf8StringIterator(first, last, isAscii());
   };
 
   JUtf8StringIterator end() const {
-    return JUtf8StringIterator(bytes.end(), bytes.end());
+    return JUtf8StringIterator(last, last, isAscii());
   };
 
+  /**
+   * Modified UTF-8 has exactly one encoding of each character, so strings
+   * with the same characters have the same bytes
+   */
   bool operator==(const JUtf8String& other) const
   {
-    if (length() != other.length())
+    // Strings borrowed from the same place, such as the same symbol, are equal
+    if (first == other.first && last == other.last)
+      return true;
+    if (characters != other.characters || size() != other.size())
       return false;
-    auto thisIter = begin();
-    auto otherIter = other.begin();
-    for (int i = 0; i < length(); i++)
-    {
-      if (*thisIter != *otherIter)
-        return false;
-      ++thisIter;
-      ++otherIter;
-    }
-    return true;
+    std::size_t hash = hash_code.load(std::memory_order_relaxed);
+    std::size_t other_hash = other.hash_code.load(std::memory_order_relaxed);
+    if (hash != 0 && other_hash != 0 && hash != other_hash)
+      return false;
+    return size() == 0 || std::memcmp(first, other.first, size()) == 0;
   }
 
   bool operator!=(const JUtf8String& other) const
@@ -298,7 +377,12 @@ public:
         converted_bytes.push_back(*code_point & 0x7f);
       }
     }
+    if (str.isBorrowed())
+      str.bytes.assign(str.first, str.last);
     str.bytes.insert(str.bytes.end(), converted_bytes.cbegin(), converted_bytes.cend());
+    str.own();
+    str.count();
+    str.hash_code.store(0, std::memory_order_relaxed);
     return is;
   }
 
@@ -311,11 +395,89 @@ private:
    */
   void replaceChar(const std::vector<u1>::iterator& index, std::vector<u1> code_point_bytes);
 
+  /**
+   * Checks that the bytes are valid modified UTF-8, and counts the characters
+   *
+   * @throws parse_failure if an illegal byte is found
+   */
+  void validate();
+
+  /**
+   * Counts the characters in the string, in the same way the iterator steps
+   * through them
+   */
+  void count();
+
+  /**
+   * @param size the number of bytes in a string
+   * @throws runtime_error if size is more than max_size
+   */
+  static void checkSize(std::size_t size);
+
+  /**
+   * Borrows bytes that are already known to be valid
+   *
+   * @param bytes the bytes to borrow
+   * @param characters the number of characters in the bytes
+   * @param hash the hash of the bytes, or 0 if not known
+   */
+  static JUtf8String unchecked(parsing::ByteView bytes, u2 characters, std::size_t hash)
+  {
+    JUtf8String str;
+    str.first = bytes.begin();
+    str.last = bytes.end();
+    str.characters = characters;
+    str.hash_code.store(hash, std::memory_order_relaxed);
+    return str;
+  }
+
+  /**
+   * @return true if needle's bytes start at position
+   */
+  bool matches(const u1* position, const JUtf8String& needle) const
+  {
+    return static_cast<std::size_t>(last - position) >= needle.size()
+        && std::memcmp(position, needle.first, needle.size()) == 0;
+  }
+
+  /**
+   * Finds the first occurrence of needle's bytes which starts on a character
+   *
+   * @param from the character to start searching from
+   * @param needle the string to search for, which must not be empty
+   * @return the start of the occurrence, or last if there isn't one
+   */
+  const u1* search(const u1* from, const JUtf8String& needle) const;
+
+  /**
+   * Points first and last at the owned byte buffer
+   */
+  void own()
+  {
+    first = bytes.data();
+    last = first + bytes.size();
+  }
+
   friend JUtf8StringIterator;
+  friend Symbol;
 
+  /** Owned storage. Empty if the string is borrowed. */
   std::vector<u1> bytes;
+  const u1* first;
+  const u1* last;
+  u2 characters;
+  /** Hash of the bytes, or 0 if it hasn't been worked out yet */
+  mutable std::atomic<std::size_t> hash_code;
 };
 
 }
 
+namespace std
+{
+template <> struct hash<mimic::JUtf8String>
+{
+  std::size_t operator()(const mimic::JUtf8String& str) const { return str.hash(); }
+};
+}
+
 #endif
@@ -9,45 +9,58 @@
 
 namespace mimic {
 
-MethodDescriptor::MethodDescriptor(const JUtf8String& str)
+MethodDescriptor::MethodDescriptor(parsing::ByteView bytes)
+  : shape(nullptr)
 {
-  if (*(str.begin()) != '(')
-    throw std::runtime_error("Missing parameter list");
-  auto param_list_end = str.find(JUtf8String(")"));
-  if (param_list_end + 1 >= str.end())
-    throw std::runtime_error("Missing return type");
-  JUtf8String param_list(str.begin() + 1, param_list_end);
-  auto descriptor_start = param_list.begin();
-  if (param_list.length() > 0)
+  const char* error = parse(bytes);
+  if (error)
+    throw std::runtime_error(error);
+}
+
+optional<MethodDescriptor> MethodDescriptor::tryParse(parsing::ByteView bytes)
+{
+  MethodDescriptor descriptor;
+  if (descriptor.parse(bytes))
+    return optional<MethodDescriptor>();
+  return descriptor;
+}
+
+const char* MethodDescriptor::parse(parsing::ByteView bytes)
+{
+  const u1* position = bytes.begin();
+  const u1* last = bytes.end();
+  if (position == last || *position != '(')
+    return "Missing parameter list";
+  ++position;
+  SignatureShape computed;
+  while (position == last || *position != ')')
+  {
+    if (position == last)
+      return "Missing return type";
+    FieldDescriptor parameter;
+    if (parameter.parse(position, last))
+      return "Invalid parameter type";
+    if (!computed.addParameter(parameter))
+      return "Parameters take more than 255 slots";
+    parameter_type_descriptors.push_back(parameter);
+  }
+  ++position;
+  if (position == last)
+    return "Missing return type";
+  if (*position == 'V')
   {
-    for (auto i = param_list.begin(); i != param_list.end(); ++i)
-    {
-      if (*i == FieldDescriptor::type::jarray)
-      {
-        continue;
-      }
-      else if (*i == FieldDescriptor::type::jclass)
-      {
-        auto descriptor_end = param_list.find(JUtf8String(";"));
-        if (descriptor_end == param_list.end())
-          throw std::runtime_error("No semicolon after class name");
-        descriptor_end++;
-        parameter_type_descriptors.push_back(FieldDescriptor(JUtf8String(descriptor_start, descriptor_end)));
-        descriptor_start = descriptor_end;
-        i = descriptor_start; 
-      }
-      else
-      {
-        parameter_type_descriptors.push_back(FieldDescriptor(JUtf8String(descriptor_start, i + 1)));
-        descriptor_start = i + 1;
-      }
-    }
-    if (descriptor_start < param_list.end())
-      throw std::runtime_error("Array parameter missing type");
+    if (position + 1 != last)
+      return "Invalid return type";
+    shape = computed.intern();
+    return nullptr;
   }
-  JUtf8String return_type(param_list_end + 1, str.end());
-  if (*return_type.begin() != 'V')
-    return_type_descriptor = FieldDescriptor(return_type);
+  FieldDescriptor return_type;
+  if (return_type.parse(position, last) || position != last)
+    return "Invalid return type";
+  return_type_descriptor = return_type;
+  computed.return_kind = SignatureShape::kindOf(return_type);
+  shape = computed.intern();
+  return nullptr;
 }
 
 }
@@ -9,8 +9,10 @@
 #define SRC_MIMIC_METHODDESCRIPTOR_H_
 
 #include "Common.h"
+#include <boost/container/small_vector.hpp>
 #include "FieldDescriptor.h"
 #include "JUtf8String.h"
+#include "SignatureShape.h"
 #include "parsing/ParseFailureException.h"
 
 namespace mimic {
@@ -22,16 +24,67 @@ namespace mimic {
  */
 class MethodDescriptor {
 public:
-  MethodDescriptor(const JUtf8String& str);
+  /**
+   * Parameter types. Most methods take only a few parameters, which are
+   * stored inline rather than on the heap.
+   */
+  typedef boost::container::small_vector<FieldDescriptor, 4> parameter_list;
 
-  auto getReturnType() { return return_type_descriptor; };
-  auto getParameters() { return parameter_type_descriptors; };
+  /**
+   * Parses a method descriptor
+   *
+   * @param str the descriptor
+   * @throws runtime_error if str is not a valid method descriptor
+   */
+  MethodDescriptor(const JUtf8String& str) : MethodDescriptor(str.view()) {};
+
+  /**
+   * Parses a method descriptor
+   *
+   * @param bytes the descriptor, which must be valid modified UTF-8
+   * @throws runtime_error if bytes is not a valid method descriptor
+   */
+  MethodDescriptor(parsing::ByteView bytes);
+
+  /**
+   * Parses a method descriptor without throwing
+   *
+   * @param str the descriptor
+   * @return the descriptor, or nothing if str is not a valid method descriptor
+   */
+  static optional<MethodDescriptor> tryParse(const JUtf8String& str) { return tryParse(str.view()); };
+
+  /**
+   * Parses a method descriptor in a single pass, without throwing and without
+   * allocating unless there are more than a few parameters or a class name
+   * hasn't been interned yet
+   *
+   * @param bytes the descriptor, which must be valid modified UTF-8
+   * @return the descriptor, or nothing if bytes is not a valid method descriptor
+   */
+  static optional<MethodDescriptor> tryParse(parsing::ByteView bytes);
+
+  const optional<FieldDescriptor>& getReturnType() const { return return_type_descriptor; };
+  const parameter_list& getParameters() const { return parameter_type_descriptors; };
+
+  /**
+   * @return the argument slots, reference map and return kind, shared with
+   *         every other method of the same shape
+   */
+  const SignatureShape& getShape() const { return *shape; };
 
 private:
   optional<FieldDescriptor> return_type_descriptor;
-  std::vector<FieldDescriptor> parameter_type_descriptors;
+  parameter_list parameter_type_descriptors;
+  const SignatureShape* shape;
+
+  MethodDescriptor() : shape(nullptr) {};
 
-  MethodDescriptor() = delete;
+  /**
+   * @param bytes the descriptor to parse into this object
+   * @return nullptr if successful, else a description of the problem
+   */
+  const char* parse(parsing::ByteView bytes);
 };
 
 }
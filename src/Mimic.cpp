@@ -4,15 +4,322 @@
  Author      : Julian Cromarty
  Version     :
  Copyright   : Copyright (c)2016, Julian Cromarty
- Description : Hello World in C++,
+ Description : Command line entry point
  ============================================================================
  */
 
+#include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <string>
+#include "ClassArchive.h"
+#include "ClassFileLoader.h"
+#include "VirtualMachine.h"
+#include "parsing/MappedFile.h"
 
-using namespace std;
+using namespace mimic;
 
-int main(void) {
-	cout << "Hello World" << endl; /* prints Hello World */
-	return 0;
+namespace
+{
+void usage()
+{
+  std::cerr << "Usage:" << std::endl
+            << "  mimic dump-archive <archive> <class files or directories...>" << std::endl
+            << "      Parses and validates classes and writes them to an archive" << std::endl
+            << "  mimic load [--archive=<archive>] [--lazy] <class files or directories...>" << std::endl
+            << "      Loads classes, from the archive where possible, and reports how long it took" << std::endl
+            << "  mimic run [--classpath=<path>] [--archive=<archive>] [--switch] [--call-sites]" << std::endl
+            << "            [--heap-size=<size>] [--tlab-size=<size>] [--heap-stats] <main class> [args...]" << std::endl
+            << "      Runs a class' main method. The class path is directories and jars separated by ':'," << std::endl
+            << "      and defaults to the current directory. Class files that are in the archive and haven't" << std::endl
+            << "      changed since it was written are loaded from it. --switch dispatches instructions" << std::endl
+            << "      through a switch rather than threaded code. --call-sites writes the inline caches of" << std::endl
+            << "      the virtual and interface calls made to stderr afterwards. --heap-size and --tlab-size" << std::endl
+            << "      size the heap and each thread's allocation buffers, in bytes with an optional k, m" << std::endl
+            << "      or g suffix, and --heap-stats writes what each thread allocated to stderr afterwards" << std::endl
+            << "  mimic layout [--classpath=<path>] <classes...>" << std::endl
+            << "      Loads classes and prints where their fields are, their references for the" << std::endl
+            << "      garbage collector and the bytes of padding their instances and statics waste" << std::endl;
+}
+
+std::vector<fs::path> classFiles(const std::vector<std::string>& args)
+{
+  std::vector<fs::path> paths;
+  for (auto& arg : args)
+  {
+    fs::path path(arg);
+    if (fs::is_directory(path))
+    {
+      auto found = ClassFileLoader::findClassFiles(path);
+      paths.insert(paths.end(), found.begin(), found.end());
+    }
+    else
+    {
+      paths.push_back(path);
+    }
+  }
+  return paths;
+}
+
+int dumpArchive(const std::vector<std::string>& args)
+{
+  if (args.size() < 2)
+  {
+    usage();
+    return 2;
+  }
+  ClassArchive::Writer writer;
+  std::size_t failed = 0;
+  for (auto& path : classFiles(std::vector<std::string>(args.begin() + 1, args.end())))
+  {
+    try
+    {
+      parsing::MappedFile file(path);
+      writer.add(file.view(), ClassArchive::modificationTime(path));
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << path.string() << ": " << e.what() << std::endl;
+      failed++;
+    }
+  }
+  writer.write(fs::path(args[0]));
+  std::cout << writer.getClassCount() << " classes archived to " << args[0];
+  if (failed)
+    std::cout << ", " << failed << " failed";
+  std::cout << std::endl;
+  return failed ? 1 : 0;
+}
+
+int load(const std::vector<std::string>& args)
+{
+  std::shared_ptr<const ClassArchive> archive;
+  ConstantPool::decoding decoding = ConstantPool::eager;
+  std::vector<std::string> paths;
+  for (auto& arg : args)
+  {
+    if (arg.compare(0, 10, "--archive=") == 0)
+      archive = ClassArchive::open(fs::path(arg.substr(10)));
+    else if (arg == "--lazy")
+      decoding = ConstantPool::lazy;
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      usage();
+      return 2;
+    }
+    else
+      paths.push_back(arg);
+  }
+  ClassFileLoader loader(0, decoding);
+  loader.setArchive(archive);
+  auto report = loader.load(classFiles(paths));
+  for (auto& result : report.results)
+  {
+    if (!result.loaded())
+      std::cerr << result.path.string() << ": " << result.error << std::endl;
+  }
+  std::cout << report.loaded << " loaded (" << report.archived << " from the archive), " << report.failed
+            << " failed in " << report.seconds * 1000 << " ms, " << static_cast<u8>(report.classesPerSecond())
+            << " classes/s" << std::endl;
+  return report.failed ? 1 : 0;
+}
+
+/** A field, gap or header in a layout, for printing */
+struct layout_entry
+{
+  u4 offset;
+  u4 size;
+  std::string label;
+
+  bool operator<(const layout_entry& other) const { return offset < other.offset; };
+};
+
+/**
+ * Prints the bytes of a layout in order. Bytes that are neither fields nor
+ * gaps are space the virtual machine reserved.
+ */
+void printEntries(std::vector<layout_entry> entries, const FieldLayout& layout)
+{
+  for (auto& g : layout.getGaps())
+    entries.push_back(layout_entry{g.offset, g.size, "(gap)"});
+  if (layout.getSize() != layout.getEnd())
+    entries.push_back(layout_entry{layout.getEnd(), layout.getSize() - layout.getEnd(), "(padding)"});
+  std::stable_sort(entries.begin(), entries.end());
+  u4 position = 0;
+  for (auto& e : entries)
+  {
+    if (e.offset > position)
+      std::cout << std::setw(8) << position << std::setw(6) << e.offset - position << "  (reserved)" << std::endl;
+    std::cout << std::setw(8) << e.offset << std::setw(6) << e.size << "  " << e.label << std::endl;
+    position = std::max(position, e.offset + e.size);
+  }
+  if (position < layout.getSize())
+    std::cout << std::setw(8) << position << std::setw(6) << layout.getSize() - position << "  (reserved)" << std::endl;
+}
+
+void printOopMap(const FieldLayout& layout)
+{
+  std::cout << "  references:";
+  if (layout.getOopMap().empty())
+    std::cout << " none";
+  for (auto& block : layout.getOopMap())
+    std::cout << ' ' << block.offset << '-' << block.end();
+  std::cout << std::endl;
+}
+
+int layout(const std::vector<std::string>& args)
+{
+  std::string class_path(".");
+  std::vector<std::string> names;
+  for (auto& arg : args)
+  {
+    if (arg.compare(0, 12, "--classpath=") == 0)
+      class_path = arg.substr(12);
+    else if (arg.compare(0, 2, "--") == 0)
+    {
+      usage();
+      return 2;
+    }
+    else
+      names.push_back(arg);
+  }
+  if (names.empty())
+  {
+    usage();
+    return 2;
+  }
+  VirtualMachine vm{ClassPath(class_path)};
+  std::size_t failed = 0;
+  u8 instance_bytes = 0;
+  u8 instance_padding = 0;
+  u8 static_bytes = 0;
+  u8 static_padding = 0;
+  for (auto name : names)
+  {
+    std::replace(name.begin(), name.end(), '.', '/');
+    RuntimeClass* clazz;
+    try
+    {
+      clazz = vm.findClass(name);
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << name << ": " << e.what() << std::endl;
+      failed++;
+      continue;
+    }
+    auto& instance = clazz->getInstanceLayout();
+    auto& statics = clazz->getStaticLayout();
+    std::cout << name << ": " << instance.getSize() << " bytes, " << instance.getPadding() << " of padding"
+              << std::endl;
+    std::vector<layout_entry> fields{layout_entry{0, sizeof(Object), "(header)"}};
+    std::vector<layout_entry> static_fields;
+    for (auto c = clazz; c; c = c->getSuperClass())
+    {
+      for (auto& f : c->getFields())
+      {
+        std::string label = (c == clazz ? "" : c->getName().str() + ".") + f.name.str() + ' ' + f.descriptor.str();
+        auto size = FieldLayout::sizeOf(FieldLayout::typeOf(FieldDescriptor(f.descriptor.view())));
+        if (!f.isStatic())
+          fields.push_back(layout_entry{f.offset, size, label});
+        else if (c == clazz)
+          static_fields.push_back(layout_entry{f.offset, size, label});
+      }
+    }
+    printEntries(fields, instance);
+    printOopMap(instance);
+    if (statics.getSize() != 0)
+    {
+      std::cout << "  statics: " << statics.getSize() << " bytes, " << statics.getPadding() << " of padding"
+                << std::endl;
+      printEntries(static_fields, statics);
+      printOopMap(statics);
+    }
+    instance_bytes += instance.getSize();
+    instance_padding += instance.getPadding();
+    static_bytes += statics.getSize();
+    static_padding += statics.getPadding();
+  }
+  std::cout << names.size() - failed << " classes: " << instance_padding << " of " << instance_bytes
+            << " instance bytes and " << static_padding << " of " << static_bytes << " static bytes are padding"
+            << std::endl;
+  return failed ? 1 : 0;
+}
+
+int run(const std::vector<std::string>& args)
+{
+  std::string class_path(".");
+  std::shared_ptr<const ClassArchive> archive;
+  Interpreter::dispatch mode = Interpreter::dispatch_threaded;
+  bool call_sites = false;
+  std::size_t heap_size = Heap::default_max_size;
+  std::size_t tlab_size = Heap::default_tlab_size;
+  bool heap_stats = false;
+  auto arg = args.begin();
+  for (; arg != args.end() && arg->compare(0, 2, "--") == 0; ++arg)
+  {
+    if (arg->compare(0, 12, "--classpath=") == 0)
+      class_path = arg->substr(12);
+    else if (arg->compare(0, 10, "--archive=") == 0)
+      archive = ClassArchive::open(fs::path(arg->substr(10)));
+    else if (*arg == "--switch")
+      mode = Interpreter::dispatch_switch;
+    else if (*arg == "--call-sites")
+      call_sites = true;
+    else if (arg->compare(0, 12, "--heap-size=") == 0)
+      heap_size = Heap::parseSize(arg->substr(12));
+    else if (arg->compare(0, 12, "--tlab-size=") == 0)
+      tlab_size = Heap::parseSize(arg->substr(12));
+    else if (*arg == "--heap-stats")
+      heap_stats = true;
+    else
+    {
+      usage();
+      return 2;
+    }
+  }
+  if (arg == args.end())
+  {
+    usage();
+    return 2;
+  }
+  ClassPath classes(class_path);
+  classes.setArchive(archive);
+  VirtualMachine vm{std::move(classes), std::cout, heap_size, tlab_size};
+  int status = vm.runMain(*arg, std::vector<std::string>(arg + 1, args.end()), mode);
+  if (call_sites)
+    vm.dumpCallSites(std::cerr);
+  if (heap_stats)
+    vm.getHeap().dumpStats(std::cerr);
+  return status;
+}
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    usage();
+    return 2;
+  }
+  std::string command(argv[1]);
+  std::vector<std::string> args(argv + 2, argv + argc);
+  try
+  {
+    if (command == "dump-archive")
+      return dumpArchive(args);
+    if (command == "load")
+      return load(args);
+    if (command == "run")
+      return run(args);
+    if (command == "layout")
+      return layout(args);
+  }
+  catch (std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  usage();
+  return 2;
 }
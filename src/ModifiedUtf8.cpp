@@ -0,0 +1,159 @@
+/**
+ * \file ModifiedUtf8.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "ModifiedUtf8.h"
+#include <cstring>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace mimic
+{
+
+namespace
+{
+bool isContinuation(u1 byte)
+{
+  return (byte & 0xc0) == 0x80;
+}
+
+/**
+ * Counts leading bytes in 0x01-0x7f eight at a time, without any vector
+ * instructions
+ */
+std::size_t asciiPrefixWords(const u1* first, const u1* last)
+{
+  const u8 high_bits = 0x8080808080808080;
+  const u8 low_bits = 0x0101010101010101;
+  const u1* position = first;
+  while (last - position >= 8)
+  {
+    u8 word;
+    std::memcpy(&word, position, sizeof(word));
+    // A high bit is set for each byte that is zero or has its own high bit set
+    if (((word - low_bits) & ~word & high_bits) | (word & high_bits))
+      break;
+    position += 8;
+  }
+  while (position != last && *position != 0 && *position < 0x80)
+    position++;
+  return position - first;
+}
+
+/**
+ * Counts leading bytes in 0x01-0x7f using whichever vector instructions
+ * the build targets
+ */
+std::size_t asciiPrefixVector(const u1* first, const u1* last)
+{
+  const u1* position = first;
+#ifdef __AVX2__
+  const __m256i zero256 = _mm256_setzero_si256();
+  while (last - position >= 32)
+  {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(position));
+    // The top bit of each byte is set if it was zero or had its top bit set
+    u4 mask = _mm256_movemask_epi8(_mm256_or_si256(bytes, _mm256_cmpeq_epi8(bytes, zero256)));
+    if (mask != 0)
+      return position - first + __builtin_ctz(mask);
+    position += 32;
+  }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  while (last - position >= 16)
+  {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+    u4 mask = _mm_movemask_epi8(_mm_or_si128(bytes, _mm_cmpeq_epi8(bytes, zero)));
+    if (mask != 0)
+      return position - first + __builtin_ctz(mask);
+    position += 16;
+  }
+#endif
+  return position - first + asciiPrefixWords(position, last);
+}
+
+/**
+ * Checks the character starting at position, which isn't ASCII
+ *
+ * @return the number of bytes in the character, or 0 if it isn't valid
+ */
+std::size_t checkSequence(const u1* position, const u1* last)
+{
+  u1 lead = position[0];
+  std::size_t available = last - position;
+  if (lead < 0xc0 || lead >= 0xf0)
+    // Nulls, stray continuation bytes and four byte UTF-8 aren't allowed
+    return 0;
+  if (lead < 0xe0)
+  {
+    if (available < 2 || !isContinuation(position[1]))
+      return 0;
+    // Overlong encodings are only allowed for the null character
+    if (lead < 0xc2 && !(lead == 0xc0 && position[1] == 0x80))
+      return 0;
+    return 2;
+  }
+  if (available < 3 || !isContinuation(position[1]) || !isContinuation(position[2]))
+    return 0;
+  if (lead == 0xe0 && position[1] < 0xa0)
+    return 0;
+  if (ModifiedUtf8::isSurrogatePair(position, last) && isContinuation(position[5]))
+    return 6;
+  return 3;
+}
+
+template <std::size_t (*prefix)(const u1*, const u1*)>
+const u1* check(const u1* first, const u1* last, std::size_t& characters)
+{
+  std::size_t count = 0;
+  const u1* position = first;
+  while (position != last)
+  {
+    std::size_t ascii = prefix(position, last);
+    position += ascii;
+    count += ascii;
+    if (position == last)
+      break;
+    std::size_t length = checkSequence(position, last);
+    if (length == 0)
+      return position;
+    position += length;
+    count++;
+  }
+  characters = count;
+  return nullptr;
+}
+}
+
+const u1* ModifiedUtf8::validate(const u1* first, const u1* last, std::size_t& characters)
+{
+  return check<asciiPrefixVector>(first, last, characters);
+}
+
+const u1* ModifiedUtf8::validateScalar(const u1* first, const u1* last, std::size_t& characters)
+{
+  return check<asciiPrefixWords>(first, last, characters);
+}
+
+std::size_t ModifiedUtf8::asciiPrefix(const u1* first, const u1* last)
+{
+  return asciiPrefixVector(first, last);
+}
+
+const char* ModifiedUtf8::fastPath()
+{
+#if defined(__AVX2__)
+  return "AVX2";
+#elif defined(__SSE2__)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
+
+}
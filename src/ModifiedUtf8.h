@@ -0,0 +1,97 @@
+/**
+ * \file ModifiedUtf8.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_MODIFIEDUTF8_H_
+#define SRC_MIMIC_MODIFIEDUTF8_H_
+
+#include "Common.h"
+
+namespace mimic
+{
+
+/**
+ * Validation and decoding helpers for modified UTF-8 byte sequences
+ *
+ * A valid sequence is made up of:
+ *  - single bytes 0x01 to 0x7f
+ *  - two byte characters 0xc2-0xdf followed by a continuation byte, or the
+ *    two byte null 0xc0 0x80
+ *  - three byte characters 0xe0-0xef followed by two continuation bytes,
+ *    which must not be an overlong encoding of a shorter character
+ *  - six byte characters made of a high surrogate (0xed 0xa0-0xaf ..)
+ *    followed by a low surrogate (0xed 0xb0-0xbf ..)
+ *
+ * A lone surrogate is a valid three byte character, as Java strings may
+ * contain them.
+ *
+ * See https://docs.oracle.com/javase/specs/jvms/se8/html/jvms-4.html#jvms-4.4.7
+ */
+class ModifiedUtf8
+{
+public:
+  ModifiedUtf8() = delete;
+
+  /**
+   * Checks that a sequence of bytes is valid modified UTF-8 and counts its
+   * characters. Runs of ASCII are checked 16 or 32 bytes at a time where SSE2
+   * or AVX2 are available.
+   *
+   * @param first the first byte
+   * @param last one past the last byte
+   * @param characters set to the number of characters if the bytes are valid
+   * @return nullptr if the bytes are valid, else the start of the first
+   *         invalid character
+   */
+  static const u1* validate(const u1* first, const u1* last, std::size_t& characters);
+
+  /**
+   * The same as validate(), but checking one byte at a time
+   */
+  static const u1* validateScalar(const u1* first, const u1* last, std::size_t& characters);
+
+  /**
+   * @param first the first byte
+   * @param last one past the last byte
+   * @return the number of bytes before the first byte which isn't 0x01-0x7f
+   */
+  static std::size_t asciiPrefix(const u1* first, const u1* last);
+
+  /**
+   * @param position the start of a character
+   * @param last one past the last byte
+   * @return true if position is the start of a six byte surrogate pair
+   */
+  static bool isSurrogatePair(const u1* position, const u1* last)
+  {
+    return last - position >= 6 && position[0] == 0xed && (position[1] & 0xf0) == 0xa0
+        && position[3] == 0xed && (position[4] & 0xf0) == 0xb0;
+  }
+
+  /**
+   * @param position the start of a character in a valid sequence
+   * @param last one past the last byte
+   * @return the number of bytes in the character
+   */
+  static std::size_t sequenceLength(const u1* position, const u1* last)
+  {
+    u1 lead = *position;
+    if (lead < 0x80)
+      return 1;
+    if (lead < 0xe0)
+      return 2;
+    return isSurrogatePair(position, last) ? 6 : 3;
+  }
+
+  /**
+   * @return the name of the instruction set used by validate()'s fast path
+   */
+  static const char* fastPath();
+};
+
+}
+
+#endif /* SRC_MIMIC_MODIFIEDUTF8_H_ */
@@ -0,0 +1,76 @@
+/**
+ * \file Object.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_OBJECT_H_
+#define SRC_MIMIC_OBJECT_H_
+
+#include "Common.h"
+#include "Symbol.h"
+
+namespace mimic
+{
+
+class RuntimeClass;
+struct Object;
+
+/**
+ * A local variable or operand stack slot. long and double values take two
+ * slots, as they do in the class file, and are held in the first of them.
+ */
+union slot
+{
+  s4 i;
+  float f;
+  s8 j;
+  double d;
+  Object* a;
+};
+
+static_assert(sizeof(slot) == 8, "slots must be 8 bytes");
+
+/**
+ * The header of every object on the heap, followed by the object's instance
+ * fields at the offsets its class gives them
+ */
+struct Object
+{
+  RuntimeClass* clazz;
+
+  /**
+   * @param offset the offset of a field, from the start of the object
+   * @return the field
+   */
+  template <typename T> T& at(u4 offset)
+  {
+    return *reinterpret_cast<T*>(reinterpret_cast<u1*>(this) + offset);
+  }
+};
+
+/**
+ * The header of an array, followed by its elements
+ */
+struct Array : Object
+{
+  s4 length;
+
+  template <typename T> T* elements() { return reinterpret_cast<T*>(this + 1); }
+};
+
+static_assert(sizeof(Array) % 8 == 0, "array elements must be 8-byte aligned");
+
+/**
+ * An instance of java/lang/String. Strings are always interned, so the text is
+ * held as a symbol and two strings with the same text are the same object.
+ */
+struct StringObject : Object
+{
+  const Symbol* value;
+};
+
+}
+
+#endif /* SRC_MIMIC_OBJECT_H_ */
@@ -0,0 +1,190 @@
+/**
+ * \file ParseTrace.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "ParseTrace.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+
+namespace mimic
+{
+
+namespace
+{
+/**
+ * One entry in the ring buffer. The sequence number works as a per-slot
+ * seqlock: it is odd while a writer is filling the slot and 2 * (ticket + 1)
+ * once the event for that ticket is complete, so readers can tell whether a
+ * slot holds the event they expect and whether it was overwritten mid-read.
+ */
+struct slot
+{
+  std::atomic<u8> sequence;
+  std::atomic<u8> nanoseconds;
+  std::atomic<u8> offset;
+  std::atomic<u8> id_and_type;
+  std::atomic<u4> count;
+};
+
+std::atomic<slot*> ring(nullptr);
+std::size_t ring_mask = 0;
+std::atomic<u8> head(0);
+std::atomic<u4> next_class_id(0);
+std::once_flag ring_allocated;
+
+u8 now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+std::atomic<bool> ParseTrace::active(false);
+
+void ParseTrace::enable(std::size_t capacity)
+{
+  std::call_once(ring_allocated, [capacity]() {
+    std::size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+    slot* slots = new slot[size];
+    for (std::size_t i = 0; i < size; i++)
+      slots[i].sequence.store(0, std::memory_order_relaxed);
+    ring_mask = size - 1;
+    ring.store(slots, std::memory_order_release);
+  });
+  active.store(true, std::memory_order_release);
+}
+
+void ParseTrace::disable()
+{
+  active.store(false, std::memory_order_release);
+}
+
+void ParseTrace::clear()
+{
+  slot* slots = ring.load(std::memory_order_acquire);
+  if (slots == nullptr)
+    return;
+  head.store(0, std::memory_order_relaxed);
+  for (std::size_t i = 0; i <= ring_mask; i++)
+    slots[i].sequence.store(0, std::memory_order_release);
+}
+
+u4 ParseTrace::begin(uintmax_t offset)
+{
+  u4 class_id = next_class_id.fetch_add(1, std::memory_order_relaxed) + 1;
+  // 0 means "not tracing", so skip it if the counter ever wraps
+  if (class_id == 0)
+    class_id = next_class_id.fetch_add(1, std::memory_order_relaxed) + 1;
+  write(class_id, class_begin, offset, 0);
+  return class_id;
+}
+
+void ParseTrace::write(u4 class_id, event_type type, uintmax_t offset, u4 count)
+{
+  slot* slots = ring.load(std::memory_order_acquire);
+  if (slots == nullptr)
+    return;
+  u8 ticket = head.fetch_add(1, std::memory_order_relaxed);
+  slot& s = slots[ticket & ring_mask];
+  // Once the ring wraps, another writer can be given the same slot. Claim it
+  // only from a finished, older event, so that a writer which has fallen a
+  // lap behind drops its event rather than overwrite a newer one.
+  u8 sequence = s.sequence.load(std::memory_order_relaxed);
+  do
+  {
+    if ((sequence & 1) != 0 || sequence > 2 * ticket)
+      return;
+  } while (!s.sequence.compare_exchange_weak(sequence, 2 * ticket + 1, std::memory_order_relaxed));
+  std::atomic_thread_fence(std::memory_order_release);
+  s.nanoseconds.store(now(), std::memory_order_relaxed);
+  s.offset.store(offset, std::memory_order_relaxed);
+  s.id_and_type.store((static_cast<u8>(class_id) << 8) | type, std::memory_order_relaxed);
+  s.count.store(count, std::memory_order_relaxed);
+  s.sequence.store(2 * (ticket + 1), std::memory_order_release);
+}
+
+std::vector<ParseTrace::event> ParseTrace::snapshot()
+{
+  std::vector<event> events;
+  slot* slots = ring.load(std::memory_order_acquire);
+  if (slots == nullptr)
+    return events;
+  u8 end = head.load(std::memory_order_acquire);
+  u8 start = end > ring_mask + 1 ? end - (ring_mask + 1) : 0;
+  for (u8 ticket = start; ticket < end; ticket++)
+  {
+    slot& s = slots[ticket & ring_mask];
+    u8 before = s.sequence.load(std::memory_order_acquire);
+    event e;
+    e.nanoseconds = s.nanoseconds.load(std::memory_order_relaxed);
+    e.offset = s.offset.load(std::memory_order_relaxed);
+    u8 id_and_type = s.id_and_type.load(std::memory_order_relaxed);
+    e.count = s.count.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    u8 after = s.sequence.load(std::memory_order_relaxed);
+    // Skip events still being written or already overwritten
+    if (before != after || before != 2 * (ticket + 1))
+      continue;
+    e.class_id = static_cast<u4>(id_and_type >> 8);
+    e.type = static_cast<event_type>(id_and_type & 0xff);
+    events.push_back(e);
+  }
+  return events;
+}
+
+void ParseTrace::dump(std::ostream& os)
+{
+  std::map<u4, u8> class_start;
+  for (auto e : snapshot())
+  {
+    if (e.type == class_begin)
+      class_start[e.class_id] = e.nanoseconds;
+    auto start = class_start.find(e.class_id);
+    os << "class " << e.class_id << ' ' << name(e.type);
+    if (start != class_start.end())
+      os << " +" << (e.nanoseconds - start->second) << "ns";
+    os << " offset " << e.offset;
+    if (e.type == version)
+      os << " version " << (e.count >> 16) << '.' << (e.count & 0xffff);
+    else
+      os << " count " << e.count;
+    os << '\n';
+  }
+  os.flush();
+}
+
+const char* ParseTrace::name(event_type type)
+{
+  switch (type)
+  {
+    case class_begin:
+      return "class_begin";
+    case version:
+      return "version";
+    case constant_pool:
+      return "constant_pool";
+    case constant_pool_validated:
+      return "constant_pool_validated";
+    case interfaces:
+      return "interfaces";
+    case fields:
+      return "fields";
+    case methods:
+      return "methods";
+    case attributes:
+      return "attributes";
+    case class_end:
+      return "class_end";
+    case class_failed:
+      return "class_failed";
+  }
+  return "unknown";
+}
+
+}
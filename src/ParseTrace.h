@@ -0,0 +1,137 @@
+/**
+ * \file ParseTrace.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_PARSETRACE_H_
+#define SRC_MIMIC_PARSETRACE_H_
+
+#include <atomic>
+#include "Common.h"
+
+namespace mimic
+{
+
+/**
+ * Opt-in recorder of class file parse events
+ *
+ * When enabled, each class parsed is given an id and the parser records an
+ * event as it reaches each section of the class file, holding the byte
+ * offset of the section, its entry count and a timestamp. Events go into a
+ * fixed-size lock-free ring buffer, so the most recent events are kept and
+ * older ones overwritten. An event is dropped if a newer one already holds
+ * its place, or another is still being written there. The buffer can be read
+ * at any time with snapshot() or dump().
+ *
+ * When disabled, beginClass() returns 0 after a single relaxed load and every
+ * subsequent record() for that class is a comparison against 0.
+ */
+class ParseTrace
+{
+public:
+  enum event_type : u1
+  {
+    class_begin,
+    version,
+    constant_pool,
+    constant_pool_validated,
+    interfaces,
+    fields,
+    methods,
+    attributes,
+    class_end,
+    class_failed
+  };
+
+  /** A single recorded event */
+  typedef struct
+  {
+    u4 class_id;
+    event_type type;
+    /** Entry count of the section. For version events, major << 16 | minor. */
+    u4 count;
+    /** Byte offset of the section within the class file */
+    u8 offset;
+    /** Steady clock timestamp */
+    u8 nanoseconds;
+  } event;
+
+  ParseTrace() = delete;
+
+  /**
+   * Starts recording events. The ring buffer is allocated on the first call
+   * and keeps that capacity for the life of the process.
+   *
+   * @param capacity the number of events to retain, rounded up to a power of 2
+   */
+  static void enable(std::size_t capacity = 4096);
+
+  /**
+   * Stops recording events. Events already recorded are kept.
+   */
+  static void disable();
+
+  /**
+   * Discards all recorded events. Only safe while nothing is being parsed.
+   */
+  static void clear();
+
+  static bool isEnabled() { return active.load(std::memory_order_relaxed); };
+
+  /**
+   * Records the start of a class
+   *
+   * @param offset the byte offset of the start of the class
+   * @return the id to pass to record() for this class, or 0 if tracing is off
+   */
+  static u4 beginClass(uintmax_t offset)
+  {
+    if (!isEnabled())
+      return 0;
+    return begin(offset);
+  }
+
+  /**
+   * Records an event for a class
+   *
+   * @param class_id the id returned by beginClass(); nothing is recorded if 0
+   * @param type the type of event
+   * @param offset the byte offset of the section
+   * @param count the number of entries in the section
+   */
+  static void record(u4 class_id, event_type type, uintmax_t offset, u4 count = 0)
+  {
+    if (class_id != 0)
+      write(class_id, type, offset, count);
+  }
+
+  /**
+   * @return the recorded events still held in the ring buffer, oldest first
+   */
+  static std::vector<event> snapshot();
+
+  /**
+   * Writes the recorded events in a human readable form. Times are shown
+   * relative to the start of each class.
+   *
+   * @param os the stream to write to
+   */
+  static void dump(std::ostream& os);
+
+  /**
+   * @return the name of an event type
+   */
+  static const char* name(event_type type);
+
+private:
+  static std::atomic<bool> active;
+
+  static u4 begin(uintmax_t offset);
+  static void write(u4 class_id, event_type type, uintmax_t offset, u4 count);
+};
+
+}
+
+#endif /* SRC_MIMIC_PARSETRACE_H_ */
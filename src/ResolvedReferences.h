@@ -0,0 +1,93 @@
+/**
+ * \file ResolvedReferences.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_RESOLVEDREFERENCES_H_
+#define SRC_MIMIC_RESOLVEDREFERENCES_H_
+
+#include "Common.h"
+#include <atomic>
+#include <memory>
+
+namespace mimic
+{
+
+/**
+ * What the symbolic references in a class' constant pool resolved to, in a
+ * table parallel to the pool
+ *
+ * An entry is resolved the first time an instruction uses it and published
+ * with a release store, after which every use is a single acquire load
+ * rather than a walk through the pool's entries and a lookup by name. Two
+ * threads resolving the same entry at once get the same answer, so it
+ * doesn't matter whose store lands last.
+ *
+ * Each entry has two pointers:
+ * - Class: the class, and the class of arrays of it
+ * - Fieldref: the field
+ * - Methodref and InterfaceMethodref: the resolved method, and the method
+ *   invokespecial selects, which differs from it for calls to a
+ *   superclass' method that's overridden between there and the caller
+ * - String: the interned java/lang/String
+ *
+ * Failed resolutions aren't recorded, so they are retried on each use.
+ */
+class ResolvedReferences
+{
+public:
+  ResolvedReferences()
+    : count(0)
+  {
+  }
+
+  /**
+   * @param count the number of constant pool entries, including the unused
+   *        entry 0
+   */
+  explicit ResolvedReferences(std::size_t count)
+    : entries(new entry[count]()), count(count)
+  {
+  }
+
+  /**
+   * @return what the entry resolved to, or null if it hasn't been resolved
+   */
+  template <typename T> T* get(u2 index) const { return load<T>(entries[index].resolved); };
+
+  /**
+   * @return the entry's second pointer, or null if it hasn't been resolved
+   */
+  template <typename T> T* getSecond(u2 index) const { return load<T>(entries[index].second); };
+
+  template <typename T> void set(u2 index, T* resolved) { store(entries[index].resolved, resolved); };
+  template <typename T> void setSecond(u2 index, T* resolved) { store(entries[index].second, resolved); };
+
+  std::size_t size() const { return count; };
+
+private:
+  struct entry
+  {
+    std::atomic<const void*> resolved;
+    std::atomic<const void*> second;
+  };
+
+  std::unique_ptr<entry[]> entries;
+  std::size_t count;
+
+  template <typename T> static T* load(const std::atomic<const void*>& pointer)
+  {
+    return static_cast<T*>(const_cast<void*>(pointer.load(std::memory_order_acquire)));
+  }
+
+  static void store(std::atomic<const void*>& pointer, const void* resolved)
+  {
+    pointer.store(resolved, std::memory_order_release);
+  }
+};
+
+}
+
+#endif /* SRC_MIMIC_RESOLVEDREFERENCES_H_ */
@@ -0,0 +1,352 @@
+/**
+ * \file RuntimeClass.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "RuntimeClass.h"
+#include <algorithm>
+#include <cstring>
+#include "MethodDescriptor.h"
+
+namespace mimic
+{
+
+namespace
+{
+const SignatureShape* shapeOf(const Symbol& descriptor)
+{
+  return &MethodDescriptor(descriptor.view()).getShape();
+}
+
+FieldDescriptor::type layoutTypeOf(const Symbol& descriptor)
+{
+  return FieldLayout::typeOf(FieldDescriptor(descriptor.view()));
+}
+
+u1 elementSize(char type)
+{
+  switch (type)
+  {
+  case 'Z':
+  case 'B':
+    return 1;
+  case 'C':
+  case 'S':
+    return 2;
+  case 'I':
+  case 'F':
+    return 4;
+  case 'J':
+  case 'D':
+    return 8;
+  default:
+    return sizeof(Object*);
+  }
+}
+
+bool named(const RuntimeClass* clazz, const char* name)
+{
+  auto view = clazz->getName().view();
+  return view.size() == std::strlen(name) && std::memcmp(view.data(), name, view.size()) == 0;
+}
+
+/**
+ * Searches superinterfaces, depth first, for a method
+ *
+ * @param abstract whether to accept abstract methods
+ */
+const RuntimeClass::method* findInInterfaces(const RuntimeClass* clazz, const Symbol& name,
+                                             const Symbol& descriptor, bool abstract)
+{
+  for (auto c = clazz; c; c = c->getSuperClass())
+  {
+    for (auto interface : c->getInterfaces())
+    {
+      auto found = interface->findDeclaredMethod(name, descriptor);
+      if (found && !found->isStatic() && (abstract || !found->isAbstract()))
+        return found;
+      found = findInInterfaces(interface, name, descriptor, abstract);
+      if (found)
+        return found;
+    }
+  }
+  return nullptr;
+}
+}
+
+const u1 RuntimeClass::polymorphic_limit;
+const u2 RuntimeClass::no_table_index;
+
+u2 RuntimeClass::method::resultSlots() const
+{
+  switch (shape->getReturnKind())
+  {
+  case SignatureShape::kind_void:
+    return 0;
+  case SignatureShape::kind_long:
+  case SignatureShape::kind_double:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+RuntimeClass::RuntimeClass(std::shared_ptr<const ClassFile> file, RuntimeClass* super,
+                           std::vector<RuntimeClass*> interfaces)
+  : flags(file->getAccessFlags()), super(super), interfaces(std::move(interfaces)), file(std::move(file)),
+    references(this->file->getConstantPool().size()),
+    instance_layout(super ? super->instance_layout : FieldLayout(sizeof(Object))), component(nullptr), element_size(0), current(linked), interface_methods(0)
+{
+  auto& cp = this->file->getConstantPool();
+  if (super && !isInterface())
+    vtable = super->vtable;
+  name = cp.getSymbol(cp.get<const ConstantPool::Class_info>(this->file->getThisClass()).name_index);
+  for (auto& info : this->file->getMethods())
+  {
+    method m;
+    m.owner = this;
+    m.name = cp.getSymbol(info.name_index);
+    m.descriptor = cp.getSymbol(info.descriptor_index);
+    m.flags = info.flags;
+    m.shape = shapeOf(m.descriptor);
+    m.argument_slots = static_cast<u2>(m.shape->getArgumentSlots() + (m.isStatic() ? 0 : 1));
+    m.code = info.instructions;
+    m.native = nullptr;
+    if (m.code && m.code->getCallSiteCount() != 0)
+      m.call_sites.reset(new call_site[m.code->getCallSiteCount()]());
+    if (m.code && m.code->getMaxLocals() < m.argument_slots)
+      throw std::runtime_error("VerifyError: " + name.str() + "." + m.name.str()
+                               + " has fewer locals than arguments");
+    if (!m.code && !(m.flags & (ClassFile::acc_abstract | ClassFile::acc_native)))
+      throw std::runtime_error("ClassFormatError: " + name.str() + "." + m.name.str()
+                               + " has no code");
+    methods.push_back(std::move(m));
+    addToTables(methods.back());
+  }
+  std::vector<FieldDescriptor::type> instance_types;
+  std::vector<FieldDescriptor::type> static_types;
+  for (auto& info : this->file->getFields())
+  {
+    field f;
+    f.owner = this;
+    f.name = cp.getSymbol(info.name_index);
+    f.descriptor = cp.getSymbol(info.descriptor_index);
+    f.flags = info.flags;
+    (f.isStatic() ? static_types : instance_types).push_back(layoutTypeOf(f.descriptor));
+    fields.push_back(f);
+  }
+  auto instance_offsets = instance_layout.addFields(instance_types);
+  auto static_offsets = static_layout.addFields(static_types);
+  std::size_t instance_field = 0;
+  std::size_t static_field = 0;
+  for (auto& f : fields)
+    f.offset = f.isStatic() ? static_offsets[static_field++] : instance_offsets[instance_field++];
+  allocateStatics(0);
+  if (!isInterface())
+    buildItables();
+}
+
+RuntimeClass::RuntimeClass(Symbol name, ClassFile::access_flags flags, RuntimeClass* super)
+  : name(name), flags(flags), super(super),
+    instance_layout(super ? super->instance_layout : FieldLayout(sizeof(Object))), component(nullptr), element_size(0), current(linked), interface_methods(0)
+{
+  if (super)
+    vtable = super->vtable;
+}
+
+RuntimeClass::RuntimeClass(Symbol name, RuntimeClass* object, RuntimeClass* component)
+  : name(name), flags(static_cast<ClassFile::access_flags>(ClassFile::acc_public | ClassFile::acc_final
+                                                           | ClassFile::acc_abstract)),
+    super(object), instance_layout(sizeof(Array)), component(component),
+    element_size(elementSize(getElementType())), current(initialised), vtable(object->vtable), interface_methods(0)
+{
+}
+
+void RuntimeClass::addMethod(const char* name, const char* descriptor, ClassFile::access_flags flags,
+                             native_method native)
+{
+  method m;
+  m.owner = this;
+  m.name = Symbol::intern(JUtf8String(name));
+  m.descriptor = Symbol::intern(JUtf8String(descriptor));
+  m.flags = static_cast<ClassFile::access_flags>(flags | ClassFile::acc_native);
+  m.shape = shapeOf(m.descriptor);
+  m.argument_slots = static_cast<u2>(m.shape->getArgumentSlots() + (m.isStatic() ? 0 : 1));
+  m.native = native;
+  methods.push_back(std::move(m));
+  addToTables(methods.back());
+}
+
+u4 RuntimeClass::addField(const char* name, const char* descriptor, ClassFile::access_flags flags)
+{
+  field f;
+  f.owner = this;
+  f.name = Symbol::intern(JUtf8String(name));
+  f.descriptor = Symbol::intern(JUtf8String(descriptor));
+  f.flags = flags;
+  if (f.isStatic())
+  {
+    u4 previous_size = static_layout.getSize();
+    f.offset = static_layout.addField(layoutTypeOf(f.descriptor));
+    allocateStatics(previous_size);
+  }
+  else
+  {
+    f.offset = instance_layout.addField(layoutTypeOf(f.descriptor));
+  }
+  fields.push_back(f);
+  return f.offset;
+}
+
+void RuntimeClass::allocateStatics(u4 previous_size)
+{
+  std::unique_ptr<u1[]> storage(new u1[static_layout.getSize()]());
+  if (statics)
+    std::memcpy(storage.get(), statics.get(), previous_size);
+  statics = std::move(storage);
+}
+
+void RuntimeClass::addToTables(method& m)
+{
+  m.table_index = no_table_index;
+  if (m.isStatic() || (m.flags & ClassFile::acc_private) || m.name.view()[0] == '<')
+    return;
+  if (isInterface())
+  {
+    m.table_index = interface_methods++;
+    return;
+  }
+  for (std::size_t i = 0; i < vtable.size(); i++)
+  {
+    if (vtable[i]->name == m.name && vtable[i]->descriptor == m.descriptor)
+    {
+      vtable[i] = &m;
+      m.table_index = static_cast<u2>(i);
+      return;
+    }
+  }
+  if (vtable.size() >= no_table_index)
+    throw std::runtime_error("ClassFormatError: " + name.str() + " has too many virtual methods");
+  m.table_index = static_cast<u2>(vtable.size());
+  vtable.push_back(&m);
+}
+
+namespace
+{
+/**
+ * Adds an interface and its superinterfaces to a list, if they aren't
+ * already in it
+ */
+void addInterface(const RuntimeClass* interface, std::vector<const RuntimeClass*>& all)
+{
+  if (std::find(all.begin(), all.end(), interface) != all.end())
+    return;
+  all.push_back(interface);
+  for (auto super : interface->getInterfaces())
+    addInterface(super, all);
+}
+}
+
+void RuntimeClass::buildItables()
+{
+  std::vector<const RuntimeClass*> all;
+  for (auto c = this; c; c = c->super)
+  {
+    for (auto interface : c->interfaces)
+      addInterface(interface, all);
+  }
+  for (auto interface : all)
+  {
+    std::vector<const method*> itable(interface->interface_methods);
+    for (auto& m : interface->methods)
+    {
+      if (m.table_index != no_table_index)
+        itable[m.table_index] = findMethod(m.name, m.descriptor);
+    }
+    itables.emplace_back(interface, std::move(itable));
+  }
+}
+
+const std::vector<const RuntimeClass::method*>* RuntimeClass::getItable(const RuntimeClass* interface) const
+{
+  for (auto& itable : itables)
+  {
+    if (itable.first == interface)
+      return &itable.second;
+  }
+  return nullptr;
+}
+
+const RuntimeClass::method* RuntimeClass::findDeclaredMethod(const Symbol& name, const Symbol& descriptor) const
+{
+  for (auto& m : methods)
+  {
+    if (m.name == name && m.descriptor == descriptor)
+      return &m;
+  }
+  return nullptr;
+}
+
+const RuntimeClass::method* RuntimeClass::findMethod(const Symbol& name, const Symbol& descriptor) const
+{
+  for (auto c = this; c; c = c->super)
+  {
+    auto found = c->findDeclaredMethod(name, descriptor);
+    if (found)
+      return found;
+  }
+  // Prefer a default method to an abstract one
+  auto found = findInInterfaces(this, name, descriptor, false);
+  return found ? found : findInInterfaces(this, name, descriptor, true);
+}
+
+const RuntimeClass::field* RuntimeClass::findField(const Symbol& name, const Symbol& descriptor) const
+{
+  for (auto& f : fields)
+  {
+    if (f.name == name && f.descriptor == descriptor)
+      return &f;
+  }
+  for (auto interface : interfaces)
+  {
+    auto found = interface->findField(name, descriptor);
+    if (found)
+      return found;
+  }
+  return super ? super->findField(name, descriptor) : nullptr;
+}
+
+bool RuntimeClass::isSubclassOf(const RuntimeClass* other) const
+{
+  for (auto c = this; c; c = c->super)
+  {
+    if (c == other)
+      return true;
+    for (auto interface : c->interfaces)
+    {
+      if (interface->isSubclassOf(other))
+        return true;
+    }
+  }
+  return false;
+}
+
+bool RuntimeClass::isAssignableTo(const RuntimeClass* target) const
+{
+  if (this == target)
+    return true;
+  if (!isArray())
+    return isSubclassOf(target);
+  if (!target->isArray())
+  {
+    // java/lang/Object is the only class without a superclass
+    return (!target->super && !target->isInterface()) || named(target, "java/lang/Cloneable")
+           || named(target, "java/io/Serializable");
+  }
+  // Arrays of primitives are only assignable to themselves
+  return component && target->component && component->isAssignableTo(target->component);
+}
+
+}
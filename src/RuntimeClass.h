@@ -0,0 +1,376 @@
+/**
+ * \file RuntimeClass.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_RUNTIMECLASS_H_
+#define SRC_MIMIC_RUNTIMECLASS_H_
+
+#include "Common.h"
+#include <deque>
+#include "ClassFile.h"
+#include "FieldLayout.h"
+#include "InstructionStream.h"
+#include "Object.h"
+#include "ResolvedReferences.h"
+#include "SignatureShape.h"
+#include "Symbol.h"
+
+namespace mimic
+{
+
+class Interpreter;
+
+/**
+ * A class loaded into the virtual machine and linked to its superclass and
+ * interfaces
+ *
+ * A class is built either from a ClassFile or, for the few classes the
+ * virtual machine provides itself and for array classes, by the virtual
+ * machine directly. Instance fields are laid out by a FieldLayout that
+ * continues the superclass', so inherited fields keep their offsets, and
+ * static fields by another in the class' own static storage. Both keep
+ * reference fields in runs, which their oop maps list.
+ *
+ * Classes get a vtable when they are linked: their superclass' vtable with
+ * the methods they override replaced, followed by the virtual methods they
+ * add. Interfaces number their methods instead, and each class gets an
+ * itable for every interface it implements, holding the method that
+ * implements each of the interface's methods. invokevirtual and
+ * invokeinterface select methods through these when their inline caches
+ * miss.
+ */
+class RuntimeClass
+{
+public:
+  /**
+   * A method implemented in C++. Arguments are passed in args as they would
+   * be in the locals of a Java method, and the result, if any, is returned in
+   * args[0].
+   */
+  typedef void (*native_method)(Interpreter& interpreter, slot* args);
+
+  enum state : u1
+  {
+    /** Linked, but <clinit> hasn't been run */
+    linked,
+    /** <clinit> is running */
+    initialising,
+    initialised,
+    /** <clinit> threw an exception */
+    erroneous
+  };
+
+  struct method;
+
+  /** The number of receiver classes a call site caches before going megamorphic */
+  static const u1 polymorphic_limit = 4;
+  /** The table_index of a method that isn't in a vtable or itable */
+  static const u2 no_table_index = 0xFFFF;
+
+  /**
+   * The inline cache of an invokevirtual or invokeinterface: the receiver
+   * classes the call has seen, up to polymorphic_limit, and the methods they
+   * selected. Once a call has seen more classes than that it's megamorphic,
+   * and always selects through the vtable or itable.
+   *
+   * Only one thread runs Java code, so call sites are updated without
+   * synchronisation.
+   */
+  struct call_site
+  {
+    const RuntimeClass* receivers[polymorphic_limit];
+    const method* targets[polymorphic_limit];
+    /** The number of receiver classes cached */
+    u1 cached;
+    bool megamorphic;
+    /** Calls made through the cache */
+    u8 hits;
+    /** Calls that had to select through the vtable or itable */
+    u8 misses;
+
+    /**
+     * @param receiver the receiver's class
+     * @return the method the class selected last time, or null if it isn't cached
+     */
+    const method* find(const RuntimeClass* receiver)
+    {
+      for (u1 i = 0; i < cached; i++)
+      {
+        if (receivers[i] == receiver)
+        {
+          hits++;
+          return targets[i];
+        }
+      }
+      return nullptr;
+    }
+
+    /**
+     * Records a miss, and caches the method a receiver class selected
+     */
+    void add(const RuntimeClass* receiver, const method* target)
+    {
+      misses++;
+      if (cached < polymorphic_limit)
+      {
+        receivers[cached] = receiver;
+        targets[cached++] = target;
+      }
+      else
+      {
+        megamorphic = true;
+      }
+    }
+  };
+
+  struct method
+  {
+    RuntimeClass* owner;
+    Symbol name;
+    Symbol descriptor;
+    ClassFile::access_flags flags;
+    const SignatureShape* shape;
+    /** The slots the arguments take, including the receiver */
+    u2 argument_slots;
+    /** The decoded code, or null for native and abstract methods */
+    std::shared_ptr<const InstructionStream> code;
+    /** The implementation of a native method, or null */
+    native_method native;
+    /**
+     * The method's index in its class' vtable or, for an interface method,
+     * in the itables of classes implementing the interface, or
+     * no_table_index for static and private methods and constructors
+     */
+    u2 table_index;
+    /** An inline cache for each of the code's call sites */
+    std::unique_ptr<call_site[]> call_sites;
+
+    bool isStatic() const { return flags & ClassFile::acc_static; };
+    bool isAbstract() const { return flags & ClassFile::acc_abstract; };
+    /** @return the number of slots the result takes */
+    u2 resultSlots() const;
+  };
+
+  struct field
+  {
+    RuntimeClass* owner;
+    Symbol name;
+    Symbol descriptor;
+    ClassFile::access_flags flags;
+    /**
+     * The offset of the field from the start of an instance, or from the start
+     * of the static storage for a static field
+     */
+    u4 offset;
+
+    bool isStatic() const { return flags & ClassFile::acc_static; };
+    /** @return the first character of the descriptor, which gives the field's type */
+    char type() const { return static_cast<char>(descriptor.view()[0]); };
+  };
+
+  RuntimeClass(const RuntimeClass&) = delete;
+  RuntimeClass& operator=(const RuntimeClass&) = delete;
+
+  /**
+   * Links a class loaded from a class file
+   *
+   * @param file the class file
+   * @param super the superclass, or nullptr for java/lang/Object
+   * @param interfaces the direct superinterfaces
+   * @throws runtime_error if the class can't be linked
+   */
+  RuntimeClass(std::shared_ptr<const ClassFile> file, RuntimeClass* super, std::vector<RuntimeClass*> interfaces);
+
+  /**
+   * Creates a class with no methods or fields, to be filled in with
+   * addMethod() and addField()
+   *
+   * @param name the class' binary name
+   * @param flags the class' access flags
+   * @param super the superclass, or nullptr for java/lang/Object
+   */
+  RuntimeClass(Symbol name, ClassFile::access_flags flags, RuntimeClass* super);
+
+  /**
+   * Creates an array class
+   *
+   * @param name the array class' name, e.g. [I or [Ljava/lang/String;
+   * @param object java/lang/Object
+   * @param component the component class for an array of references, or
+   *        nullptr for an array of primitives
+   */
+  RuntimeClass(Symbol name, RuntimeClass* object, RuntimeClass* component);
+
+  /**
+   * Adds a method to a class the virtual machine is building. Methods must
+   * be added before any subclasses are created, so that they inherit them in
+   * their vtables.
+   *
+   * @param name the method's name
+   * @param descriptor the method's descriptor
+   * @param flags the method's access flags
+   * @param native the method's implementation
+   */
+  void addMethod(const char* name, const char* descriptor, ClassFile::access_flags flags, native_method native);
+
+  /**
+   * Adds a field to a class the virtual machine is building
+   *
+   * @param name the field's name
+   * @param descriptor the field's descriptor
+   * @param flags the field's access flags
+   * @return the field's offset
+   */
+  u4 addField(const char* name, const char* descriptor, ClassFile::access_flags flags);
+
+  /**
+   * Reserves space in instances for hidden state the virtual machine keeps
+   * in them, like java/lang/String's text. It goes after the fields added so
+   * far, and the garbage collector doesn't scan it.
+   *
+   * @param size the size of the state in bytes
+   * @param align what its offset must be a multiple of
+   * @return its offset
+   */
+  u4 reserveInstanceSpace(u4 size, u4 align) { return instance_layout.reserve(size, align); };
+
+  const Symbol& getName() const { return name; };
+  ClassFile::access_flags getAccessFlags() const { return flags; };
+  bool isInterface() const { return flags & ClassFile::acc_interface; };
+  bool isArray() const { return name.view()[0] == '['; };
+  RuntimeClass* getSuperClass() const { return super; };
+  const std::vector<RuntimeClass*>& getInterfaces() const { return interfaces; };
+  /** @return the class file the class was loaded from, or null */
+  const ClassFile* getClassFile() const { return file.get(); };
+  /** @return the class' constant pool. Only classes loaded from class files have one. */
+  const ConstantPool& getConstantPool() const { return file->getConstantPool(); };
+  /** @return what the constant pool's symbolic references have resolved to */
+  ResolvedReferences& getResolvedReferences() { return references; };
+  const ResolvedReferences& getResolvedReferences() const { return references; };
+  /** @return the size of an instance in bytes, including the header */
+  u4 getInstanceSize() const { return instance_layout.getSize(); };
+  /** @return where instance fields are, including inherited ones */
+  const FieldLayout& getInstanceLayout() const { return instance_layout; };
+  /** @return where static fields are in the static storage */
+  const FieldLayout& getStaticLayout() const { return static_layout; };
+  /** @return the runs of references in an instance, for the garbage collector */
+  const std::vector<FieldLayout::oop_block>& getOopMap() const { return instance_layout.getOopMap(); };
+  /** @return the storage of the static fields */
+  u1* getStatics() const { return statics.get(); };
+  const std::deque<method>& getMethods() const { return methods; };
+  const std::vector<field>& getFields() const { return fields; };
+
+  /** @return the component class of an array of references, or null */
+  RuntimeClass* getComponent() const { return component; };
+  /** @return the array's element type, from its descriptor, e.g. 'I' or 'L' */
+  char getElementType() const { return static_cast<char>(name.view()[1]); };
+  /** @return the size of an array element in bytes */
+  u1 getElementSize() const { return element_size; };
+
+  state getState() const { return current; };
+  void setState(state s) { current = s; };
+
+  /**
+   * @param name a method name
+   * @param descriptor a method descriptor
+   * @return the method declared by this class, or null
+   */
+  const method* findDeclaredMethod(const Symbol& name, const Symbol& descriptor) const;
+
+  /**
+   * Looks a method up in this class, its superclasses and then its
+   * superinterfaces, as method resolution and selection do
+   *
+   * https://docs.oracle.com/javase/specs/jvms/se8/html/jvms-5.html#jvms-5.4.3.3
+   *
+   * @return the method, or null if there isn't one
+   */
+  const method* findMethod(const Symbol& name, const Symbol& descriptor) const;
+
+  /**
+   * Looks a field up in this class, its superinterfaces and then its
+   * superclasses
+   *
+   * https://docs.oracle.com/javase/specs/jvms/se8/html/jvms-5.html#jvms-5.4.3.2
+   *
+   * @return the field, or null if there isn't one
+   */
+  const field* findField(const Symbol& name, const Symbol& descriptor) const;
+
+  /**
+   * @param index a method's table_index
+   * @return the method the class selects for it
+   */
+  const method* getVirtual(u2 index) const { return vtable[index]; };
+  std::size_t getVtableSize() const { return vtable.size(); };
+
+  /**
+   * @param interface an interface
+   * @return the methods implementing the interface's methods, by their
+   *         table_index, with null for any this class doesn't implement,
+   *         or null if this class doesn't implement the interface
+   */
+  const std::vector<const method*>* getItable(const RuntimeClass* interface) const;
+
+  /**
+   * @param other a class
+   * @return true if this class is other or a subclass or subinterface of it
+   */
+  bool isSubclassOf(const RuntimeClass* other) const;
+
+  /**
+   * Whether a reference to an instance of this class can be cast to another,
+   * as checkcast, instanceof and aastore decide
+   *
+   * https://docs.oracle.com/javase/specs/jvms/se8/html/jvms-6.html#jvms-6.5.checkcast
+   *
+   * @param target the class to cast to
+   */
+  bool isAssignableTo(const RuntimeClass* target) const;
+
+private:
+  Symbol name;
+  ClassFile::access_flags flags;
+  RuntimeClass* super;
+  std::vector<RuntimeClass*> interfaces;
+  std::shared_ptr<const ClassFile> file;
+  ResolvedReferences references;
+  /** A deque, so that adding a method doesn't move the others */
+  std::deque<method> methods;
+  std::vector<field> fields;
+  FieldLayout instance_layout;
+  FieldLayout static_layout;
+  std::unique_ptr<u1[]> statics;
+  RuntimeClass* component;
+  u1 element_size;
+  state current;
+  std::vector<const method*> vtable;
+  /** The interface and its itable, for each interface the class implements */
+  std::vector<std::pair<const RuntimeClass*, std::vector<const method*>>> itables;
+  /** For an interface, the number of methods it has given a table_index */
+  u2 interface_methods;
+
+  /**
+   * Allocates zeroed static storage for the fields added so far, keeping the
+   * values of those already allocated
+   *
+   * @param previous_size the size of the storage already allocated
+   */
+  void allocateStatics(u4 previous_size);
+
+  /**
+   * Gives a newly added method a table_index, overriding its superclass'
+   * method in the vtable if there is one
+   */
+  void addToTables(method& m);
+
+  /** Builds the itables of the interfaces the class implements */
+  void buildItables();
+};
+
+}
+
+#endif /* SRC_MIMIC_RUNTIMECLASS_H_ */
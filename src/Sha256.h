@@ -0,0 +1,40 @@
+/**
+ * \file Sha256.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_SHA256_H_
+#define SRC_MIMIC_SHA256_H_
+
+#include "Common.h"
+#include <array>
+#include "parsing/ByteView.h"
+
+namespace mimic
+{
+
+/**
+ * The SHA-256 digest, for identifying content where a collision would mean
+ * using the wrong data
+ *
+ * https://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.180-4.pdf
+ */
+class Sha256
+{
+public:
+  typedef std::array<u1, 32> digest;
+
+  Sha256() = delete;
+
+  /**
+   * @param bytes the message
+   * @return the message's digest
+   */
+  static digest hash(parsing::ByteView bytes);
+};
+
+}
+
+#endif /* SRC_MIMIC_SHA256_H_ */
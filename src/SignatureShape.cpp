@@ -0,0 +1,160 @@
+/**
+ * \file SignatureShape.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "SignatureShape.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace mimic
+{
+
+namespace
+{
+const unsigned shard_bits = 4;
+const std::size_t shard_count = 1 << shard_bits;
+const std::size_t initial_capacity = 16;
+
+/**
+ * An open-addressed hash table of interned shapes. As with the symbol table,
+ * tables only ever have slots filled in, so readers can probe them without
+ * locking, and a table that's been replaced by a bigger one is never freed.
+ */
+struct table
+{
+  explicit table(std::size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<const SignatureShape*>[capacity]())
+  {
+  }
+
+  const std::size_t mask;
+  std::unique_ptr<std::atomic<const SignatureShape*>[]> slots;
+};
+
+/**
+ * One of the independently locked parts of the shape table. Each shape
+ * belongs to the shard picked by the low bits of its hash.
+ */
+struct shard
+{
+  std::atomic<table*> current;
+  /** Guards used, and replacing current */
+  std::mutex lock;
+  std::size_t used = 0;
+};
+
+std::atomic<std::size_t> interned_count(0);
+
+shard* shards()
+{
+  // Never freed, as shapes must outlive every descriptor that uses them
+  static shard* all = []() {
+    shard* created = new shard[shard_count];
+    for (std::size_t i = 0; i < shard_count; i++)
+      created[i].current.store(new table(initial_capacity), std::memory_order_relaxed);
+    return created;
+  }();
+  return all;
+}
+
+const SignatureShape* find(const table* t, std::size_t hash, const SignatureShape& shape)
+{
+  for (std::size_t i = (hash >> shard_bits) & t->mask;; i = (i + 1) & t->mask)
+  {
+    const SignatureShape* entry = t->slots[i].load(std::memory_order_acquire);
+    if (entry == nullptr || *entry == shape)
+      return entry;
+  }
+}
+
+void insert(table* t, std::size_t hash, const SignatureShape* entry)
+{
+  std::size_t i = (hash >> shard_bits) & t->mask;
+  while (t->slots[i].load(std::memory_order_relaxed) != nullptr)
+    i = (i + 1) & t->mask;
+  t->slots[i].store(entry, std::memory_order_release);
+}
+}
+
+SignatureShape::kind SignatureShape::kindOf(const FieldDescriptor& descriptor)
+{
+  if (!descriptor.isPrimitive())
+    return kind_reference;
+  switch (descriptor.getType())
+  {
+  case FieldDescriptor::type::jlong:
+    return kind_long;
+  case FieldDescriptor::type::jfloat:
+    return kind_float;
+  case FieldDescriptor::type::jdouble:
+    return kind_double;
+  default:
+    return kind_int;
+  }
+}
+
+bool SignatureShape::addParameter(const FieldDescriptor& parameter)
+{
+  kind k = kindOf(parameter);
+  u2 size = (k == kind_long || k == kind_double) ? 2 : 1;
+  if (slots + size > max_slots)
+    return false;
+  if (k == kind_reference)
+    references[slots >> 6] |= u8(1) << (slots & 63);
+  slots += size;
+  parameters++;
+  return true;
+}
+
+std::size_t SignatureShape::hash() const
+{
+  std::size_t result = (std::size_t(slots) << 16) | (std::size_t(parameters) << 8) | return_kind;
+  for (u8 word : references)
+    result = result * 1000003 ^ std::hash<u8>()(word);
+  return result;
+}
+
+const SignatureShape* SignatureShape::intern() const
+{
+  std::size_t h = hash();
+  shard& s = shards()[h & (shard_count - 1)];
+  const SignatureShape* found = find(s.current.load(std::memory_order_acquire), h, *this);
+  if (found)
+    return found;
+
+  std::lock_guard<std::mutex> guard(s.lock);
+  table* t = s.current.load(std::memory_order_relaxed);
+  // Someone else may have interned it since we looked
+  found = find(t, h, *this);
+  if (found)
+    return found;
+  // Keep the table no more than half full so that probes stay short
+  if ((s.used + 1) * 2 > t->mask + 1)
+  {
+    table* bigger = new table((t->mask + 1) * 2);
+    for (std::size_t i = 0; i <= t->mask; i++)
+    {
+      const SignatureShape* entry = t->slots[i].load(std::memory_order_relaxed);
+      if (entry)
+        insert(bigger, entry->hash(), entry);
+    }
+    s.current.store(bigger, std::memory_order_release);
+    t = bigger;
+  }
+  const SignatureShape* entry = new SignatureShape(*this);
+  insert(t, h, entry);
+  s.used++;
+  interned_count.fetch_add(1, std::memory_order_relaxed);
+  return entry;
+}
+
+std::size_t SignatureShape::count()
+{
+  return interned_count.load(std::memory_order_relaxed);
+}
+
+}
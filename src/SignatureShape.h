@@ -0,0 +1,123 @@
+/**
+ * \file SignatureShape.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_SIGNATURESHAPE_H_
+#define SRC_MIMIC_SIGNATURESHAPE_H_
+
+#include "Common.h"
+#include "FieldDescriptor.h"
+
+namespace mimic
+{
+
+/**
+ * The calling convention of a method descriptor: how many local variable
+ * slots its arguments take, which of those slots hold references, and what
+ * kind of value it returns
+ *
+ * Shapes are worked out once when a descriptor is parsed and interned, so all
+ * methods with the same shape, in any class, share one immortal object and
+ * shapes can be compared by address. The receiver of an instance method isn't
+ * part of its descriptor, so isn't counted.
+ */
+class SignatureShape
+{
+public:
+  /**
+   * Kinds of value as the JVM's instructions see them. boolean, byte, char
+   * and short values are all passed and returned as int.
+   */
+  enum kind : u1
+  {
+    kind_void,
+    kind_int,
+    kind_long,
+    kind_float,
+    kind_double,
+    kind_reference
+  };
+
+  /** The most slots a method descriptor's parameters may take */
+  static const u2 max_slots = 255;
+
+  /**
+   * @param descriptor a field type
+   * @return the kind of value the type is passed as
+   */
+  static kind kindOf(const FieldDescriptor& descriptor);
+
+  /**
+   * Finds or creates the shared shape equal to this one
+   *
+   * @return the interned shape, which lives for the life of the process
+   */
+  const SignatureShape* intern() const;
+
+  /**
+   * @return the number of distinct shapes interned so far
+   */
+  static std::size_t count();
+
+  /**
+   * @return the number of local variable slots the arguments take, where long
+   *         and double take two
+   */
+  u1 getArgumentSlots() const { return slots; };
+
+  /**
+   * @return the number of parameters
+   */
+  u1 getParameterCount() const { return parameters; };
+
+  /**
+   * @return the kind of value returned
+   */
+  kind getReturnKind() const { return return_kind; };
+
+  /**
+   * @param slot an argument slot
+   * @return true if the slot holds a reference, which GC must treat as a root
+   */
+  bool isReference(u1 slot) const { return (references[slot >> 6] >> (slot & 63)) & 1; };
+
+  /**
+   * @return the reference map, one bit per argument slot starting from the
+   *         lowest bit of the first word
+   */
+  const std::array<u8, 4>& getReferenceMap() const { return references; };
+
+  std::size_t hash() const;
+
+  bool operator==(const SignatureShape& other) const
+  {
+    return slots == other.slots && parameters == other.parameters && return_kind == other.return_kind
+           && references == other.references;
+  }
+  bool operator!=(const SignatureShape& other) const { return !(*this == other); };
+
+private:
+  friend class MethodDescriptor;
+
+  std::array<u8, 4> references;
+  u1 slots;
+  u1 parameters;
+  kind return_kind;
+
+  SignatureShape() : references(), slots(0), parameters(0), return_kind(kind_void) {};
+
+  /**
+   * Adds the next parameter
+   *
+   * @param parameter the parameter's type
+   * @return false if the parameters would take more than max_slots
+   */
+  bool addParameter(const FieldDescriptor& parameter);
+};
+
+}
+
+#endif /* SRC_MIMIC_SIGNATURESHAPE_H_ */
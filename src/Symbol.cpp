@@ -0,0 +1,198 @@
+/**
+ * \file Symbol.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "Symbol.h"
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace mimic
+{
+
+namespace
+{
+const unsigned shard_bits = 6;
+const std::size_t shard_count = 1 << shard_bits;
+const std::size_t initial_capacity = 64;
+const std::size_t chunk_size = 64 * 1024;
+
+/**
+ * An open-addressed hash table of interned strings. Tables only ever have
+ * slots filled in, so readers can probe them without locking. When a table
+ * fills up it's replaced by a bigger one, but never freed as readers may still
+ * be probing it.
+ */
+struct table
+{
+  explicit table(std::size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<const Symbol::interned*>[capacity]())
+  {
+  }
+
+  const std::size_t mask;
+  std::unique_ptr<std::atomic<const Symbol::interned*>[]> slots;
+};
+
+/**
+ * One of the independently locked parts of the symbol table. Each string
+ * belongs to the shard picked by the low bits of its hash.
+ */
+struct shard
+{
+  std::atomic<table*> current;
+  /** Guards everything below, and replacing current */
+  std::mutex lock;
+  std::size_t used = 0;
+  /** Free space in the chunk that interned strings are allocated from */
+  u1* free = nullptr;
+  std::size_t free_size = 0;
+};
+
+std::atomic<std::size_t> interned_count(0);
+
+shard* shards()
+{
+  // Never freed, as symbols must outlive everything that uses them
+  static shard* all = []() {
+    shard* created = new shard[shard_count];
+    for (std::size_t i = 0; i < shard_count; i++)
+      created[i].current.store(new table(initial_capacity), std::memory_order_relaxed);
+    return created;
+  }();
+  return all;
+}
+
+const Symbol::interned* find(const table* t, std::size_t hash, parsing::ByteView bytes)
+{
+  for (std::size_t i = (hash >> shard_bits) & t->mask;; i = (i + 1) & t->mask)
+  {
+    const Symbol::interned* entry = t->slots[i].load(std::memory_order_acquire);
+    if (entry == nullptr)
+      return nullptr;
+    if (entry->hash == hash && parsing::ByteView(entry->bytes(), entry->size) == bytes)
+      return entry;
+  }
+}
+
+void insert(table* t, const Symbol::interned* entry)
+{
+  std::size_t i = (entry->hash >> shard_bits) & t->mask;
+  while (t->slots[i].load(std::memory_order_relaxed) != nullptr)
+    i = (i + 1) & t->mask;
+  t->slots[i].store(entry, std::memory_order_release);
+}
+
+/**
+ * Copies a string into a shard's chunk. Must be called with the shard locked.
+ */
+const Symbol::interned* allocate(shard& s, std::size_t hash, u2 length, parsing::ByteView bytes)
+{
+  std::size_t size = sizeof(Symbol::interned) + bytes.size();
+  // Keep every entry aligned for the next one
+  size = (size + alignof(Symbol::interned) - 1) & ~(alignof(Symbol::interned) - 1);
+  u1* memory;
+  if (size > chunk_size / 4)
+  {
+    memory = new u1[size];
+  }
+  else
+  {
+    if (size > s.free_size)
+    {
+      s.free = new u1[chunk_size];
+      s.free_size = chunk_size;
+    }
+    memory = s.free;
+    s.free += size;
+    s.free_size -= size;
+  }
+  auto entry = new (memory) Symbol::interned;
+  entry->hash = hash;
+  entry->size = static_cast<u2>(bytes.size());
+  if (!bytes.empty())
+    std::memcpy(memory + sizeof(Symbol::interned), bytes.data(), bytes.size());
+  entry->length = length;
+  entry->marks.store(0, std::memory_order_relaxed);
+  return entry;
+}
+}
+
+Symbol::Symbol()
+{
+  static const interned* empty = intern(parsing::ByteView()).entry;
+  entry = empty;
+}
+
+Symbol Symbol::intern(parsing::ByteView bytes)
+{
+  return intern(bytes, JUtf8String::hashOf(bytes), nullptr);
+}
+
+Symbol Symbol::intern(parsing::ByteView bytes, std::size_t hash, u2 length)
+{
+  return intern(bytes, hash, &length);
+}
+
+Symbol Symbol::intern(parsing::ByteView bytes, std::size_t hash, const u2* length)
+{
+  // The size and length are only stored as u2s
+  if (bytes.size() > JUtf8String::max_size)
+    throw std::runtime_error("Can't intern a string of " + std::to_string(bytes.size()) + " bytes");
+  shard& s = shards()[hash & (shard_count - 1)];
+  const interned* found = find(s.current.load(std::memory_order_acquire), hash, bytes);
+  if (found)
+    return Symbol(found);
+
+  std::lock_guard<std::mutex> guard(s.lock);
+  table* t = s.current.load(std::memory_order_relaxed);
+  // Someone else may have interned it since we looked
+  found = find(t, hash, bytes);
+  if (found)
+    return Symbol(found);
+  // Keep the table no more than half full so that probes stay short
+  if ((s.used + 1) * 2 > t->mask + 1)
+  {
+    table* bigger = new table((t->mask + 1) * 2);
+    for (std::size_t i = 0; i <= t->mask; i++)
+    {
+      const interned* entry = t->slots[i].load(std::memory_order_relaxed);
+      if (entry)
+        insert(bigger, entry);
+    }
+    s.current.store(bigger, std::memory_order_release);
+    t = bigger;
+  }
+  u2 characters;
+  if (length)
+  {
+    characters = *length;
+  }
+  else
+  {
+    JUtf8String str = JUtf8String::unchecked(bytes, 0, hash);
+    str.count();
+    characters = str.length();
+  }
+  const interned* entry = allocate(s, hash, characters, bytes);
+  insert(t, entry);
+  s.used++;
+  interned_count.fetch_add(1, std::memory_order_relaxed);
+  return Symbol(entry);
+}
+
+std::size_t Symbol::count()
+{
+  return interned_count.load(std::memory_order_relaxed);
+}
+
+JUtf8String Symbol::string() const
+{
+  return JUtf8String::unchecked(view(), length(), hash());
+}
+
+}
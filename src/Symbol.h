@@ -0,0 +1,159 @@
+/**
+ * \file Symbol.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_SYMBOL_H_
+#define SRC_MIMIC_SYMBOL_H_
+
+#include <atomic>
+#include "Common.h"
+#include "JUtf8String.h"
+#include "parsing/ByteView.h"
+
+namespace mimic
+{
+
+/**
+ * A handle to a modified UTF-8 string interned in the process-wide symbol
+ * table
+ *
+ * Each distinct byte sequence is stored once, however many classes refer to
+ * it, so two symbols are equal if and only if they point at the same entry.
+ * The hash and length are worked out when a string is first interned.
+ * Interned strings are never freed, so handles and the strings and views they
+ * hand out stay valid for the life of the process.
+ *
+ * Interning is safe from any number of threads. Looking up a string that is
+ * already interned takes no locks.
+ */
+class Symbol
+{
+public:
+  /**
+   * Constructs the empty symbol
+   */
+  Symbol();
+
+  /**
+   * Interns a string
+   *
+   * @param bytes the string's bytes, which must already be valid modified UTF-8
+   * @return the symbol for the bytes
+   * @throws runtime_error if there are more than JUtf8String::max_size bytes
+   */
+  static Symbol intern(parsing::ByteView bytes);
+
+  /**
+   * Interns a string
+   *
+   * @param str the string
+   * @return the symbol for the string
+   */
+  static Symbol intern(const JUtf8String& str) { return intern(str.view()); };
+
+  /**
+   * Interns a string whose hash and length are already known, e.g. because
+   * they were stored alongside it in a class archive
+   *
+   * @param bytes the string's bytes, which must already be valid modified UTF-8
+   * @param hash the hash of the bytes, as JUtf8String::hashOf() works it out
+   * @param length the number of characters in the string
+   * @return the symbol for the bytes
+   * @throws runtime_error if there are more than JUtf8String::max_size bytes
+   */
+  static Symbol intern(parsing::ByteView bytes, std::size_t hash, u2 length);
+
+  /**
+   * @return the number of symbols interned so far, including the empty symbol
+   */
+  static std::size_t count();
+
+  /**
+   * @return the hash of the symbol's bytes
+   */
+  std::size_t hash() const { return entry->hash; };
+
+  /**
+   * @return the number of bytes in the symbol
+   */
+  u2 size() const { return entry->size; };
+
+  /**
+   * @return the number of characters in the symbol (not the number of bytes)
+   */
+  u2 length() const { return entry->length; };
+
+  /**
+   * @return a view of the interned bytes
+   */
+  parsing::ByteView view() const { return parsing::ByteView(entry->bytes(), entry->size); };
+
+  /**
+   * @return a string borrowing the interned bytes
+   */
+  JUtf8String string() const;
+
+  /**
+   * @return a copy of the bytes, for messages and printing
+   */
+  std::string str() const { return std::string(reinterpret_cast<const char*>(entry->bytes()), entry->size); };
+
+  /**
+   * @return the marks that have been added to the symbol
+   */
+  u1 getMarks() const { return entry->marks.load(std::memory_order_acquire); };
+
+  /**
+   * Records facts about the symbol's text, such as that it has been checked
+   * to be a valid name, so that they only need working out once however many
+   * classes use the symbol. Safe from any number of threads.
+   *
+   * @param marks the bits to set, whose meaning is up to the caller
+   */
+  void addMarks(u1 marks) const { entry->marks.fetch_or(marks, std::memory_order_release); };
+
+  bool operator==(const Symbol& other) const { return entry == other.entry; };
+  bool operator!=(const Symbol& other) const { return entry != other.entry; };
+
+  friend std::ostream& operator<<(std::ostream& os, const Symbol& symbol)
+  {
+    return os << symbol.string();
+  }
+
+  /** Interned strings, followed in memory by their bytes */
+  struct interned
+  {
+    std::size_t hash;
+    u2 size;
+    u2 length;
+    /** Set by addMarks(), and otherwise unused */
+    mutable std::atomic<u1> marks;
+
+    const u1* bytes() const { return reinterpret_cast<const u1*>(this + 1); };
+  };
+
+private:
+  explicit Symbol(const interned* entry) : entry(entry) {};
+
+  /**
+   * @param length the number of characters, or nullptr to count them
+   */
+  static Symbol intern(parsing::ByteView bytes, std::size_t hash, const u2* length);
+
+  const interned* entry;
+};
+
+}
+
+namespace std
+{
+template <> struct hash<mimic::Symbol>
+{
+  std::size_t operator()(const mimic::Symbol& symbol) const { return symbol.hash(); }
+};
+}
+
+#endif /* SRC_MIMIC_SYMBOL_H_ */
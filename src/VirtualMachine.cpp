@@ -0,0 +1,551 @@
+/**
+ * \file VirtualMachine.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "VirtualMachine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Bytecode.h"
+
+namespace mimic
+{
+
+namespace
+{
+const ClassFile::access_flags public_static = static_cast<ClassFile::access_flags>(ClassFile::acc_public
+                                                                                    | ClassFile::acc_static);
+
+/** Where a PrintStream's hidden pointer to the stream it writes to is: straight after the header, as it has no fields */
+const u4 stream_offset = sizeof(Object);
+
+std::string javaName(const Symbol& name)
+{
+  std::string str = name.str();
+  std::replace(str.begin(), str.end(), '/', '.');
+  return str;
+}
+
+/**
+ * Formats a floating point number the way Double.toString and Float.toString
+ * do: with as few digits as tell the value apart from its neighbours, in
+ * decimal between 10^-3 and 10^7 and in scientific notation outside
+ */
+std::string floatingToString(double value, bool single)
+{
+  if (std::isnan(value))
+    return "NaN";
+  if (std::isinf(value))
+    return value > 0 ? "Infinity" : "-Infinity";
+  if (value == 0)
+    return std::signbit(value) ? "-0.0" : "0.0";
+  char buffer[32];
+  for (int precision = 1; precision <= 17; precision++)
+  {
+    std::snprintf(buffer, sizeof(buffer), "%.*e", precision - 1, value);
+    if (single ? std::strtof(buffer, nullptr) == static_cast<float>(value) : std::strtod(buffer, nullptr) == value)
+      break;
+  }
+  std::string scientific(buffer);
+  std::string sign = scientific[0] == '-' ? "-" : "";
+  std::size_t e = scientific.find('e');
+  std::string digits = scientific.substr(sign.size(), e - sign.size());
+  digits.erase(std::remove(digits.begin(), digits.end(), '.'), digits.end());
+  int exponent = std::atoi(scientific.c_str() + e + 1);
+  double magnitude = std::fabs(value);
+  if (magnitude >= 1e-3 && magnitude < 1e7)
+  {
+    if (exponent < 0)
+      return sign + "0." + std::string(-exponent - 1, '0') + digits;
+    if (digits.size() <= static_cast<std::size_t>(exponent) + 1)
+      return sign + digits + std::string(exponent + 1 - digits.size(), '0') + ".0";
+    return sign + digits.substr(0, exponent + 1) + "." + digits.substr(exponent + 1);
+  }
+  return sign + digits.substr(0, 1) + "." + (digits.size() > 1 ? digits.substr(1) : "0") + "E"
+         + std::to_string(exponent);
+}
+
+/** Writes a UTF-16 code unit as UTF-8 */
+void writeChar(std::ostream& os, u2 c)
+{
+  if (c < 0x80)
+  {
+    os.put(static_cast<char>(c));
+  }
+  else if (c < 0x800)
+  {
+    os.put(static_cast<char>(0xc0 | (c >> 6)));
+    os.put(static_cast<char>(0x80 | (c & 0x3f)));
+  }
+  else
+  {
+    os.put(static_cast<char>(0xe0 | (c >> 12)));
+    os.put(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+    os.put(static_cast<char>(0x80 | (c & 0x3f)));
+  }
+}
+
+s4 identityHash(Object* object)
+{
+  return static_cast<s4>(reinterpret_cast<std::uintptr_t>(object) >> 3);
+}
+
+/** @return what String.valueOf(Object) would */
+std::string toString(VirtualMachine& vm, Object* object)
+{
+  if (!object)
+    return "null";
+  if (object->clazz == vm.findClass("java/lang/String"))
+    return static_cast<StringObject*>(object)->value->str();
+  std::stringstream ss;
+  ss << javaName(object->clazz->getName()) << "@" << std::hex << identityHash(object);
+  return ss.str();
+}
+
+std::ostream& streamOf(slot* args)
+{
+  return *args[0].a->at<std::ostream*>(stream_offset);
+}
+
+void objectInit(Interpreter&, slot*)
+{
+}
+
+void objectHashCode(Interpreter&, slot* args)
+{
+  args[0].i = identityHash(args[0].a);
+}
+
+void objectEquals(Interpreter&, slot* args)
+{
+  args[0].i = args[0].a == args[1].a;
+}
+
+void stringLength(Interpreter&, slot* args)
+{
+  args[0].i = static_cast<StringObject*>(args[0].a)->value->length();
+}
+
+void stringToString(Interpreter&, slot*)
+{
+}
+
+void throwableInitMessage(Interpreter& interpreter, slot* args)
+{
+  args[0].a->at<Object*>(interpreter.getVM().getMessageOffset()) = args[1].a;
+}
+
+void throwableGetMessage(Interpreter& interpreter, slot* args)
+{
+  args[0].a = args[0].a->at<Object*>(interpreter.getVM().getMessageOffset());
+}
+
+void systemNanoTime(Interpreter&, slot* args)
+{
+  args[0].j = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void systemCurrentTimeMillis(Interpreter&, slot* args)
+{
+  args[0].j = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void systemArraycopy(Interpreter& interpreter, slot* args)
+{
+  VirtualMachine& vm = interpreter.getVM();
+  auto src = static_cast<Array*>(args[0].a);
+  s4 src_pos = args[1].i;
+  auto dest = static_cast<Array*>(args[2].a);
+  s4 dest_pos = args[3].i;
+  s4 length = args[4].i;
+  if (!src || !dest)
+    vm.raise("java/lang/NullPointerException");
+  RuntimeClass* from = src->clazz;
+  RuntimeClass* to = dest->clazz;
+  if (!from->isArray() || !to->isArray() || (from->getComponent() == nullptr) != (to->getComponent() == nullptr)
+      || (!from->getComponent() && from != to))
+    vm.raise("java/lang/ArrayStoreException", "arraycopy: type mismatch");
+  if (src_pos < 0 || dest_pos < 0 || length < 0 || s8(src_pos) + length > src->length
+      || s8(dest_pos) + length > dest->length)
+    vm.raise("java/lang/ArrayIndexOutOfBoundsException", "arraycopy: last source index "
+                                                         + std::to_string(s8(src_pos) + length)
+                                                         + " out of bounds for length "
+                                                         + std::to_string(src->length));
+  if (from->getComponent() && !from->getComponent()->isAssignableTo(to->getComponent()))
+  {
+    // Each element has to be checked, and those before a bad one are still copied
+    for (s4 i = 0; i < length; i++)
+    {
+      Object* element = src->elements<Object*>()[src_pos + i];
+      if (element && !element->clazz->isAssignableTo(to->getComponent()))
+        vm.raise("java/lang/ArrayStoreException", "arraycopy: element type mismatch");
+      dest->elements<Object*>()[dest_pos + i] = element;
+    }
+    return;
+  }
+  u1 size = from->getElementSize();
+  std::memmove(dest->elements<u1>() + std::size_t(dest_pos) * size, src->elements<u1>() + std::size_t(src_pos) * size,
+               std::size_t(length) * size);
+}
+
+void printString(Interpreter& interpreter, slot* args)
+{
+  streamOf(args) << toString(interpreter.getVM(), args[1].a);
+}
+
+void printInt(Interpreter&, slot* args)
+{
+  streamOf(args) << args[1].i;
+}
+
+void printLong(Interpreter&, slot* args)
+{
+  streamOf(args) << args[1].j;
+}
+
+void printBoolean(Interpreter&, slot* args)
+{
+  streamOf(args) << (args[1].i ? "true" : "false");
+}
+
+void printChar(Interpreter&, slot* args)
+{
+  writeChar(streamOf(args), static_cast<u2>(args[1].i));
+}
+
+void printFloat(Interpreter&, slot* args)
+{
+  streamOf(args) << floatingToString(args[1].f, true);
+}
+
+void printDouble(Interpreter&, slot* args)
+{
+  streamOf(args) << floatingToString(args[1].d, false);
+}
+
+void println(Interpreter&, slot* args)
+{
+  streamOf(args) << '\n';
+}
+
+/** Defines println in terms of print */
+template <RuntimeClass::native_method print> void printLine(Interpreter& interpreter, slot* args)
+{
+  print(interpreter, args);
+  streamOf(args) << '\n';
+}
+}
+
+VirtualMachine::VirtualMachine(ClassPath class_path, std::ostream& out, std::size_t heap_size,
+                               std::size_t tlab_size)
+  : class_path(std::move(class_path)), out(out), heap(heap_size, tlab_size), string_class(nullptr),
+    message_offset(0), out_of_memory(nullptr)
+{
+  defineBuiltIns();
+}
+
+RuntimeClass* VirtualMachine::builtIn(const char* name, const char* super, ClassFile::access_flags flags)
+{
+  Symbol symbol = Symbol::intern(JUtf8String(name));
+  std::unique_ptr<RuntimeClass> clazz(new RuntimeClass(symbol, flags, super ? findClass(super) : nullptr));
+  clazz->setState(RuntimeClass::initialised);
+  RuntimeClass* created = clazz.get();
+  classes.emplace(symbol, std::move(clazz));
+  return created;
+}
+
+void VirtualMachine::defineBuiltIns()
+{
+  RuntimeClass* object = builtIn("java/lang/Object", nullptr);
+  object->addMethod("<init>", "()V", ClassFile::acc_public, objectInit);
+  object->addMethod("hashCode", "()I", ClassFile::acc_public, objectHashCode);
+  object->addMethod("equals", "(Ljava/lang/Object;)Z", ClassFile::acc_public, objectEquals);
+
+  string_class = builtIn("java/lang/String", "java/lang/Object",
+                         static_cast<ClassFile::access_flags>(ClassFile::acc_public | ClassFile::acc_final));
+  string_class->reserveInstanceSpace(sizeof(StringObject::value), alignof(const Symbol*));
+  string_class->addMethod("length", "()I", ClassFile::acc_public, stringLength);
+  string_class->addMethod("toString", "()Ljava/lang/String;", ClassFile::acc_public, stringToString);
+
+  RuntimeClass* throwable = builtIn("java/lang/Throwable", "java/lang/Object");
+  message_offset = throwable->addField("detailMessage", "Ljava/lang/String;", ClassFile::acc_private);
+  throwable->addMethod("<init>", "()V", ClassFile::acc_public, objectInit);
+  throwable->addMethod("<init>", "(Ljava/lang/String;)V", ClassFile::acc_public, throwableInitMessage);
+  throwable->addMethod("getMessage", "()Ljava/lang/String;", ClassFile::acc_public, throwableGetMessage);
+  // Constructors aren't inherited, but method resolution finds Throwable's for its subclasses
+  static const char* const throwables[][2] = {
+    {"java/lang/Exception", "java/lang/Throwable"},
+    {"java/lang/Error", "java/lang/Throwable"},
+    {"java/lang/RuntimeException", "java/lang/Exception"},
+    {"java/lang/ArithmeticException", "java/lang/RuntimeException"},
+    {"java/lang/ArrayStoreException", "java/lang/RuntimeException"},
+    {"java/lang/ClassCastException", "java/lang/RuntimeException"},
+    {"java/lang/IllegalArgumentException", "java/lang/RuntimeException"},
+    {"java/lang/IllegalStateException", "java/lang/RuntimeException"},
+    {"java/lang/IndexOutOfBoundsException", "java/lang/RuntimeException"},
+    {"java/lang/ArrayIndexOutOfBoundsException", "java/lang/IndexOutOfBoundsException"},
+    {"java/lang/NegativeArraySizeException", "java/lang/RuntimeException"},
+    {"java/lang/NullPointerException", "java/lang/RuntimeException"},
+    {"java/lang/UnsupportedOperationException", "java/lang/RuntimeException"},
+    {"java/lang/LinkageError", "java/lang/Error"},
+    {"java/lang/NoClassDefFoundError", "java/lang/LinkageError"},
+    {"java/lang/VirtualMachineError", "java/lang/Error"},
+    {"java/lang/OutOfMemoryError", "java/lang/VirtualMachineError"},
+    {"java/lang/StackOverflowError", "java/lang/VirtualMachineError"}};
+  for (auto& t : throwables)
+    builtIn(t[0], t[1]);
+
+  RuntimeClass* print_stream = builtIn("java/io/PrintStream", "java/lang/Object");
+  print_stream->reserveInstanceSpace(sizeof(std::ostream*), alignof(std::ostream*));
+  print_stream->addMethod("print", "(Ljava/lang/String;)V", ClassFile::acc_public, printString);
+  print_stream->addMethod("print", "(Ljava/lang/Object;)V", ClassFile::acc_public, printString);
+  print_stream->addMethod("print", "(I)V", ClassFile::acc_public, printInt);
+  print_stream->addMethod("print", "(J)V", ClassFile::acc_public, printLong);
+  print_stream->addMethod("print", "(Z)V", ClassFile::acc_public, printBoolean);
+  print_stream->addMethod("print", "(C)V", ClassFile::acc_public, printChar);
+  print_stream->addMethod("print", "(F)V", ClassFile::acc_public, printFloat);
+  print_stream->addMethod("print", "(D)V", ClassFile::acc_public, printDouble);
+  print_stream->addMethod("println", "()V", ClassFile::acc_public, println);
+  print_stream->addMethod("println", "(Ljava/lang/String;)V", ClassFile::acc_public, printLine<printString>);
+  print_stream->addMethod("println", "(Ljava/lang/Object;)V", ClassFile::acc_public, printLine<printString>);
+  print_stream->addMethod("println", "(I)V", ClassFile::acc_public, printLine<printInt>);
+  print_stream->addMethod("println", "(J)V", ClassFile::acc_public, printLine<printLong>);
+  print_stream->addMethod("println", "(Z)V", ClassFile::acc_public, printLine<printBoolean>);
+  print_stream->addMethod("println", "(C)V", ClassFile::acc_public, printLine<printChar>);
+  print_stream->addMethod("println", "(F)V", ClassFile::acc_public, printLine<printFloat>);
+  print_stream->addMethod("println", "(D)V", ClassFile::acc_public, printLine<printDouble>);
+
+  RuntimeClass* system = builtIn("java/lang/System", "java/lang/Object",
+                                 static_cast<ClassFile::access_flags>(ClassFile::acc_public | ClassFile::acc_final));
+  u4 out_offset = system->addField("out", "Ljava/io/PrintStream;", public_static);
+  u4 err_offset = system->addField("err", "Ljava/io/PrintStream;", public_static);
+  system->addMethod("nanoTime", "()J", public_static, systemNanoTime);
+  system->addMethod("currentTimeMillis", "()J", public_static, systemCurrentTimeMillis);
+  system->addMethod("arraycopy", "(Ljava/lang/Object;ILjava/lang/Object;II)V", public_static, systemArraycopy);
+  Object* system_out = allocate(print_stream);
+  system_out->at<std::ostream*>(stream_offset) = &out;
+  *reinterpret_cast<Object**>(system->getStatics() + out_offset) = system_out;
+  Object* system_err = allocate(print_stream);
+  system_err->at<std::ostream*>(stream_offset) = &std::cerr;
+  *reinterpret_cast<Object**>(system->getStatics() + err_offset) = system_err;
+
+  out_of_memory = allocate(findClass("java/lang/OutOfMemoryError"));
+  out_of_memory->at<Object*>(message_offset) = intern(Symbol::intern(JUtf8String("Java heap space")));
+}
+
+RuntimeClass* VirtualMachine::findClass(const Symbol& name)
+{
+  auto found = classes.find(name);
+  if (found != classes.end())
+    return found->second.get();
+
+  auto view = name.view();
+  if (view.size() >= 2 && view[0] == '[')
+  {
+    RuntimeClass* component = nullptr;
+    if (view[1] == 'L' && view.size() > 3 && view[view.size() - 1] == ';')
+      component = findClass(Symbol::intern(parsing::ByteView(view.data() + 2, view.size() - 3)));
+    else if (view[1] == '[')
+      component = findClass(Symbol::intern(parsing::ByteView(view.data() + 1, view.size() - 1)));
+    else if (view.size() != 2 || !std::strchr("ZBCSIFJD", view[1]))
+      throw std::runtime_error("NoClassDefFoundError: " + name.str());
+    std::unique_ptr<RuntimeClass> array(new RuntimeClass(name, findClass("java/lang/Object"), component));
+    RuntimeClass* created = array.get();
+    classes.emplace(name, std::move(array));
+    return created;
+  }
+
+  if (std::find(loading.begin(), loading.end(), name) != loading.end())
+    throw std::runtime_error("ClassCircularityError: " + name.str());
+  auto file = class_path.find(name.str());
+  if (!file)
+    throw std::runtime_error("NoClassDefFoundError: " + name.str());
+  return link(std::move(file), name);
+}
+
+RuntimeClass* VirtualMachine::define(std::shared_ptr<const ClassFile> file)
+{
+  auto& cp = file->getConstantPool();
+  Symbol name = cp.getSymbol(cp.get<const ConstantPool::Class_info>(file->getThisClass()).name_index);
+  if (classes.count(name))
+    throw std::runtime_error("LinkageError: duplicate class definition for " + name.str());
+  return link(std::move(file), name);
+}
+
+RuntimeClass* VirtualMachine::link(std::shared_ptr<const ClassFile> file, const Symbol& name)
+{
+  auto& cp = file->getConstantPool();
+  auto className = [&cp](u2 index) {
+    return cp.getSymbol(cp.get<const ConstantPool::Class_info>(index).name_index);
+  };
+  if (className(file->getThisClass()) != name)
+    throw std::runtime_error("NoClassDefFoundError: " + name.str() + " (wrong name: "
+                             + className(file->getThisClass()).str() + ")");
+  if (file->getSuperClass() == 0)
+    throw std::runtime_error("ClassFormatError: " + name.str() + " has no superclass");
+
+  loading.push_back(name);
+  RuntimeClass* super;
+  std::vector<RuntimeClass*> interfaces;
+  try
+  {
+    super = findClass(className(file->getSuperClass()));
+    for (u2 index : file->getInterfaces())
+      interfaces.push_back(findClass(className(index)));
+  }
+  catch (...)
+  {
+    loading.pop_back();
+    throw;
+  }
+  loading.pop_back();
+
+  if (super->isInterface() || super->isArray() || (super->getAccessFlags() & ClassFile::acc_final))
+    throw std::runtime_error("IncompatibleClassChangeError: " + name.str() + " can't extend "
+                             + super->getName().str());
+  for (auto interface : interfaces)
+  {
+    if (!interface->isInterface())
+      throw std::runtime_error("IncompatibleClassChangeError: " + name.str() + " can't implement "
+                               + interface->getName().str());
+  }
+  std::unique_ptr<RuntimeClass> clazz(new RuntimeClass(std::move(file), super, std::move(interfaces)));
+  RuntimeClass* created = clazz.get();
+  classes.emplace(name, std::move(clazz));
+  return created;
+}
+
+void* VirtualMachine::allocateZeroed(std::size_t size)
+{
+  void* p = heap.allocate(size);
+  if (!p)
+  {
+    if (!out_of_memory)
+      throw std::runtime_error("OutOfMemoryError: the heap is too small for the built in classes");
+    throw Interpreter::thrown{out_of_memory};
+  }
+  return p;
+}
+
+Object* VirtualMachine::allocate(RuntimeClass* clazz)
+{
+  auto object = static_cast<Object*>(allocateZeroed(clazz->getInstanceSize()));
+  object->clazz = clazz;
+  return object;
+}
+
+Array* VirtualMachine::allocateArray(RuntimeClass* clazz, s4 length)
+{
+  if (length < 0)
+    raise("java/lang/NegativeArraySizeException", std::to_string(length));
+  auto array = static_cast<Array*>(allocateZeroed(sizeof(Array) + std::size_t(length) * clazz->getElementSize()));
+  array->clazz = clazz;
+  array->length = length;
+  return array;
+}
+
+Object* VirtualMachine::intern(const Symbol& text)
+{
+  auto found = strings.find(text);
+  if (found != strings.end())
+    return found->second;
+  auto str = static_cast<StringObject*>(allocate(string_class));
+  auto inserted = strings.emplace(text, str).first;
+  str->value = &inserted->first;
+  return str;
+}
+
+void VirtualMachine::raise(const char* class_name, const std::string& message)
+{
+  Object* exception = allocate(findClass(class_name));
+  if (!message.empty())
+    exception->at<Object*>(message_offset) = intern(Symbol::intern(JUtf8String(message)));
+  throw Interpreter::thrown{exception};
+}
+
+std::string VirtualMachine::describe(Object* throwable)
+{
+  std::string description = javaName(throwable->clazz->getName());
+  Object* message = throwable->at<Object*>(message_offset);
+  if (message)
+    description += ": " + toString(*this, message);
+  return description;
+}
+
+int VirtualMachine::runMain(const std::string& main_class, const std::vector<std::string>& args,
+                            Interpreter::dispatch mode)
+{
+  std::string name(main_class);
+  std::replace(name.begin(), name.end(), '.', '/');
+  RuntimeClass* clazz = findClass(name);
+  auto main = clazz->findDeclaredMethod(Symbol::intern(JUtf8String("main")),
+                                        Symbol::intern(JUtf8String("([Ljava/lang/String;)V")));
+  if (!main || (main->flags & public_static) != public_static)
+    throw std::runtime_error("NoSuchMethodError: " + name + " has no public static void main(String[])");
+  Array* arguments = allocateArray(findClass("[Ljava/lang/String;"), static_cast<s4>(args.size()));
+  for (std::size_t i = 0; i < args.size(); i++)
+    arguments->elements<Object*>()[i] = intern(Symbol::intern(JUtf8String(args[i])));
+
+  Interpreter interpreter(*this, mode);
+  slot argument;
+  argument.a = arguments;
+  try
+  {
+    interpreter.call(*main, {argument});
+  }
+  catch (Interpreter::thrown& t)
+  {
+    out.flush();
+    std::cerr << "Exception in thread \"main\" " << describe(t.exception) << std::endl;
+    return 1;
+  }
+  out.flush();
+  return 0;
+}
+
+void VirtualMachine::dumpCallSites(std::ostream& stream) const
+{
+  std::vector<const RuntimeClass*> sorted;
+  for (auto& entry : classes)
+    sorted.push_back(entry.second.get());
+  std::sort(sorted.begin(), sorted.end(), [](const RuntimeClass* a, const RuntimeClass* b) {
+    return a->getName().str() < b->getName().str();
+  });
+  for (auto clazz : sorted)
+  {
+    for (auto& method : clazz->getMethods())
+    {
+      if (!method.call_sites)
+        continue;
+      auto& code = *method.code;
+      for (u4 i = 0; i < code.size(); i++)
+      {
+        if (code[i].op != Bytecode::op_invokevirtual && code[i].op != Bytecode::op_invokeinterface)
+          continue;
+        auto& site = method.call_sites[code[i].value];
+        if (site.hits == 0 && site.misses == 0)
+          continue;
+        // A call site that has run has resolved its method
+        auto target = clazz->getResolvedReferences().get<const RuntimeClass::method>(code[i].index);
+        stream << clazz->getName().str() << "." << method.name.str() << method.descriptor.str() << " pc "
+               << code.pcOf(i) << " " << Bytecode::name(code[i].op) << " " << target->owner->getName().str()
+               << "." << target->name.str() << target->descriptor.str() << ": "
+               << (site.megamorphic ? "megamorphic" : site.cached == 1 ? "monomorphic" : "polymorphic") << ", "
+               << site.hits << " hits, " << site.misses << " misses, receivers";
+        for (u1 r = 0; r < site.cached; r++)
+          stream << " " << site.receivers[r]->getName().str();
+        stream << std::endl;
+      }
+    }
+  }
+}
+
+}
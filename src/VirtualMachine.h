@@ -0,0 +1,173 @@
+/**
+ * \file VirtualMachine.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_MIMIC_VIRTUALMACHINE_H_
+#define SRC_MIMIC_VIRTUALMACHINE_H_
+
+#include "Common.h"
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include "ClassPath.h"
+#include "Heap.h"
+#include "Interpreter.h"
+#include "Object.h"
+#include "RuntimeClass.h"
+
+namespace mimic
+{
+
+/**
+ * The classes loaded so far, the heap, and the few parts of the Java class
+ * library that are built in
+ *
+ * There's no class library yet, so java/lang/Object, String, System, Throwable
+ * and the exceptions the virtual machine throws itself, along with
+ * java/io/PrintStream, are provided by the virtual machine with native
+ * methods. They take precedence over classes of the same name on the class
+ * path. System.out writes to the stream given to the constructor.
+ *
+ * Objects are allocated from a Heap and never freed until the virtual
+ * machine is destroyed. When the heap is full a preallocated
+ * java/lang/OutOfMemoryError is thrown.
+ *
+ * Not safe to use from more than one thread, other than to allocate.
+ */
+class VirtualMachine
+{
+public:
+  /**
+   * @param class_path where to load classes from
+   * @param out where System.out writes to
+   * @param heap_size the size of the heap in bytes
+   * @param tlab_size the size of each thread's allocation buffers in bytes
+   * @throws runtime_error if the heap can't be reserved, or is too small for
+   *         the built in classes' objects
+   */
+  explicit VirtualMachine(ClassPath class_path = ClassPath(), std::ostream& out = std::cout,
+                          std::size_t heap_size = Heap::default_max_size,
+                          std::size_t tlab_size = Heap::default_tlab_size);
+
+  VirtualMachine(const VirtualMachine&) = delete;
+  VirtualMachine& operator=(const VirtualMachine&) = delete;
+
+  /**
+   * Finds a class, loading and linking it and its superclasses if need be
+   *
+   * @param name the class' binary name, e.g. java/lang/Object or [I
+   * @return the class
+   * @throws runtime_error if the class can't be found, parsed or linked
+   */
+  RuntimeClass* findClass(const Symbol& name);
+  RuntimeClass* findClass(const std::string& name) { return findClass(Symbol::intern(JUtf8String(name))); };
+
+  /**
+   * Links a class that isn't on the class path
+   *
+   * @param file the class
+   * @return the class
+   * @throws runtime_error if a class of the same name is already loaded, or
+   *         the class can't be linked
+   */
+  RuntimeClass* define(std::shared_ptr<const ClassFile> file);
+
+  /**
+   * @param clazz a class that isn't abstract
+   * @return a new instance with its fields zeroed
+   * @throws Interpreter::thrown OutOfMemoryError if the heap is full
+   */
+  Object* allocate(RuntimeClass* clazz);
+
+  /**
+   * @param clazz an array class
+   * @param length the number of elements
+   * @return a new array with its elements zeroed
+   * @throws Interpreter::thrown NegativeArraySizeException if length is
+   *         negative, or OutOfMemoryError if the heap is full
+   */
+  Array* allocateArray(RuntimeClass* clazz, s4 length);
+
+  /**
+   * @param text the string's text
+   * @return the java/lang/String with the text, which is the same object
+   *         every time for the same text
+   */
+  Object* intern(const Symbol& text);
+
+  /**
+   * Throws one of the built in exceptions
+   *
+   * @param class_name the exception's class, e.g. java/lang/ArithmeticException
+   * @param message the exception's detail message, or empty for none
+   * @throws Interpreter::thrown always
+   */
+  [[noreturn]] void raise(const char* class_name, const std::string& message = std::string());
+
+  /**
+   * @param throwable a java/lang/Throwable
+   * @return the exception's class name and detail message, as Java prints them
+   */
+  std::string describe(Object* throwable);
+
+  /**
+   * Runs a class' public static void main(String[]) method. An exception
+   * thrown out of main is printed to std::cerr.
+   *
+   * @param main_class the class' binary or fully qualified name
+   * @param args the arguments to pass to main
+   * @param mode how the interpreter should dispatch instructions
+   * @return 0 if main returned normally, 1 if it threw an exception
+   * @throws runtime_error if main can't be found, or a class can't be linked
+   */
+  int runMain(const std::string& main_class, const std::vector<std::string>& args,
+              Interpreter::dispatch mode = Interpreter::dispatch_threaded);
+
+  /**
+   * Writes out the inline cache of every invokevirtual and invokeinterface
+   * that has run: its state, hit and miss counts and the receiver classes it
+   * has cached, one call site per line
+   *
+   * @param stream where to write
+   */
+  void dumpCallSites(std::ostream& stream) const;
+
+  std::ostream& getOut() const { return out; };
+  const ClassPath& getClassPath() const { return class_path; };
+  const Heap& getHeap() const { return heap; };
+
+  /** @return the offset of Throwable's detail message */
+  u4 getMessageOffset() const { return message_offset; };
+
+private:
+  ClassPath class_path;
+  std::ostream& out;
+  std::unordered_map<Symbol, std::unique_ptr<RuntimeClass>> classes;
+  /** Classes being loaded, to catch circular inheritance */
+  std::vector<Symbol> loading;
+  std::unordered_map<Symbol, StringObject*> strings;
+  Heap heap;
+  RuntimeClass* string_class;
+  u4 message_offset;
+  /** Thrown when the heap is full, as there would be no room to allocate it then */
+  Object* out_of_memory;
+
+  /**
+   * Creates one of the built in classes
+   *
+   * @param name the class' binary name
+   * @param super the superclass' binary name, or nullptr for java/lang/Object
+   */
+  RuntimeClass* builtIn(const char* name, const char* super,
+                        ClassFile::access_flags flags = ClassFile::acc_public);
+  void defineBuiltIns();
+  RuntimeClass* link(std::shared_ptr<const ClassFile> file, const Symbol& name);
+  void* allocateZeroed(std::size_t size);
+};
+
+}
+
+#endif /* SRC_MIMIC_VIRTUALMACHINE_H_ */
@@ -0,0 +1,77 @@
+/**
+ * \file AttributeParser_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "AttributeParser.h"
+#include "ClassFile.h"
+
+namespace mimic
+{
+
+namespace
+{
+/** Recognises an attribute name by comparing it with each known name in turn */
+AttributeParser::kind compareEachName(const JUtf8String& name)
+{
+  static const std::vector<std::pair<JUtf8String, AttributeParser::kind>> known = []() {
+    std::vector<std::pair<JUtf8String, AttributeParser::kind>> names;
+    for (u1 k = AttributeParser::attr_constant_value; k <= AttributeParser::attr_method_parameters; k++)
+    {
+      auto kind = static_cast<AttributeParser::kind>(k);
+      names.emplace_back(AttributeParser::nameOf(kind).string(), kind);
+    }
+    return names;
+  }();
+  for (auto& entry : known)
+  {
+    if (entry.first == name)
+      return entry.second;
+  }
+  return AttributeParser::attr_unknown;
+}
+}
+
+MIMIC_BENCHMARK(AttributeParserNames)
+{
+  // Every string of every class, some of which are attribute names
+  std::vector<Symbol> names;
+  std::vector<JUtf8String> strings;
+  for (auto& path : bench::classFiles())
+  {
+    ClassFile clazz(path);
+    auto& cp = clazz.getConstantPool();
+    for (u2 i = 1; i < cp.size(); i++)
+    {
+      if (cp.getType(i) < ConstantPool::cp_utf8)
+        continue;
+      names.push_back(cp.getSymbol(i));
+      strings.push_back(names.back().string());
+    }
+  }
+  std::cout << names.size() << " strings" << std::endl;
+
+  bench::measure("comparing with each known name", 0, [&strings]() {
+    std::size_t known = 0;
+    for (auto& str : strings)
+      known += compareEachName(str) != AttributeParser::attr_unknown;
+    bench::keep(known);
+  });
+  bench::measure("perfect hash of the bytes", 0, [&names]() {
+    std::size_t known = 0;
+    for (auto& name : names)
+      known += AttributeParser::kindOf(name.view()) != AttributeParser::attr_unknown;
+    bench::keep(known);
+  });
+  bench::measure("perfect hash of the symbol", 0, [&names]() {
+    std::size_t known = 0;
+    for (auto& name : names)
+      known += AttributeParser::kindOf(name) != AttributeParser::attr_unknown;
+    bench::keep(known);
+  });
+}
+
+}
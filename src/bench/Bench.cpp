@@ -0,0 +1,128 @@
+/**
+ * \file Bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include <chrono>
+#include "ClassFileLoader.h"
+
+namespace mimic
+{
+namespace bench
+{
+
+namespace
+{
+/** How long to keep repeating each measurement for */
+const std::chrono::milliseconds min_time(250);
+
+struct benchmark
+{
+  const char* name;
+  void (*function)();
+};
+
+std::vector<benchmark>& benchmarks()
+{
+  static std::vector<benchmark> all;
+  return all;
+}
+
+std::vector<fs::path> class_files;
+
+void addClassFiles(const fs::path& path)
+{
+  if (fs::is_directory(path))
+  {
+    auto found = ClassFileLoader::findClassFiles(path);
+    class_files.insert(class_files.end(), found.begin(), found.end());
+  }
+  else
+  {
+    class_files.push_back(path);
+  }
+}
+
+/**
+ * Runs the work repeatedly until enough time has passed, and prints the name,
+ * runs and time per run
+ *
+ * @return the time per run in nanoseconds
+ */
+double timeRuns(const std::string& name, const std::function<void()>& work)
+{
+  typedef std::chrono::steady_clock clock;
+  // Warm up caches and anything initialised on first use
+  work();
+  u8 runs = 1;
+  clock::duration elapsed;
+  for (;;)
+  {
+    auto start = clock::now();
+    for (u8 i = 0; i < runs; i++)
+      work();
+    elapsed = clock::now() - start;
+    if (elapsed >= min_time)
+      break;
+    runs *= 2;
+  }
+  double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count() / runs;
+  std::cout << std::left << std::setw(48) << name << std::right << std::setw(12) << runs << " runs"
+            << std::fixed << std::setprecision(1) << std::setw(14) << nanoseconds << " ns/run";
+  return nanoseconds;
+}
+}
+
+Registration::Registration(const char* name, void (*function)())
+{
+  benchmarks().push_back(benchmark{name, function});
+}
+
+void measure(const std::string& name, std::size_t bytes, const std::function<void()>& work)
+{
+  double nanoseconds = timeRuns(name, work);
+  if (bytes != 0)
+    std::cout << std::setw(10) << (bytes / nanoseconds) * 1e9 / (1 << 20) << " MiB/s";
+  std::cout << std::endl;
+}
+
+void measure(const std::string& name, std::size_t count, const char* unit, const std::function<void()>& work)
+{
+  double nanoseconds = timeRuns(name, work);
+  std::cout << std::setw(10) << (count / nanoseconds) * 1e3 << " M" << unit << "/s" << std::endl;
+}
+
+const std::vector<fs::path>& classFiles()
+{
+  return class_files;
+}
+
+int run(int argc, char** argv)
+{
+  std::string filter;
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if (arg.compare(0, 9, "--filter=") == 0)
+      filter = arg.substr(9);
+    else
+      addClassFiles(fs::path(arg));
+  }
+  if (class_files.empty())
+    addClassFiles(fs::path("src/test/resources"));
+  std::cout << class_files.size() << " class files" << std::endl;
+  for (auto& b : benchmarks())
+  {
+    if (std::string(b.name).find(filter) == std::string::npos)
+      continue;
+    std::cout << "== " << b.name << std::endl;
+    b.function();
+  }
+  return 0;
+}
+
+}
+}
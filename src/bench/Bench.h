@@ -0,0 +1,89 @@
+/**
+ * \file Bench.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_BENCH_BENCH_H_
+#define SRC_BENCH_BENCH_H_
+
+#include <functional>
+#include <string>
+#include "Common.h"
+
+namespace mimic
+{
+namespace bench
+{
+
+/**
+ * Registers a benchmark function to be run by mimicbench. Use through the
+ * MIMIC_BENCHMARK macro.
+ */
+class Registration
+{
+public:
+  Registration(const char* name, void (*function)());
+};
+
+/**
+ * Times a piece of work, running it repeatedly until enough time has passed
+ * to give a stable figure, and prints the time per run
+ *
+ * @param name what is being measured
+ * @param bytes the number of bytes processed by each run, used to report
+ *        throughput, or 0 if throughput doesn't apply
+ * @param work the work to time
+ */
+void measure(const std::string& name, std::size_t bytes, const std::function<void()>& work);
+
+/**
+ * Times a piece of work like measure(), reporting how many of something it
+ * got through per second rather than its throughput in bytes
+ *
+ * @param name what is being measured
+ * @param count the number of items each run processes
+ * @param unit what the items are, e.g. "bytecodes"
+ * @param work the work to time
+ */
+void measure(const std::string& name, std::size_t count, const char* unit, const std::function<void()>& work);
+
+/**
+ * @return the class files given on the command line, or found under the
+ *         directories given on the command line. Defaults to the classes in
+ *         the test resources.
+ */
+const std::vector<fs::path>& classFiles();
+
+/**
+ * Prevents the compiler optimising away a value which is otherwise unused
+ */
+template <typename T> void keep(const T& value)
+{
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * Runs the registered benchmarks
+ *
+ * @param argc the number of arguments
+ * @param argv class files or directories to use, and optionally
+ *        --filter=text to only run benchmarks whose names contain text
+ * @return the exit status
+ */
+int run(int argc, char** argv);
+
+}
+}
+
+/**
+ * Defines a benchmark. The body should call bench::measure() for each figure
+ * it reports.
+ */
+#define MIMIC_BENCHMARK(name) \
+  static void name(); \
+  static ::mimic::bench::Registration name##_registration(#name, name); \
+  static void name()
+
+#endif /* SRC_BENCH_BENCH_H_ */
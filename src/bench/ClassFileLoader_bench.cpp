@@ -0,0 +1,52 @@
+/**
+ * \file ClassFileLoader_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "ClassFileLoader.h"
+
+namespace mimic
+{
+
+MIMIC_BENCHMARK(ClassFileLoaderLoad)
+{
+  auto& paths = bench::classFiles();
+  std::size_t bytes = 0;
+  for (auto& path : paths)
+    bytes += fs::file_size(path);
+  ClassFileLoader parallel;
+  std::cout << paths.size() << " classes, " << bytes << " bytes, " << parallel.getThreads() << " threads"
+            << std::endl;
+
+  for (auto decoding : { ConstantPool::eager, ConstantPool::lazy })
+  {
+    const char* mode = decoding == ConstantPool::eager ? "eager" : "lazy";
+    ClassFileLoader single(1, decoding);
+    bench::measure(std::string("1 thread, ") + mode, bytes, [&single, &paths]() {
+      bench::keep(single.load(paths));
+    });
+    ClassFileLoader pool(parallel.getThreads(), decoding);
+    bench::measure(std::to_string(pool.getThreads()) + " threads, " + mode, bytes, [&pool, &paths]() {
+      bench::keep(pool.load(paths));
+    });
+    auto report = pool.load(paths);
+    std::cout << "  " << report.loaded << " loaded, " << report.failed << " failed, " << std::fixed
+              << std::setprecision(0) << report.classesPerSecond() << " classes/s" << std::endl;
+  }
+  ClassArchive::Writer writer;
+  for (auto& path : paths)
+    writer.add(parsing::MappedFile(path).view());
+  fs::path archive = fs::temp_directory_path() / "mimicbench.jsa";
+  writer.write(archive);
+  ClassFileLoader archived(parallel.getThreads());
+  archived.setArchive(ClassArchive::open(archive));
+  bench::measure(std::to_string(archived.getThreads()) + " threads, from archive", bytes, [&archived, &paths]() {
+    bench::keep(archived.load(paths));
+  });
+  fs::remove(archive);
+}
+
+}
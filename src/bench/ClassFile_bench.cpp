@@ -0,0 +1,61 @@
+/**
+ * \file ClassFile_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "ClassFile.h"
+
+namespace mimic
+{
+
+namespace
+{
+/**
+ * Looks up the name and descriptor of every method, the way tooling that
+ * lists a class's methods would
+ */
+std::size_t walkMethods(const ConstantPool& cp, const std::vector<ClassFile::method_info>& methods)
+{
+  std::size_t bytes = 0;
+  for (auto& method : methods)
+  {
+    bytes += cp.getSymbol(method.name_index).size();
+    bytes += cp.getSymbol(method.descriptor_index).size();
+  }
+  return bytes;
+}
+}
+
+MIMIC_BENCHMARK(ClassFileWalkMethods)
+{
+  std::vector<ClassFile> classes;
+  std::size_t methods = 0;
+  for (auto& path : bench::classFiles())
+  {
+    classes.emplace_back(path, ConstantPool::lazy);
+    methods += classes.back().getMethodsCount();
+  }
+  std::cout << classes.size() << " classes, " << methods << " methods" << std::endl;
+
+  bench::measure("copying the pool and methods, as accessors used to", 0, [&classes]() {
+    std::size_t bytes = 0;
+    for (auto& clazz : classes)
+    {
+      ConstantPool cp = clazz.getConstantPool();
+      std::vector<ClassFile::method_info> methods = clazz.getMethods();
+      bytes += walkMethods(cp, methods);
+    }
+    bench::keep(bytes);
+  });
+  bench::measure("through const references", 0, [&classes]() {
+    std::size_t bytes = 0;
+    for (auto& clazz : classes)
+      bytes += walkMethods(clazz.getConstantPool(), clazz.getMethods());
+    bench::keep(bytes);
+  });
+}
+
+}
@@ -0,0 +1,160 @@
+/**
+ * \file ClassValidator_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "ClassFile.h"
+#include "ClassValidator.h"
+
+namespace mimic
+{
+
+namespace
+{
+/**
+ * Checks the references of member, NameAndType, Class and String entries by
+ * comparing the results of getType(), the way the validator used to
+ */
+std::size_t checkWithGetType(const ConstantPool& cp)
+{
+  std::size_t invalid = 0;
+  for (u2 i = 1; i < cp.size(); i++)
+  {
+    switch (cp.getType(i))
+    {
+    case ConstantPool::cp_fieldref:
+    {
+      auto info = cp.get<const ConstantPool::Fieldref_info>(i);
+      if (cp.getType(info.class_index) != ConstantPool::cp_class
+          || cp.getType(info.name_and_type_index) != ConstantPool::cp_nameAndType)
+        invalid++;
+      break;
+    }
+    case ConstantPool::cp_methodref:
+    {
+      auto info = cp.get<const ConstantPool::Methodref_info>(i);
+      if (cp.getType(info.class_index) != ConstantPool::cp_class
+          || cp.getType(info.name_and_type_index) != ConstantPool::cp_nameAndType)
+        invalid++;
+      break;
+    }
+    case ConstantPool::cp_interfaceMethodref:
+    {
+      auto info = cp.get<const ConstantPool::InterfaceMethodref_info>(i);
+      if (cp.getType(info.class_index) != ConstantPool::cp_class
+          || cp.getType(info.name_and_type_index) != ConstantPool::cp_nameAndType)
+        invalid++;
+      break;
+    }
+    case ConstantPool::cp_nameAndType:
+    {
+      auto info = cp.get<const ConstantPool::NameAndType_info>(i);
+      auto descriptor = cp.getType(info.descriptor_index);
+      if (cp.getType(info.name_index) == ConstantPool::cp_tag
+          || (descriptor != ConstantPool::cp_fieldDescriptor && descriptor != ConstantPool::cp_methodDescriptor))
+        invalid++;
+      break;
+    }
+    case ConstantPool::cp_class:
+    {
+      auto type = cp.getType(cp.get<const ConstantPool::Class_info>(i).name_index);
+      if (type != ConstantPool::cp_utf8 && type != ConstantPool::cp_fieldDescriptor)
+        invalid++;
+      break;
+    }
+    case ConstantPool::cp_string:
+      if (cp.getType(cp.get<const ConstantPool::String_info>(i).string_index) < ConstantPool::cp_utf8)
+        invalid++;
+      break;
+    default:
+      break;
+    }
+  }
+  return invalid;
+}
+
+/** Checks a class name the way the validator used to, by searching for each invalid character */
+bool legacyIsClassName(const JUtf8String& str)
+{
+  static const JUtf8String dot(".");
+  static const std::vector<JUtf8String> invalid = {JUtf8String(";"), JUtf8String("[")};
+  static const JUtf8String empty_identifier("//");
+  if (str.size() == 0 || str.contains(dot) || str.contains(invalid))
+    return false;
+  auto bytes = str.view();
+  return bytes[0] != '/' && bytes[bytes.size() - 1] != '/' && !str.contains(empty_identifier);
+}
+}
+
+MIMIC_BENCHMARK(ClassValidatorConstantPool)
+{
+  std::vector<ClassFile> classes;
+  std::size_t entries = 0;
+  for (auto& path : bench::classFiles())
+  {
+    classes.emplace_back(path);
+    entries += classes.back().getConstantPool().size();
+  }
+  std::cout << classes.size() << " classes, " << entries << " constant pool entries" << std::endl;
+
+  bench::measure("checking references with getType()", 0, [&classes]() {
+    std::size_t invalid = 0;
+    for (auto& clazz : classes)
+      invalid += checkWithGetType(clazz.getConstantPool());
+    bench::keep(invalid);
+  });
+  bench::measure("ClassValidator::checkConstantPool", 0, [&classes]() {
+    std::size_t invalid = 0;
+    for (auto& clazz : classes)
+      invalid += ClassValidator::checkConstantPool(clazz.getConstantPool(), clazz.getMajorVersion(),
+                                                   clazz.getMinorVersion()).size();
+    bench::keep(invalid);
+  });
+}
+
+MIMIC_BENCHMARK(ClassValidatorNames)
+{
+  // Every class name in every class, as each class would validate them
+  std::vector<Symbol> names;
+  std::size_t bytes = 0;
+  for (auto& path : bench::classFiles())
+  {
+    ClassFile clazz(path);
+    auto& cp = clazz.getConstantPool();
+    for (u2 i = 1; i < cp.size(); i++)
+    {
+      if (cp.getType(i) != ConstantPool::cp_class)
+        continue;
+      u2 name_index = cp.get<const ConstantPool::Class_info>(i).name_index;
+      if (cp.getType(name_index) != ConstantPool::cp_utf8)
+        continue;
+      names.push_back(cp.getSymbol(name_index));
+      bytes += names.back().size();
+    }
+  }
+  std::cout << names.size() << " class names" << std::endl;
+
+  bench::measure("searching for each invalid character", bytes, [&names]() {
+    std::size_t valid = 0;
+    for (auto& name : names)
+      valid += legacyIsClassName(name.string());
+    bench::keep(valid);
+  });
+  bench::measure("byte class table", bytes, [&names]() {
+    std::size_t valid = 0;
+    for (auto& name : names)
+      valid += ClassValidator::isValidClassOrInterfaceName(name.string());
+    bench::keep(valid);
+  });
+  bench::measure("remembered on the symbol", bytes, [&names]() {
+    std::size_t valid = 0;
+    for (auto& name : names)
+      valid += ClassValidator::isValidClassOrInterfaceName(name);
+    bench::keep(valid);
+  });
+}
+
+}
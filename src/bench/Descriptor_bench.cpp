@@ -0,0 +1,188 @@
+/**
+ * \file Descriptor_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "ClassFile.h"
+#include "MethodDescriptor.h"
+
+namespace mimic
+{
+
+namespace
+{
+/**
+ * Descriptors typical of library code, used alongside any in the class files
+ */
+const char* const typical[] = {
+  "I", "J", "Z", "[B", "[C", "Ljava/lang/String;", "Ljava/lang/Object;", "[Ljava/lang/Object;",
+  "Ljava/util/Map;", "Ljava/util/concurrent/ConcurrentHashMap$Node;", "()V", "(I)V", "()I",
+  "()Ljava/lang/String;", "(Ljava/lang/Object;)Z", "(Ljava/lang/String;I)Ljava/lang/String;",
+  "([BII)V", "(Ljava/lang/Object;Ljava/lang/Object;)Ljava/lang/Object;",
+  "(Ljava/lang/invoke/MethodHandles$Lookup;Ljava/lang/String;Ljava/lang/invoke/MethodType;"
+  "Ljava/lang/invoke/MethodType;Ljava/lang/invoke/MethodHandle;Ljava/lang/invoke/MethodType;)"
+  "Ljava/lang/invoke/CallSite;",
+  "(IJLjava/lang/String;[DZ)[[J"};
+
+/**
+ * The field descriptor parser as it was before it worked on bytes, for
+ * comparison. It names primitives with new strings, copies the class name
+ * out of the descriptor, then interns it.
+ */
+bool legacyField(const JUtf8String& str, Symbol& class_name)
+{
+  JUtf8String name;
+  u1 dimensions = 0;
+  bool complete = false;
+  for (auto i = str.begin(); i != str.end(); ++i)
+  {
+    if (complete)
+      return false;
+    complete = true;
+    switch (*i)
+    {
+    case 'B': name = JUtf8String("byte"); break;
+    case 'C': name = JUtf8String("char"); break;
+    case 'D': name = JUtf8String("double"); break;
+    case 'F': name = JUtf8String("float"); break;
+    case 'I': name = JUtf8String("int"); break;
+    case 'J': name = JUtf8String("long"); break;
+    case 'S': name = JUtf8String("short"); break;
+    case 'Z': name = JUtf8String("boolean"); break;
+    case 'L':
+    {
+      auto start = i;
+      ++start;
+      auto end = start;
+      while (end != str.end() && *end != ';')
+        ++end;
+      if (end == str.end() || end == start)
+        return false;
+      name = JUtf8String(start, end);
+      i = end;
+      break;
+    }
+    case '[':
+      dimensions++;
+      complete = false;
+      break;
+    default:
+      return false;
+    }
+  }
+  if (!complete)
+    return false;
+  std::vector<u1> bytes = name.getBytes();
+  for (int i = 0; i < dimensions; i++)
+  {
+    bytes.push_back('[');
+    bytes.push_back(']');
+  }
+  class_name = Symbol::intern(parsing::ByteView(bytes));
+  return true;
+}
+
+/**
+ * The method descriptor parser as it was, which cuts out each parameter as a
+ * new string and collects the results in a vector
+ */
+bool legacyMethod(const JUtf8String& str, std::vector<Symbol>& parameters)
+{
+  auto i = str.begin();
+  if (i == str.end() || *i != '(')
+    return false;
+  ++i;
+  auto start = i;
+  while (i == str.end() || *i != ')')
+  {
+    if (i == str.end())
+      return false;
+    if (*i == '[')
+    {
+      ++i;
+      continue;
+    }
+    auto end = i;
+    if (*i == 'L')
+    {
+      while (end != str.end() && *end != ';')
+        ++end;
+      if (end == str.end())
+        return false;
+    }
+    ++end;
+    Symbol parameter;
+    if (!legacyField(JUtf8String(start, end), parameter))
+      return false;
+    parameters.push_back(parameter);
+    start = end;
+    i = end;
+  }
+  ++i;
+  if (i == str.end())
+    return false;
+  Symbol return_type;
+  return *i == 'V' || legacyField(JUtf8String(i, str.end()), return_type);
+}
+}
+
+MIMIC_BENCHMARK(DescriptorParse)
+{
+  std::vector<JUtf8String> fields;
+  std::vector<JUtf8String> methods;
+  for (auto descriptor : typical)
+  {
+    JUtf8String str(descriptor);
+    (descriptor[0] == '(' ? methods : fields).push_back(str);
+  }
+  for (auto& path : bench::classFiles())
+  {
+    ClassFile clazz(path, ConstantPool::lazy);
+    auto& cp = clazz.getConstantPool();
+    for (u2 i = 1; i < cp.size(); i++)
+    {
+      auto type = cp.getType(i);
+      if (type == ConstantPool::cp_fieldDescriptor)
+        fields.push_back(cp.getSymbol(i).string());
+      else if (type == ConstantPool::cp_methodDescriptor)
+        methods.push_back(cp.getSymbol(i).string());
+    }
+  }
+  std::size_t field_bytes = 0;
+  std::size_t method_bytes = 0;
+  for (auto& field : fields)
+    field_bytes += field.size();
+  for (auto& method : methods)
+    method_bytes += method.size();
+  std::cout << fields.size() << " field descriptors, " << methods.size() << " method descriptors" << std::endl;
+
+  bench::measure("field descriptors, legacy", field_bytes, [&fields]() {
+    for (auto& field : fields)
+    {
+      Symbol name;
+      bench::keep(legacyField(field, name));
+      bench::keep(name);
+    }
+  });
+  bench::measure("field descriptors, bytes", field_bytes, [&fields]() {
+    for (auto& field : fields)
+      bench::keep(FieldDescriptor::tryParse(field.view()));
+  });
+  bench::measure("method descriptors, legacy", method_bytes, [&methods]() {
+    for (auto& method : methods)
+    {
+      std::vector<Symbol> parameters;
+      bench::keep(legacyMethod(method, parameters));
+      bench::keep(parameters);
+    }
+  });
+  bench::measure("method descriptors, bytes", method_bytes, [&methods]() {
+    for (auto& method : methods)
+      bench::keep(MethodDescriptor::tryParse(method.view()));
+  });
+}
+
+}
@@ -0,0 +1,76 @@
+/**
+ * \file Heap_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <cstdlib>
+#include <thread>
+#include "bench/Bench.h"
+#include "Heap.h"
+
+namespace mimic
+{
+
+namespace
+{
+/** The objects each thread allocates in a run */
+const u8 objects_per_thread = 1000000;
+
+/** @return the size of the i'th object: a header and one to three fields, 24 bytes on average */
+std::size_t sizeOf(u8 i)
+{
+  return 16 + 8 * (i % 3);
+}
+
+/** Runs work on a number of threads at once and waits for them all */
+void onThreads(unsigned threads, const std::function<void()>& work)
+{
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; t++)
+    workers.emplace_back(work);
+  work();
+  for (auto& worker : workers)
+    worker.join();
+}
+}
+
+MIMIC_BENCHMARK(HeapAllocation)
+{
+  // Always several threads, to measure contention for eden even on one core
+  for (unsigned threads : {1, 2, 4})
+  {
+    // Room for every object, and a TLAB per thread to spare
+    std::size_t heap_size = threads * (objects_per_thread * 24 + Heap::default_tlab_size);
+    std::string suffix = " (" + std::to_string(threads) + (threads == 1 ? " thread)" : " threads)");
+    bench::measure("TLAB" + suffix, threads * objects_per_thread, "objects", [=]() {
+      Heap heap(heap_size);
+      onThreads(threads, [&heap]() {
+        for (u8 i = 0; i < objects_per_thread; i++)
+        {
+          auto header = static_cast<u8*>(heap.allocate(sizeOf(i)));
+          *header = i;
+        }
+      });
+      bench::keep(heap.getUsed());
+    });
+    // What allocation cost before there was a heap
+    bench::measure("calloc" + suffix, threads * objects_per_thread, "objects", [=]() {
+      onThreads(threads, []() {
+        std::vector<void*> allocated;
+        allocated.reserve(objects_per_thread);
+        for (u8 i = 0; i < objects_per_thread; i++)
+        {
+          auto header = static_cast<u8*>(std::calloc(1, sizeOf(i)));
+          *header = i;
+          allocated.push_back(header);
+        }
+        for (void* p : allocated)
+          std::free(p);
+      });
+    });
+  }
+}
+
+}
@@ -0,0 +1,49 @@
+/**
+ * \file InstructionStream_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "ClassFile.h"
+#include "InstructionStream.h"
+
+namespace mimic
+{
+
+MIMIC_BENCHMARK(InstructionStreamDecode)
+{
+  std::vector<ClassFile> classes;
+  std::vector<std::pair<const ClassFile*, const attributes::code*>> methods;
+  std::size_t bytes = 0;
+  for (auto& path : bench::classFiles())
+    classes.emplace_back(path);
+  for (auto& clazz : classes)
+  {
+    for (auto& method : clazz.getMethods())
+    {
+      for (auto& attr : method.attrs)
+      {
+        if (auto code = getIf<attributes::code>(attr))
+        {
+          methods.emplace_back(&clazz, code);
+          bytes += code->code.size();
+        }
+      }
+    }
+  }
+  std::cout << methods.size() << " methods, " << bytes << " bytes of code" << std::endl;
+
+  bench::measure("decoding every method", bytes, [&methods]() {
+    std::size_t instructions = 0;
+    for (auto& method : methods)
+    {
+      InstructionStream stream(*method.second, method.first->getConstantPool(), method.first->getMajorVersion());
+      instructions += stream.size();
+    }
+    bench::keep(instructions);
+  });
+}
+
+}
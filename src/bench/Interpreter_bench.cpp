@@ -0,0 +1,171 @@
+/**
+ * \file Interpreter_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "test/ClassBuilder.h"
+#include "Interpreter.h"
+#include "VirtualMachine.h"
+
+namespace mimic
+{
+
+namespace
+{
+typedef Bytecode B;
+
+/** The iterations of each benchmark's loop */
+const s4 iterations = 100000;
+
+/**
+ * Adds a static (I)I method which runs a body n times and returns local 1.
+ * Local 2 is the loop counter, and local 3 is free for the body to use.
+ *
+ * The method runs 9 + (5 + the body's bytecodes) * n bytecodes, plus those of
+ * the setup.
+ */
+void loop(ClassBuilder& builder, const char* name, const std::function<void(CodeBuilder&)>& setup,
+          const std::function<void(CodeBuilder&)>& body)
+{
+  CodeBuilder code;
+  setup(code);
+  code.op(B::op_iconst_0).op(B::op_istore_1).op(B::op_iconst_0).op(B::op_istore_2)
+    .label("test")
+    .op(B::op_iload_2).op(B::op_iload_0).branch(B::op_if_icmpge, "done");
+  body(code);
+  code.iinc(2, 1).branch(B::op_goto, "test")
+    .label("done")
+    .op(B::op_iload_1).op(B::op_ireturn);
+  builder.method(ClassFile::acc_static, name, "(I)I", 4, 4, code);
+}
+
+void none(CodeBuilder&)
+{
+}
+
+/**
+ * Runs a method with each kind of dispatch
+ *
+ * @param bytecodes the number of bytecodes a call runs
+ */
+void measureDispatch(VirtualMachine& vm, RuntimeClass* clazz, const char* name, u8 bytecodes)
+{
+  auto method = clazz->findDeclaredMethod(Symbol::intern(JUtf8String(name)), Symbol::intern(JUtf8String("(I)I")));
+  slot n;
+  n.j = 0;
+  n.i = iterations;
+  for (auto mode : {Interpreter::dispatch_threaded, Interpreter::dispatch_switch})
+  {
+    if (mode == Interpreter::dispatch_threaded && !Interpreter::hasThreadedDispatch())
+      continue;
+    Interpreter interpreter(vm, mode);
+    std::string label = std::string(name) + (mode == Interpreter::dispatch_threaded ? " (threaded)" : " (switch)");
+    bench::measure(label, bytecodes, "bytecodes", [&]() {
+      bench::keep(interpreter.call(*method, {n}).i);
+    });
+  }
+}
+}
+
+MIMIC_BENCHMARK(Interpreter)
+{
+  VirtualMachine vm;
+
+  ClassBuilder holder("Holder");
+  holder.field(0, "value", "I");
+  u2 object_init = holder.methodRef("java/lang/Object", "<init>", "()V");
+  holder.method(ClassFile::acc_public, "<init>", "()V", 1, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_invokespecial, object_init).op(B::op_return));
+  holder.method(ClassFile::acc_public, "add", "(II)I", 2, 3, CodeBuilder()
+    .op(B::op_iload_1).op(B::op_iload_2).op(B::op_iadd).op(B::op_ireturn));
+  vm.define(holder.build());
+  // Subclasses of Holder, for calls that see more than one receiver class
+  const u1 receivers = 8;
+  for (u1 i = 0; i < receivers; i++)
+  {
+    std::string name = "Holder" + std::to_string(i);
+    ClassBuilder subclass(name, "Holder");
+    u2 super_init = subclass.methodRef("Holder", "<init>", "()V");
+    subclass.method(ClassFile::acc_public, "<init>", "()V", 1, 1, CodeBuilder()
+      .op(B::op_aload_0).op2(B::op_invokespecial, super_init).op(B::op_return));
+    subclass.method(ClassFile::acc_public, "add", "(II)I", 2, 3, CodeBuilder()
+      .op(B::op_iload_1).op(B::op_iload_2).op(B::op_ixor).op(B::op_ireturn));
+    vm.define(subclass.build());
+  }
+
+  ClassBuilder builder("Loops");
+  u2 holder_class = builder.classRef("Holder");
+  u2 holder_init = builder.methodRef("Holder", "<init>", "()V");
+  u2 value = builder.fieldRef("Holder", "value", "I");
+  u2 add_static = builder.methodRef("Loops", "add", "(II)I");
+  u2 add_virtual = builder.methodRef("Holder", "add", "(II)I");
+  builder.method(ClassFile::acc_static, "add", "(II)I", 2, 2, CodeBuilder()
+    .op(B::op_iload_0).op(B::op_iload_1).op(B::op_iadd).op(B::op_ireturn));
+  // 5 bytecodes, of which 3 are Holder's constructor
+  auto newHolder = [=](CodeBuilder& code) {
+    code.op2(B::op_new, holder_class).op(B::op_dup).op2(B::op_invokespecial, holder_init).op(B::op_astore_3);
+  };
+
+  // s += i
+  loop(builder, "loop", none, [](CodeBuilder& code) {
+    code.op(B::op_iload_1).op(B::op_iload_2).op(B::op_iadd).op(B::op_istore_1);
+  });
+  // s = s * 31 + (i ^ (i >>> 3))
+  loop(builder, "arithmetic", none, [](CodeBuilder& code) {
+    code.op(B::op_iload_1).op(B::op_bipush, 31).op(B::op_imul)
+      .op(B::op_iload_2).op(B::op_iload_2).op(B::op_iconst_3).op(B::op_iushr).op(B::op_ixor)
+      .op(B::op_iadd).op(B::op_istore_1);
+  });
+  // h.value += i; s = h.value
+  loop(builder, "fields", newHolder, [=](CodeBuilder& code) {
+    code.op(B::op_aload_3).op(B::op_dup).op2(B::op_getfield, value).op(B::op_iload_2).op(B::op_iadd)
+      .op2(B::op_putfield, value)
+      .op(B::op_aload_3).op2(B::op_getfield, value).op(B::op_istore_1);
+  });
+  // s = add(s, i), which runs 4 bytecodes
+  loop(builder, "staticCalls", none, [=](CodeBuilder& code) {
+    code.op(B::op_iload_1).op(B::op_iload_2).op2(B::op_invokestatic, add_static).op(B::op_istore_1);
+  });
+  // s = h.add(s, i), which runs 4 bytecodes
+  loop(builder, "virtualCalls", newHolder, [=](CodeBuilder& code) {
+    code.op(B::op_aload_3).op(B::op_iload_1).op(B::op_iload_2).op2(B::op_invokevirtual, add_virtual)
+      .op(B::op_istore_1);
+  });
+  // Holder[] hs = {new Holder0(), new Holder1(), ...}, which runs 3 + 12 bytecodes per element
+  auto newHolders = [&builder](u1 count) {
+    return [&builder, count](CodeBuilder& code) {
+      code.op(B::op_bipush, count).op2(B::op_anewarray, builder.classRef("Holder")).op(B::op_astore_3);
+      for (u1 i = 0; i < count; i++)
+      {
+        std::string name = "Holder" + std::to_string(i);
+        code.op(B::op_aload_3).op(B::op_bipush, i).op2(B::op_new, builder.classRef(name)).op(B::op_dup)
+          .op2(B::op_invokespecial, builder.methodRef(name, "<init>", "()V")).op(B::op_aastore);
+      }
+    };
+  };
+  // s = hs[i & (count - 1)].add(s, i), which runs 4 bytecodes
+  auto callHolders = [=](u1 count) {
+    return [=](CodeBuilder& code) {
+      code.op(B::op_aload_3).op(B::op_iload_2).op(B::op_bipush, static_cast<u1>(count - 1)).op(B::op_iand)
+        .op(B::op_aaload).op(B::op_iload_1).op(B::op_iload_2).op2(B::op_invokevirtual, add_virtual)
+        .op(B::op_istore_1);
+    };
+  };
+  loop(builder, "polymorphicCalls", newHolders(2), callHolders(2));
+  loop(builder, "megamorphicCalls", newHolders(receivers), callHolders(receivers));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  const u8 n = iterations;
+  measureDispatch(vm, clazz, "loop", 9 + (5 + 4) * n);
+  measureDispatch(vm, clazz, "arithmetic", 9 + (5 + 10) * n);
+  measureDispatch(vm, clazz, "fields", 5 + 9 + (5 + 9) * n);
+  measureDispatch(vm, clazz, "staticCalls", 9 + (5 + 4 + 4) * n);
+  measureDispatch(vm, clazz, "virtualCalls", 5 + 9 + (5 + 5 + 4) * n);
+  measureDispatch(vm, clazz, "polymorphicCalls", 3 + 12 * 2 + 9 + (5 + 9 + 4) * n);
+  measureDispatch(vm, clazz, "megamorphicCalls", 3 + 12 * receivers + 9 + (5 + 9 + 4) * n);
+}
+
+}
@@ -0,0 +1,73 @@
+/**
+ * \file JUtf8String_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "ClassFile.h"
+#include "ClassValidator.h"
+
+namespace mimic
+{
+
+MIMIC_BENCHMARK(JUtf8StringSearch)
+{
+  std::vector<JUtf8String> names;
+  std::size_t bytes = 0;
+  for (auto& path : bench::classFiles())
+  {
+    ClassFile clazz(path, ConstantPool::lazy);
+    auto& cp = clazz.getConstantPool();
+    for (u2 i = 1; i < cp.size(); i++)
+    {
+      if (cp.getType(i) == ConstantPool::cp_utf8)
+      {
+        names.push_back(cp.get<const JUtf8String>(i));
+        bytes += names.back().size();
+      }
+    }
+  }
+  std::cout << names.size() << " Utf8 constants, " << bytes << " bytes" << std::endl;
+
+  const std::vector<JUtf8String> invalid = { JUtf8String("."), JUtf8String(";"), JUtf8String("["),
+                                             JUtf8String("/") };
+  bench::measure("contains(unqualified name characters)", bytes, [&names, &invalid]() {
+    for (auto& name : names)
+      bench::keep(name.contains(invalid));
+  });
+  const JUtf8String init("<init>");
+  bench::measure("find(\"<init>\")", bytes, [&names, &init]() {
+    for (auto& name : names)
+      bench::keep(name.find(init));
+  });
+  const JUtf8String slash("/");
+  bench::measure("split(\"/\")", bytes, [&names, &slash]() {
+    for (auto& name : names)
+      bench::keep(name.split(slash));
+  });
+  bench::measure("iterate code points", bytes, [&names]() {
+    u4 sum = 0;
+    for (auto& name : names)
+    {
+      for (auto c : name)
+        sum += c;
+    }
+    bench::keep(sum);
+  });
+  bench::measure("ClassValidator::validateUnqualifiedName", bytes, [&names]() {
+    for (auto& name : names)
+    {
+      try
+      {
+        ClassValidator::validateUnqualifiedName(name);
+      }
+      catch (std::runtime_error&)
+      {
+      }
+    }
+  });
+}
+
+}
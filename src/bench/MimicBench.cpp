@@ -0,0 +1,19 @@
+/**
+ * \file MimicBench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ *
+ * Micro-benchmarks for the class file parser. Run as
+ *
+ *   mimicbench [--filter=name] [class files or directories...]
+ *
+ * e.g. against the classes of an extracted JDK image.
+ */
+
+#include "bench/Bench.h"
+
+int main(int argc, char** argv)
+{
+  return mimic::bench::run(argc, argv);
+}
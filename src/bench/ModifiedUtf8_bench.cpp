@@ -0,0 +1,99 @@
+/**
+ * \file ModifiedUtf8_bench.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "bench/Bench.h"
+#include "ClassFile.h"
+#include "ModifiedUtf8.h"
+
+namespace mimic
+{
+
+namespace
+{
+/**
+ * @return the bytes of every Utf8 constant in the benchmark's class files
+ */
+std::vector<std::vector<u1>> utf8Constants()
+{
+  std::vector<std::vector<u1>> constants;
+  for (auto& path : bench::classFiles())
+  {
+    ClassFile clazz(path, ConstantPool::lazy);
+    auto& cp = clazz.getConstantPool();
+    for (u2 i = 1; i < cp.size(); i++)
+    {
+      auto type = cp.getType(i);
+      if (type == ConstantPool::cp_utf8 || type == ConstantPool::cp_fieldDescriptor
+          || type == ConstantPool::cp_methodDescriptor)
+        constants.push_back(cp.getSymbol(i).view());
+    }
+  }
+  return constants;
+}
+
+/**
+ * The check JUtf8String used to make, for comparison
+ */
+bool legacyValidate(const u1* first, const u1* last)
+{
+  for (auto i = first; i != last; ++i)
+  {
+    if (*i == 0 || *i >= 0xf0)
+      return false;
+  }
+  return true;
+}
+}
+
+MIMIC_BENCHMARK(ModifiedUtf8Validate)
+{
+  auto constants = utf8Constants();
+  std::size_t bytes = 0;
+  for (auto& constant : constants)
+    bytes += constant.size();
+  std::cout << constants.size() << " Utf8 constants, " << bytes << " bytes, fast path "
+            << ModifiedUtf8::fastPath() << std::endl;
+
+  bench::measure("legacy byte scan (no structure checks)", bytes, [&constants]() {
+    for (auto& constant : constants)
+      bench::keep(legacyValidate(constant.data(), constant.data() + constant.size()));
+  });
+  bench::measure("ModifiedUtf8::validateScalar", bytes, [&constants]() {
+    std::size_t characters;
+    for (auto& constant : constants)
+      bench::keep(ModifiedUtf8::validateScalar(constant.data(), constant.data() + constant.size(), characters));
+  });
+  bench::measure("ModifiedUtf8::validate", bytes, [&constants]() {
+    std::size_t characters;
+    for (auto& constant : constants)
+      bench::keep(ModifiedUtf8::validate(constant.data(), constant.data() + constant.size(), characters));
+  });
+  bench::measure("JUtf8String::borrow", bytes, [&constants]() {
+    for (auto& constant : constants)
+      bench::keep(JUtf8String::borrow(parsing::ByteView(constant)));
+  });
+
+  // Long strings, such as big string literals, are where the vector path pays off
+  std::vector<u1> joined;
+  while (joined.size() < 64 * 1024)
+  {
+    for (auto& constant : constants)
+      joined.insert(joined.end(), constant.begin(), constant.end());
+    if (constants.empty())
+      break;
+  }
+  bench::measure("ModifiedUtf8::validateScalar (joined)", joined.size(), [&joined]() {
+    std::size_t characters;
+    bench::keep(ModifiedUtf8::validateScalar(joined.data(), joined.data() + joined.size(), characters));
+  });
+  bench::measure("ModifiedUtf8::validate (joined)", joined.size(), [&joined]() {
+    std::size_t characters;
+    bench::keep(ModifiedUtf8::validate(joined.data(), joined.data() + joined.size(), characters));
+  });
+}
+
+}
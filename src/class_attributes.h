@@ -51,7 +51,7 @@ typedef struct
 typedef struct
 {
   u2 bootstrap_method_ref;
-  std::vector<u2> methods;
+  std::vector<u2> bootstrap_arguments;
 } bootstrap_method_info;
 
 typedef struct
@@ -60,17 +60,19 @@ typedef struct
   std::vector<bootstrap_method_info> info;
 } bootstrap_methods;
 
+template <> source_debug_extension lazy<source_debug_extension>::decode() const;
+
 typedef variant<inner_classes,
                 enclosing_method,
                 synthetic,
                 signature,
                 source_file,
-                source_debug_extension,
+                lazy<source_debug_extension>,
                 deprecated,
-                runtime_visible_annotations,
-                runtime_invisible_annotations,
-                runtime_visible_type_annotations,
-                runtime_invisible_type_annotations,
+                lazy<runtime_visible_annotations>,
+                lazy<runtime_invisible_annotations>,
+                lazy<runtime_visible_type_annotations>,
+                lazy<runtime_invisible_type_annotations>,
                 bootstrap_methods> class_attr_type;
 };
 };
@@ -62,12 +62,16 @@ typedef struct
   std::vector<local_variable_type_info> table;
 } local_variable_type_table;
 
-typedef variant<stack_map_table,
+template <> stack_map_table lazy<stack_map_table>::decode() const;
+template <> local_variable_table lazy<local_variable_table>::decode() const;
+template <> local_variable_type_table lazy<local_variable_type_table>::decode() const;
+
+typedef variant<lazy<stack_map_table>,
                 line_number_table,
-                local_variable_table,
-                local_variable_type_table,
-                runtime_visible_type_annotations,
-                runtime_invisible_type_annotations> code_attr_type;
+                lazy<local_variable_table>,
+                lazy<local_variable_type_table>,
+                lazy<runtime_visible_type_annotations>,
+                lazy<runtime_invisible_type_annotations>> code_attr_type;
 };
 };
 
@@ -9,10 +9,31 @@
 #define SRC_MIMIC_COMMON_ATTRIBUTES_H_
 
 #include "Common.h"
+#include "parsing/ByteView.h"
 
 namespace mimic {
 namespace attributes {
 
+/**
+ * An attribute that is only decoded when it's asked for. Annotations, local
+ * variable tables and the like are bulky and seldom used, so parsing only
+ * notes where they are.
+ */
+template <typename T> struct lazy
+{
+  u2 attribute_name_index;
+  /** The attribute's info, which the ClassFile it belongs to keeps alive */
+  parsing::ByteView info;
+
+  /**
+   * Decodes the attribute. Only valid for as long as the ClassFile is.
+   *
+   * @return the decoded attribute
+   * @throws parse_failure if the attribute is malformed
+   */
+  T decode() const;
+};
+
 typedef struct
 {
   u2 attribute_name_index;
@@ -29,18 +50,32 @@ typedef struct
   u2 attribute_name_index;
 } deprecated;
 
+struct annotation;
+
 typedef struct annotation_element_value
 {
   u1 type_tag;
+  /**
+   * const_value_index or class_info_index; type_name_index and
+   * const_name_index for an enum constant; the values of an array; or a
+   * nested annotation
+   */
   variant<u2,
           std::tuple<u2, u2>,
-          std::tuple<u2, std::vector<struct annotation_element_value>>> value;
+          std::vector<struct annotation_element_value>,
+          std::shared_ptr<const struct annotation>> value;
 } annotation_element_value;
 
 typedef struct
+{
+  u2 element_name_index;
+  annotation_element_value value;
+} element_value_pair;
+
+typedef struct annotation
 {
   u2 type_index;
-  std::vector<annotation_element_value> elements;
+  std::vector<element_value_pair> elements;
 } annotation;
 
 typedef struct
@@ -82,6 +117,11 @@ typedef struct
   std::vector<u1> info;
 } runtime_invisible_type_annotations;
 
+template <> runtime_visible_annotations lazy<runtime_visible_annotations>::decode() const;
+template <> runtime_invisible_annotations lazy<runtime_invisible_annotations>::decode() const;
+template <> runtime_visible_type_annotations lazy<runtime_visible_type_annotations>::decode() const;
+template <> runtime_invisible_type_annotations lazy<runtime_invisible_type_annotations>::decode() const;
+
 };
 };
 
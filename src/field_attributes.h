@@ -24,10 +24,10 @@ typedef variant<constant_value,
                 synthetic,
                 signature,
                 deprecated,
-                runtime_visible_annotations,
-                runtime_invisible_annotations,
-                runtime_visible_type_annotations,
-                runtime_invisible_type_annotations> field_attr_type;
+                lazy<runtime_visible_annotations>,
+                lazy<runtime_invisible_annotations>,
+                lazy<runtime_visible_type_annotations>,
+                lazy<runtime_invisible_type_annotations>> field_attr_type;
 };
 };
 
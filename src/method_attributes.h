@@ -9,6 +9,7 @@
 #define SRC_MIMIC_METHOD_ATTRIBUTES_H_
 
 #include "Common.h"
+#include "code_attributes.h"
 #include "common_attributes.h"
 
 namespace mimic {
@@ -34,7 +35,7 @@ typedef struct
 typedef struct
 {
   u2 attribute_name_index;
-  std::vector<u2> excption_index_table;
+  std::vector<u2> exception_index_table;
 } exceptions;
 
 typedef struct
@@ -61,17 +62,22 @@ typedef struct
   std::vector<std::tuple<u2, u2>> parameters;
 } method_parameters;
 
+template <> runtime_visible_parameter_annotations lazy<runtime_visible_parameter_annotations>::decode() const;
+template <> runtime_invisible_parameter_annotations lazy<runtime_invisible_parameter_annotations>::decode() const;
+template <> annotation_default lazy<annotation_default>::decode() const;
+
 typedef variant<code,
                 exceptions,
                 synthetic,
                 signature,
                 deprecated,
-                runtime_visible_annotations,
-                runtime_invisible_annotations,
-                runtime_visible_parameter_annotations,
-                runtime_invisible_parameter_annotations,
-                runtime_visible_type_annotations,
-                runtime_invisible_type_annotations,
+                lazy<runtime_visible_annotations>,
+                lazy<runtime_invisible_annotations>,
+                lazy<runtime_visible_parameter_annotations>,
+                lazy<runtime_invisible_parameter_annotations>,
+                lazy<runtime_visible_type_annotations>,
+                lazy<runtime_invisible_type_annotations>,
+                lazy<annotation_default>,
                 method_parameters> method_attr_type;
 };
 };
@@ -6,7 +6,7 @@
  */
 
 #include "ByteConsumer.h"
-#include <type_traits>
+#include <iterator>
 
 namespace mimic
 {
@@ -14,68 +14,49 @@ namespace parsing
 {
 
 ByteConsumer::ByteConsumer(std::istream& stream, uintmax_t length) :
-		stream(stream), bytesRemainingCount(length)
+		stream(&stream), declaredLength(length), first(nullptr), cursor(nullptr), last(nullptr)
 {
 }
 
-ByteConsumer::~ByteConsumer()
+ByteConsumer::ByteConsumer(const u1* data, uintmax_t length, std::shared_ptr<const void> backing) :
+		stream(nullptr), declaredLength(length), first(data), cursor(data), last(data + length),
+		backing(std::move(backing))
 {
-
 }
 
-uint8_t ByteConsumer::readU1()
+ByteConsumer::~ByteConsumer()
 {
-	if (stream.peek() == std::istream::traits_type::eof())
-		throw parse_failure("No bytes available to read");
-	if (bytesRemainingCount > 0)
-		bytesRemainingCount--;
-	return (static_cast<uint8_t>(stream.get()));
-}
 
-uint16_t ByteConsumer::readU2()
-{
-	if (stream.peek() == std::istream::traits_type::eof())
-		throw parse_failure("No bytes available to read");
-	uint16_t value = stream.get() << 8;
-	if (stream.eof())
-		throw parse_failure("No bytes available to read");
-	if (bytesRemainingCount > 0)
-		bytesRemainingCount -= 2;
-	return (static_cast<uint16_t>(value | stream.get()));
 }
 
-uint32_t ByteConsumer::readU4()
+uintmax_t ByteConsumer::bytesRemaining() const
 {
-	if (stream.peek() == std::istream::traits_type::eof())
-		throw parse_failure("No bytes available to read");
-	uint32_t value = 0;
-	for (int i = 0; i < 4; i++)
-	{
-		if (stream.eof())
-			throw parse_failure("No bytes available to read");
-		value |= (stream.get() << (8 * (3 - i)));
-	}
-	if (bytesRemainingCount > 0)
-		bytesRemainingCount -= 4;
-	return (value);
+	if (stream != nullptr)
+		return declaredLength;
+	return last - cursor;
 }
 
-std::vector<uint8_t> ByteConsumer::readBytes(int numberOfBytes)
+void ByteConsumer::fill(uintmax_t count)
 {
-	if (stream.peek() == std::istream::traits_type::eof())
-		throw parse_failure("No bytes available to read");
-	std::vector<uint8_t> bytes;
-	for (int i = 0; i < numberOfBytes; i++)
+	if (stream != nullptr)
 	{
-		if (stream.peek() == std::istream::traits_type::eof())
-			throw parse_failure("No bytes available to read");
-		bytes.push_back(stream.get());
+		if (declaredLength != static_cast<uintmax_t>(-1))
+		{
+			buffer.resize(declaredLength);
+			stream->read(reinterpret_cast<char*>(buffer.data()), declaredLength);
+			buffer.resize(stream->gcount());
+		}
+		else
+		{
+			buffer.assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+		}
+		stream = nullptr;
+		first = cursor = buffer.data();
+		last = first + buffer.size();
 	}
-	if (bytesRemainingCount > 0)
-		bytesRemainingCount -= numberOfBytes;
-	return bytes;
+	if (static_cast<uintmax_t>(last - cursor) < count)
+		throw parse_failure("No bytes available to read");
 }
 
 }
 }
-
@@ -10,6 +10,7 @@
 
 #include <istream>
 #include "Common.h"
+#include "ByteView.h"
 #include "ParseFailureException.h"
 
 namespace mimic
@@ -20,7 +21,9 @@ namespace parsing
 /**
  * Reads a byte stream in small pieces, for use by parsers
  *
- * Multi-byte values are read as big-endian
+ * Multi-byte values are read as big-endian. All reads are served from a
+ * contiguous in-memory buffer; either one supplied by the caller, or one
+ * filled by reading the whole of an istream the first time it is needed.
  */
 class ByteConsumer
 {
@@ -31,11 +34,30 @@ public:
 	/**
 	 * Constructor
 	 *
+	 * The stream is read in its entirety (or up to length bytes, if given)
+	 * into an internal buffer on the first read.
+	 *
 	 * @param buf Stream buffer to read from
 	 * @param length the length of the stream, if known
 	 */
 	ByteConsumer(std::istream& stream, uintmax_t length = -1);
 
+	/**
+	 * Constructor
+	 *
+	 * Reads directly from the given buffer without copying it. The buffer
+	 * must outlive the ByteConsumer and any ByteView read from it.
+	 *
+	 * If a backing owner is given, it keeps the buffer alive; parsers may then
+	 * retain views into the buffer beyond the life of the ByteConsumer as long
+	 * as they also hold a reference to the owner.
+	 *
+	 * @param data pointer to the first byte to read
+	 * @param length the number of bytes available
+	 * @param backing the owner of the buffer, if it may be retained
+	 */
+	ByteConsumer(const u1* data, uintmax_t length, std::shared_ptr<const void> backing = nullptr);
+
 	virtual ~ByteConsumer();
 
 	/**
@@ -44,7 +66,11 @@ public:
 	 * @return the next byte from the stream as an unsigned integer
 	 * @throws parse_failure if the end of the stream is reached when attempting to read
 	 */
-	u1 readU1();
+	u1 readU1()
+	{
+		require(1);
+		return *cursor++;
+	}
 
 	/**
 	 * Read a 2-byte unsigned integer value from the stream
@@ -52,7 +78,13 @@ public:
 	 * @return the next 2 bytes from the stream as an unsigned integer
 	 * @throws parse_failure if the end of the stream is reached when attempting to read
 	 */
-	u2 readU2();
+	u2 readU2()
+	{
+		require(2);
+		u2 value = static_cast<u2>((cursor[0] << 8) | cursor[1]);
+		cursor += 2;
+		return value;
+	}
 
 	/**
 	 * Read a 4-byte unsigned integer value from the stream
@@ -60,25 +92,79 @@ public:
 	 * @return the next 4 bytes from the stream as an unsigned integer
 	 * @throws parse_failure if the end of the stream is reached when attempting to read
 	 */
-	u4 readU4();
+	u4 readU4()
+	{
+		require(4);
+		u4 value = (static_cast<u4>(cursor[0]) << 24) | (static_cast<u4>(cursor[1]) << 16)
+				| (static_cast<u4>(cursor[2]) << 8) | cursor[3];
+		cursor += 4;
+		return value;
+	}
 
 	/**
-	 * Read a vector of bytes from the stream
+	 * Read a run of bytes from the stream
 	 *
 	 * @param numberOfBytes the number of bytes to read
-	 * @return a vector containing the specified number of bytes
+	 * @return a view of the specified number of bytes, valid for the lifetime
+	 *         of this ByteConsumer
 	 * @throws parse_failure if the end of the stream is reached when attempting to read
 	 */
-	std::vector<u1> readBytes(int numberOfBytes);
+	ByteView readBytes(u4 numberOfBytes)
+	{
+		require(numberOfBytes);
+		ByteView bytes(cursor, numberOfBytes);
+		cursor += numberOfBytes;
+		return bytes;
+	}
+
+	/**
+	 * @return the number of bytes remaining to be read in the stream or -1 if
+	 *         unknown and nothing has been read yet
+	 */
+	uintmax_t bytesRemaining() const;
+
+	/**
+	 * @return the number of bytes read so far
+	 */
+	uintmax_t position() const { return cursor - first; };
+
+	/**
+	 * @param start a position previously returned by position()
+	 * @return a view of the bytes read between start and the current position
+	 */
+	ByteView viewFrom(uintmax_t start) const { return ByteView(first + start, (cursor - first) - start); };
 
 	/**
-	 * @return the number of bytes remaining to be read in the stream or -1 if unknown
+	 * @return the owner of the buffer being read if views into it may be
+	 *         retained, else null
 	 */
-	uintmax_t bytesRemaining() { return bytesRemainingCount; };
+	const std::shared_ptr<const void>& getBacking() const { return backing; };
 
 private:
-	std::istream& stream;
-	uintmax_t bytesRemainingCount;
+	std::istream* stream;
+	uintmax_t declaredLength;
+	std::vector<u1> buffer;
+	const u1* first;
+	const u1* cursor;
+	const u1* last;
+	std::shared_ptr<const void> backing;
+
+	/**
+	 * Ensures that at least count bytes are available to read
+	 *
+	 * @throws parse_failure if fewer than count bytes remain
+	 */
+	void require(uintmax_t count)
+	{
+		if (static_cast<uintmax_t>(last - cursor) < count)
+			fill(count);
+	}
+
+	/**
+	 * Slow path of require(). Reads the stream into the buffer if that has not
+	 * happened yet, then throws if there still aren't enough bytes.
+	 */
+	void fill(uintmax_t count);
 };
 
 }
@@ -0,0 +1,99 @@
+/**
+ * \file ByteView.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_PARSING_BYTEVIEW_H_
+#define SRC_PARSING_BYTEVIEW_H_
+
+#include <cstring>
+#include "Common.h"
+
+namespace mimic
+{
+namespace parsing
+{
+
+/**
+ * A non-owning, read-only view of a contiguous run of bytes
+ *
+ * The view is only valid for as long as the memory it points at. Views handed
+ * out by a ByteConsumer point into the consumer's buffer (or the buffer the
+ * consumer was constructed over), so must not outlive it.
+ */
+class ByteView
+{
+public:
+	typedef const u1* iterator;
+	typedef const u1* const_iterator;
+	typedef u1 value_type;
+
+	ByteView() :
+			first(nullptr), count(0)
+	{
+	}
+
+	/**
+	 * Constructor
+	 *
+	 * @param data pointer to the first byte of the view
+	 * @param size the number of bytes in the view
+	 */
+	ByteView(const u1* data, std::size_t size) :
+			first(data), count(size)
+	{
+	}
+
+	/**
+	 * Constructor
+	 *
+	 * @param bytes the vector to view. Must outlive the view.
+	 */
+	ByteView(const std::vector<u1>& bytes) :
+			first(bytes.data()), count(bytes.size())
+	{
+	}
+
+	const u1* data() const { return first; };
+	std::size_t size() const { return count; };
+	bool empty() const { return count == 0; };
+	const u1* begin() const { return first; };
+	const u1* end() const { return first + count; };
+	u1 operator[](std::size_t index) const { return first[index]; };
+
+	/**
+	 * @return a copy of the viewed bytes
+	 */
+	operator std::vector<u1>() const { return std::vector<u1>(begin(), end()); };
+
+	bool operator==(const ByteView& other) const
+	{
+		return count == other.count && (count == 0 || std::memcmp(first, other.first, count) == 0);
+	}
+
+	bool operator!=(const ByteView& other) const
+	{
+		return !(*this == other);
+	}
+
+private:
+	const u1* first;
+	std::size_t count;
+};
+
+inline bool operator==(const std::vector<u1>& lhs, const ByteView& rhs)
+{
+	return ByteView(lhs) == rhs;
+}
+
+inline bool operator==(const ByteView& lhs, const std::vector<u1>& rhs)
+{
+	return lhs == ByteView(rhs);
+}
+
+}
+}
+
+#endif /* SRC_PARSING_BYTEVIEW_H_ */
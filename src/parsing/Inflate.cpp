@@ -0,0 +1,414 @@
+/**
+ * \file Inflate.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "Inflate.h"
+#include <algorithm>
+
+namespace mimic
+{
+namespace parsing
+{
+
+namespace
+{
+const unsigned max_bits = 15;
+const unsigned max_literals = 288;
+const unsigned max_distances = 30;
+/** Codes no longer than this are decoded with one table lookup */
+const unsigned fast_bits = 9;
+
+const u2 length_base[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99,
+		115, 131, 163, 195, 227, 258};
+const u1 length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const u2 distance_base[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+		1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const u1 distance_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+		12, 12, 13, 13};
+/** The order code length code lengths are sent in */
+const u1 code_length_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+/**
+ * Reads the compressed stream a few bits at a time, least significant bit
+ * first
+ *
+ * Reading past the end of the input yields zero bits, so that lookups can
+ * always peek a full table's worth. Actually consuming those bits is an
+ * error.
+ */
+class bit_reader
+{
+public:
+	bit_reader(ByteView input) :
+			position(input.begin()), last(input.end()), buffer(0), available(0), padding(0)
+	{
+	}
+
+	/**
+	 * @return the next count bits, without consuming them
+	 */
+	u4 peek(unsigned count)
+	{
+		while (available < count)
+		{
+			u8 byte = 0;
+			if (position != last)
+				byte = *position++;
+			else
+				padding += 8;
+			buffer |= byte << available;
+			available += 8;
+		}
+		return buffer & ((u8(1) << count) - 1);
+	}
+
+	void drop(unsigned count)
+	{
+		buffer >>= count;
+		available -= count;
+		if (padding > available)
+			throw parse_failure("Unexpected end of compressed data");
+	}
+
+	u4 bits(unsigned count)
+	{
+		u4 value = peek(count);
+		drop(count);
+		return value;
+	}
+
+	/**
+	 * Discards any bits up to the next byte boundary, then hands back the
+	 * rest of the input as bytes
+	 */
+	ByteView alignToByte()
+	{
+		drop(available & 7);
+		// Whole bytes still in the buffer haven't been used yet
+		position -= (available - padding) / 8;
+		buffer = 0;
+		available = 0;
+		padding = 0;
+		return ByteView(position, last - position);
+	}
+
+	void skip(std::size_t bytes)
+	{
+		position += bytes;
+	}
+
+private:
+	const u1* position;
+	const u1* last;
+	u8 buffer;
+	unsigned available;
+	/** How many of the available bits are past the end of the input */
+	unsigned padding;
+};
+
+/**
+ * A canonical Huffman code
+ */
+class huffman
+{
+public:
+	/**
+	 * Builds the code from the length of each symbol's code
+	 *
+	 * @param lengths the code length for each symbol, 0 if it is unused
+	 * @param symbol_count the number of symbols
+	 */
+	void build(const u1* lengths, unsigned symbol_count)
+	{
+		std::fill(std::begin(counts), std::end(counts), 0);
+		for (unsigned i = 0; i < symbol_count; i++)
+			counts[lengths[i]]++;
+		counts[0] = 0;
+		int left = 1;
+		for (unsigned length = 1; length <= max_bits; length++)
+		{
+			left = (left << 1) - counts[length];
+			if (left < 0)
+				throw parse_failure("Over-subscribed Huffman code");
+		}
+		u2 offsets[max_bits + 2];
+		offsets[1] = 0;
+		for (unsigned length = 1; length <= max_bits; length++)
+			offsets[length + 1] = offsets[length] + counts[length];
+		for (unsigned i = 0; i < symbol_count; i++)
+		{
+			if (lengths[i] != 0)
+				symbols[offsets[lengths[i]]++] = i;
+		}
+
+		// Fill in the lookup table for short codes. The stream holds codes
+		// most significant bit first, but is read least significant bit
+		// first, so the table is indexed by the reversed code.
+		std::fill(std::begin(fast), std::end(fast), 0);
+		u2 code = 0;
+		unsigned index = 0;
+		for (unsigned length = 1; length <= fast_bits; length++)
+		{
+			for (unsigned i = 0; i < counts[length]; i++, code++, index++)
+			{
+				unsigned reversed = 0;
+				for (unsigned bit = 0; bit < length; bit++)
+					reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+				for (unsigned fill = reversed; fill < (1u << fast_bits); fill += 1u << length)
+					fast[fill] = static_cast<u2>((length << 9) | symbols[index]);
+			}
+			code <<= 1;
+		}
+	}
+
+	unsigned decode(bit_reader& in) const
+	{
+		u2 entry = fast[in.peek(fast_bits)];
+		if (entry != 0)
+		{
+			in.drop(entry >> 9);
+			return entry & 0x1ff;
+		}
+		return decodeSlowly(in);
+	}
+
+private:
+	u2 counts[max_bits + 1];
+	u2 symbols[max_literals];
+	/** The length of the code in the top bits and the symbol in the low nine, or 0 if the code is longer */
+	u2 fast[1 << fast_bits];
+
+	/**
+	 * Decodes one bit at a time, for codes too long for the lookup table
+	 */
+	unsigned decodeSlowly(bit_reader& in) const
+	{
+		int code = 0;
+		int first = 0;
+		int index = 0;
+		for (unsigned length = 1; length <= max_bits; length++)
+		{
+			code |= in.bits(1);
+			int count = counts[length];
+			if (code - count < first)
+				return symbols[index + (code - first)];
+			index += count;
+			first = (first + count) << 1;
+			code <<= 1;
+		}
+		throw parse_failure("Invalid Huffman code");
+	}
+};
+
+class inflater
+{
+public:
+	inflater(ByteView compressed, std::size_t size) :
+			in(compressed), output(size), written(0)
+	{
+	}
+
+	std::vector<u1> run()
+	{
+		bool last_block;
+		do
+		{
+			last_block = in.bits(1);
+			switch (in.bits(2))
+			{
+			case 0:
+				stored();
+				break;
+			case 1:
+				fixed();
+				break;
+			case 2:
+				dynamic();
+				break;
+			default:
+				throw parse_failure("Invalid deflate block type");
+			}
+		} while (!last_block);
+		if (written != output.size())
+			throw parse_failure("Inflated data is smaller than expected");
+		return std::move(output);
+	}
+
+private:
+	bit_reader in;
+	std::vector<u1> output;
+	std::size_t written;
+	huffman literals;
+	huffman distances;
+
+	void stored()
+	{
+		ByteView rest = in.alignToByte();
+		if (rest.size() < 4)
+			throw parse_failure("Unexpected end of compressed data");
+		u2 length = rest[0] | (rest[1] << 8);
+		u2 complement = rest[2] | (rest[3] << 8);
+		if (length != static_cast<u2>(~complement))
+			throw parse_failure("Stored block length is corrupt");
+		if (rest.size() - 4 < length)
+			throw parse_failure("Unexpected end of compressed data");
+		if (output.size() - written < length)
+			throw parse_failure("Inflated data is larger than expected");
+		std::copy(rest.begin() + 4, rest.begin() + 4 + length, output.begin() + written);
+		written += length;
+		in.skip(4 + length);
+	}
+
+	void fixed()
+	{
+		// Built once, as every fixed block uses the same codes
+		static const struct fixed_codes
+		{
+			huffman literals;
+			huffman distances;
+
+			fixed_codes()
+			{
+				u1 lengths[max_literals];
+				std::fill(lengths, lengths + 144, 8);
+				std::fill(lengths + 144, lengths + 256, 9);
+				std::fill(lengths + 256, lengths + 280, 7);
+				std::fill(lengths + 280, lengths + max_literals, 8);
+				literals.build(lengths, max_literals);
+				std::fill(lengths, lengths + max_distances, 5);
+				distances.build(lengths, max_distances);
+			}
+		} codes;
+		decodeBlock(codes.literals, codes.distances);
+	}
+
+	void dynamic()
+	{
+		unsigned literal_count = in.bits(5) + 257;
+		unsigned distance_count = in.bits(5) + 1;
+		unsigned code_length_count = in.bits(4) + 4;
+		if (literal_count > 286 || distance_count > max_distances)
+			throw parse_failure("Too many Huffman codes");
+		u1 lengths[max_literals + max_distances] = {};
+		for (unsigned i = 0; i < code_length_count; i++)
+			lengths[code_length_order[i]] = in.bits(3);
+		huffman code_lengths;
+		code_lengths.build(lengths, 19);
+
+		std::fill(std::begin(lengths), std::end(lengths), 0);
+		unsigned total = literal_count + distance_count;
+		for (unsigned i = 0; i < total;)
+		{
+			unsigned symbol = code_lengths.decode(in);
+			if (symbol < 16)
+			{
+				lengths[i++] = symbol;
+				continue;
+			}
+			u1 repeated = 0;
+			unsigned times;
+			if (symbol == 16)
+			{
+				if (i == 0)
+					throw parse_failure("Repeated code length with no previous length");
+				repeated = lengths[i - 1];
+				times = 3 + in.bits(2);
+			}
+			else if (symbol == 17)
+			{
+				times = 3 + in.bits(3);
+			}
+			else
+			{
+				times = 11 + in.bits(7);
+			}
+			if (i + times > total)
+				throw parse_failure("Too many code lengths");
+			std::fill(lengths + i, lengths + i + times, repeated);
+			i += times;
+		}
+		if (lengths[256] == 0)
+			throw parse_failure("Missing end of block code");
+		literals.build(lengths, literal_count);
+		distances.build(lengths + literal_count, distance_count);
+		decodeBlock(literals, distances);
+	}
+
+	/**
+	 * Decodes the body of a compressed block
+	 */
+	void decodeBlock(const huffman& literal_code, const huffman& distance_code)
+	{
+		u1* out = output.data();
+		std::size_t size = output.size();
+		for (;;)
+		{
+			unsigned symbol = literal_code.decode(in);
+			if (symbol < 256)
+			{
+				if (written == size)
+					throw parse_failure("Inflated data is larger than expected");
+				out[written++] = static_cast<u1>(symbol);
+				continue;
+			}
+			if (symbol == 256)
+				return;
+			symbol -= 257;
+			if (symbol >= 29)
+				throw parse_failure("Invalid length code");
+			std::size_t length = length_base[symbol] + in.bits(length_extra[symbol]);
+			unsigned distance_symbol = distance_code.decode(in);
+			if (distance_symbol >= max_distances)
+				throw parse_failure("Invalid distance code");
+			std::size_t distance = distance_base[distance_symbol] + in.bits(distance_extra[distance_symbol]);
+			if (distance > written)
+				throw parse_failure("Distance is before the start of the data");
+			if (size - written < length)
+				throw parse_failure("Inflated data is larger than expected");
+			const u1* from = out + written - distance;
+			u1* to = out + written;
+			if (distance >= length)
+				std::copy(from, from + length, to);
+			else
+				// Overlapping copies repeat the last distance bytes
+				for (std::size_t i = 0; i < length; i++)
+					to[i] = from[i];
+			written += length;
+		}
+	}
+};
+}
+
+std::vector<u1> Inflate::inflate(ByteView compressed, std::size_t size)
+{
+	return inflater(compressed, size).run();
+}
+
+u4 Inflate::crc32(ByteView bytes)
+{
+	static const struct table
+	{
+		u4 entries[256];
+
+		table()
+		{
+			for (u4 i = 0; i < 256; i++)
+			{
+				u4 crc = i;
+				for (int bit = 0; bit < 8; bit++)
+					crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+				entries[i] = crc;
+			}
+		}
+	} crc_table;
+	u4 crc = 0xffffffff;
+	for (u1 byte : bytes)
+		crc = crc_table.entries[(crc ^ byte) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+}
+}
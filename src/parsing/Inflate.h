@@ -0,0 +1,55 @@
+/**
+ * \file Inflate.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_PARSING_INFLATE_H_
+#define SRC_PARSING_INFLATE_H_
+
+#include "Common.h"
+#include "ByteView.h"
+#include "ParseFailureException.h"
+
+namespace mimic
+{
+namespace parsing
+{
+
+/**
+ * A decoder for raw DEFLATE data (RFC 1951), as found in ZIP archives
+ *
+ * Stored, fixed Huffman and dynamic Huffman blocks are all supported. Codes
+ * of up to nine bits, which make up nearly all of real data, are decoded with
+ * a single table lookup.
+ */
+class Inflate
+{
+public:
+	Inflate() = delete;
+
+	/**
+	 * Decompresses a complete DEFLATE stream
+	 *
+	 * @param compressed the compressed data
+	 * @param size the exact size of the decompressed data
+	 * @return the decompressed data
+	 * @throws parse_failure if the data is corrupt, or doesn't decompress to
+	 *         exactly size bytes
+	 */
+	static std::vector<u1> inflate(ByteView compressed, std::size_t size);
+
+	/**
+	 * Calculates a CRC-32 as used by ZIP, gzip and PNG
+	 *
+	 * @param bytes the data to check
+	 * @return the CRC
+	 */
+	static u4 crc32(ByteView bytes);
+};
+
+}
+}
+
+#endif /* SRC_PARSING_INFLATE_H_ */
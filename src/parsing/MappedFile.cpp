@@ -0,0 +1,57 @@
+/**
+ * \file MappedFile.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "MappedFile.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mimic
+{
+namespace parsing
+{
+
+MappedFile::MappedFile(const fs::path& path) :
+		address(nullptr), length(0)
+{
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		throw std::runtime_error("Unable to open " + path.string() + ": " + std::strerror(errno));
+	struct stat st;
+	if (::fstat(fd, &st) != 0)
+	{
+		int error = errno;
+		::close(fd);
+		throw std::runtime_error("Unable to stat " + path.string() + ": " + std::strerror(error));
+	}
+	length = st.st_size;
+	// mmap() rejects zero-length mappings, so an empty file is just an empty view
+	if (length > 0)
+	{
+		void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			int error = errno;
+			::close(fd);
+			throw std::runtime_error("Unable to map " + path.string() + ": " + std::strerror(error));
+		}
+		address = static_cast<const u1*>(mapping);
+	}
+	::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (address != nullptr)
+		::munmap(const_cast<u1*>(address), length);
+}
+
+}
+}
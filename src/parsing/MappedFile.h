@@ -0,0 +1,66 @@
+/**
+ * \file MappedFile.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_PARSING_MAPPEDFILE_H_
+#define SRC_PARSING_MAPPEDFILE_H_
+
+#include "Common.h"
+#include "ByteView.h"
+
+namespace mimic
+{
+namespace parsing
+{
+
+/**
+ * A read-only memory mapping of a whole file
+ *
+ * The file descriptor is closed as soon as the mapping has been made, so the
+ * only resource held is the mapping itself, which is released on destruction.
+ */
+class MappedFile
+{
+public:
+	MappedFile() = delete;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * Maps the given file
+	 *
+	 * @param path the file to map
+	 * @throws runtime_error if the file cannot be opened or mapped
+	 */
+	MappedFile(const fs::path& path);
+
+	virtual ~MappedFile();
+
+	/**
+	 * Maps the given file, returning a shared handle suitable for use as the
+	 * backing of a ByteConsumer
+	 *
+	 * @param path the file to map
+	 * @return the mapping
+	 */
+	static std::shared_ptr<const MappedFile> open(const fs::path& path)
+	{
+		return std::make_shared<const MappedFile>(path);
+	}
+
+	const u1* data() const { return address; };
+	std::size_t size() const { return length; };
+	ByteView view() const { return ByteView(address, length); };
+
+private:
+	const u1* address;
+	std::size_t length;
+};
+
+}
+}
+
+#endif /* SRC_PARSING_MAPPEDFILE_H_ */
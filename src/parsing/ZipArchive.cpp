@@ -0,0 +1,163 @@
+/**
+ * \file ZipArchive.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "ZipArchive.h"
+#include "Inflate.h"
+
+namespace mimic
+{
+namespace parsing
+{
+
+namespace
+{
+const u4 end_of_central_directory_signature = 0x06054b50;
+const u4 central_header_signature = 0x02014b50;
+const u4 local_header_signature = 0x04034b50;
+const std::size_t end_of_central_directory_size = 22;
+const std::size_t central_header_size = 46;
+const std::size_t local_header_size = 30;
+const u2 encrypted_flag = 0x0001;
+
+/*
+ * ZIP is little-endian throughout, unlike class files, so ByteConsumer's
+ * readers don't apply
+ */
+u2 readLe2(const u1* p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+u4 readLe4(const u1* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<u4>(p[3]) << 24);
+}
+}
+
+std::size_t ZipArchive::name_hash::operator()(const ByteView& name) const
+{
+	// FNV-1a
+	std::size_t hash = 14695981039346656037ULL;
+	for (u1 byte : name)
+		hash = (hash ^ byte) * 1099511628211ULL;
+	return hash;
+}
+
+ZipArchive::ZipArchive(const fs::path& path) :
+		mapping(MappedFile::open(path))
+{
+	readCentralDirectory();
+}
+
+void ZipArchive::readCentralDirectory()
+{
+	const u1* data = mapping->data();
+	std::size_t size = mapping->size();
+	if (size < end_of_central_directory_size)
+		throw parse_failure("Not a ZIP archive");
+	// The end record is last, but may be followed by a comment of up to 64K
+	std::size_t lowest = size > end_of_central_directory_size + 0xffff ?
+			size - end_of_central_directory_size - 0xffff : 0;
+	std::size_t end = size - end_of_central_directory_size;
+	while (readLe4(data + end) != end_of_central_directory_signature)
+	{
+		if (end == lowest)
+			throw parse_failure("Not a ZIP archive");
+		end--;
+	}
+	const u1* record = data + end;
+	u2 entry_count = readLe2(record + 10);
+	u4 directory_size = readLe4(record + 12);
+	u4 directory_offset = readLe4(record + 16);
+	if (entry_count == 0xffff || directory_offset == 0xffffffff)
+		throw parse_failure("ZIP64 archives aren't supported");
+	if (directory_offset > end || directory_size > end - directory_offset)
+		throw parse_failure("Central directory is outside the archive");
+
+	entries.reserve(entry_count);
+	index.reserve(entry_count);
+	const u1* position = data + directory_offset;
+	const u1* last = position + directory_size;
+	for (u2 i = 0; i < entry_count; i++)
+	{
+		if (last - position < static_cast<std::ptrdiff_t>(central_header_size)
+				|| readLe4(position) != central_header_signature)
+			throw parse_failure("Corrupt central directory entry");
+		u2 name_length = readLe2(position + 28);
+		u2 extra_length = readLe2(position + 30);
+		u2 comment_length = readLe2(position + 32);
+		std::size_t header_size = central_header_size + name_length + extra_length + comment_length;
+		if (static_cast<std::size_t>(last - position) < header_size)
+			throw parse_failure("Corrupt central directory entry");
+		entry e;
+		e.flags = readLe2(position + 8);
+		e.method = static_cast<compression>(readLe2(position + 10));
+		e.crc = readLe4(position + 16);
+		e.compressed_size = readLe4(position + 20);
+		e.size = readLe4(position + 24);
+		e.local_header_offset = readLe4(position + 42);
+		e.name = ByteView(position + central_header_size, name_length);
+		entries.push_back(e);
+		// If a name appears twice, the first wins, as with java.util.zip
+		index.emplace(e.name, entries.size() - 1);
+		position += header_size;
+	}
+}
+
+const ZipArchive::entry* ZipArchive::find(ByteView name) const
+{
+	auto found = index.find(name);
+	return found == index.end() ? nullptr : &entries[found->second];
+}
+
+const ZipArchive::entry* ZipArchive::find(const std::string& name) const
+{
+	return find(ByteView(reinterpret_cast<const u1*>(name.data()), name.size()));
+}
+
+ZipArchive::contents ZipArchive::read(const entry& e) const
+{
+	if (e.flags & encrypted_flag)
+		throw parse_failure("Encrypted ZIP entries aren't supported");
+	const u1* data = mapping->data();
+	std::size_t size = mapping->size();
+	if (e.local_header_offset > size || size - e.local_header_offset < local_header_size
+			|| readLe4(data + e.local_header_offset) != local_header_signature)
+		throw parse_failure("Corrupt local header");
+	// The local name and extra field lengths can differ from the central ones
+	const u1* header = data + e.local_header_offset;
+	std::size_t offset = e.local_header_offset + local_header_size + readLe2(header + 26) + readLe2(header + 28);
+	if (offset > size || size - offset < e.compressed_size)
+		throw parse_failure("Entry data is outside the archive");
+	ByteView raw(data + offset, e.compressed_size);
+
+	switch (e.method)
+	{
+	case stored:
+		if (e.compressed_size != e.size)
+			throw parse_failure("Stored entry sizes don't match");
+		return contents{raw, mapping};
+	case deflated:
+	{
+		auto inflated = std::make_shared<const std::vector<u1>>(Inflate::inflate(raw, e.size));
+		if (Inflate::crc32(*inflated) != e.crc)
+			throw parse_failure("Entry CRC doesn't match");
+		return contents{ByteView(*inflated), inflated};
+	}
+	default:
+		throw parse_failure("Unsupported ZIP compression method");
+	}
+}
+
+std::unique_ptr<ByteConsumer> ZipArchive::open(const entry& e) const
+{
+	contents c = read(e);
+	return std::unique_ptr<ByteConsumer>(new ByteConsumer(c.bytes.data(), c.bytes.size(), c.backing));
+}
+
+}
+}
@@ -0,0 +1,139 @@
+/**
+ * \file ZipArchive.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_PARSING_ZIPARCHIVE_H_
+#define SRC_PARSING_ZIPARCHIVE_H_
+
+#include <string>
+#include <unordered_map>
+#include "Common.h"
+#include "ByteConsumer.h"
+#include "ByteView.h"
+#include "MappedFile.h"
+#include "ParseFailureException.h"
+
+namespace mimic
+{
+namespace parsing
+{
+
+/**
+ * A read-only ZIP archive, such as a jar
+ *
+ * The archive is memory-mapped and its central directory read up front into
+ * a hash index, so entries can be found by name in constant time. Nothing is
+ * read from an entry until it's asked for: stored entries are handed out as
+ * views of the mapping without any copying, and deflated ones are inflated
+ * and CRC checked each time they're read. Stored entries aren't CRC checked,
+ * so that reading one never touches its bytes.
+ *
+ * ZIP64 archives, encryption and compression methods other than deflate
+ * aren't supported.
+ */
+class ZipArchive
+{
+public:
+	enum compression : u2
+	{
+		stored = 0,
+		deflated = 8
+	};
+
+	/**
+	 * An entry in the central directory
+	 */
+	struct entry
+	{
+		/** The entry's name, a view of the mapped archive */
+		ByteView name;
+		compression method;
+		u2 flags;
+		u4 crc;
+		u4 compressed_size;
+		u4 size;
+		u4 local_header_offset;
+
+		bool isDirectory() const { return !name.empty() && name[name.size() - 1] == '/'; };
+	};
+
+	/**
+	 * The bytes of an entry, along with whatever keeps them alive
+	 */
+	struct contents
+	{
+		ByteView bytes;
+		std::shared_ptr<const void> backing;
+	};
+
+	ZipArchive() = delete;
+	ZipArchive(const ZipArchive&) = delete;
+	ZipArchive& operator=(const ZipArchive&) = delete;
+
+	/**
+	 * Maps an archive and reads its central directory
+	 *
+	 * @param path the archive
+	 * @throws runtime_error if the file cannot be mapped
+	 * @throws parse_failure if the central directory is malformed
+	 */
+	ZipArchive(const fs::path& path);
+
+	/**
+	 * @return every entry, in central directory order
+	 */
+	const std::vector<entry>& getEntries() const { return entries; };
+
+	/**
+	 * @param name the full name of an entry, e.g. java/lang/Object.class
+	 * @return the entry, or nullptr if there's no such entry
+	 */
+	const entry* find(ByteView name) const;
+	const entry* find(const std::string& name) const;
+
+	/**
+	 * @param class_name a binary class name, e.g. java/lang/Object
+	 * @return the entry for the class, or nullptr if it isn't in the archive
+	 */
+	const entry* findClass(const std::string& class_name) const { return find(class_name + ".class"); };
+
+	/**
+	 * Reads an entry, inflating it if necessary
+	 *
+	 * @param e an entry of this archive
+	 * @return the entry's bytes, which are kept alive by the returned backing
+	 * @throws parse_failure if the entry is corrupt or can't be decompressed
+	 */
+	contents read(const entry& e) const;
+
+	/**
+	 * Creates a ByteConsumer over an entry, suitable for parsing a class from.
+	 * The consumer's backing keeps the entry's bytes alive.
+	 *
+	 * @param e an entry of this archive
+	 * @return the consumer
+	 * @throws parse_failure if the entry is corrupt or can't be decompressed
+	 */
+	std::unique_ptr<ByteConsumer> open(const entry& e) const;
+
+private:
+	struct name_hash
+	{
+		std::size_t operator()(const ByteView& name) const;
+	};
+
+	std::shared_ptr<const MappedFile> mapping;
+	std::vector<entry> entries;
+	/** Entry names to their position in entries */
+	std::unordered_map<ByteView, std::size_t, name_hash> index;
+
+	void readCentralDirectory();
+};
+
+}
+}
+
+#endif /* SRC_PARSING_ZIPARCHIVE_H_ */
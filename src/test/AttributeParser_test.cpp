@@ -0,0 +1,170 @@
+/**
+ * \file AttributeParser_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "test/TestCommon.h"
+#include "AttributeParser.h"
+#include "parsing/ParseFailureException.h"
+
+namespace mimic
+{
+
+class AttributeParserTest: public testing::Test
+{
+
+protected:
+  AttributeParserTest()
+  {
+  }
+
+  virtual ~AttributeParserTest()
+  {
+  }
+};
+
+TEST_F(AttributeParserTest, TestKindOfKnownNames)
+{
+  for (u1 k = AttributeParser::attr_constant_value; k <= AttributeParser::attr_method_parameters; k++)
+  {
+    auto kind = static_cast<AttributeParser::kind>(k);
+    Symbol name = AttributeParser::nameOf(kind);
+    EXPECT_EQ(kind, AttributeParser::kindOf(name)) << name;
+    EXPECT_EQ(kind, AttributeParser::kindOf(name.view())) << name;
+  }
+  EXPECT_EQ(AttributeParser::attr_code, AttributeParser::kindOf(Symbol::intern(JUtf8String("Code"))));
+  EXPECT_EQ(AttributeParser::attr_bootstrap_methods,
+            AttributeParser::kindOf(JUtf8String("BootstrapMethods").view()));
+}
+
+TEST_F(AttributeParserTest, TestKindOfUnknownNames)
+{
+  for (auto name : {"", "code", "Codes", "Cod", "SourceFile ", "StackMap", "Module"})
+  {
+    EXPECT_EQ(AttributeParser::attr_unknown, AttributeParser::kindOf(Symbol::intern(JUtf8String(name)))) << name;
+    EXPECT_EQ(AttributeParser::attr_unknown, AttributeParser::kindOf(JUtf8String(name).view())) << name;
+  }
+}
+
+TEST_F(AttributeParserTest, TestFirstVersion)
+{
+  EXPECT_EQ(45, AttributeParser::firstVersion(AttributeParser::attr_code));
+  EXPECT_EQ(50, AttributeParser::firstVersion(AttributeParser::attr_stack_map_table));
+  EXPECT_EQ(51, AttributeParser::firstVersion(AttributeParser::attr_bootstrap_methods));
+  EXPECT_EQ(52, AttributeParser::firstVersion(AttributeParser::attr_method_parameters));
+}
+
+TEST_F(AttributeParserTest, TestAnnotations)
+{
+  std::vector<u1> info = {
+    0, 1,                   // num_annotations
+    0, 10, 0, 4,            // type_index, num_element_value_pairs
+    0, 11, 'I', 0, 20,      // an int
+    0, 12, 'e', 0, 21, 0, 22, // an enum constant
+    0, 13, '[', 0, 2,       // an array of
+    's', 0, 23,             //   a string
+    'c', 0, 24,             //   and a class
+    0, 14, '@', 0, 25, 0, 1, // a nested annotation
+    0, 15, 'Z', 0, 26
+  };
+  attributes::lazy<attributes::runtime_visible_annotations> lazy{3, parsing::ByteView(info)};
+  auto decoded = lazy.decode();
+  EXPECT_EQ(3, decoded.attribute_name_index);
+  ASSERT_EQ(1u, decoded.annotations.size());
+  auto& annotation = decoded.annotations[0];
+  EXPECT_EQ(10, annotation.type_index);
+  ASSERT_EQ(4u, annotation.elements.size());
+
+  EXPECT_EQ(11, annotation.elements[0].element_name_index);
+  EXPECT_EQ('I', annotation.elements[0].value.type_tag);
+  EXPECT_EQ(20, *getIf<u2>(annotation.elements[0].value.value));
+
+  auto constant = getIf<std::tuple<u2, u2>>(annotation.elements[1].value.value);
+  ASSERT_NE(nullptr, constant);
+  EXPECT_EQ(std::make_tuple(u2(21), u2(22)), *constant);
+
+  auto array = getIf<std::vector<attributes::annotation_element_value>>(annotation.elements[2].value.value);
+  ASSERT_NE(nullptr, array);
+  ASSERT_EQ(2u, array->size());
+  EXPECT_EQ('s', (*array)[0].type_tag);
+  EXPECT_EQ(23, *getIf<u2>((*array)[0].value));
+  EXPECT_EQ('c', (*array)[1].type_tag);
+  EXPECT_EQ(24, *getIf<u2>((*array)[1].value));
+
+  auto nested = getIf<std::shared_ptr<const attributes::annotation>>(annotation.elements[3].value.value);
+  ASSERT_NE(nullptr, nested);
+  EXPECT_EQ(25, (*nested)->type_index);
+  ASSERT_EQ(1u, (*nested)->elements.size());
+  EXPECT_EQ(15, (*nested)->elements[0].element_name_index);
+  EXPECT_EQ(26, *getIf<u2>((*nested)->elements[0].value.value));
+}
+
+TEST_F(AttributeParserTest, TestParameterAnnotations)
+{
+  std::vector<u1> info = {2, 0, 0, 0, 1, 0, 10, 0, 0};
+  auto decoded = AttributeParser::decode<attributes::runtime_invisible_parameter_annotations>(3, info);
+  ASSERT_EQ(2u, decoded.parameter_annotations.size());
+  EXPECT_TRUE(decoded.parameter_annotations[0].empty());
+  ASSERT_EQ(1u, decoded.parameter_annotations[1].size());
+  EXPECT_EQ(10, decoded.parameter_annotations[1][0].type_index);
+}
+
+TEST_F(AttributeParserTest, TestInvalidElementValues)
+{
+  std::vector<u1> bad_tag = {0, 1, 0, 10, 0, 1, 0, 11, 'X', 0, 0};
+  EXPECT_THROW(AttributeParser::decode<attributes::runtime_visible_annotations>(3, bad_tag),
+               parsing::parse_failure);
+  // Arrays nested far too deeply for any real annotation
+  std::vector<u1> deep;
+  for (int i = 0; i < 1000; i++)
+    deep.insert(deep.end(), {'[', 0, 1});
+  deep.insert(deep.end(), {'I', 0, 1});
+  EXPECT_THROW(AttributeParser::decode<attributes::annotation_default>(3, deep), parsing::parse_failure);
+}
+
+TEST_F(AttributeParserTest, TestLengthMismatch)
+{
+  std::vector<u1> extra = {0, 6, 0};
+  EXPECT_THROW(AttributeParser::decode<attributes::source_file>(3, extra), parsing::parse_failure);
+  std::vector<u1> truncated = {0, 2, 0, 1, 0};
+  EXPECT_THROW(AttributeParser::decode<attributes::exceptions>(3, truncated), parsing::parse_failure);
+  std::vector<u1> none;
+  EXPECT_THROW(AttributeParser::decode<attributes::constant_value>(3, none), parsing::parse_failure);
+  EXPECT_EQ(3, AttributeParser::decode<attributes::deprecated>(3, none).attribute_name_index);
+}
+
+TEST_F(AttributeParserTest, TestLocalVariables)
+{
+  std::vector<u1> info = {0, 2, 0, 0, 0, 5, 0, 10, 0, 11, 0, 0, 0, 1, 0, 4, 0, 12, 0, 13, 0, 1};
+  auto variables = AttributeParser::decode<attributes::local_variable_table>(3, info);
+  ASSERT_EQ(2u, variables.table.size());
+  EXPECT_EQ(5, variables.table[0].length);
+  EXPECT_EQ(11, variables.table[0].descriptor_index);
+  EXPECT_EQ(1, variables.table[1].start_pc);
+  EXPECT_EQ(1, variables.table[1].index);
+  auto types = AttributeParser::decode<attributes::local_variable_type_table>(3, info);
+  ASSERT_EQ(2u, types.table.size());
+  EXPECT_EQ(13, types.table[1].signature_index);
+}
+
+TEST_F(AttributeParserTest, TestBootstrapMethods)
+{
+  std::vector<u1> info = {0, 2, 0, 5, 0, 2, 0, 6, 0, 7, 0, 8, 0, 0};
+  auto methods = AttributeParser::decode<attributes::bootstrap_methods>(3, info);
+  ASSERT_EQ(2u, methods.info.size());
+  EXPECT_EQ(5, methods.info[0].bootstrap_method_ref);
+  EXPECT_EQ((std::vector<u2>{6, 7}), methods.info[0].bootstrap_arguments);
+  EXPECT_EQ(8, methods.info[1].bootstrap_method_ref);
+  EXPECT_TRUE(methods.info[1].bootstrap_arguments.empty());
+}
+
+TEST_F(AttributeParserTest, TestSourceDebugExtension)
+{
+  std::vector<u1> info = {'S', 'M', 'A', 'P'};
+  attributes::lazy<attributes::source_debug_extension> lazy{3, parsing::ByteView(info)};
+  EXPECT_EQ(JUtf8String("SMAP"), lazy.decode().debug_extension);
+}
+
+}
@@ -0,0 +1,335 @@
+/**
+ * \file ClassArchive_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+#include "test/TestCommon.h"
+#include "ClassArchive.h"
+#include "ClassFileLoader.h"
+#include "ClassPath.h"
+
+namespace mimic
+{
+
+class ClassArchiveTest: public testing::Test
+{
+
+protected:
+  fs::path hello_world = fs::path("src/test/resources/HelloWorld.class");
+  fs::path directory;
+  fs::path archive;
+  std::vector<u1> source;
+
+  ClassArchiveTest()
+  {
+    directory = fs::temp_directory_path() / ("mimic_archive_test_" + std::to_string(::getpid()));
+    fs::create_directories(directory);
+    archive = directory / "classes.jsa";
+    source = parsing::MappedFile(hello_world).view();
+  }
+
+  virtual ~ClassArchiveTest()
+  {
+    fs::remove_all(directory);
+  }
+
+  void writeArchive()
+  {
+    ClassArchive::Writer writer;
+    writer.add(source, ClassArchive::modificationTime(hello_world));
+    // The same class again is only stored once
+    writer.add(source);
+    ASSERT_EQ(1u, writer.getClassCount());
+    writer.write(archive);
+  }
+};
+
+TEST_F(ClassArchiveTest, TestRoundTrip)
+{
+  writeArchive();
+  ClassFile parsed(hello_world);
+  ClassArchive classes(archive);
+  ASSERT_EQ(1u, classes.getClassCount());
+  auto loaded = classes.load(source);
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(parsed.getMajorVersion(), loaded->getMajorVersion());
+  EXPECT_EQ(parsed.getMinorVersion(), loaded->getMinorVersion());
+  EXPECT_EQ(parsed.getAccessFlags(), loaded->getAccessFlags());
+  EXPECT_EQ(parsed.getThisClass(), loaded->getThisClass());
+  EXPECT_EQ(parsed.getSuperClass(), loaded->getSuperClass());
+  EXPECT_EQ(parsed.getInterfaces(), loaded->getInterfaces());
+  ASSERT_EQ(parsed.getMethodsCount(), loaded->getMethodsCount());
+  for (std::size_t i = 0; i < parsed.getMethodsCount(); i++)
+  {
+    EXPECT_EQ(parsed.getMethods()[i].flags, loaded->getMethods()[i].flags);
+    EXPECT_EQ(parsed.getMethods()[i].name_index, loaded->getMethods()[i].name_index);
+    EXPECT_EQ(parsed.getMethods()[i].descriptor_index, loaded->getMethods()[i].descriptor_index);
+    auto expected_code = getIf<attributes::code>(parsed.getMethods()[i].attrs.at(0));
+    auto actual_code = getIf<attributes::code>(loaded->getMethods()[i].attrs.at(0));
+    ASSERT_NE(nullptr, actual_code);
+    EXPECT_EQ(expected_code->code, actual_code->code);
+    EXPECT_EQ(expected_code->attrs.size(), actual_code->attrs.size());
+  }
+  ASSERT_EQ(parsed.getFieldCount(), loaded->getFieldCount());
+  ASSERT_EQ(parsed.getAttributesCount(), loaded->getAttributesCount());
+  EXPECT_EQ(getIf<attributes::source_file>(parsed.getAttributes()[0])->sourcefile_index,
+            getIf<attributes::source_file>(loaded->getAttributes()[0])->sourcefile_index);
+
+  auto& expected = parsed.getConstantPool();
+  auto& actual = loaded->getConstantPool();
+  EXPECT_TRUE(actual.isLazy());
+  ASSERT_EQ(expected.size(), actual.size());
+  for (u2 i = 1; i < expected.size(); i++)
+  {
+    ASSERT_EQ(expected.getType(i), actual.getType(i)) << "at index " << i;
+    if (expected.getType(i) >= ConstantPool::cp_utf8)
+    {
+      EXPECT_EQ(expected.getSymbol(i), actual.getSymbol(i)) << "at index " << i;
+    }
+  }
+  EXPECT_EQ(JUtf8String("<init>"), actual.get<const JUtf8String>(7));
+  EXPECT_EQ(expected.get<const ConstantPool::Methodref_info>(1).class_index,
+            actual.get<const ConstantPool::Methodref_info>(1).class_index);
+}
+
+TEST_F(ClassArchiveTest, TestClassOutlivesArchive)
+{
+  writeArchive();
+  optional<ClassFile> loaded;
+  {
+    ClassArchive classes(archive);
+    loaded = classes.load(source);
+  }
+  ASSERT_TRUE(loaded);
+  EXPECT_EQ(JUtf8String("<init>"), loaded->getConstantPool().get<const JUtf8String>(7));
+}
+
+TEST_F(ClassArchiveTest, TestChangedClassIsNotFound)
+{
+  writeArchive();
+  ClassArchive classes(archive);
+  auto changed = source;
+  changed[changed.size() - 1] ^= 1;
+  EXPECT_FALSE(classes.load(changed));
+  changed = source;
+  changed.push_back(0);
+  EXPECT_FALSE(classes.load(changed));
+  EXPECT_TRUE(classes.load(source));
+}
+
+TEST_F(ClassArchiveTest, TestFoundByDigest)
+{
+  writeArchive();
+  std::vector<u1> bytes = parsing::MappedFile(archive).view();
+  auto digest = Sha256::hash(source);
+  EXPECT_NE(bytes.end(), std::search(bytes.begin(), bytes.end(), digest.begin(), digest.end()));
+}
+
+TEST_F(ClassArchiveTest, TestFoundByName)
+{
+  writeArchive();
+  ClassArchive classes(archive);
+  u8 modified = ClassArchive::modificationTime(hello_world);
+  auto loaded = classes.find(JUtf8String("HelloWorld"), source.size(), modified);
+  ASSERT_TRUE(loaded);
+  auto& cp = loaded->getConstantPool();
+  EXPECT_EQ(JUtf8String("HelloWorld"),
+            cp.get<const JUtf8String>(cp.get<const ConstantPool::Class_info>(loaded->getThisClass()).name_index));
+  EXPECT_FALSE(classes.find(JUtf8String("HelloWorlds"), source.size(), modified));
+  EXPECT_FALSE(classes.find(JUtf8String("java/lang/Object"), source.size(), modified));
+  // A class file that has changed since the archive was written
+  EXPECT_FALSE(classes.find(JUtf8String("HelloWorld"), source.size() + 1, modified));
+  EXPECT_FALSE(classes.find(JUtf8String("HelloWorld"), source.size(), modified + 1));
+}
+
+TEST_F(ClassArchiveTest, TestNotFoundByNameWithoutModificationTime)
+{
+  ClassArchive::Writer writer;
+  writer.add(source);
+  writer.write(archive);
+  ClassArchive classes(archive);
+  EXPECT_TRUE(classes.load(source));
+  EXPECT_FALSE(classes.find(JUtf8String("HelloWorld"), source.size(), 0));
+}
+
+TEST_F(ClassArchiveTest, TestClassPathUsesArchive)
+{
+  fs::path file = directory / "HelloWorld.class";
+  fs::copy_file(hello_world, file);
+  ClassArchive::Writer writer;
+  writer.add(source, ClassArchive::modificationTime(file));
+  writer.write(archive);
+
+  ClassPath classes(std::vector<fs::path>{directory});
+  classes.setArchive(ClassArchive::open(archive));
+  auto found = classes.find("HelloWorld");
+  ASSERT_TRUE(found);
+  EXPECT_TRUE(found->getConstantPool().isLazy());
+  EXPECT_FALSE(classes.find("Missing"));
+
+  // Once the class file has been rewritten it's parsed rather than taken from the archive
+  fs::last_write_time(file, fs::last_write_time(file) + std::chrono::seconds(1));
+  found = classes.find("HelloWorld");
+  ASSERT_TRUE(found);
+  EXPECT_FALSE(found->getConstantPool().isLazy());
+
+  // Classes are only taken from the archive where the class path has their files
+  fs::remove(file);
+  EXPECT_FALSE(classes.find("HelloWorld"));
+}
+
+TEST_F(ClassArchiveTest, TestInvalidClassIsNotArchived)
+{
+  ClassArchive::Writer writer;
+  auto invalid = source;
+  invalid.resize(invalid.size() - 1);
+  EXPECT_THROW(writer.add(invalid), parsing::parse_failure);
+  EXPECT_EQ(0u, writer.getClassCount());
+}
+
+TEST_F(ClassArchiveTest, TestRejectsOtherFiles)
+{
+  EXPECT_THROW(ClassArchive{hello_world}, parsing::parse_failure);
+  writeArchive();
+  // Truncate the archive
+  std::vector<u1> truncated = parsing::MappedFile(archive).view();
+  truncated.pop_back();
+  std::ofstream(archive, std::ios::binary | std::ios::trunc)
+      .write(reinterpret_cast<const char*>(truncated.data()), truncated.size());
+  EXPECT_THROW(ClassArchive{archive}, parsing::parse_failure);
+}
+
+TEST_F(ClassArchiveTest, TestRejectsCorruptRecords)
+{
+  writeArchive();
+  std::vector<u1> bytes = parsing::MappedFile(archive).view();
+  // Cut the archive short anywhere, keeping the size in the header right, and
+  // the class' record or its strings are cut short
+  for (std::size_t size = bytes.size() - 1; size >= 40; size--)
+  {
+    std::vector<u1> truncated(bytes.begin(), bytes.begin() + size);
+    u8 archive_size = size;
+    std::memcpy(truncated.data() + 32, &archive_size, sizeof(archive_size));
+    std::ofstream(archive, std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char*>(truncated.data()), truncated.size());
+    try
+    {
+      ClassArchive classes(archive);
+      EXPECT_THROW(classes.load(source), parsing::parse_failure) << "at size " << size;
+    }
+    catch (parsing::parse_failure&)
+    {
+      // The hash table was cut short
+    }
+  }
+}
+
+TEST_F(ClassArchiveTest, TestRejectsCorruptConstantPools)
+{
+  writeArchive();
+  const std::vector<u1> bytes = parsing::MappedFile(archive).view();
+  u4 table_capacity;
+  u4 table_offset;
+  std::memcpy(&table_capacity, bytes.data() + 20, sizeof(table_capacity));
+  std::memcpy(&table_offset, bytes.data() + 24, sizeof(table_offset));
+  u4 record_offset = 0;
+  for (u4 slot = 0; slot < table_capacity && !record_offset; slot++)
+    std::memcpy(&record_offset, bytes.data() + table_offset + slot * 40 + 36, sizeof(record_offset));
+  ASSERT_NE(0u, record_offset);
+  u2 constant_pool_count;
+  u4 utf8_count;
+  std::memcpy(&constant_pool_count, bytes.data() + record_offset + 4, sizeof(constant_pool_count));
+  std::memcpy(&utf8_count, bytes.data() + record_offset + 20, sizeof(utf8_count));
+  std::size_t payloads = record_offset + 24;
+  std::size_t tags = payloads + 4 * (constant_pool_count + utf8_count);
+  std::size_t class_entry = 0;
+  for (std::size_t i = 1; i < constant_pool_count && !class_entry; i++)
+  {
+    if (bytes[tags + i] == ConstantPool::Class)
+      class_entry = i;
+  }
+  ASSERT_NE(0u, class_entry);
+
+  auto rejected = [&](std::size_t position, std::vector<u1> replacement) {
+    std::vector<u1> corrupt = bytes;
+    std::copy(replacement.begin(), replacement.end(), corrupt.begin() + position);
+    std::ofstream(archive, std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char*>(corrupt.data()), corrupt.size());
+    ClassArchive classes(archive);
+    EXPECT_THROW(classes.load(source), parsing::parse_failure) << "at " << position;
+  };
+  // A tag no class file has
+  rejected(tags + 1, {2});
+  // A Long without its upper half
+  rejected(tags + constant_pool_count - 1, {ConstantPool::Long});
+  // A Class whose name is past the end of the pool
+  u4 past_end = constant_pool_count;
+  rejected(payloads + 4 * class_entry, {u1(past_end), u1(past_end >> 8), u1(past_end >> 16), u1(past_end >> 24)});
+}
+
+TEST_F(ClassArchiveTest, TestFullTableIsProbedOnce)
+{
+  writeArchive();
+  std::vector<u1> bytes = parsing::MappedFile(archive).view();
+  u4 table_capacity;
+  u4 table_offset;
+  std::memcpy(&table_capacity, bytes.data() + 20, sizeof(table_capacity));
+  std::memcpy(&table_offset, bytes.data() + 24, sizeof(table_offset));
+  // Fill every slot with the class' entry, so there's no empty one to stop at
+  std::size_t entry_size = 40;
+  std::vector<u1> entry;
+  for (u4 slot = 0; slot < table_capacity; slot++)
+  {
+    auto position = bytes.begin() + table_offset + slot * entry_size;
+    if (std::any_of(position, position + entry_size, [](u1 b) { return b != 0; }))
+      entry.assign(position, position + entry_size);
+  }
+  ASSERT_EQ(entry_size, entry.size());
+  for (u4 slot = 0; slot < table_capacity; slot++)
+    std::copy(entry.begin(), entry.end(), bytes.begin() + table_offset + slot * entry_size);
+  std::ofstream(archive, std::ios::binary | std::ios::trunc)
+      .write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  ClassArchive classes(archive);
+  auto changed = source;
+  changed[changed.size() - 1] ^= 1;
+  EXPECT_FALSE(classes.load(changed));
+  EXPECT_TRUE(classes.load(source));
+}
+
+TEST_F(ClassArchiveTest, TestEmptyArchive)
+{
+  ClassArchive::Writer().write(archive);
+  ClassArchive classes(archive);
+  EXPECT_EQ(0u, classes.getClassCount());
+  EXPECT_FALSE(classes.load(source));
+  EXPECT_FALSE(classes.find(JUtf8String("HelloWorld"), source.size(), ClassArchive::modificationTime(hello_world)));
+}
+
+TEST_F(ClassArchiveTest, TestLoaderUsesArchive)
+{
+  writeArchive();
+  fs::copy_file(hello_world, directory / "Hello.class");
+  // A class that isn't in the archive is parsed as usual
+  auto changed = source;
+  changed[changed.size() - 1] ^= 1;
+  std::ofstream(directory / "Changed.class", std::ios::binary)
+      .write(reinterpret_cast<const char*>(changed.data()), changed.size());
+  ClassFileLoader loader(2);
+  loader.setArchive(ClassArchive::open(archive));
+  auto report = loader.loadDirectory(directory);
+  ASSERT_EQ(2u, report.results.size());
+  EXPECT_TRUE(report.results[0].loaded());
+  EXPECT_FALSE(report.results[0].archived);
+  EXPECT_FALSE(report.results[0].clazz->getConstantPool().isLazy());
+  EXPECT_TRUE(report.results[1].loaded());
+  EXPECT_TRUE(report.results[1].archived);
+  EXPECT_EQ(1u, report.archived);
+}
+
+}
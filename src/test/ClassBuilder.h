@@ -0,0 +1,398 @@
+/**
+ * \file ClassBuilder.h
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#ifndef SRC_TEST_CLASSBUILDER_H_
+#define SRC_TEST_CLASSBUILDER_H_
+
+#include <cstring>
+#include <map>
+#include <string>
+#include "Common.h"
+#include "Bytecode.h"
+#include "ClassFile.h"
+#include "ConstantPool.h"
+
+namespace mimic
+{
+
+/**
+ * Assembles a method's code, with branches to named labels, for tests and
+ * benchmarks that need classes no compiler is at hand to produce
+ */
+class CodeBuilder
+{
+public:
+  CodeBuilder& op(u1 opcode)
+  {
+    bytes.push_back(opcode);
+    return *this;
+  }
+
+  /** An instruction with a one byte operand, like bipush, iload or newarray */
+  CodeBuilder& op(u1 opcode, u1 operand)
+  {
+    bytes.insert(bytes.end(), {opcode, operand});
+    return *this;
+  }
+
+  /** An instruction with a two byte operand, like sipush or a constant pool reference */
+  CodeBuilder& op2(u1 opcode, u2 operand)
+  {
+    bytes.insert(bytes.end(), {opcode, static_cast<u1>(operand >> 8), static_cast<u1>(operand)});
+    return *this;
+  }
+
+  CodeBuilder& iinc(u1 index, s1 delta)
+  {
+    bytes.insert(bytes.end(), {Bytecode::op_iinc, index, static_cast<u1>(delta)});
+    return *this;
+  }
+
+  CodeBuilder& invokeinterface(u2 index, u1 count)
+  {
+    op2(Bytecode::op_invokeinterface, index);
+    bytes.insert(bytes.end(), {count, 0});
+    return *this;
+  }
+
+  CodeBuilder& multianewarray(u2 index, u1 dimensions)
+  {
+    op2(Bytecode::op_multianewarray, index);
+    bytes.push_back(dimensions);
+    return *this;
+  }
+
+  /** A branch with a two byte offset to a label, which may come later */
+  CodeBuilder& branch(u1 opcode, const std::string& label)
+  {
+    u4 pc = static_cast<u4>(bytes.size());
+    bytes.push_back(opcode);
+    fixups.push_back(fixup{static_cast<u4>(bytes.size()), pc, label, false});
+    bytes.insert(bytes.end(), {0, 0});
+    return *this;
+  }
+
+  CodeBuilder& tableswitch(s4 low, const std::string& default_label, const std::vector<std::string>& labels)
+  {
+    u4 pc = switchHeader(Bytecode::op_tableswitch, default_label);
+    put4(static_cast<u4>(low));
+    put4(static_cast<u4>(low + static_cast<s4>(labels.size()) - 1));
+    for (auto& label : labels)
+    {
+      fixups.push_back(fixup{static_cast<u4>(bytes.size()), pc, label, true});
+      put4(0);
+    }
+    return *this;
+  }
+
+  CodeBuilder& lookupswitch(const std::string& default_label, const std::vector<std::pair<s4, std::string>>& pairs)
+  {
+    u4 pc = switchHeader(Bytecode::op_lookupswitch, default_label);
+    put4(static_cast<u4>(pairs.size()));
+    for (auto& pair : pairs)
+    {
+      put4(static_cast<u4>(pair.first));
+      fixups.push_back(fixup{static_cast<u4>(bytes.size()), pc, pair.second, true});
+      put4(0);
+    }
+    return *this;
+  }
+
+  CodeBuilder& label(const std::string& name)
+  {
+    labels[name] = static_cast<u4>(bytes.size());
+    return *this;
+  }
+
+  u2 pcOf(const std::string& label) const { return static_cast<u2>(labels.at(label)); }
+
+  /** @return the code, with the branches filled in */
+  std::vector<u1> build() const
+  {
+    std::vector<u1> code(bytes);
+    for (auto& f : fixups)
+    {
+      u4 offset = labels.at(f.label) - f.pc;
+      if (f.wide)
+      {
+        for (int i = 0; i < 4; i++)
+          code[f.at + i] = static_cast<u1>(offset >> (24 - 8 * i));
+      }
+      else
+      {
+        code[f.at] = static_cast<u1>(offset >> 8);
+        code[f.at + 1] = static_cast<u1>(offset);
+      }
+    }
+    return code;
+  }
+
+private:
+  struct fixup
+  {
+    /** Where the offset goes */
+    u4 at;
+    /** The pc of the branch, which the offset is from */
+    u4 pc;
+    std::string label;
+    /** Whether the offset takes four bytes rather than two */
+    bool wide;
+  };
+
+  std::vector<u1> bytes;
+  std::vector<fixup> fixups;
+  std::map<std::string, u4> labels;
+
+  void put4(u4 value)
+  {
+    bytes.insert(bytes.end(), {static_cast<u1>(value >> 24), static_cast<u1>(value >> 16),
+                               static_cast<u1>(value >> 8), static_cast<u1>(value)});
+  }
+
+  u4 switchHeader(u1 opcode, const std::string& default_label)
+  {
+    u4 pc = static_cast<u4>(bytes.size());
+    bytes.push_back(opcode);
+    while (bytes.size() % 4 != 0)
+      bytes.push_back(0);
+    fixups.push_back(fixup{static_cast<u4>(bytes.size()), pc, default_label, true});
+    put4(0);
+    return pc;
+  }
+};
+
+/**
+ * Assembles a class file, adding constant pool entries as they are asked for
+ */
+class ClassBuilder
+{
+public:
+  struct handler
+  {
+    std::string start;
+    std::string end;
+    std::string handler;
+    /** The class caught, or 0 for any */
+    u2 catch_type;
+  };
+
+  explicit ClassBuilder(const std::string& name, const std::string& super = "java/lang/Object",
+                        u2 flags = ClassFile::acc_public | ClassFile::acc_super, u2 major_version = 52)
+    : flags(flags), major_version(major_version), count(1)
+  {
+    this_class = classRef(name);
+    super_class = classRef(super);
+  }
+
+  u2 utf8(const std::string& str)
+  {
+    std::vector<u1> entry = {ConstantPool::Utf8, static_cast<u1>(str.size() >> 8), static_cast<u1>(str.size())};
+    entry.insert(entry.end(), str.begin(), str.end());
+    return add("U" + str, entry);
+  }
+
+  u2 classRef(const std::string& name) { return add("C" + name, reference(ConstantPool::Class, utf8(name))); }
+  u2 string(const std::string& str) { return add("S" + str, reference(ConstantPool::String, utf8(str))); }
+
+  u2 integer(s4 value) { return add("I" + std::to_string(value), wide(ConstantPool::Integer, u4(value), 0, false)); }
+
+  u2 floatConstant(float value)
+  {
+    u4 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return add("F" + std::to_string(bits), wide(ConstantPool::Float, bits, 0, false));
+  }
+
+  u2 longConstant(s8 value)
+  {
+    return add("J" + std::to_string(value), wide(ConstantPool::Long, u4(u8(value) >> 32), u4(value), true), 2);
+  }
+
+  u2 doubleConstant(double value)
+  {
+    u8 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return add("D" + std::to_string(bits), wide(ConstantPool::Double, u4(bits >> 32), u4(bits), true), 2);
+  }
+
+  u2 nameAndType(const std::string& name, const std::string& descriptor)
+  {
+    u2 n = utf8(name);
+    u2 d = utf8(descriptor);
+    return add("N" + name + " " + descriptor, pair(ConstantPool::NameAndType, n, d));
+  }
+
+  u2 fieldRef(const std::string& clazz, const std::string& name, const std::string& descriptor)
+  {
+    return memberRef(ConstantPool::Fieldref, clazz, name, descriptor);
+  }
+
+  u2 methodRef(const std::string& clazz, const std::string& name, const std::string& descriptor)
+  {
+    return memberRef(ConstantPool::Methodref, clazz, name, descriptor);
+  }
+
+  u2 interfaceMethodRef(const std::string& clazz, const std::string& name, const std::string& descriptor)
+  {
+    return memberRef(ConstantPool::InterfaceMethodref, clazz, name, descriptor);
+  }
+
+  ClassBuilder& implement(const std::string& interface)
+  {
+    interfaces.push_back(classRef(interface));
+    return *this;
+  }
+
+  ClassBuilder& field(u2 access, const std::string& name, const std::string& descriptor)
+  {
+    put2(fields, access);
+    put2(fields, utf8(name));
+    put2(fields, utf8(descriptor));
+    put2(fields, 0);
+    field_count++;
+    return *this;
+  }
+
+  ClassBuilder& method(u2 access, const std::string& name, const std::string& descriptor, u2 max_stack,
+                       u2 max_locals, const CodeBuilder& code, const std::vector<handler>& handlers = {})
+  {
+    put2(methods, access);
+    put2(methods, utf8(name));
+    put2(methods, utf8(descriptor));
+    put2(methods, 1);
+    std::vector<u1> bytes = code.build();
+    put2(methods, utf8("Code"));
+    put4(methods, static_cast<u4>(12 + bytes.size() + 8 * handlers.size()));
+    put2(methods, max_stack);
+    put2(methods, max_locals);
+    put4(methods, static_cast<u4>(bytes.size()));
+    methods.insert(methods.end(), bytes.begin(), bytes.end());
+    put2(methods, static_cast<u2>(handlers.size()));
+    for (auto& h : handlers)
+    {
+      put2(methods, code.pcOf(h.start));
+      put2(methods, code.pcOf(h.end));
+      put2(methods, code.pcOf(h.handler));
+      put2(methods, h.catch_type);
+    }
+    put2(methods, 0);
+    method_count++;
+    return *this;
+  }
+
+  /** Adds an abstract or native method, which has no code */
+  ClassBuilder& method(u2 access, const std::string& name, const std::string& descriptor)
+  {
+    put2(methods, access);
+    put2(methods, utf8(name));
+    put2(methods, utf8(descriptor));
+    put2(methods, 0);
+    method_count++;
+    return *this;
+  }
+
+  std::vector<u1> bytes() const
+  {
+    std::vector<u1> bytes = {0xCA, 0xFE, 0xBA, 0xBE, 0, 0};
+    put2(bytes, major_version);
+    put2(bytes, count);
+    bytes.insert(bytes.end(), pool.begin(), pool.end());
+    put2(bytes, flags);
+    put2(bytes, this_class);
+    put2(bytes, super_class);
+    put2(bytes, static_cast<u2>(interfaces.size()));
+    for (u2 interface : interfaces)
+      put2(bytes, interface);
+    put2(bytes, field_count);
+    bytes.insert(bytes.end(), fields.begin(), fields.end());
+    put2(bytes, method_count);
+    bytes.insert(bytes.end(), methods.begin(), methods.end());
+    put2(bytes, 0);
+    return bytes;
+  }
+
+  /** @return the class, parsed */
+  std::shared_ptr<const ClassFile> build() const
+  {
+    auto data = std::make_shared<const std::vector<u1>>(bytes());
+    parsing::ByteConsumer bc(data->data(), data->size(), data);
+    return std::make_shared<const ClassFile>(bc);
+  }
+
+private:
+  u2 flags;
+  u2 major_version;
+  u2 this_class = 0;
+  u2 super_class = 0;
+  /** The next free constant pool index */
+  u2 count;
+  std::vector<u1> pool;
+  std::map<std::string, u2> entries;
+  std::vector<u2> interfaces;
+  std::vector<u1> fields;
+  u2 field_count = 0;
+  std::vector<u1> methods;
+  u2 method_count = 0;
+
+  static void put2(std::vector<u1>& bytes, u2 value)
+  {
+    bytes.insert(bytes.end(), {static_cast<u1>(value >> 8), static_cast<u1>(value)});
+  }
+
+  static void put4(std::vector<u1>& bytes, u4 value)
+  {
+    put2(bytes, static_cast<u2>(value >> 16));
+    put2(bytes, static_cast<u2>(value));
+  }
+
+  static std::vector<u1> reference(u1 tag, u2 index)
+  {
+    return {tag, static_cast<u1>(index >> 8), static_cast<u1>(index)};
+  }
+
+  static std::vector<u1> pair(u1 tag, u2 first, u2 second)
+  {
+    return {tag, static_cast<u1>(first >> 8), static_cast<u1>(first), static_cast<u1>(second >> 8),
+            static_cast<u1>(second)};
+  }
+
+  static std::vector<u1> wide(u1 tag, u4 high, u4 low, bool both)
+  {
+    std::vector<u1> entry = {tag};
+    put4(entry, high);
+    if (both)
+      put4(entry, low);
+    return entry;
+  }
+
+  u2 memberRef(u1 tag, const std::string& clazz, const std::string& name, const std::string& descriptor)
+  {
+    u2 c = classRef(clazz);
+    u2 n = nameAndType(name, descriptor);
+    return add(std::to_string(tag) + clazz + "." + name + " " + descriptor, pair(tag, c, n));
+  }
+
+  /**
+   * @param key identifies the entry, so it's only added once
+   * @param size the number of indices the entry takes
+   */
+  u2 add(const std::string& key, const std::vector<u1>& entry, u2 size = 1)
+  {
+    auto found = entries.find(key);
+    if (found != entries.end())
+      return found->second;
+    u2 index = count;
+    pool.insert(pool.end(), entry.begin(), entry.end());
+    count = static_cast<u2>(count + size);
+    entries[key] = index;
+    return index;
+  }
+};
+
+}
+
+#endif /* SRC_TEST_CLASSBUILDER_H_ */
@@ -0,0 +1,107 @@
+/**
+ * \file ClassFileLoader_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <unistd.h>
+#include "test/TestCommon.h"
+#include "ClassFileLoader.h"
+
+namespace mimic
+{
+
+class ClassFileLoaderTest: public testing::Test
+{
+
+protected:
+  fs::path hello_world = fs::path("src/test/resources/HelloWorld.class");
+  fs::path directory;
+
+  ClassFileLoaderTest()
+  {
+    directory = fs::temp_directory_path() / ("mimic_loader_test_" + std::to_string(::getpid()));
+    fs::create_directories(directory / "nested");
+  }
+
+  virtual ~ClassFileLoaderTest()
+  {
+    fs::remove_all(directory);
+  }
+
+  /**
+   * Writes the first bytes of HelloWorld.class to a file
+   */
+  void writeTruncated(const fs::path& path, std::size_t size)
+  {
+    std::ifstream in(hello_world, std::ios::binary);
+    std::vector<char> bytes(size);
+    in.read(bytes.data(), size);
+    std::ofstream out(path, std::ios::binary);
+    out.write(bytes.data(), size);
+  }
+};
+
+TEST_F(ClassFileLoaderTest, TestResultsInOrder)
+{
+  std::vector<fs::path> paths;
+  for (int i = 0; i < 50; i++)
+    paths.push_back(i % 7 == 3 ? fs::path("src/test/resources/NoSuchFile.class") : hello_world);
+  ClassFileLoader loader(4);
+  auto report = loader.load(paths);
+  ASSERT_EQ(paths.size(), report.results.size());
+  ASSERT_EQ(7u, report.failed);
+  ASSERT_EQ(43u, report.loaded);
+  for (std::size_t i = 0; i < paths.size(); i++)
+  {
+    ASSERT_EQ(paths[i], report.results[i].path);
+    ASSERT_EQ(i % 7 != 3, report.results[i].loaded());
+    if (report.results[i].loaded())
+    {
+      ASSERT_EQ(52, report.results[i].clazz->getMajorVersion());
+      ASSERT_TRUE(report.results[i].error.empty());
+    }
+    else
+    {
+      ASSERT_FALSE(report.results[i].error.empty());
+    }
+  }
+}
+
+TEST_F(ClassFileLoaderTest, TestLoadDirectory)
+{
+  fs::copy_file(hello_world, directory / "b.class");
+  fs::copy_file(hello_world, directory / "nested" / "a.class");
+  writeTruncated(directory / "c.class", 20);
+  std::ofstream(directory / "notes.txt") << "not a class";
+  ClassFileLoader loader(2, ConstantPool::lazy);
+  auto report = loader.loadDirectory(directory);
+  ASSERT_EQ(3u, report.results.size());
+  EXPECT_EQ(directory / "b.class", report.results[0].path);
+  EXPECT_EQ(directory / "c.class", report.results[1].path);
+  EXPECT_EQ(directory / "nested" / "a.class", report.results[2].path);
+  EXPECT_TRUE(report.results[0].loaded());
+  EXPECT_FALSE(report.results[1].loaded());
+  EXPECT_TRUE(report.results[2].loaded());
+  EXPECT_TRUE(report.results[2].clazz->getConstantPool().isLazy());
+  EXPECT_EQ(2u, report.loaded);
+  EXPECT_EQ(1u, report.failed);
+  EXPECT_GT(report.classesPerSecond(), 0);
+}
+
+TEST_F(ClassFileLoaderTest, TestEmpty)
+{
+  auto report = ClassFileLoader().load(std::vector<fs::path>());
+  ASSERT_TRUE(report.results.empty());
+  ASSERT_EQ(0u, report.loaded);
+  ASSERT_EQ(0u, report.failed);
+}
+
+TEST_F(ClassFileLoaderTest, TestDefaultThreads)
+{
+  ASSERT_LE(1u, ClassFileLoader().getThreads());
+  ASSERT_EQ(3u, ClassFileLoader(3).getThreads());
+}
+
+}
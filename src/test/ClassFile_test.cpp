@@ -24,6 +24,46 @@ protected:
 	virtual ~ClassFileTest()
 	{
 	}
+
+	static void putU2(std::vector<u1>& bytes, u2 value)
+	{
+		bytes.push_back(static_cast<u1>(value >> 8));
+		bytes.push_back(static_cast<u1>(value));
+	}
+
+	static void putUtf8(std::vector<u1>& bytes, const std::string& str)
+	{
+		bytes.push_back(ConstantPool::Utf8);
+		putU2(bytes, static_cast<u2>(str.size()));
+		bytes.insert(bytes.end(), str.begin(), str.end());
+	}
+
+	/**
+	 * Builds a class Foo with the given class attributes. Its pool is
+	 * #5 "SourceFile", #6 "Foo.java", #7 "RuntimeVisibleAnnotations",
+	 * #8 "LFoo;" and #9 "Unknown", after the class entries.
+	 */
+	static std::vector<u1> classWithAttributes(u2 major_version, u2 attributes_count,
+	                                           const std::vector<u1>& attributes)
+	{
+		std::vector<u1> bytes = {0xCA, 0xFE, 0xBA, 0xBE, 0, 0};
+		putU2(bytes, major_version);
+		putU2(bytes, 10);
+		putUtf8(bytes, "Foo");
+		bytes.insert(bytes.end(), {ConstantPool::Class, 0, 1});
+		putUtf8(bytes, "java/lang/Object");
+		bytes.insert(bytes.end(), {ConstantPool::Class, 0, 3});
+		putUtf8(bytes, "SourceFile");
+		putUtf8(bytes, "Foo.java");
+		putUtf8(bytes, "RuntimeVisibleAnnotations");
+		putUtf8(bytes, "LFoo;");
+		putUtf8(bytes, "Unknown");
+		// Flags, this class, super class and no interfaces, fields or methods
+		bytes.insert(bytes.end(), {0, 0x21, 0, 2, 0, 4, 0, 0, 0, 0, 0, 0});
+		putU2(bytes, attributes_count);
+		bytes.insert(bytes.end(), attributes.begin(), attributes.end());
+		return bytes;
+	}
 };
 
 TEST_F(ClassFileTest, TestInvalidMagicNumber)
@@ -49,4 +89,117 @@ TEST_F(ClassFileTest, TestHelloWorld)
 	ASSERT_EQ(0, clazz.getMinorVersion());
 }
 
+TEST_F(ClassFileTest, TestHelloWorldMapped)
+{
+	ClassFile clazz(fs::path("src/test/resources/HelloWorld.class"));
+	ASSERT_EQ(52, clazz.getMajorVersion());
+	ASSERT_EQ(0, clazz.getMinorVersion());
+	auto& cp = clazz.getConstantPool();
+	// #7 is "<init>"
+	auto init = cp.get<const JUtf8String>(7);
+	EXPECT_EQ(JUtf8String("<init>"), init);
+	EXPECT_TRUE(init.isBorrowed());
+}
+
+
+TEST_F(ClassFileTest, TestAccessorsReturnReferences)
+{
+	ClassFile clazz(fs::path("src/test/resources/HelloWorld.class"));
+	ASSERT_EQ(&clazz.getConstantPool(), &clazz.getConstantPool());
+	ASSERT_EQ(&clazz.getMethods(), &clazz.getMethods());
+	ASSERT_EQ(&clazz.getFields(), &clazz.getFields());
+	ASSERT_EQ(&clazz.getInterfaces(), &clazz.getInterfaces());
+	ASSERT_EQ(&clazz.getAttributes(), &clazz.getAttributes());
+	ASSERT_EQ(2u, clazz.getMethodsCount());
+}
+
+TEST_F(ClassFileTest, TestMove)
+{
+	ClassFile clazz(fs::path("src/test/resources/HelloWorld.class"));
+	const ClassFile::method_info* methods = clazz.getMethods().data();
+	ClassFile moved(std::move(clazz));
+	// The method table is taken over rather than copied
+	ASSERT_EQ(methods, moved.getMethods().data());
+	ASSERT_EQ(2u, moved.getMethodsCount());
+	ASSERT_EQ(JUtf8String("<init>"), moved.getConstantPool().get<const JUtf8String>(7));
+	ClassFile assigned(fs::path("src/test/resources/HelloWorld.class"));
+	assigned = std::move(moved);
+	ASSERT_EQ(methods, assigned.getMethods().data());
+}
+
+TEST_F(ClassFileTest, TestCodeReachesMethods)
+{
+	ClassFile clazz(fs::path("src/test/resources/HelloWorld.class"));
+	auto& cp = clazz.getConstantPool();
+	for (auto& method : clazz.getMethods())
+	{
+		ASSERT_EQ(1u, method.attrs.size());
+		auto code = getIf<attributes::code>(method.attrs[0]);
+		ASSERT_NE(nullptr, code);
+		EXPECT_EQ(JUtf8String("Code"), cp.get<const JUtf8String>(code->attribute_name_index));
+		EXPECT_FALSE(code->code.empty());
+		// The last instruction of both methods is a return
+		EXPECT_EQ(0xB1, code->code.back());
+		EXPECT_TRUE(code->exception_table.empty());
+		ASSERT_EQ(1u, code->attrs.size());
+		auto lines = getIf<attributes::line_number_table>(code->attrs[0]);
+		ASSERT_NE(nullptr, lines);
+		EXPECT_FALSE(lines->table.empty());
+	}
+	ASSERT_EQ(1u, clazz.getAttributesCount());
+	auto source = getIf<attributes::source_file>(clazz.getAttributes()[0]);
+	ASSERT_NE(nullptr, source);
+	EXPECT_EQ(JUtf8String("HelloWorld.java"), cp.get<const JUtf8String>(source->sourcefile_index));
+}
+
+TEST_F(ClassFileTest, TestLazyAttributesOutliveTheStream)
+{
+	std::vector<u1> attributes = {0, 5, 0, 0, 0, 2, 0, 6};                  // SourceFile
+	attributes.insert(attributes.end(), {0, 9, 0, 0, 0, 3, 1, 2, 3});       // Unknown
+	attributes.insert(attributes.end(), {0, 7, 0, 0, 0, 6, 0, 1, 0, 8, 0, 0}); // @Foo
+	auto bytes = classWithAttributes(52, 3, attributes);
+	optional<ClassFile> clazz;
+	{
+		std::stringstream ss(std::string(bytes.begin(), bytes.end()));
+		parsing::ByteConsumer bc(ss);
+		clazz.emplace(bc);
+	}
+	ASSERT_EQ(2u, clazz->getAttributesCount());
+	auto source = getIf<attributes::source_file>(clazz->getAttributes()[0]);
+	ASSERT_NE(nullptr, source);
+	EXPECT_EQ(6, source->sourcefile_index);
+	auto lazy = getIf<attributes::lazy<attributes::runtime_visible_annotations>>(clazz->getAttributes()[1]);
+	ASSERT_NE(nullptr, lazy);
+	auto annotations = lazy->decode();
+	EXPECT_EQ(7, annotations.attribute_name_index);
+	ASSERT_EQ(1u, annotations.annotations.size());
+	EXPECT_EQ(8, annotations.annotations[0].type_index);
+	EXPECT_TRUE(annotations.annotations[0].elements.empty());
+}
+
+TEST_F(ClassFileTest, TestAttributesBeforeTheirVersion)
+{
+	// Annotations were only defined in version 49
+	auto bytes = classWithAttributes(48, 1, {0, 7, 0, 0, 0, 2, 0, 0});
+	parsing::ByteConsumer bc(bytes.data(), bytes.size());
+	ClassFile clazz(bc);
+	EXPECT_EQ(0u, clazz.getAttributesCount());
+}
+
+TEST_F(ClassFileTest, TestInvalidAttributes)
+{
+	// A name that isn't a Utf8 entry
+	auto bytes = classWithAttributes(52, 1, {0, 2, 0, 0, 0, 0});
+	parsing::ByteConsumer bad_name(bytes.data(), bytes.size());
+	EXPECT_THROW(ClassFile{bad_name}, parsing::parse_failure);
+	// A SourceFile attribute that is longer than its contents
+	bytes = classWithAttributes(52, 1, {0, 5, 0, 0, 0, 3, 0, 6, 0});
+	parsing::ByteConsumer too_long(bytes.data(), bytes.size());
+	EXPECT_THROW(ClassFile{too_long}, parsing::parse_failure);
+	// And one that is too short
+	bytes = classWithAttributes(52, 1, {0, 5, 0, 0, 0, 1, 0});
+	parsing::ByteConsumer too_short(bytes.data(), bytes.size());
+	EXPECT_THROW(ClassFile{too_short}, parsing::parse_failure);
+}
+
 }
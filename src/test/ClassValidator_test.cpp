@@ -23,6 +23,31 @@ protected:
 	virtual ~ClassValidatorTest()
 	{
 	}
+
+	/**
+	 * @return a pool whose entry #1 is a method handle of the given kind,
+	 *         referring to a complete member reference of the given type
+	 */
+	ConstantPool handlePool(ConstantPool::reference_kind kind, ConstantPool::tag member, const char* name = "foo")
+	{
+		std::vector<ConstantPool::cp_type> entries{ConstantPool::tag::Invalid,
+		                                           ConstantPool::MethodHandle_info(kind, 2)};
+		if (member == ConstantPool::Fieldref)
+			entries.push_back(ConstantPool::Fieldref_info(3, 4));
+		else if (member == ConstantPool::Methodref)
+			entries.push_back(ConstantPool::Methodref_info(3, 4));
+		else
+			entries.push_back(ConstantPool::InterfaceMethodref_info(3, 4));
+		entries.push_back(ConstantPool::Class_info(5));
+		entries.push_back(ConstantPool::NameAndType_info(6, 7));
+		entries.push_back(JUtf8String("Foo"));
+		entries.push_back(JUtf8String(name));
+		if (member == ConstantPool::Fieldref)
+			entries.push_back(FieldDescriptor(JUtf8String("I")));
+		else
+			entries.push_back(MethodDescriptor(JUtf8String("()V")));
+		return ConstantPool(entries);
+	}
 };
 
 TEST_F(ClassValidatorTest, TestClassInfoMissingUtf8)
@@ -159,121 +184,91 @@ TEST_F(ClassValidatorTest, TestMethodHandleInfoInvalidIndexPutStatic)
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidGetField)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::getField, 2),
-                                                     ConstantPool::Fieldref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::getField, ConstantPool::Fieldref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidGetStatic)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::getStatic, 2),
-                                                     ConstantPool::Fieldref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::getStatic, ConstantPool::Fieldref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeInterface)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeInterface, 2),
-                                                     ConstantPool::InterfaceMethodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeInterface, ConstantPool::InterfaceMethodref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeSpecialV51)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeSpecial, 2),
-                                                     ConstantPool::Methodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeSpecial, ConstantPool::Methodref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 51, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeStaticV51)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeStatic, 2),
-                                                     ConstantPool::Methodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeStatic, ConstantPool::Methodref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 51, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeSpecialV52)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeSpecial, 2),
-                                                     ConstantPool::Methodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeSpecial, ConstantPool::Methodref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeStaticV52)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeStatic, 2),
-                                                     ConstantPool::Methodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeStatic, ConstantPool::Methodref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeSpecialV51Interface)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeSpecial, 2),
-                                                     ConstantPool::InterfaceMethodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeSpecial, ConstantPool::InterfaceMethodref));
 	ASSERT_THROW(ClassValidator::validateConstantPool(cp, 51, 0), std::runtime_error);
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeStaticV51Interface)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeStatic, 2),
-                                                     ConstantPool::InterfaceMethodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeStatic, ConstantPool::InterfaceMethodref));
 	ASSERT_THROW(ClassValidator::validateConstantPool(cp, 51, 0), std::runtime_error);
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeSpecialV52Interface)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeSpecial, 2),
-                                                     ConstantPool::InterfaceMethodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeSpecial, ConstantPool::InterfaceMethodref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeStaticV52Interface)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeStatic, 2),
-                                                     ConstantPool::InterfaceMethodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeStatic, ConstantPool::InterfaceMethodref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidInvokeVirtual)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::invokeVirtual, 2),
-                                                     ConstantPool::Methodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::invokeVirtual, ConstantPool::Methodref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidNewInvokeSpecial)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::newInvokeSpecial, 2),
-                                                     ConstantPool::Methodref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::newInvokeSpecial, ConstantPool::Methodref, "<init>"));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidPutField)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::putField, 2),
-                                                     ConstantPool::Fieldref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::putField, ConstantPool::Fieldref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
 TEST_F(ClassValidatorTest, TestMethodHandleInfoValidPutStatic)
 {
-  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
-                                                     ConstantPool::MethodHandle_info(ConstantPool::reference_kind::putStatic, 2),
-                                                     ConstantPool::Fieldref_info(0, 0)});
+  ConstantPool cp(handlePool(ConstantPool::putStatic, ConstantPool::Fieldref));
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
@@ -330,10 +325,41 @@ TEST_F(ClassValidatorTest, TestInvokeDynamicInfoValid)
                                                      ConstantPool::NameAndType_info(4, 5),
                                                      ConstantPool::tag::Invalid,
                                                      JUtf8String("Foo"),
-                                                     FieldDescriptor(JUtf8String("C"))});
+                                                     MethodDescriptor(JUtf8String("(C)V"))});
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
 
+TEST_F(ClassValidatorTest, TestBootstrapMethods)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                     ConstantPool::InvokeDynamic_info(1, 2),
+                                                     ConstantPool::NameAndType_info(4, 5),
+                                                     ConstantPool::MethodHandle_info(ConstantPool::invokeStatic, 1),
+                                                     JUtf8String("Foo"),
+                                                     MethodDescriptor(JUtf8String("(C)V")),
+                                                     ConstantPool::Integer_info(1)});
+  attributes::bootstrap_methods methods{0, {{3, {6, 3}}}};
+  // The InvokeDynamic entry refers to a second bootstrap method
+  EXPECT_THROW(ClassValidator::validateBootstrapMethods(cp, &methods), ClassValidator::validation_failure);
+  EXPECT_THROW(ClassValidator::validateBootstrapMethods(cp, nullptr), ClassValidator::validation_failure);
+  methods.info.push_back({3, {}});
+  EXPECT_NO_THROW(ClassValidator::validateBootstrapMethods(cp, &methods));
+  // Bootstrap methods must be method handles, and their arguments loadable constants
+  methods.info.push_back({2, {4, 1}});
+  try
+  {
+    ClassValidator::validateBootstrapMethods(cp, &methods);
+    FAIL();
+  }
+  catch (const ClassValidator::validation_failure& e)
+  {
+    ASSERT_EQ(3u, e.getErrors().size());
+    EXPECT_EQ(1, e.getErrors()[0].index);
+    EXPECT_EQ(2, e.getErrors()[1].index);
+    EXPECT_EQ(4, e.getErrors()[2].index);
+  }
+}
+
 TEST_F(ClassValidatorTest, TestNameAndTypeInfoMissingName)
 {
   ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
@@ -376,4 +402,217 @@ TEST_F(ClassValidatorTest, TestNameAndTypeInfoValid)
                                                      FieldDescriptor(JUtf8String("B"))});
 	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
 }
+TEST_F(ClassValidatorTest, TestFieldrefValid)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                     ConstantPool::Fieldref_info(2, 3),
+                                                     ConstantPool::Class_info(4),
+                                                     ConstantPool::NameAndType_info(5, 6),
+                                                     JUtf8String("Foo"),
+                                                     JUtf8String("bar"),
+                                                     FieldDescriptor(JUtf8String("[I"))});
+	ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
+}
+
+TEST_F(ClassValidatorTest, TestFieldrefInvalidReferences)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                     ConstantPool::Fieldref_info(5, 3),
+                                                     ConstantPool::Fieldref_info(4, 1),
+                                                     ConstantPool::Fieldref_info(4, 6),
+                                                     ConstantPool::Class_info(7),
+                                                     ConstantPool::NameAndType_info(7, 8),
+                                                     ConstantPool::NameAndType_info(7, 9),
+                                                     JUtf8String("Foo"),
+                                                     FieldDescriptor(JUtf8String("I")),
+                                                     MethodDescriptor(JUtf8String("()I"))});
+  auto errors = ClassValidator::checkConstantPool(cp, 52, 0);
+  ASSERT_EQ(3u, errors.size());
+  // A class that's a NameAndType, a name & type that's a Fieldref, and a method descriptor
+  EXPECT_EQ(1u, errors[0].index);
+  EXPECT_STREQ("Invalid class reference", errors[0].reason);
+  EXPECT_EQ(2u, errors[1].index);
+  EXPECT_STREQ("Invalid name & type reference", errors[1].reason);
+  EXPECT_EQ(3u, errors[2].index);
+  EXPECT_STREQ("Field reference without a field descriptor", errors[2].reason);
+}
+
+TEST_F(ClassValidatorTest, TestMethodrefInitMustReturnVoid)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                     ConstantPool::Methodref_info(2, 3),
+                                                     ConstantPool::Class_info(4),
+                                                     ConstantPool::NameAndType_info(5, 6),
+                                                     JUtf8String("Foo"),
+                                                     JUtf8String("<init>"),
+                                                     MethodDescriptor(JUtf8String("(J)I"))});
+	ASSERT_THROW(ClassValidator::validateConstantPool(cp, 52, 0), ClassValidator::validation_failure);
+}
+
+TEST_F(ClassValidatorTest, TestMethodrefToClassInitialiser)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                     ConstantPool::Methodref_info(2, 3),
+                                                     ConstantPool::Class_info(4),
+                                                     ConstantPool::NameAndType_info(5, 6),
+                                                     JUtf8String("Foo"),
+                                                     JUtf8String("<clinit>"),
+                                                     MethodDescriptor(JUtf8String("()V"))});
+	ASSERT_THROW(ClassValidator::validateConstantPool(cp, 52, 0), ClassValidator::validation_failure);
+}
+
+TEST_F(ClassValidatorTest, TestInterfaceMethodrefToInit)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                     ConstantPool::InterfaceMethodref_info(2, 3),
+                                                     ConstantPool::Class_info(4),
+                                                     ConstantPool::NameAndType_info(5, 6),
+                                                     JUtf8String("Foo"),
+                                                     JUtf8String("<init>"),
+                                                     MethodDescriptor(JUtf8String("()V"))});
+	ASSERT_THROW(ClassValidator::validateConstantPool(cp, 52, 0), ClassValidator::validation_failure);
+}
+
+TEST_F(ClassValidatorTest, TestMethodHandleInitialisers)
+{
+	ASSERT_THROW(ClassValidator::validateConstantPool(handlePool(ConstantPool::newInvokeSpecial,
+	                                                             ConstantPool::Methodref), 52, 0),
+	             ClassValidator::validation_failure);
+	ASSERT_THROW(ClassValidator::validateConstantPool(handlePool(ConstantPool::invokeVirtual,
+	                                                             ConstantPool::Methodref, "<init>"), 52, 0),
+	             ClassValidator::validation_failure);
+	ASSERT_NO_THROW(ClassValidator::validateConstantPool(handlePool(ConstantPool::getField,
+	                                                                ConstantPool::Fieldref, "<init>"), 52, 0));
+}
+
+TEST_F(ClassValidatorTest, TestMethodHandleBeforeVersion51)
+{
+	ASSERT_THROW(ClassValidator::validateConstantPool(handlePool(ConstantPool::invokeStatic,
+	                                                             ConstantPool::Methodref), 50, 0),
+	             ClassValidator::validation_failure);
+}
+
+TEST_F(ClassValidatorTest, TestInvokeDynamicInfoFieldDescriptor)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                     ConstantPool::InvokeDynamic_info(0, 2),
+                                                     ConstantPool::NameAndType_info(3, 4),
+                                                     JUtf8String("Foo"),
+                                                     FieldDescriptor(JUtf8String("C"))});
+	ASSERT_THROW(ClassValidator::validateConstantPool(cp, 52, 0), ClassValidator::validation_failure);
+}
+
+TEST_F(ClassValidatorTest, TestClassInfoEmptyIdentifier)
+{
+  for (auto name : { "", "/Foo", "Foo/", "java//Foo" })
+  {
+    ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                       ConstantPool::Class_info(2),
+                                                       JUtf8String(name)});
+    EXPECT_THROW(ClassValidator::validateConstantPool(cp, 52, 0), ClassValidator::validation_failure) << name;
+  }
+}
+
+TEST_F(ClassValidatorTest, TestCollectsEveryError)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ConstantPool::tag::Invalid,
+                                                     ConstantPool::String_info(9),
+                                                     ConstantPool::Integer_info(1),
+                                                     ConstantPool::Class_info(2),
+                                                     JUtf8String("Foo"),
+                                                     ConstantPool::MethodType_info(4)});
+  try
+  {
+    ClassValidator::validateConstantPool(cp, 52, 0);
+    FAIL() << "Pool should not validate";
+  }
+  catch (ClassValidator::validation_failure& e)
+  {
+    ASSERT_EQ(3u, e.getErrors().size());
+    EXPECT_EQ(1u, e.getErrors()[0].index);
+    EXPECT_EQ(3u, e.getErrors()[1].index);
+    EXPECT_EQ(5u, e.getErrors()[2].index);
+    EXPECT_EQ(std::string("Invalid constant pool entry #1: Invalid string reference (and 2 more)"), e.what());
+  }
+}
+
+TEST_F(ClassValidatorTest, TestNameSharedWithDescriptor)
+{
+  // #1 NameAndType(#2, #2), #2 Utf8 "I", which is both a field's name and its descriptor
+  std::vector<u1> bytes = { ConstantPool::NameAndType, 0x00, 0x02, 0x00, 0x02,
+                            ConstantPool::Utf8, 0x00, 0x01, 'I' };
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 3);
+  ASSERT_EQ(ConstantPool::cp_fieldDescriptor, cp.getType(2));
+  ASSERT_NO_THROW(ClassValidator::validateConstantPool(cp, 52, 0));
+}
+
+TEST_F(ClassValidatorTest, TestLazyPoolValidatesOnAccess)
+{
+  // #1 Fieldref(#2, #2), #2 Utf8 "Foo"
+  std::vector<u1> bytes = { ConstantPool::Fieldref, 0x00, 0x02, 0x00, 0x02,
+                            ConstantPool::Utf8, 0x00, 0x03, 'F', 'o', 'o' };
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 3, ConstantPool::lazy, 52, 0);
+  ASSERT_EQ(JUtf8String("Foo"), cp.get<const JUtf8String>(2));
+  try
+  {
+    cp.get<const ConstantPool::Fieldref_info>(1);
+    FAIL() << "Fieldref should not validate";
+  }
+  catch (ClassValidator::validation_failure& e)
+  {
+    ASSERT_EQ(1u, e.getErrors().size());
+    EXPECT_EQ(1u, e.getErrors()[0].index);
+  }
+}
+
+TEST_F(ClassValidatorTest, TestClassNames)
+{
+  for (auto name : { "Foo", "java/lang/Object", "a/b/c$D", "\xc3\xa9t\xc3\xa9/Caf\xc3\xa9", "<Foo>" })
+  {
+    EXPECT_TRUE(ClassValidator::isValidClassOrInterfaceName(JUtf8String(name))) << name;
+    EXPECT_TRUE(ClassValidator::isValidClassOrInterfaceName(Symbol::intern(JUtf8String(name)))) << name;
+  }
+  for (auto name : { "", "/", "java.lang.Object", "Foo;", "[I", "/Foo", "Foo/", "java//Foo" })
+  {
+    EXPECT_FALSE(ClassValidator::isValidClassOrInterfaceName(JUtf8String(name))) << name;
+    EXPECT_FALSE(ClassValidator::isValidClassOrInterfaceName(Symbol::intern(JUtf8String(name)))) << name;
+  }
+}
+
+TEST_F(ClassValidatorTest, TestUnqualifiedNames)
+{
+  for (auto name : { "foo", "<init>", "x$1", "\xe2\x82\xac" })
+  {
+    EXPECT_TRUE(ClassValidator::isValidUnqualifiedName(JUtf8String(name))) << name;
+    EXPECT_TRUE(ClassValidator::isValidUnqualifiedName(Symbol::intern(JUtf8String(name)))) << name;
+  }
+  for (auto name : { "", "a.b", "a;", "[a", "a/b" })
+  {
+    EXPECT_FALSE(ClassValidator::isValidUnqualifiedName(JUtf8String(name))) << name;
+    EXPECT_FALSE(ClassValidator::isValidUnqualifiedName(Symbol::intern(JUtf8String(name)))) << name;
+  }
+}
+
+TEST_F(ClassValidatorTest, TestNamesRememberedOnSymbol)
+{
+  Symbol valid = Symbol::intern(JUtf8String("TestNamesRemembered/Valid"));
+  Symbol invalid = Symbol::intern(JUtf8String("TestNamesRemembered.Invalid"));
+  ASSERT_EQ(0u, valid.getMarks());
+  ASSERT_TRUE(ClassValidator::isValidClassOrInterfaceName(valid));
+  ASSERT_FALSE(ClassValidator::isValidClassOrInterfaceName(invalid));
+  u1 valid_marks = valid.getMarks();
+  u1 invalid_marks = invalid.getMarks();
+  ASSERT_NE(0u, valid_marks);
+  ASSERT_NE(0u, invalid_marks);
+  ASSERT_NE(valid_marks, invalid_marks);
+  // Asking again gives the remembered answer without checking again
+  ASSERT_TRUE(ClassValidator::isValidClassOrInterfaceName(valid));
+  ASSERT_FALSE(ClassValidator::isValidClassOrInterfaceName(invalid));
+  ASSERT_EQ(valid_marks, valid.getMarks());
+  // Being a valid class name says nothing about being a valid unqualified name
+  ASSERT_FALSE(ClassValidator::isValidUnqualifiedName(valid));
+  ASSERT_TRUE(ClassValidator::isValidClassOrInterfaceName(valid));
+}
 }
@@ -0,0 +1,246 @@
+/**
+ * \file ConstantPool_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "test/TestCommon.h"
+#include "ClassFile.h"
+#include "ConstantPool.h"
+#include "parsing/ByteConsumer.h"
+
+namespace mimic
+{
+
+class ConstantPoolTest: public testing::Test
+{
+
+protected:
+  ConstantPoolTest()
+  {
+  }
+
+  virtual ~ConstantPoolTest()
+  {
+  }
+
+  /* #1 Class(#2), #2 Utf8 name, #3 Long (2 entries), #5 Integer */
+  std::vector<u1> poolBytes(const std::string& name)
+  {
+    std::vector<u1> bytes = { ConstantPool::Class, 0x00, 0x02,
+                              ConstantPool::Utf8, 0x00, static_cast<u1>(name.size()) };
+    bytes.insert(bytes.end(), name.begin(), name.end());
+    std::vector<u1> rest = { ConstantPool::Long, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+                             ConstantPool::Integer, 0x00, 0x00, 0x04, 0xd2 };
+    bytes.insert(bytes.end(), rest.begin(), rest.end());
+    return bytes;
+  }
+};
+
+TEST_F(ConstantPoolTest, TestEagerLongTakesTwoEntries)
+{
+  auto bytes = poolBytes("Foo");
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 6);
+  ASSERT_EQ(6u, cp.size());
+  EXPECT_EQ(0u, bc.bytesRemaining());
+  EXPECT_EQ(ConstantPool::cp_long, cp.getType(3));
+  EXPECT_EQ(ConstantPool::cp_tag, cp.getType(4));
+  EXPECT_EQ(1234u, cp.get<const ConstantPool::Integer_info>(5).bytes);
+}
+
+TEST_F(ConstantPoolTest, TestLazyMatchesEager)
+{
+  auto bytes = poolBytes("Foo");
+  parsing::ByteConsumer eager_bc(bytes.data(), bytes.size());
+  ConstantPool eager(eager_bc, 6);
+  parsing::ByteConsumer lazy_bc(bytes.data(), bytes.size());
+  ConstantPool lazy(lazy_bc, 6, ConstantPool::lazy, 52, 0);
+  ASSERT_TRUE(lazy.isLazy());
+  ASSERT_FALSE(eager.isLazy());
+  EXPECT_EQ(0u, lazy_bc.bytesRemaining());
+  ASSERT_EQ(eager.size(), lazy.size());
+  for (u2 i = 1; i < eager.size(); i++)
+    EXPECT_EQ(eager.getType(i), lazy.getType(i));
+  EXPECT_EQ(2u, lazy.get<const ConstantPool::Class_info>(1).name_index);
+  EXPECT_EQ(JUtf8String("Foo"), lazy.get<const JUtf8String>(2));
+  EXPECT_EQ(0x0000000100000002u, lazy.get<const ConstantPool::Long_info>(3).value);
+  EXPECT_EQ(1234u, lazy.get<const ConstantPool::Integer_info>(5).bytes);
+}
+
+TEST_F(ConstantPoolTest, TestLazyEntryIsDecodedOnce)
+{
+  auto bytes = poolBytes("Foo");
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 6, ConstantPool::lazy, 52, 0);
+  auto& first = cp.get<const JUtf8String>(2);
+  auto& second = cp.get<const JUtf8String>(2);
+  EXPECT_EQ(&first, &second);
+  ConstantPool copy(cp);
+  EXPECT_EQ(&first, &copy.get<const JUtf8String>(2));
+}
+
+TEST_F(ConstantPoolTest, TestLazyPoolOutlivesStream)
+{
+  std::stringstream ss;
+  auto bytes = poolBytes("Foo");
+  ss.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  std::unique_ptr<ConstantPool> cp;
+  {
+    parsing::ByteConsumer bc(ss, bytes.size());
+    cp.reset(new ConstantPool(bc, 6, ConstantPool::lazy, 52, 0));
+  }
+  EXPECT_EQ(JUtf8String("Foo"), cp->get<const JUtf8String>(2));
+}
+
+TEST_F(ConstantPoolTest, TestLazyValidatesOnAccess)
+{
+  auto bytes = poolBytes("wib.ble");
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 6, ConstantPool::lazy, 52, 0);
+  EXPECT_NO_THROW(cp.get<const ConstantPool::Integer_info>(5));
+  EXPECT_THROW(cp.get<const ConstantPool::Class_info>(1), std::runtime_error);
+  EXPECT_THROW(cp.get<const ConstantPool::Class_info>(1), std::runtime_error);
+}
+
+TEST_F(ConstantPoolTest, TestLazyUnknownTagFailsParse)
+{
+  std::vector<u1> bytes = { 0x02, 0x00, 0x00 };
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ASSERT_THROW(ConstantPool(bc, 2, ConstantPool::lazy, 52, 0), parsing::parse_failure);
+}
+
+TEST_F(ConstantPoolTest, TestLazyInvalidIndex)
+{
+  auto bytes = poolBytes("Foo");
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 6, ConstantPool::lazy, 52, 0);
+  EXPECT_THROW(cp.getType(0), std::range_error);
+  EXPECT_THROW(cp.getType(6), std::range_error);
+}
+
+TEST_F(ConstantPoolTest, TestLazyHelloWorld)
+{
+  fs::path path("src/test/resources/HelloWorld.class");
+  ClassFile eager(path);
+  ClassFile lazy(path, ConstantPool::lazy);
+  auto& eager_cp = eager.getConstantPool();
+  auto& lazy_cp = lazy.getConstantPool();
+  ASSERT_TRUE(lazy_cp.isLazy());
+  ASSERT_EQ(eager_cp.size(), lazy_cp.size());
+  for (u2 i = 1; i < eager_cp.size(); i++)
+    EXPECT_EQ(eager_cp.getType(i), lazy_cp.getType(i));
+  EXPECT_EQ(JUtf8String("<init>"), lazy_cp.get<const JUtf8String>(7));
+}
+
+
+TEST_F(ConstantPoolTest, TestOnlyReferencedUtf8IsDescriptor)
+{
+  /* #1 NameAndType(#2, #3), #2 "I", #3 "()V", #4 "I", #5 "(I)V", #6 MethodType(#5),
+   * #7 Class(#8), #8 "[J" */
+  std::vector<u1> bytes = { ConstantPool::NameAndType, 0x00, 0x02, 0x00, 0x03,
+                            ConstantPool::Utf8, 0x00, 0x01, 'I',
+                            ConstantPool::Utf8, 0x00, 0x03, '(', ')', 'V',
+                            ConstantPool::Utf8, 0x00, 0x01, 'I',
+                            ConstantPool::Utf8, 0x00, 0x04, '(', 'I', ')', 'V',
+                            ConstantPool::MethodType, 0x00, 0x05,
+                            ConstantPool::Class, 0x00, 0x08,
+                            ConstantPool::Utf8, 0x00, 0x02, '[', 'J' };
+  for (auto mode : { ConstantPool::eager, ConstantPool::lazy })
+  {
+    parsing::ByteConsumer bc(bytes.data(), bytes.size());
+    ConstantPool cp(bc, 9, mode, 52, 0);
+    EXPECT_EQ(ConstantPool::cp_utf8, cp.getType(2));
+    EXPECT_EQ(ConstantPool::cp_methodDescriptor, cp.getType(3));
+    EXPECT_EQ(ConstantPool::cp_utf8, cp.getType(4));
+    EXPECT_EQ(ConstantPool::cp_methodDescriptor, cp.getType(5));
+    EXPECT_EQ(ConstantPool::cp_fieldDescriptor, cp.getType(8));
+  }
+}
+
+TEST_F(ConstantPoolTest, TestUnparseableDescriptorIsUtf8)
+{
+  /* #1 MethodType(#2), #2 "I" */
+  std::vector<u1> bytes = { ConstantPool::MethodType, 0x00, 0x02,
+                            ConstantPool::Utf8, 0x00, 0x01, 'I' };
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 3);
+  EXPECT_EQ(ConstantPool::cp_utf8, cp.getType(2));
+}
+
+TEST_F(ConstantPoolTest, TestHelloWorldDescriptors)
+{
+  ClassFile clazz(fs::path("src/test/resources/HelloWorld.class"));
+  auto& cp = clazz.getConstantPool();
+  // #8 "()V" is used by <init>, #12 "(I[C)V" by main
+  EXPECT_EQ(ConstantPool::cp_methodDescriptor, cp.getType(8));
+  EXPECT_EQ(ConstantPool::cp_methodDescriptor, cp.getType(12));
+  // #9 "Code" is an attribute name
+  EXPECT_EQ(ConstantPool::cp_utf8, cp.getType(9));
+}
+
+TEST_F(ConstantPoolTest, TestPackedEntries)
+{
+  /* #1 Fieldref(#2, #3), #2 MethodHandle(invokeStatic, #1), #3 Double (2 entries),
+   * #5 InvokeDynamic(#6, #7) */
+  std::vector<u1> bytes = { ConstantPool::Fieldref, 0x00, 0x02, 0x00, 0x03,
+                            ConstantPool::MethodHandle, ConstantPool::invokeStatic, 0x00, 0x01,
+                            ConstantPool::Double, 0x40, 0x09, 0x21, 0xfb, 0x54, 0x44, 0x2d, 0x18,
+                            ConstantPool::InvokeDynamic, 0x00, 0x06, 0x00, 0x07 };
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 6);
+  auto fieldref = cp.get<const ConstantPool::Fieldref_info>(1);
+  EXPECT_EQ(2u, fieldref.class_index);
+  EXPECT_EQ(3u, fieldref.name_and_type_index);
+  auto handle = cp.get<const ConstantPool::MethodHandle_info>(2);
+  EXPECT_EQ(ConstantPool::invokeStatic, handle.kind);
+  EXPECT_EQ(1u, handle.reference_index);
+  EXPECT_EQ(0x400921fb54442d18u, cp.get<const ConstantPool::Double_info>(3).bytes);
+  EXPECT_EQ(ConstantPool::Invalid, cp.get<const ConstantPool::tag>(4));
+  auto indy = cp.get<const ConstantPool::InvokeDynamic_info>(5);
+  EXPECT_EQ(6u, indy.bootstrap_method_attr_index);
+  EXPECT_EQ(7u, indy.name_and_type_index);
+}
+
+TEST_F(ConstantPoolTest, TestGetWrongType)
+{
+  auto bytes = poolBytes("Foo");
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ConstantPool cp(bc, 6);
+  EXPECT_THROW(cp.get<const ConstantPool::Integer_info>(1), std::exception);
+  EXPECT_THROW(cp.get<const JUtf8String>(1), std::exception);
+  EXPECT_THROW(cp.get<const ConstantPool::Class_info>(2), std::exception);
+  EXPECT_THROW(cp.get<const FieldDescriptor>(2), std::exception);
+  EXPECT_THROW(cp.get<const ConstantPool::Long_info>(4), std::exception);
+}
+
+TEST_F(ConstantPoolTest, TestFromEntries)
+{
+  ConstantPool cp(std::vector<ConstantPool::cp_type>{ ConstantPool::Invalid,
+                                                      ConstantPool::Class_info(2),
+                                                      JUtf8String("Foo"),
+                                                      ConstantPool::Long_info(1, 2),
+                                                      ConstantPool::Invalid,
+                                                      ConstantPool::Methodref_info(1, 6),
+                                                      ConstantPool::NameAndType_info(2, 7),
+                                                      MethodDescriptor(JUtf8String("()V")) });
+  ASSERT_EQ(8u, cp.size());
+  EXPECT_FALSE(cp.isLazy());
+  EXPECT_EQ(2u, cp.get<const ConstantPool::Class_info>(1).name_index);
+  EXPECT_EQ(JUtf8String("Foo"), cp.get<const JUtf8String>(2));
+  EXPECT_EQ(0x0000000100000002u, cp.get<const ConstantPool::Long_info>(3).value);
+  EXPECT_EQ(ConstantPool::cp_tag, cp.getType(4));
+  EXPECT_EQ(1u, cp.get<const ConstantPool::Methodref_info>(5).class_index);
+  EXPECT_EQ(6u, cp.get<const ConstantPool::Methodref_info>(5).name_and_type_index);
+  EXPECT_EQ(7u, cp.get<const ConstantPool::NameAndType_info>(6).descriptor_index);
+  EXPECT_EQ(ConstantPool::cp_methodDescriptor, cp.getType(7));
+}
+
+TEST_F(ConstantPoolTest, TestLongInLastEntry)
+{
+  std::vector<u1> bytes = { ConstantPool::Long, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02 };
+  parsing::ByteConsumer bc(bytes.data(), bytes.size());
+  ASSERT_THROW(ConstantPool(bc, 2), parsing::parse_failure);
+}
+}
@@ -168,4 +168,50 @@ TEST_F(FieldDescriptorTest, TestEquals)
 {
   ASSERT_EQ(FieldDescriptor(JUtf8String("Z")), FieldDescriptor(JUtf8String("Z")));
 }
+
+TEST_F(FieldDescriptorTest, TestTryParse)
+{
+  auto descriptor = FieldDescriptor::tryParse(JUtf8String("[Ljava/lang/String;"));
+  ASSERT_TRUE(descriptor);
+  ASSERT_EQ(FieldDescriptor(JUtf8String("[Ljava/lang/String;")), descriptor.value());
+}
+
+TEST_F(FieldDescriptorTest, TestTryParseInvalid)
+{
+  ASSERT_FALSE(FieldDescriptor::tryParse(JUtf8String("Code")));
+  ASSERT_FALSE(FieldDescriptor::tryParse(JUtf8String("Ljava/lang/String")));
+  ASSERT_FALSE(FieldDescriptor::tryParse(JUtf8String("[")));
+  ASSERT_FALSE(FieldDescriptor::tryParse(JUtf8String("")));
+}
+
+TEST_F(FieldDescriptorTest, TestInvalidTrailingCharacters)
+{
+  ASSERT_THROW(FieldDescriptor(JUtf8String("II")), parsing::parse_failure);
+  ASSERT_THROW(FieldDescriptor(JUtf8String("Ljava/lang/String;I")), parsing::parse_failure);
+}
+
+TEST_F(FieldDescriptorTest, TestParseByteView)
+{
+  std::vector<u1> bytes = { '[', 'L', 'a', 0xc4, 0xb6, ';' };
+  FieldDescriptor descriptor((parsing::ByteView(bytes)));
+  ASSERT_EQ(1, descriptor.getArrayDimensions());
+  ASSERT_EQ(FieldDescriptor::type::jclass, descriptor.getType());
+  ASSERT_EQ(JUtf8String("aĶ[]"), descriptor.getClassName());
+  ASSERT_FALSE(FieldDescriptor::tryParse(parsing::ByteView(bytes.data(), 5)));
+}
+
+TEST_F(FieldDescriptorTest, TestClassNamesAreInterned)
+{
+  ASSERT_EQ(FieldDescriptor(JUtf8String("I")).getClassSymbol(), Symbol::intern(JUtf8String("int")));
+  ASSERT_EQ(FieldDescriptor(JUtf8String("[[I")).getClassSymbol(), Symbol::intern(JUtf8String("int[][]")));
+  ASSERT_EQ(FieldDescriptor(JUtf8String("Ljava/lang/Object;")).getClassSymbol(),
+            FieldDescriptor(JUtf8String("Ljava/lang/Object;")).getClassSymbol());
+}
+
+TEST_F(FieldDescriptorTest, TestLongArrayClassName)
+{
+  std::string name(300, 'a');
+  FieldDescriptor descriptor(JUtf8String("[[L" + name + ";"));
+  ASSERT_EQ(JUtf8String(name + "[][]"), descriptor.getClassName());
+}
 }
@@ -0,0 +1,171 @@
+/**
+ * \file FieldLayout_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <sstream>
+#include "test/TestCommon.h"
+#include "test/ClassBuilder.h"
+#include "FieldLayout.h"
+#include "VirtualMachine.h"
+
+namespace mimic
+{
+
+typedef FieldDescriptor D;
+
+class FieldLayoutTest: public testing::Test
+{
+
+protected:
+  std::ostringstream out;
+  VirtualMachine vm;
+
+  FieldLayoutTest()
+    : vm(ClassPath(), out)
+  {
+  }
+
+  virtual ~FieldLayoutTest()
+  {
+  }
+
+  static u4 offsetOf(const RuntimeClass* clazz, const char* name)
+  {
+    for (auto& f : clazz->getFields())
+    {
+      if (f.name.str() == name)
+        return f.offset;
+    }
+    throw std::logic_error(std::string("No field ") + name);
+  }
+
+  static void expectOops(const FieldLayout& layout, const std::vector<std::pair<u4, u4>>& expected)
+  {
+    std::vector<std::pair<u4, u4>> oops;
+    for (auto& block : layout.getOopMap())
+      oops.emplace_back(block.offset, block.count);
+    EXPECT_EQ(expected, oops);
+  }
+};
+
+TEST_F(FieldLayoutTest, TestPacksLargestFirst)
+{
+  FieldLayout layout(8);
+  auto offsets = layout.addFields({D::jbyte, D::jint, D::jlong, D::jshort, D::jclass, D::jboolean, D::jchar,
+                                   D::jdouble, D::jarray});
+  EXPECT_EQ((std::vector<u4>{32, 24, 8, 28, 40, 33, 30, 16, 48}), offsets);
+  EXPECT_EQ(56u, layout.getEnd());
+  EXPECT_EQ(56u, layout.getSize());
+  EXPECT_EQ(6u, layout.getPadding());
+  expectOops(layout, {{40, 2}});
+  ASSERT_EQ(1u, layout.getGaps().size());
+  EXPECT_EQ(34u, layout.getGaps()[0].offset);
+  EXPECT_EQ(6u, layout.getGaps()[0].size);
+}
+
+TEST_F(FieldLayoutTest, TestFillsGaps)
+{
+  FieldLayout layout(8);
+  layout.addFields({D::jbyte});
+  EXPECT_EQ(16u, layout.getSize());
+  EXPECT_EQ(7u, layout.getPadding());
+
+  // A subclass' fields go in the superclass' tail padding where they fit
+  FieldLayout subclass(layout);
+  EXPECT_EQ((std::vector<u4>{16, 12, 10, 9}), subclass.addFields({D::jlong, D::jint, D::jshort, D::jbyte}));
+  EXPECT_TRUE(subclass.getGaps().empty());
+  EXPECT_EQ(24u, subclass.getSize());
+  EXPECT_EQ(0u, subclass.getPadding());
+
+  // Fields added one at a time fill gaps too
+  FieldLayout single(8);
+  EXPECT_EQ(8u, single.addField(D::jint));
+  EXPECT_EQ(16u, single.addField(D::jdouble));
+  EXPECT_EQ(12u, single.addField(D::jchar));
+  EXPECT_EQ(14u, single.addField(D::jboolean));
+  EXPECT_EQ(15u, single.addField(D::jbyte));
+  EXPECT_EQ(24u, single.addField(D::jbyte));
+}
+
+TEST_F(FieldLayoutTest, TestReferencesStayContiguous)
+{
+  FieldLayout base(8);
+  EXPECT_EQ((std::vector<u4>{16, 8}), base.addFields({D::jclass, D::jint}));
+  expectOops(base, {{16, 1}});
+
+  // The superclass ended with its references, so the subclass' extend them
+  FieldLayout derived(base);
+  EXPECT_EQ((std::vector<u4>{32, 24}), derived.addFields({D::jlong, D::jarray}));
+  expectOops(derived, {{16, 2}});
+  // ...but primitives still fill the gap the superclass left
+  EXPECT_EQ(12u, derived.addField(D::jfloat));
+
+  // Now that it ends with a primitive, references start a new run after it
+  FieldLayout more(derived);
+  EXPECT_EQ((std::vector<u4>{40, 48}), more.addFields({D::jclass, D::jclass}));
+  expectOops(more, {{16, 2}, {40, 2}});
+}
+
+TEST_F(FieldLayoutTest, TestReservedSpaceIsntScanned)
+{
+  FieldLayout layout(8);
+  EXPECT_EQ(8u, layout.reserve(8, 8));
+  EXPECT_EQ(16u, layout.addField(D::jclass));
+  expectOops(layout, {{16, 1}});
+  EXPECT_EQ(24u, layout.getSize());
+  EXPECT_EQ(0u, layout.getPadding());
+}
+
+TEST_F(FieldLayoutTest, TestTypeOf)
+{
+  EXPECT_EQ(D::jarray, FieldLayout::typeOf(D(JUtf8String("[I"))));
+  EXPECT_EQ(D::jarray, FieldLayout::typeOf(D(JUtf8String("[[Ljava/lang/String;"))));
+  EXPECT_EQ(D::jclass, FieldLayout::typeOf(D(JUtf8String("Ljava/lang/String;"))));
+  EXPECT_EQ(D::jshort, FieldLayout::typeOf(D(JUtf8String("S"))));
+  EXPECT_EQ(8u, FieldLayout::sizeOf(D::jarray));
+  EXPECT_EQ(2u, FieldLayout::sizeOf(D::jchar));
+}
+
+TEST_F(FieldLayoutTest, TestClassLayouts)
+{
+  ClassBuilder base("Base");
+  base.field(0, "flag", "Z").field(0, "name", "Ljava/lang/String;").field(ClassFile::acc_static, "count", "I")
+    .field(ClassFile::acc_static, "instance", "LBase;").field(ClassFile::acc_static, "total", "J");
+  RuntimeClass* base_class = vm.define(base.build());
+  EXPECT_EQ(8u, offsetOf(base_class, "flag"));
+  EXPECT_EQ(16u, offsetOf(base_class, "name"));
+  EXPECT_EQ(24u, base_class->getInstanceSize());
+  EXPECT_EQ(7u, base_class->getInstanceLayout().getPadding());
+  expectOops(base_class->getInstanceLayout(), {{16, 1}});
+  EXPECT_EQ(8u, offsetOf(base_class, "count"));
+  EXPECT_EQ(16u, offsetOf(base_class, "instance"));
+  EXPECT_EQ(0u, offsetOf(base_class, "total"));
+  EXPECT_EQ(24u, base_class->getStaticLayout().getSize());
+  expectOops(base_class->getStaticLayout(), {{16, 1}});
+
+  ClassBuilder derived("Derived", "Base");
+  derived.field(0, "values", "[I").field(0, "small", "S");
+  RuntimeClass* derived_class = vm.define(derived.build());
+  EXPECT_EQ(10u, offsetOf(derived_class, "small"));
+  EXPECT_EQ(24u, offsetOf(derived_class, "values"));
+  EXPECT_EQ(32u, derived_class->getInstanceSize());
+  EXPECT_EQ(derived_class->getInstanceLayout().getOopMap().size(), derived_class->getOopMap().size());
+  expectOops(derived_class->getInstanceLayout(), {{16, 2}});
+  EXPECT_EQ(0u, derived_class->getStaticLayout().getSize());
+}
+
+TEST_F(FieldLayoutTest, TestBuiltInLayouts)
+{
+  // Hidden state isn't in the oop map
+  RuntimeClass* string = vm.findClass("java/lang/String");
+  EXPECT_EQ(sizeof(StringObject), string->getInstanceSize());
+  EXPECT_TRUE(string->getOopMap().empty());
+  RuntimeClass* throwable = vm.findClass("java/lang/Throwable");
+  expectOops(throwable->getInstanceLayout(), {{vm.getMessageOffset(), 1}});
+  expectOops(vm.findClass("java/lang/System")->getStaticLayout(), {{0, 2}});
+}
+
+}
@@ -0,0 +1,196 @@
+/**
+ * \file Heap_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "test/TestCommon.h"
+#include "test/ClassBuilder.h"
+#include "Heap.h"
+#include "VirtualMachine.h"
+
+namespace mimic
+{
+
+typedef Bytecode B;
+
+class HeapTest: public testing::Test
+{
+
+protected:
+  HeapTest()
+  {
+  }
+
+  virtual ~HeapTest()
+  {
+  }
+
+  static u1* bytes(void* p)
+  {
+    return static_cast<u1*>(p);
+  }
+};
+
+TEST_F(HeapTest, TestBumpsWithinTlab)
+{
+  Heap heap(1 << 20, 4096);
+  u1* first = bytes(heap.allocate(16));
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(first + 16, heap.allocate(24));
+  EXPECT_EQ(first + 40, heap.allocate(3));
+  EXPECT_EQ(first + 48, heap.allocate(8));
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(first) % Heap::alignment);
+  EXPECT_TRUE(std::all_of(first, first + 56, [](u1 b) { return b == 0; }));
+  EXPECT_EQ(4096u, heap.getUsed());
+
+  auto stats = heap.getStats();
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(std::this_thread::get_id(), stats[0].thread);
+  EXPECT_EQ(4u, stats[0].objects);
+  EXPECT_EQ(56u, stats[0].bytes);
+  EXPECT_EQ(1u, stats[0].tlabs);
+  EXPECT_EQ(0u, stats[0].outside);
+  EXPECT_EQ(0u, stats[0].waste);
+}
+
+TEST_F(HeapTest, TestRetiresNearlyFullTlabs)
+{
+  Heap heap(1 << 20, 4096);
+  u1* first = bytes(heap.allocate(4000));
+  // 96 bytes are left, which is too much to throw away, so this comes from eden
+  u1* outside = bytes(heap.allocate(128));
+  EXPECT_EQ(first + 4096, outside);
+  EXPECT_EQ(first + 4000, heap.allocate(64));
+  // 32 bytes are left, which is little enough to throw away for a new TLAB
+  EXPECT_EQ(outside + 128, heap.allocate(40));
+  // Too big for any TLAB
+  EXPECT_EQ(outside + 128 + 4096, heap.allocate(8192));
+
+  auto stats = heap.getStats();
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(5u, stats[0].objects);
+  EXPECT_EQ(4000u + 128 + 64 + 40 + 8192, stats[0].bytes);
+  EXPECT_EQ(2u, stats[0].tlabs);
+  EXPECT_EQ(2u, stats[0].outside);
+  EXPECT_EQ(32u, stats[0].waste);
+}
+
+TEST_F(HeapTest, TestExhaustion)
+{
+  Heap heap(16384, 4096);
+  EXPECT_EQ(nullptr, heap.allocate(1 << 20));
+  EXPECT_EQ(nullptr, heap.allocate(std::numeric_limits<std::size_t>::max()));
+  EXPECT_EQ(nullptr, heap.allocate(std::numeric_limits<std::size_t>::max() - 6));
+  EXPECT_EQ(0u, heap.getUsed());
+  std::size_t count = 0;
+  while (heap.allocate(100))
+    count++;
+  EXPECT_EQ(16384u / 4096 * (4096 / 104), count);
+  EXPECT_EQ(16384u, heap.getUsed());
+  // What's left of the last TLAB can still be used
+  EXPECT_NE(nullptr, heap.allocate(40));
+  EXPECT_EQ(nullptr, heap.allocate(8));
+}
+
+TEST_F(HeapTest, TestThreads)
+{
+  Heap heap(std::size_t(64) << 20, 4096);
+  const u8 threads = 4;
+  const u8 count = 10000;
+  std::vector<std::vector<u8*>> allocated(threads);
+  std::vector<std::thread> workers;
+  for (u8 t = 0; t < threads; t++)
+  {
+    workers.emplace_back([&heap, &allocated, t, count]() {
+      for (u8 i = 0; i < count; i++)
+      {
+        auto p = static_cast<u8*>(heap.allocate(8 + 8 * (i % 4)));
+        if (!p || *p != 0)
+          break;
+        *p = t + 1;
+        allocated[t].push_back(p);
+      }
+    });
+  }
+  // Statistics can be read while the threads allocate
+  for (int i = 0; i < 100; i++)
+  {
+    for (auto& s : heap.getStats())
+      EXPECT_GE(count, s.objects);
+  }
+  for (auto& worker : workers)
+    worker.join();
+
+  // Nothing was handed to two threads
+  for (u8 t = 0; t < threads; t++)
+  {
+    ASSERT_EQ(count, allocated[t].size());
+    for (auto p : allocated[t])
+      ASSERT_EQ(t + 1, *p);
+  }
+  auto stats = heap.getStats();
+  ASSERT_EQ(threads, stats.size());
+  u8 tlabs = 0;
+  for (auto& s : stats)
+  {
+    EXPECT_EQ(count, s.objects);
+    EXPECT_EQ(count / 4 * (8 + 16 + 24 + 32), s.bytes);
+    tlabs += s.tlabs;
+  }
+  EXPECT_EQ(tlabs * 4096, heap.getUsed());
+}
+
+TEST_F(HeapTest, TestParseSize)
+{
+  EXPECT_EQ(4096u, Heap::parseSize("4096"));
+  EXPECT_EQ(64u << 10, Heap::parseSize("64k"));
+  EXPECT_EQ(2u << 20, Heap::parseSize("2M"));
+  EXPECT_EQ(std::size_t(3) << 30, Heap::parseSize("3g"));
+  for (auto invalid : {"", "k", "12x", "-1", "1kb", "1 k"})
+    EXPECT_THROW(Heap::parseSize(invalid), std::runtime_error) << invalid;
+}
+
+TEST_F(HeapTest, TestInvalidSizes)
+{
+  EXPECT_THROW(Heap(0, 4096), std::runtime_error);
+  EXPECT_THROW(Heap(1 << 20, 100), std::runtime_error);
+  std::ostringstream out;
+  EXPECT_THROW(VirtualMachine(ClassPath(), out, 32, 32), std::runtime_error);
+}
+
+TEST_F(HeapTest, TestOutOfMemoryError)
+{
+  std::ostringstream out;
+  VirtualMachine vm(ClassPath(), out, 1 << 20, 4096);
+  ClassBuilder builder("Allocator");
+  builder.method(ClassFile::acc_static, "allocate", "(I)[I", 1, 1, CodeBuilder()
+    .op(B::op_iload_0).op(B::op_newarray, 10).op(B::op_areturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+  auto method = clazz->findDeclaredMethod(Symbol::intern(JUtf8String("allocate")),
+                                          Symbol::intern(JUtf8String("(I)[I")));
+  Interpreter interpreter(vm);
+  slot length;
+  length.j = 0;
+  length.i = 1 << 20;
+  try
+  {
+    interpreter.call(*method, {length});
+    FAIL() << "nothing thrown";
+  }
+  catch (Interpreter::thrown& t)
+  {
+    EXPECT_EQ("java.lang.OutOfMemoryError: Java heap space", vm.describe(t.exception));
+  }
+  // The failed allocation didn't use the heap up
+  length.i = 10;
+  EXPECT_EQ(10, static_cast<Array*>(interpreter.call(*method, {length}).a)->length);
+}
+
+}
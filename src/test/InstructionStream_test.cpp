@@ -0,0 +1,298 @@
+/**
+ * \file InstructionStream_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <cstring>
+#include "test/TestCommon.h"
+#include "ClassFile.h"
+#include "InstructionStream.h"
+#include "MethodDescriptor.h"
+#include "parsing/ParseFailureException.h"
+
+namespace mimic
+{
+
+class InstructionStreamTest: public testing::Test
+{
+
+protected:
+  ConstantPool cp;
+
+  InstructionStreamTest()
+    : cp(std::vector<ConstantPool::cp_type>{ConstantPool::Invalid,
+                                            ConstantPool::Class_info(2),
+                                            JUtf8String("Foo"),
+                                            ConstantPool::Long_info(1, 2),
+                                            ConstantPool::Invalid,
+                                            ConstantPool::Methodref_info(1, 6),
+                                            ConstantPool::NameAndType_info(2, 7),
+                                            MethodDescriptor(JUtf8String("()V")),
+                                            ConstantPool::Integer_info(0x12345678),
+                                            ConstantPool::Float_info(0x3fc00000),
+                                            ConstantPool::String_info(2),
+                                            ConstantPool::Double_info(0x400921fb, 0x54442d18),
+                                            ConstantPool::Invalid,
+                                            ConstantPool::Fieldref_info(1, 14),
+                                            ConstantPool::NameAndType_info(2, 15),
+                                            FieldDescriptor(JUtf8String("I"))})
+  {
+  }
+
+  virtual ~InstructionStreamTest()
+  {
+  }
+
+  static attributes::code codeOf(std::vector<u1> bytes)
+  {
+    attributes::code code;
+    code.attribute_name_index = 0;
+    code.max_stack = 4;
+    code.max_locals = 4;
+    code.code = std::move(bytes);
+    return code;
+  }
+
+  InstructionStream decode(std::vector<u1> bytes, u2 major_version = 52)
+  {
+    return InstructionStream(codeOf(std::move(bytes)), cp, major_version);
+  }
+};
+
+TEST_F(InstructionStreamTest, TestConstantsAreFolded)
+{
+  auto stream = decode({Bytecode::op_iconst_m1,
+                        Bytecode::op_bipush, 0xfb,
+                        Bytecode::op_sipush, 0x03, 0xe8,
+                        Bytecode::op_ldc, 8,
+                        Bytecode::op_ldc_w, 0, 9,
+                        Bytecode::op_ldc, 10,
+                        Bytecode::op_ldc2_w, 0, 3,
+                        Bytecode::op_ldc2_w, 0, 11,
+                        Bytecode::op_lconst_1,
+                        Bytecode::op_fconst_2,
+                        Bytecode::op_dconst_1,
+                        Bytecode::op_return});
+  ASSERT_EQ(12u, stream.size());
+  EXPECT_EQ(Bytecode::op_push_int, stream[0].op);
+  EXPECT_EQ(-1, stream[0].value);
+  EXPECT_EQ(Bytecode::op_push_int, stream[1].op);
+  EXPECT_EQ(-5, stream[1].value);
+  EXPECT_EQ(1000, stream[2].value);
+  EXPECT_EQ(Bytecode::op_push_int, stream[3].op);
+  EXPECT_EQ(0x12345678, stream[3].value);
+  EXPECT_EQ(Bytecode::op_push_float, stream[4].op);
+  EXPECT_EQ(0x3fc00000, stream[4].value);
+  // Strings still have to be loaded from the pool
+  EXPECT_EQ(Bytecode::op_ldc, stream[5].op);
+  EXPECT_EQ(10, stream[5].index);
+  EXPECT_EQ(Bytecode::op_push_long, stream[6].op);
+  EXPECT_EQ(0x0000000100000002u, stream.getWideConstant(stream[6].index));
+  EXPECT_EQ(Bytecode::op_push_double, stream[7].op);
+  EXPECT_EQ(0x400921fb54442d18u, stream.getWideConstant(stream[7].index));
+  EXPECT_EQ(Bytecode::op_push_long, stream[8].op);
+  EXPECT_EQ(1u, stream.getWideConstant(stream[8].index));
+  EXPECT_EQ(Bytecode::op_push_float, stream[9].op);
+  float two;
+  std::memcpy(&two, &stream[9].value, sizeof(two));
+  EXPECT_EQ(2.0f, two);
+  EXPECT_EQ(Bytecode::op_push_double, stream[10].op);
+  EXPECT_EQ(Bytecode::op_return, stream[11].op);
+}
+
+TEST_F(InstructionStreamTest, TestLocalsAreFolded)
+{
+  auto stream = decode({Bytecode::op_iload_2,
+                        Bytecode::op_astore_3,
+                        Bytecode::op_dload, 7,
+                        Bytecode::op_wide, Bytecode::op_lstore, 0x01, 0x2c,
+                        Bytecode::op_iinc, 1, 0xff,
+                        Bytecode::op_wide, Bytecode::op_iinc, 0x01, 0x2c, 0x80, 0x00,
+                        Bytecode::op_return});
+  ASSERT_EQ(7u, stream.size());
+  EXPECT_EQ(Bytecode::op_iload, stream[0].op);
+  EXPECT_EQ(2, stream[0].index);
+  EXPECT_EQ(Bytecode::op_astore, stream[1].op);
+  EXPECT_EQ(3, stream[1].index);
+  EXPECT_EQ(Bytecode::op_dload, stream[2].op);
+  EXPECT_EQ(7, stream[2].index);
+  EXPECT_EQ(Bytecode::op_lstore, stream[3].op);
+  EXPECT_EQ(300, stream[3].index);
+  EXPECT_EQ(Bytecode::op_iinc, stream[4].op);
+  EXPECT_EQ(1, stream[4].index);
+  EXPECT_EQ(-1, stream[4].value);
+  EXPECT_EQ(Bytecode::op_iinc, stream[5].op);
+  EXPECT_EQ(300, stream[5].index);
+  EXPECT_EQ(-32768, stream[5].value);
+}
+
+TEST_F(InstructionStreamTest, TestBranchesTargetInstructions)
+{
+  auto stream = decode({Bytecode::op_iconst_0,                          // 0
+                        Bytecode::op_ifeq, 0x00, 0x08,                  // 1 -> 9
+                        Bytecode::op_goto_w, 0xff, 0xff, 0xff, 0xfc,    // 4 -> 0
+                        Bytecode::op_goto, 0xff, 0xf8,                  // 9 -> 1
+                        Bytecode::op_return});
+  ASSERT_EQ(5u, stream.size());
+  EXPECT_EQ(3, stream[1].value);
+  EXPECT_EQ(Bytecode::op_goto, stream[2].op);
+  EXPECT_EQ(0, stream[2].value);
+  EXPECT_EQ(1, stream[3].value);
+  EXPECT_EQ(9, stream.pcOf(3));
+  EXPECT_EQ(3u, stream.indexAt(9));
+  EXPECT_EQ(stream.size(), stream.indexAt(10));
+  // Into the middle of an instruction, and off either end of the code
+  EXPECT_THROW(decode({Bytecode::op_goto, 0x00, 0x01, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_goto, 0xff, 0xff, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_goto, 0x00, 0x04, Bytecode::op_return}), parsing::parse_failure);
+}
+
+TEST_F(InstructionStreamTest, TestSwitches)
+{
+  auto stream = decode({Bytecode::op_iload_1,                         // 0
+                        Bytecode::op_tableswitch, 0, 0,               // 1, padded to 4
+                        0, 0, 0, 55,                                  // default -> 56
+                        0xff, 0xff, 0xff, 0xff, 0, 0, 0, 1,           // -1 to 1
+                        0, 0, 0, 55, 0, 0, 0, 27, 0, 0, 0, 55,        // -> 56, 28, 56
+                        Bytecode::op_lookupswitch, 0, 0, 0,           // 28, padded to 32
+                        0, 0, 0, 28,                                  // default -> 56
+                        0, 0, 0, 2,
+                        0xff, 0xff, 0xff, 0xf6, 0xff, 0xff, 0xff, 0xe4,  // -10 -> 0
+                        0, 0, 0, 100, 0, 0, 0, 28,                    // 100 -> 56
+                        Bytecode::op_return});                        // 56
+  ASSERT_EQ(4u, stream.size());
+  auto& table = stream.getTableSwitch(stream[1].index);
+  EXPECT_EQ(-1, table.low);
+  EXPECT_EQ(1, table.high);
+  EXPECT_EQ(2u, table.target(0));
+  EXPECT_EQ(3u, table.target(1));
+  EXPECT_EQ(3u, table.target(-2));
+  EXPECT_EQ(3u, table.target(2));
+  EXPECT_EQ(3u, table.targets.size());
+  auto& lookup = stream.getLookupSwitch(stream[2].index);
+  EXPECT_EQ((std::vector<s4>{-10, 100}), lookup.keys);
+  EXPECT_EQ(0u, lookup.target(-10));
+  EXPECT_EQ(3u, lookup.target(100));
+  EXPECT_EQ(3u, lookup.target(0));
+}
+
+TEST_F(InstructionStreamTest, TestUnsortedLookupSwitch)
+{
+  EXPECT_THROW(decode({Bytecode::op_lookupswitch, 0, 0, 0,
+                       0, 0, 0, 28,
+                       0, 0, 0, 2,
+                       0, 0, 0, 5, 0, 0, 0, 28,
+                       0, 0, 0, 4, 0, 0, 0, 28,
+                       Bytecode::op_return}), parsing::parse_failure);
+}
+
+TEST_F(InstructionStreamTest, TestInvalidCode)
+{
+  EXPECT_THROW(decode({0xcb}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_sipush, 0}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_wide, Bytecode::op_iadd, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_newarray, 3, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_tableswitch, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0}),
+               parsing::parse_failure);
+}
+
+TEST_F(InstructionStreamTest, TestSubroutinesOnlyInOldClasses)
+{
+  std::vector<u1> code = {Bytecode::op_jsr, 0x00, 0x04, Bytecode::op_return, Bytecode::op_astore_1,
+                          Bytecode::op_ret, 1};
+  EXPECT_THROW(decode(code, 51), parsing::parse_failure);
+  auto stream = decode(code, 50);
+  EXPECT_EQ(Bytecode::op_jsr, stream[0].op);
+  EXPECT_EQ(2, stream[0].value);
+  EXPECT_EQ(Bytecode::op_ret, stream[3].op);
+  EXPECT_EQ(1, stream[3].index);
+}
+
+TEST_F(InstructionStreamTest, TestConstantPoolReferences)
+{
+  auto stream = decode({Bytecode::op_getstatic, 0, 13,
+                        Bytecode::op_invokestatic, 0, 5,
+                        Bytecode::op_new, 0, 1,
+                        Bytecode::op_multianewarray, 0, 1, 2,
+                        Bytecode::op_return});
+  EXPECT_EQ(13, stream[0].index);
+  EXPECT_EQ(5, stream[1].index);
+  EXPECT_EQ(1, stream[2].index);
+  EXPECT_EQ(2, stream[3].small);
+  EXPECT_THROW(decode({Bytecode::op_getfield, 0, 5, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_invokevirtual, 0, 13, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_ldc, 3, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_ldc2_w, 0, 8, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_new, 0, 99, Bytecode::op_return}), parsing::parse_failure);
+  EXPECT_THROW(decode({Bytecode::op_new, 0, 0, Bytecode::op_return}), parsing::parse_failure);
+}
+
+TEST_F(InstructionStreamTest, TestCallSitesAreNumbered)
+{
+  auto stream = decode({Bytecode::op_aload_0,
+                        Bytecode::op_invokevirtual, 0, 5,
+                        Bytecode::op_invokestatic, 0, 5,
+                        Bytecode::op_aload_0,
+                        Bytecode::op_invokevirtual, 0, 5,
+                        Bytecode::op_return});
+  EXPECT_EQ(2u, stream.getCallSiteCount());
+  EXPECT_EQ(0, stream[1].value);
+  EXPECT_EQ(0, stream[2].value);
+  EXPECT_EQ(1, stream[4].value);
+  EXPECT_EQ(0u, decode({Bytecode::op_return}).getCallSiteCount());
+}
+
+TEST_F(InstructionStreamTest, TestExceptionHandlersAndLines)
+{
+  auto code = codeOf({Bytecode::op_aload_0,               // 0
+                      Bytecode::op_getfield, 0, 13,       // 1
+                      Bytecode::op_ireturn,               // 4
+                      Bytecode::op_astore_1,              // 5
+                      Bytecode::op_iconst_0,              // 6
+                      Bytecode::op_ireturn});             // 7
+  code.exception_table.push_back(attributes::exception_info{0, 5, 5, 1});
+  code.attrs.push_back(attributes::line_number_table{0, {{5, 20}, {0, 10}}});
+  InstructionStream stream(code, cp, 52);
+  ASSERT_EQ(1u, stream.getExceptionHandlers().size());
+  auto& handler = stream.getExceptionHandlers()[0];
+  EXPECT_EQ(0u, handler.start);
+  EXPECT_EQ(3u, handler.end);
+  EXPECT_EQ(3u, handler.handler);
+  EXPECT_EQ(1, handler.catch_type);
+  EXPECT_EQ(10, stream.lineOf(0));
+  EXPECT_EQ(10, stream.lineOf(2));
+  EXPECT_EQ(20, stream.lineOf(3));
+  EXPECT_EQ(20, stream.lineOf(5));
+
+  code.exception_table[0].end_pc = 3;
+  EXPECT_THROW(InstructionStream(code, cp, 52), parsing::parse_failure);
+  code.exception_table[0] = attributes::exception_info{0, 8, 5, 10};
+  EXPECT_THROW(InstructionStream(code, cp, 52), parsing::parse_failure);
+}
+
+TEST_F(InstructionStreamTest, TestClassFileDecodesMethods)
+{
+  ClassFile clazz(fs::path("src/test/resources/HelloWorld.class"));
+  auto& cp = clazz.getConstantPool();
+  for (auto& method : clazz.getMethods())
+  {
+    ASSERT_NE(nullptr, method.instructions);
+    auto& stream = *method.instructions;
+    EXPECT_EQ(Bytecode::op_return, stream[stream.size() - 1].op);
+    EXPECT_NE(0, stream.lineOf(0));
+    if (cp.getSymbol(method.name_index) != Symbol::intern(JUtf8String("main")))
+      continue;
+    // System.out.println("Hello world")
+    ASSERT_EQ(4u, stream.size());
+    EXPECT_EQ(Bytecode::op_getstatic, stream[0].op);
+    EXPECT_EQ(Bytecode::op_ldc, stream[1].op);
+    EXPECT_EQ(JUtf8String("Hello world!"),
+              cp.get<const JUtf8String>(cp.get<const ConstantPool::String_info>(stream[1].index).string_index));
+    EXPECT_EQ(Bytecode::op_invokevirtual, stream[2].op);
+    EXPECT_EQ(5, stream.pcOf(2));
+  }
+}
+
+}
@@ -0,0 +1,696 @@
+/**
+ * \file Interpreter_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "test/TestCommon.h"
+#include "test/ClassBuilder.h"
+#include "Interpreter.h"
+#include "VirtualMachine.h"
+
+namespace mimic
+{
+
+typedef Bytecode B;
+
+/**
+ * Runs every test with both threaded and switch dispatch
+ */
+class InterpreterTest: public testing::TestWithParam<Interpreter::dispatch>
+{
+
+protected:
+  std::ostringstream out;
+  VirtualMachine vm;
+
+  InterpreterTest()
+    : vm(ClassPath(), out)
+  {
+  }
+
+  virtual ~InterpreterTest()
+  {
+  }
+
+  slot call(RuntimeClass* clazz, const char* name, const char* descriptor, const std::vector<slot>& args = {})
+  {
+    auto method = clazz->findDeclaredMethod(Symbol::intern(JUtf8String(name)),
+                                            Symbol::intern(JUtf8String(descriptor)));
+    if (!method)
+      throw std::logic_error(std::string("No method ") + name);
+    Interpreter interpreter(vm, GetParam());
+    return interpreter.call(*method, args);
+  }
+
+  /**
+   * @return the exception the method threw, as Java would print it
+   */
+  std::string thrownBy(RuntimeClass* clazz, const char* name, const char* descriptor,
+                       const std::vector<slot>& args = {})
+  {
+    try
+    {
+      call(clazz, name, descriptor, args);
+    }
+    catch (Interpreter::thrown& t)
+    {
+      return vm.describe(t.exception);
+    }
+    return "nothing thrown";
+  }
+
+  static slot i(s4 value)
+  {
+    slot s;
+    s.j = 0;
+    s.i = value;
+    return s;
+  }
+
+  static slot j(s8 value)
+  {
+    slot s;
+    s.j = value;
+    return s;
+  }
+
+  static slot f(float value)
+  {
+    slot s;
+    s.j = 0;
+    s.f = value;
+    return s;
+  }
+
+  static slot d(double value)
+  {
+    slot s;
+    s.d = value;
+    return s;
+  }
+
+  static std::string text(const slot& s)
+  {
+    return static_cast<StringObject*>(s.a)->value->str();
+  }
+};
+
+TEST_P(InterpreterTest, TestIntArithmetic)
+{
+  ClassBuilder builder("Arithmetic");
+  // ((a * b + a / b - a % b) << 2) ^ (a >>> 1)
+  builder.method(ClassFile::acc_static, "compute", "(II)I", 4, 2, CodeBuilder()
+    .op(B::op_iload_0).op(B::op_iload_1).op(B::op_imul)
+    .op(B::op_iload_0).op(B::op_iload_1).op(B::op_idiv).op(B::op_iadd)
+    .op(B::op_iload_0).op(B::op_iload_1).op(B::op_irem).op(B::op_isub)
+    .op(B::op_iconst_2).op(B::op_ishl)
+    .op(B::op_iload_0).op(B::op_iconst_1).op(B::op_iushr)
+    .op(B::op_ixor).op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "add", "(II)I", 2, 2, CodeBuilder()
+    .op(B::op_iload_0).op(B::op_iload_1).op(B::op_iadd).op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "divide", "(II)I", 2, 2, CodeBuilder()
+    .op(B::op_iload_0).op(B::op_iload_1).op(B::op_idiv).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(-2147483588, call(clazz, "compute", "(II)I", {i(-7), i(2)}).i);
+  EXPECT_EQ(std::numeric_limits<s4>::min(), call(clazz, "add", "(II)I", {i(std::numeric_limits<s4>::max()), i(1)}).i);
+  EXPECT_EQ(std::numeric_limits<s4>::min(), call(clazz, "divide", "(II)I", {i(std::numeric_limits<s4>::min()), i(-1)}).i);
+  EXPECT_EQ(-3, call(clazz, "divide", "(II)I", {i(-7), i(2)}).i);
+  EXPECT_EQ("java.lang.ArithmeticException: / by zero", thrownBy(clazz, "divide", "(II)I", {i(1), i(0)}));
+}
+
+TEST_P(InterpreterTest, TestLongsAndDoubles)
+{
+  ClassBuilder builder("Wide");
+  u2 three = builder.longConstant(3);
+  // (double) (a * 3L - 1L) / b
+  builder.method(ClassFile::acc_static, "compute", "(JD)D", 4, 4, CodeBuilder()
+    .op(B::op_lload_0).op2(B::op_ldc2_w, three).op(B::op_lmul)
+    .op(B::op_lconst_1).op(B::op_lsub).op(B::op_l2d)
+    .op(B::op_dload_2).op(B::op_ddiv).op(B::op_dreturn));
+  // (a << 40) >>> 8
+  builder.method(ClassFile::acc_static, "shift", "(J)J", 3, 2, CodeBuilder()
+    .op(B::op_lload_0).op(B::op_bipush, 40).op(B::op_lshl)
+    .op(B::op_bipush, 8).op(B::op_lushr).op(B::op_lreturn));
+  builder.method(ClassFile::acc_static, "compare", "(JJ)I", 4, 4, CodeBuilder()
+    .op(B::op_lload_0).op(B::op_lload_2).op(B::op_lcmp).op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "toInt", "(F)I", 1, 1, CodeBuilder()
+    .op(B::op_fload_0).op(B::op_f2i).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(7.0, call(clazz, "compute", "(JD)D", {j(5), j(0), d(2.0), j(0)}).d);
+  EXPECT_EQ(s8(3) << 32, call(clazz, "shift", "(J)J", {j(3), j(0)}).j);
+  EXPECT_EQ(-1, call(clazz, "compare", "(JJ)I", {j(-5), j(0), j(5), j(0)}).i);
+  EXPECT_EQ(0, call(clazz, "compare", "(JJ)I", {j(5), j(0), j(5), j(0)}).i);
+  EXPECT_EQ(0, call(clazz, "toInt", "(F)I", {f(std::nanf(""))}).i);
+  EXPECT_EQ(std::numeric_limits<s4>::max(), call(clazz, "toInt", "(F)I", {f(1e20f)}).i);
+  EXPECT_EQ(-2, call(clazz, "toInt", "(F)I", {f(-2.9f)}).i);
+}
+
+TEST_P(InterpreterTest, TestFloatingPointComparisons)
+{
+  ClassBuilder builder("Compare");
+  builder.method(ClassFile::acc_static, "fcmpl", "(FF)I", 2, 2, CodeBuilder()
+    .op(B::op_fload_0).op(B::op_fload_1).op(B::op_fcmpl).op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "fcmpg", "(FF)I", 2, 2, CodeBuilder()
+    .op(B::op_fload_0).op(B::op_fload_1).op(B::op_fcmpg).op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "dcmpl", "(DD)I", 4, 4, CodeBuilder()
+    .op(B::op_dload_0).op(B::op_dload_2).op(B::op_dcmpl).op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "dcmpg", "(DD)I", 4, 4, CodeBuilder()
+    .op(B::op_dload_0).op(B::op_dload_2).op(B::op_dcmpg).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  // The results are ints, used directly rather than only through a branch
+  EXPECT_EQ(1, call(clazz, "fcmpl", "(FF)I", {f(2.0f), f(1.0f)}).i);
+  EXPECT_EQ(0, call(clazz, "fcmpl", "(FF)I", {f(1.0f), f(1.0f)}).i);
+  EXPECT_EQ(-1, call(clazz, "fcmpl", "(FF)I", {f(1.0f), f(2.0f)}).i);
+  EXPECT_EQ(-1, call(clazz, "fcmpl", "(FF)I", {f(std::nanf("")), f(1.0f)}).i);
+  EXPECT_EQ(1, call(clazz, "fcmpg", "(FF)I", {f(2.0f), f(1.0f)}).i);
+  EXPECT_EQ(-1, call(clazz, "fcmpg", "(FF)I", {f(1.0f), f(2.0f)}).i);
+  EXPECT_EQ(1, call(clazz, "fcmpg", "(FF)I", {f(1.0f), f(std::nanf(""))}).i);
+  EXPECT_EQ(1, call(clazz, "dcmpl", "(DD)I", {d(2.0), j(0), d(1.0), j(0)}).i);
+  EXPECT_EQ(0, call(clazz, "dcmpl", "(DD)I", {d(1.0), j(0), d(1.0), j(0)}).i);
+  EXPECT_EQ(-1, call(clazz, "dcmpl", "(DD)I", {d(std::nan("")), j(0), d(1.0), j(0)}).i);
+  EXPECT_EQ(-1, call(clazz, "dcmpg", "(DD)I", {d(1.0), j(0), d(2.0), j(0)}).i);
+  EXPECT_EQ(1, call(clazz, "dcmpg", "(DD)I", {d(1.0), j(0), d(std::nan("")), j(0)}).i);
+}
+
+TEST_P(InterpreterTest, TestLoop)
+{
+  ClassBuilder builder("Loop");
+  // int s = 0; for (int i = 1; i <= n; i++) s += i; return s;
+  builder.method(ClassFile::acc_static, "sum", "(I)I", 2, 3, CodeBuilder()
+    .op(B::op_iconst_0).op(B::op_istore_1)
+    .op(B::op_iconst_1).op(B::op_istore_2)
+    .label("test")
+    .op(B::op_iload_2).op(B::op_iload_0).branch(B::op_if_icmpgt, "done")
+    .op(B::op_iload_1).op(B::op_iload_2).op(B::op_iadd).op(B::op_istore_1)
+    .iinc(2, 1)
+    .branch(B::op_goto, "test")
+    .label("done")
+    .op(B::op_iload_1).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(5050, call(clazz, "sum", "(I)I", {i(100)}).i);
+  EXPECT_EQ(0, call(clazz, "sum", "(I)I", {i(0)}).i);
+}
+
+TEST_P(InterpreterTest, TestRecursion)
+{
+  ClassBuilder builder("Fibonacci");
+  u2 fib = builder.methodRef("Fibonacci", "fib", "(I)I");
+  builder.method(ClassFile::acc_static, "fib", "(I)I", 3, 1, CodeBuilder()
+    .op(B::op_iload_0).op(B::op_iconst_2).branch(B::op_if_icmpge, "recurse")
+    .op(B::op_iload_0).op(B::op_ireturn)
+    .label("recurse")
+    .op(B::op_iload_0).op(B::op_iconst_1).op(B::op_isub).op2(B::op_invokestatic, fib)
+    .op(B::op_iload_0).op(B::op_iconst_2).op(B::op_isub).op2(B::op_invokestatic, fib)
+    .op(B::op_iadd).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(6765, call(clazz, "fib", "(I)I", {i(20)}).i);
+}
+
+TEST_P(InterpreterTest, TestStackOverflow)
+{
+  ClassBuilder builder("Deep");
+  u2 self = builder.methodRef("Deep", "down", "(I)I");
+  builder.method(ClassFile::acc_static, "down", "(I)I", 2, 1, CodeBuilder()
+    .op(B::op_iload_0).op(B::op_iconst_1).op(B::op_iadd).op2(B::op_invokestatic, self).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ("java.lang.StackOverflowError", thrownBy(clazz, "down", "(I)I", {i(0)}));
+}
+
+TEST_P(InterpreterTest, TestObjectsAndVirtualCalls)
+{
+  ClassBuilder counter("Counter");
+  counter.field(0, "count", "I").field(0, "total", "J");
+  u2 object_init = counter.methodRef("java/lang/Object", "<init>", "()V");
+  u2 count = counter.fieldRef("Counter", "count", "I");
+  u2 total = counter.fieldRef("Counter", "total", "J");
+  counter.method(ClassFile::acc_public, "<init>", "()V", 1, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_invokespecial, object_init).op(B::op_return));
+  // count++; total += v;
+  counter.method(ClassFile::acc_public, "add", "(I)V", 5, 2, CodeBuilder()
+    .op(B::op_aload_0).op(B::op_dup).op2(B::op_getfield, count).op(B::op_iconst_1).op(B::op_iadd)
+    .op2(B::op_putfield, count)
+    .op(B::op_aload_0).op(B::op_dup).op2(B::op_getfield, total).op(B::op_iload_1).op(B::op_i2l).op(B::op_ladd)
+    .op2(B::op_putfield, total)
+    .op(B::op_return));
+  vm.define(counter.build());
+
+  ClassBuilder doubler("Doubler", "Counter");
+  u2 counter_init = doubler.methodRef("Counter", "<init>", "()V");
+  u2 counter_add = doubler.methodRef("Counter", "add", "(I)V");
+  doubler.method(ClassFile::acc_public, "<init>", "()V", 1, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_invokespecial, counter_init).op(B::op_return));
+  // super.add(v * 2)
+  doubler.method(ClassFile::acc_public, "add", "(I)V", 3, 2, CodeBuilder()
+    .op(B::op_aload_0).op(B::op_iload_1).op(B::op_iconst_2).op(B::op_imul)
+    .op2(B::op_invokespecial, counter_add).op(B::op_return));
+  vm.define(doubler.build());
+
+  ClassBuilder builder("Main");
+  u2 doubler_class = builder.classRef("Doubler");
+  u2 init = builder.methodRef("Doubler", "<init>", "()V");
+  u2 add = builder.methodRef("Counter", "add", "(I)V");
+  u2 main_count = builder.fieldRef("Counter", "count", "I");
+  u2 main_total = builder.fieldRef("Counter", "total", "J");
+  // Counter c = new Doubler(); c.add(5); c.add(7); return c.total + c.count * 1000;
+  builder.method(ClassFile::acc_static, "run", "()J", 4, 1, CodeBuilder()
+    .op2(B::op_new, doubler_class).op(B::op_dup).op2(B::op_invokespecial, init).op(B::op_astore_0)
+    .op(B::op_aload_0).op(B::op_iconst_5).op2(B::op_invokevirtual, add)
+    .op(B::op_aload_0).op(B::op_bipush, 7).op2(B::op_invokevirtual, add)
+    .op(B::op_aload_0).op2(B::op_getfield, main_total)
+    .op(B::op_aload_0).op2(B::op_getfield, main_count).op2(B::op_sipush, 1000).op(B::op_imul).op(B::op_i2l)
+    .op(B::op_ladd).op(B::op_lreturn));
+  builder.method(ClassFile::acc_static, "nullReceiver", "()V", 2, 0, CodeBuilder()
+    .op(B::op_aconst_null).op(B::op_iconst_1).op2(B::op_invokevirtual, add).op(B::op_return));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(2024, call(clazz, "run", "()J").j);
+  EXPECT_EQ("java.lang.NullPointerException", thrownBy(clazz, "nullReceiver", "()V"));
+}
+
+TEST_P(InterpreterTest, TestPackedFields)
+{
+  ClassBuilder builder("Packed");
+  builder.field(0, "b", "B").field(0, "s", "S").field(0, "c", "C").field(0, "l", "J");
+  u2 packed = builder.classRef("Packed");
+  u2 b = builder.fieldRef("Packed", "b", "B");
+  u2 s = builder.fieldRef("Packed", "s", "S");
+  u2 c = builder.fieldRef("Packed", "c", "C");
+  u2 l = builder.fieldRef("Packed", "l", "J");
+  // Packed p = new Packed(); p.b = p.s = p.c = p.l = v; return p.b + p.s + p.c + p.l;
+  builder.method(ClassFile::acc_static, "run", "(I)J", 4, 2, CodeBuilder()
+    .op2(B::op_new, packed).op(B::op_astore_1)
+    .op(B::op_aload_1).op(B::op_iload_0).op2(B::op_putfield, b)
+    .op(B::op_aload_1).op(B::op_iload_0).op2(B::op_putfield, s)
+    .op(B::op_aload_1).op(B::op_iload_0).op2(B::op_putfield, c)
+    .op(B::op_aload_1).op(B::op_iload_0).op(B::op_i2l).op2(B::op_putfield, l)
+    .op(B::op_aload_1).op2(B::op_getfield, b).op(B::op_aload_1).op2(B::op_getfield, s).op(B::op_iadd)
+    .op(B::op_aload_1).op2(B::op_getfield, c).op(B::op_iadd).op(B::op_i2l)
+    .op(B::op_aload_1).op2(B::op_getfield, l).op(B::op_ladd).op(B::op_lreturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  // The fields share a cell, so each must be stored at its own size
+  EXPECT_EQ(24u, clazz->getInstanceSize());
+  EXPECT_EQ(0x45 + 0x2345 + 0x2345 + 0x12345, call(clazz, "run", "(I)J", {i(0x12345)}).j);
+  EXPECT_EQ(-1 - 1 + 0xFFFF - 1, call(clazz, "run", "(I)J", {i(-1)}).j);
+}
+
+TEST_P(InterpreterTest, TestSuperCallSelectsClosestOverride)
+{
+  ClassBuilder a("A");
+  u2 object_init = a.methodRef("java/lang/Object", "<init>", "()V");
+  a.method(ClassFile::acc_public, "<init>", "()V", 1, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_invokespecial, object_init).op(B::op_return));
+  a.method(ClassFile::acc_public, "value", "()I", 1, 1, CodeBuilder().op(B::op_iconst_1).op(B::op_ireturn));
+  vm.define(a.build());
+
+  ClassBuilder b("B", "A");
+  u2 a_init = b.methodRef("A", "<init>", "()V");
+  b.method(ClassFile::acc_public, "<init>", "()V", 1, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_invokespecial, a_init).op(B::op_return));
+  b.method(ClassFile::acc_public, "value", "()I", 1, 1, CodeBuilder().op(B::op_iconst_2).op(B::op_ireturn));
+  vm.define(b.build());
+
+  ClassBuilder c("C", "B");
+  u2 c_class = c.classRef("C");
+  u2 b_init = c.methodRef("B", "<init>", "()V");
+  u2 c_init = c.methodRef("C", "<init>", "()V");
+  u2 a_value = c.methodRef("A", "value", "()I");
+  c.method(ClassFile::acc_public, "<init>", "()V", 1, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_invokespecial, b_init).op(B::op_return));
+  c.method(ClassFile::acc_public, "value", "()I", 1, 1, CodeBuilder().op(B::op_iconst_3).op(B::op_ireturn));
+  // new C().super.value(), naming A rather than the direct superclass B
+  c.method(ClassFile::acc_static, "run", "()I", 2, 0, CodeBuilder()
+    .op2(B::op_new, c_class).op(B::op_dup).op2(B::op_invokespecial, c_init)
+    .op2(B::op_invokespecial, a_value).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(c.build());
+
+  EXPECT_EQ(2, call(clazz, "run", "()I").i);
+  auto& references = clazz->getResolvedReferences();
+  RuntimeClass* a_class = vm.findClass("A");
+  EXPECT_EQ(a_class->findDeclaredMethod(Symbol::intern(JUtf8String("value")), Symbol::intern(JUtf8String("()I"))),
+            references.get<const RuntimeClass::method>(a_value));
+  EXPECT_EQ(vm.findClass("B"), references.getSecond<const RuntimeClass::method>(a_value)->owner);
+  // Run again from the resolved references
+  EXPECT_EQ(2, call(clazz, "run", "()I").i);
+}
+
+TEST_P(InterpreterTest, TestReferencesAreResolvedOnFirstUse)
+{
+  ClassBuilder builder("Resolved");
+  builder.field(ClassFile::acc_static, "count", "I");
+  u2 count = builder.fieldRef("Resolved", "count", "I");
+  u2 bump = builder.methodRef("Resolved", "bump", "()V");
+  u2 string_class = builder.classRef("java/lang/String");
+  u2 text = builder.string("text");
+  builder.method(ClassFile::acc_static, "bump", "()V", 2, 0, CodeBuilder()
+    .op2(B::op_getstatic, count).op(B::op_iconst_1).op(B::op_iadd).op2(B::op_putstatic, count).op(B::op_return));
+  builder.method(ClassFile::acc_static, "run", "()I", 2, 0, CodeBuilder()
+    .op2(B::op_invokestatic, bump).op2(B::op_invokestatic, bump)
+    .op(B::op_iconst_2).op2(B::op_anewarray, string_class).op(B::op_pop)
+    .op(B::op_ldc, static_cast<u1>(text)).op(B::op_pop)
+    .op2(B::op_getstatic, count).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+  auto& references = clazz->getResolvedReferences();
+
+  EXPECT_EQ(clazz->getConstantPool().size(), references.size());
+  EXPECT_EQ(nullptr, references.get<const RuntimeClass::method>(bump));
+  EXPECT_EQ(nullptr, references.get<const RuntimeClass::field>(count));
+
+  EXPECT_EQ(2, call(clazz, "run", "()I").i);
+  EXPECT_EQ(clazz->findDeclaredMethod(Symbol::intern(JUtf8String("bump")), Symbol::intern(JUtf8String("()V"))),
+            references.get<const RuntimeClass::method>(bump));
+  EXPECT_EQ(clazz->findField(Symbol::intern(JUtf8String("count")), Symbol::intern(JUtf8String("I"))),
+            references.get<const RuntimeClass::field>(count));
+  EXPECT_EQ(vm.findClass("java/lang/String"), references.get<RuntimeClass>(string_class));
+  EXPECT_EQ(vm.findClass("[Ljava/lang/String;"), references.getSecond<RuntimeClass>(string_class));
+  EXPECT_EQ(vm.intern(Symbol::intern(JUtf8String("text"))), references.get<Object>(text));
+  EXPECT_EQ(4, call(clazz, "run", "()I").i);
+}
+
+TEST_P(InterpreterTest, TestInterfaces)
+{
+  ClassBuilder shape("Shape", "java/lang/Object",
+                     ClassFile::acc_public | ClassFile::acc_interface | ClassFile::acc_abstract);
+  shape.method(ClassFile::acc_public | ClassFile::acc_abstract, "area", "()I");
+  vm.define(shape.build());
+
+  ClassBuilder square("Square");
+  square.implement("Shape").field(0, "side", "I");
+  u2 object_init = square.methodRef("java/lang/Object", "<init>", "()V");
+  u2 side = square.fieldRef("Square", "side", "I");
+  square.method(ClassFile::acc_public, "<init>", "()V", 2, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_invokespecial, object_init)
+    .op(B::op_aload_0).op(B::op_iconst_3).op2(B::op_putfield, side).op(B::op_return));
+  square.method(ClassFile::acc_public, "area", "()I", 2, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_getfield, side).op(B::op_aload_0).op2(B::op_getfield, side)
+    .op(B::op_imul).op(B::op_ireturn));
+  vm.define(square.build());
+
+  ClassBuilder builder("Main");
+  u2 square_class = builder.classRef("Square");
+  u2 shape_class = builder.classRef("Shape");
+  u2 string_class = builder.classRef("java/lang/String");
+  u2 init = builder.methodRef("Square", "<init>", "()V");
+  u2 area = builder.interfaceMethodRef("Shape", "area", "()I");
+  // Shape s = new Square(); return s.area() * 10 + (s instanceof Shape ? 1 : 0);
+  builder.method(ClassFile::acc_static, "run", "()I", 3, 1, CodeBuilder()
+    .op2(B::op_new, square_class).op(B::op_dup).op2(B::op_invokespecial, init).op(B::op_astore_0)
+    .op(B::op_aload_0).op2(B::op_checkcast, shape_class).invokeinterface(area, 1)
+    .op(B::op_bipush, 10).op(B::op_imul)
+    .op(B::op_aload_0).op2(B::op_instanceof, shape_class).op(B::op_iadd)
+    .op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "badCast", "()V", 2, 0, CodeBuilder()
+    .op2(B::op_new, square_class).op(B::op_dup).op2(B::op_invokespecial, init)
+    .op2(B::op_checkcast, string_class).op(B::op_pop).op(B::op_return));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(91, call(clazz, "run", "()I").i);
+  EXPECT_EQ("java.lang.ClassCastException: class Square cannot be cast to class java.lang.String",
+            thrownBy(clazz, "badCast", "()V"));
+}
+
+TEST_P(InterpreterTest, TestInlineCaches)
+{
+  ClassBuilder animal("Animal", "java/lang/Object", ClassFile::acc_public | ClassFile::acc_abstract);
+  animal.method(ClassFile::acc_public | ClassFile::acc_abstract, "id", "()I");
+  vm.define(animal.build());
+  ClassBuilder tagged("Tagged", "java/lang/Object",
+                      ClassFile::acc_public | ClassFile::acc_interface | ClassFile::acc_abstract);
+  tagged.method(ClassFile::acc_public | ClassFile::acc_abstract, "tag", "()I");
+  RuntimeClass* tagged_class = vm.define(tagged.build());
+  std::vector<RuntimeClass*> animals;
+  for (s1 id = 1; id <= 6; id++)
+  {
+    ClassBuilder builder("Animal" + std::to_string(id), "Animal");
+    builder.implement("Tagged");
+    builder.method(ClassFile::acc_public, "id", "()I", 1, 1, CodeBuilder().op(B::op_bipush, id).op(B::op_ireturn));
+    builder.method(ClassFile::acc_public, "tag", "()I", 1, 1, CodeBuilder().op(B::op_bipush, -id).op(B::op_ireturn));
+    animals.push_back(vm.define(builder.build()));
+  }
+
+  ClassBuilder builder("Caller");
+  u2 id = builder.methodRef("Animal", "id", "()I");
+  u2 tag = builder.interfaceMethodRef("Tagged", "tag", "()I");
+  builder.method(ClassFile::acc_static, "id", "(LAnimal;)I", 1, 1, CodeBuilder()
+    .op(B::op_aload_0).op2(B::op_invokevirtual, id).op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "tag", "(LTagged;)I", 1, 1, CodeBuilder()
+    .op(B::op_aload_0).invokeinterface(tag, 1).op(B::op_ireturn));
+  RuntimeClass* caller = vm.define(builder.build());
+  auto& id_site = caller->findDeclaredMethod(Symbol::intern(JUtf8String("id")),
+                                             Symbol::intern(JUtf8String("(LAnimal;)I")))->call_sites[0];
+  auto& tag_site = caller->findDeclaredMethod(Symbol::intern(JUtf8String("tag")),
+                                              Symbol::intern(JUtf8String("(LTagged;)I")))->call_sites[0];
+  auto callWith = [&](const char* name, const char* descriptor, std::size_t index) {
+    slot receiver;
+    receiver.a = vm.allocate(animals[index]);
+    return call(caller, name, descriptor, {receiver}).i;
+  };
+
+  for (int i = 0; i < 3; i++)
+    EXPECT_EQ(1, callWith("id", "(LAnimal;)I", 0));
+  EXPECT_EQ(1u, id_site.cached);
+  EXPECT_FALSE(id_site.megamorphic);
+  EXPECT_EQ(2u, id_site.hits);
+  EXPECT_EQ(1u, id_site.misses);
+
+  for (std::size_t i = 1; i < 4; i++)
+    EXPECT_EQ(static_cast<s4>(i + 1), callWith("id", "(LAnimal;)I", i));
+  EXPECT_EQ(RuntimeClass::polymorphic_limit, id_site.cached);
+  EXPECT_FALSE(id_site.megamorphic);
+  EXPECT_EQ(4u, id_site.misses);
+
+  // More receiver classes than the cache holds are selected through the vtable
+  for (int i = 0; i < 2; i++)
+  {
+    EXPECT_EQ(5, callWith("id", "(LAnimal;)I", 4));
+    EXPECT_EQ(6, callWith("id", "(LAnimal;)I", 5));
+  }
+  EXPECT_TRUE(id_site.megamorphic);
+  EXPECT_EQ(8u, id_site.misses);
+  EXPECT_EQ(1, callWith("id", "(LAnimal;)I", 0));
+  EXPECT_EQ(3u, id_site.hits);
+
+  for (std::size_t i = 0; i < animals.size(); i++)
+    EXPECT_EQ(-static_cast<s4>(i + 1), callWith("tag", "(LTagged;)I", i));
+  EXPECT_TRUE(tag_site.megamorphic);
+  EXPECT_EQ(-3, callWith("tag", "(LTagged;)I", 2));
+  EXPECT_EQ(1u, tag_site.hits);
+  EXPECT_EQ(tagged_class, tag_site.targets[0]->owner->getInterfaces()[0]);
+
+  std::ostringstream dump;
+  vm.dumpCallSites(dump);
+  EXPECT_EQ("Caller.id(LAnimal;)I pc 1 invokevirtual Animal.id()I: megamorphic, 3 hits, 8 misses, "
+            "receivers Animal1 Animal2 Animal3 Animal4\n"
+            "Caller.tag(LTagged;)I pc 1 invokeinterface Tagged.tag()I: megamorphic, 1 hits, 6 misses, "
+            "receivers Animal1 Animal2 Animal3 Animal4\n",
+            dump.str());
+}
+
+TEST_P(InterpreterTest, TestArraysAndHandlers)
+{
+  ClassBuilder builder("Arrays");
+  u2 aioobe = builder.classRef("java/lang/ArrayIndexOutOfBoundsException");
+  // int[] a = new int[n]; for (int i = 0; i < n; i++) a[i] = i * i;
+  // try { return a[n]; } catch (ArrayIndexOutOfBoundsException e) { return a[n - 1]; }
+  CodeBuilder code;
+  code.op(B::op_iload_0).op(B::op_newarray, 10).op(B::op_astore_1)
+    .op(B::op_iconst_0).op(B::op_istore_2)
+    .label("test")
+    .op(B::op_iload_2).op(B::op_iload_0).branch(B::op_if_icmpge, "done")
+    .op(B::op_aload_1).op(B::op_iload_2).op(B::op_iload_2).op(B::op_iload_2).op(B::op_imul).op(B::op_iastore)
+    .iinc(2, 1)
+    .branch(B::op_goto, "test")
+    .label("done")
+    .label("try")
+    .op(B::op_aload_1).op(B::op_iload_0).op(B::op_iaload).op(B::op_ireturn)
+    .label("catch")
+    .op(B::op_astore_2)
+    .op(B::op_aload_1).op(B::op_iload_0).op(B::op_iconst_1).op(B::op_isub).op(B::op_iaload).op(B::op_ireturn);
+  builder.method(ClassFile::acc_static, "squares", "(I)I", 4, 3, code, {{"try", "catch", "catch", aioobe}});
+  builder.method(ClassFile::acc_static, "length", "(I)I", 1, 1, CodeBuilder()
+    .op(B::op_iload_0).op(B::op_newarray, 8).op(B::op_arraylength).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(16, call(clazz, "squares", "(I)I", {i(5)}).i);
+  EXPECT_EQ(12, call(clazz, "length", "(I)I", {i(12)}).i);
+  EXPECT_EQ("java.lang.NegativeArraySizeException: -1", thrownBy(clazz, "length", "(I)I", {i(-1)}));
+  EXPECT_EQ("java.lang.ArrayIndexOutOfBoundsException: Index -1 out of bounds for length 0", thrownBy(clazz, "squares", "(I)I", {i(0)}));
+}
+
+TEST_P(InterpreterTest, TestThrowAndCatch)
+{
+  ClassBuilder builder("Throws");
+  u2 illegal_state = builder.classRef("java/lang/IllegalStateException");
+  u2 illegal_argument = builder.classRef("java/lang/IllegalArgumentException");
+  u2 runtime_exception = builder.classRef("java/lang/RuntimeException");
+  u2 state_init = builder.methodRef("java/lang/IllegalStateException", "<init>", "(Ljava/lang/String;)V");
+  u2 argument_init = builder.methodRef("java/lang/IllegalArgumentException", "<init>", "(Ljava/lang/String;)V");
+  u2 get_message = builder.methodRef("java/lang/Throwable", "getMessage", "()Ljava/lang/String;");
+  u2 boom = builder.string("boom");
+  u2 bad = builder.string("bad");
+  // try { throw new IllegalStateException("boom"); } catch (RuntimeException e) { return e.getMessage(); }
+  CodeBuilder code;
+  code.label("try")
+    .op2(B::op_new, illegal_state).op(B::op_dup).op(B::op_ldc, static_cast<u1>(boom))
+    .op2(B::op_invokespecial, state_init).op(B::op_athrow)
+    .label("catch")
+    .op2(B::op_invokevirtual, get_message).op(B::op_areturn);
+  builder.method(ClassFile::acc_static, "caught", "()Ljava/lang/String;", 3, 0, code,
+                 {{"try", "catch", "catch", runtime_exception}});
+  builder.method(ClassFile::acc_static, "uncaught", "()V", 3, 0, CodeBuilder()
+    .op2(B::op_new, illegal_argument).op(B::op_dup).op(B::op_ldc, static_cast<u1>(bad))
+    .op2(B::op_invokespecial, argument_init).op(B::op_athrow));
+  builder.method(ClassFile::acc_static, "throwNull", "()V", 1, 0, CodeBuilder()
+    .op(B::op_aconst_null).op(B::op_athrow));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ("boom", text(call(clazz, "caught", "()Ljava/lang/String;")));
+  EXPECT_EQ("java.lang.IllegalArgumentException: bad", thrownBy(clazz, "uncaught", "()V"));
+  EXPECT_EQ("java.lang.NullPointerException", thrownBy(clazz, "throwNull", "()V"));
+}
+
+TEST_P(InterpreterTest, TestSwitches)
+{
+  ClassBuilder builder("Switches");
+  builder.method(ClassFile::acc_static, "table", "(I)I", 1, 1, CodeBuilder()
+    .op(B::op_iload_0).tableswitch(1, "default", {"one", "two", "three"})
+    .label("one").op(B::op_bipush, 10).op(B::op_ireturn)
+    .label("two").op(B::op_bipush, 20).op(B::op_ireturn)
+    .label("three").op(B::op_bipush, 30).op(B::op_ireturn)
+    .label("default").op(B::op_iconst_m1).op(B::op_ireturn));
+  builder.method(ClassFile::acc_static, "lookup", "(I)I", 1, 1, CodeBuilder()
+    .op(B::op_iload_0).lookupswitch("default", {{-100, "low"}, {7, "seven"}, {1000, "high"}})
+    .label("low").op(B::op_iconst_1).op(B::op_ireturn)
+    .label("seven").op(B::op_iconst_2).op(B::op_ireturn)
+    .label("high").op(B::op_iconst_3).op(B::op_ireturn)
+    .label("default").op(B::op_iconst_0).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(10, call(clazz, "table", "(I)I", {i(1)}).i);
+  EXPECT_EQ(30, call(clazz, "table", "(I)I", {i(3)}).i);
+  EXPECT_EQ(-1, call(clazz, "table", "(I)I", {i(0)}).i);
+  EXPECT_EQ(-1, call(clazz, "table", "(I)I", {i(4)}).i);
+  EXPECT_EQ(1, call(clazz, "lookup", "(I)I", {i(-100)}).i);
+  EXPECT_EQ(2, call(clazz, "lookup", "(I)I", {i(7)}).i);
+  EXPECT_EQ(3, call(clazz, "lookup", "(I)I", {i(1000)}).i);
+  EXPECT_EQ(0, call(clazz, "lookup", "(I)I", {i(8)}).i);
+}
+
+TEST_P(InterpreterTest, TestStaticInitialiser)
+{
+  ClassBuilder builder("Config");
+  builder.field(ClassFile::acc_static, "value", "I");
+  u2 value = builder.fieldRef("Config", "value", "I");
+  builder.method(ClassFile::acc_static, "<clinit>", "()V", 1, 0, CodeBuilder()
+    .op(B::op_bipush, 42).op2(B::op_putstatic, value).op(B::op_return));
+  builder.method(ClassFile::acc_static, "get", "()I", 1, 0, CodeBuilder()
+    .op2(B::op_getstatic, value).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_EQ(RuntimeClass::linked, clazz->getState());
+  EXPECT_EQ(42, call(clazz, "get", "()I").i);
+  EXPECT_EQ(RuntimeClass::initialised, clazz->getState());
+}
+
+TEST_P(InterpreterTest, TestStringsAndPrinting)
+{
+  ClassBuilder builder("Printer");
+  u2 out_field = builder.fieldRef("java/lang/System", "out", "Ljava/io/PrintStream;");
+  u2 println_int = builder.methodRef("java/io/PrintStream", "println", "(I)V");
+  u2 println_double = builder.methodRef("java/io/PrintStream", "println", "(D)V");
+  u2 print_string = builder.methodRef("java/io/PrintStream", "print", "(Ljava/lang/String;)V");
+  u2 length = builder.methodRef("java/lang/String", "length", "()I");
+  u2 abc = builder.string("abc");
+  u2 one_and_a_half = builder.doubleConstant(1.5);
+  u2 big = builder.doubleConstant(1e10);
+  builder.method(ClassFile::acc_static, "print", "()V", 3, 0, CodeBuilder()
+    .op2(B::op_getstatic, out_field).op(B::op_ldc, static_cast<u1>(abc)).op2(B::op_invokevirtual, print_string)
+    .op2(B::op_getstatic, out_field).op(B::op_bipush, 42).op2(B::op_invokevirtual, println_int)
+    .op2(B::op_getstatic, out_field).op2(B::op_ldc2_w, one_and_a_half).op2(B::op_invokevirtual, println_double)
+    .op2(B::op_getstatic, out_field).op2(B::op_ldc2_w, big).op2(B::op_invokevirtual, println_double)
+    .op(B::op_return));
+  // "abc" == "abc" ? "abc".length() : -1
+  builder.method(ClassFile::acc_static, "interned", "()I", 2, 0, CodeBuilder()
+    .op(B::op_ldc, static_cast<u1>(abc)).op(B::op_ldc, static_cast<u1>(abc)).branch(B::op_if_acmpne, "different")
+    .op(B::op_ldc, static_cast<u1>(abc)).op2(B::op_invokevirtual, length).op(B::op_ireturn)
+    .label("different")
+    .op(B::op_iconst_m1).op(B::op_ireturn));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  call(clazz, "print", "()V");
+  EXPECT_EQ("abc42\n1.5\n1.0E10\n", out.str());
+  EXPECT_EQ(3, call(clazz, "interned", "()I").i);
+}
+
+TEST_P(InterpreterTest, TestMissingClass)
+{
+  ClassBuilder builder("Missing");
+  u2 missing = builder.classRef("does/not/Exist");
+  builder.method(ClassFile::acc_static, "run", "()V", 2, 0, CodeBuilder()
+    .op2(B::op_new, missing).op(B::op_pop).op(B::op_return));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  EXPECT_THROW(call(clazz, "run", "()V"), std::runtime_error);
+}
+
+TEST_P(InterpreterTest, TestHelloWorld)
+{
+  // The test class' main is (I[C)V rather than a real main, so it's called directly
+  for (auto path : {"src/test/resources", "src/test/resources/Classes.jar"})
+  {
+    std::ostringstream hello;
+    VirtualMachine hello_vm(ClassPath(path), hello);
+    RuntimeClass* clazz = hello_vm.findClass("HelloWorld");
+    auto main = clazz->findDeclaredMethod(Symbol::intern(JUtf8String("main")), Symbol::intern(JUtf8String("(I[C)V")));
+    ASSERT_NE(nullptr, main) << path;
+    slot no_chars;
+    no_chars.a = nullptr;
+    Interpreter interpreter(hello_vm, GetParam());
+    interpreter.call(*main, {i(0), no_chars});
+    EXPECT_EQ("Hello world!\n", hello.str()) << path;
+    EXPECT_THROW(hello_vm.runMain("HelloWorld", {}, GetParam()), std::runtime_error) << path;
+  }
+}
+
+TEST_P(InterpreterTest, TestRunMain)
+{
+  ClassBuilder builder("app/Main", "java/lang/Object", ClassFile::acc_public | ClassFile::acc_super);
+  u2 out_field = builder.fieldRef("java/lang/System", "out", "Ljava/io/PrintStream;");
+  u2 println = builder.methodRef("java/io/PrintStream", "println", "(Ljava/lang/String;)V");
+  u2 exception = builder.classRef("java/lang/UnsupportedOperationException");
+  u2 exception_init = builder.methodRef("java/lang/UnsupportedOperationException", "<init>", "(Ljava/lang/String;)V");
+  // System.out.println(args[1]); if (args.length > 2) throw new UnsupportedOperationException(args[2]);
+  builder.method(ClassFile::acc_public | ClassFile::acc_static, "main", "([Ljava/lang/String;)V", 3, 1, CodeBuilder()
+    .op2(B::op_getstatic, out_field).op(B::op_aload_0).op(B::op_iconst_1).op(B::op_aaload)
+    .op2(B::op_invokevirtual, println)
+    .op(B::op_aload_0).op(B::op_arraylength).op(B::op_iconst_2).branch(B::op_if_icmpgt, "throw")
+    .op(B::op_return)
+    .label("throw")
+    .op2(B::op_new, exception).op(B::op_dup).op(B::op_aload_0).op(B::op_iconst_2).op(B::op_aaload)
+    .op2(B::op_invokespecial, exception_init).op(B::op_athrow));
+  vm.define(builder.build());
+
+  EXPECT_EQ(0, vm.runMain("app.Main", {"zero", "one"}, GetParam()));
+  EXPECT_EQ("one\n", out.str());
+  testing::internal::CaptureStderr();
+  EXPECT_EQ(1, vm.runMain("app/Main", {"zero", "one", "two"}, GetParam()));
+  EXPECT_EQ("Exception in thread \"main\" java.lang.UnsupportedOperationException: two\n",
+            testing::internal::GetCapturedStderr());
+}
+
+INSTANTIATE_TEST_CASE_P(Dispatch, InterpreterTest,
+                        testing::Values(Interpreter::dispatch_threaded, Interpreter::dispatch_switch));
+
+}
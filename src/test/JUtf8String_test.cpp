@@ -5,6 +5,7 @@
  *      Author: Julian Cromarty
  */
 #include <sstream>
+#include <unordered_set>
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "JUtf8String.h"
@@ -410,4 +411,204 @@ TEST_F(JUtf8StringTest, TestNotEqual)
 {
   ASSERT_NE(JUtf8String("foo"), JUtf8String("bar"));
 }
+
+TEST_F(JUtf8StringTest, TestBorrowDoesNotCopy)
+{
+  std::vector<u1> bytes = { 0x66, 0x6f, 0x6f };
+  auto str = JUtf8String::borrow(parsing::ByteView(bytes));
+  ASSERT_TRUE(str.isBorrowed());
+  ASSERT_EQ(bytes.data(), str.view().data());
+  ASSERT_EQ(JUtf8String("foo"), str);
+}
+
+TEST_F(JUtf8StringTest, TestBorrowValidates)
+{
+  std::vector<u1> bytes = { 0x66, 0x00 };
+  ASSERT_THROW(JUtf8String::borrow(parsing::ByteView(bytes)), parsing::parse_failure);
+}
+
+TEST_F(JUtf8StringTest, TestCopyOfBorrowedStringIsBorrowed)
+{
+  std::vector<u1> bytes = { 0x66, 0x6f, 0x6f };
+  auto str = JUtf8String::borrow(parsing::ByteView(bytes));
+  JUtf8String copy(str);
+  ASSERT_TRUE(copy.isBorrowed());
+  ASSERT_EQ(bytes.data(), copy.view().data());
+}
+
+TEST_F(JUtf8StringTest, TestCopyOfOwnedStringIsOwned)
+{
+  JUtf8String str("foo");
+  JUtf8String copy(str);
+  ASSERT_FALSE(copy.isBorrowed());
+  ASSERT_NE(str.view().data(), copy.view().data());
+  ASSERT_EQ(str, copy);
+}
+
+TEST_F(JUtf8StringTest, TestAppendToBorrowedStringCopies)
+{
+  std::vector<u1> bytes = { 0x66, 0x6f, 0x6f };
+  auto str = JUtf8String::borrow(parsing::ByteView(bytes));
+  std::stringstream ss;
+  ss << std::string("bar");
+  ss >> str;
+  ASSERT_FALSE(str.isBorrowed());
+  ASSERT_EQ(JUtf8String("foobar"), str);
+  ASSERT_EQ(3u, bytes.size());
+}
+
+TEST_F(JUtf8StringTest, TestConstructFromRangeMultiByteCharacters)
+{
+  JUtf8String str("aĶ‹b");
+  ASSERT_EQ(JUtf8String("Ķ‹"), JUtf8String(str.begin() + 1, str.begin() + 3));
+}
+
+TEST_F(JUtf8StringTest, TestLengthAfterAppend)
+{
+  JUtf8String str("aĶ");
+  ASSERT_EQ(2u, str.length());
+  ASSERT_EQ(3u, str.size());
+  std::stringstream ss;
+  ss << std::string("‹b");
+  ss >> str;
+  ASSERT_EQ(4u, str.length());
+  ASSERT_EQ(7u, str.size());
+}
+
+TEST_F(JUtf8StringTest, TestHash)
+{
+  std::vector<u1> bytes = { 0x66, 0x6f, 0x6f };
+  JUtf8String owned("foo");
+  auto borrowed = JUtf8String::borrow(parsing::ByteView(bytes));
+  ASSERT_EQ(owned.hash(), borrowed.hash());
+  ASSERT_EQ(std::hash<JUtf8String>()(owned), owned.hash());
+  ASSERT_NE(owned.hash(), JUtf8String("fop").hash());
+  ASSERT_EQ(JUtf8String::hashOf(parsing::ByteView(bytes)), owned.hash());
+}
+
+TEST_F(JUtf8StringTest, TestHashAfterAppend)
+{
+  JUtf8String str("foo");
+  auto hash = str.hash();
+  std::stringstream ss;
+  ss << std::string("bar");
+  ss >> str;
+  ASSERT_NE(hash, str.hash());
+  ASSERT_EQ(JUtf8String("foobar").hash(), str.hash());
+}
+
+TEST_F(JUtf8StringTest, TestUnorderedSet)
+{
+  std::unordered_set<JUtf8String> strings;
+  strings.insert(JUtf8String("foo"));
+  strings.insert(JUtf8String("bar"));
+  strings.insert(JUtf8String("foo"));
+  ASSERT_EQ(2u, strings.size());
+  ASSERT_EQ(1u, strings.count(JUtf8String("bar")));
+  ASSERT_EQ(0u, strings.count(JUtf8String("baz")));
+}
+
+TEST_F(JUtf8StringTest, TestNotEqualSameLength)
+{
+  ASSERT_NE(JUtf8String("Ķa"), JUtf8String("aĶ"));
+  ASSERT_NE(JUtf8String("foo"), JUtf8String("fop"));
+  ASSERT_EQ(JUtf8String(""), JUtf8String());
+}
+
+TEST_F(JUtf8StringTest, TestSplitMultiByteDelimiter)
+{
+  auto parts = JUtf8String("aĶbĶĶc").split(JUtf8String("Ķ"));
+  ASSERT_EQ(4u, parts.size());
+  ASSERT_EQ(JUtf8String("a"), parts[0]);
+  ASSERT_EQ(JUtf8String("b"), parts[1]);
+  ASSERT_EQ(JUtf8String(""), parts[2]);
+  ASSERT_EQ(JUtf8String("c"), parts[3]);
+}
+
+TEST_F(JUtf8StringTest, TestMalformedSequencesThrowOnConstruction)
+{
+  std::vector<std::vector<u1>> invalid = { { 0x80 }, { 0x41, 0xc4 }, { 0xe2, 0x80 }, { 0xc1, 0x81 },
+                                           { 0xe0, 0x80, 0x80 } };
+  for (auto& bytes : invalid)
+  {
+    ASSERT_THROW(JUtf8String{bytes}, parsing::parse_failure);
+    ASSERT_THROW(JUtf8String::borrow(parsing::ByteView(bytes)), parsing::parse_failure);
+  }
+}
+
+TEST_F(JUtf8StringTest, TestTooLongThrowsOnConstruction)
+{
+  ASSERT_EQ(JUtf8String::max_size, JUtf8String(std::string(JUtf8String::max_size, 'a')).size());
+  ASSERT_THROW(JUtf8String(std::string(JUtf8String::max_size + 1, 'a')), std::runtime_error);
+  // Nulls take two bytes each once encoded
+  ASSERT_THROW(JUtf8String(std::string(JUtf8String::max_size / 2 + 1, '\0')), std::runtime_error);
+  std::vector<u1> bytes(JUtf8String::max_size + 1, 'a');
+  ASSERT_THROW(JUtf8String::borrow(parsing::ByteView(bytes)), std::runtime_error);
+  ASSERT_EQ(JUtf8String::max_size, JUtf8String::borrow(parsing::ByteView(bytes.data(), JUtf8String::max_size)).length());
+}
+
+TEST_F(JUtf8StringTest, TestThreeByteCharacterStartingWithEd)
+{
+  // U+D55C U+D55C, which aren't surrogates
+  std::vector<u1> bytes = { 0xed, 0x95, 0x9c, 0xed, 0x95, 0x9c };
+  JUtf8String str(bytes);
+  ASSERT_EQ(2u, str.length());
+  ASSERT_EQ(0xd55cu, *str.begin());
+}
+
+TEST_F(JUtf8StringTest, TestIsAscii)
+{
+  ASSERT_TRUE(JUtf8String("java/lang/Object").isAscii());
+  ASSERT_TRUE(JUtf8String().isAscii());
+  ASSERT_FALSE(JUtf8String("aĶb").isAscii());
+  ASSERT_FALSE(JUtf8String("\0", 1).isAscii());
+}
+
+TEST_F(JUtf8StringTest, TestAsciiIteration)
+{
+  JUtf8String str("abc");
+  auto i = str.begin();
+  ASSERT_EQ(static_cast<u4>('a'), *i);
+  ASSERT_EQ(static_cast<u4>('c'), *(i + 2));
+  ASSERT_EQ(str.end(), i + 3);
+  ASSERT_EQ(str.end(), i + 10);
+}
+
+TEST_F(JUtf8StringTest, TestFind)
+{
+  JUtf8String ascii("java/lang/Object");
+  ASSERT_EQ(ascii.begin() + 5, ascii.find(JUtf8String("lang")));
+  ASSERT_EQ(ascii.end(), ascii.find(JUtf8String("Lang")));
+  ASSERT_EQ(ascii.end(), ascii.find(JUtf8String("Ķ")));
+  ASSERT_EQ(ascii.end(), ascii.find(JUtf8String("Objects")));
+  JUtf8String mixed("aĶb‹Ķc");
+  ASSERT_EQ(mixed.begin() + 2, mixed.find(JUtf8String("b")));
+  ASSERT_EQ(mixed.begin() + 1, mixed.find(JUtf8String("Ķ")));
+  ASSERT_EQ(mixed.begin() + 3, mixed.find(JUtf8String("‹Ķ")));
+  ASSERT_EQ(mixed.end(), mixed.find(JUtf8String("Ķ‹")));
+}
+
+TEST_F(JUtf8StringTest, TestContainsAny)
+{
+  std::vector<JUtf8String> invalid = { JUtf8String("."), JUtf8String(";"), JUtf8String("["), JUtf8String("/") };
+  ASSERT_FALSE(JUtf8String("ValidIdentifierThatIsLongerThanSixteenBytes").contains(invalid));
+  ASSERT_TRUE(JUtf8String("ValidIdentifierThatIsLongerThanSixteenBytes;").contains(invalid));
+  ASSERT_TRUE(JUtf8String("a[").contains(invalid));
+  ASSERT_TRUE(JUtf8String("Ķ‹Ķ‹Ķ‹Ķ‹Ķ‹Ķ‹Ķ/").contains(invalid));
+  ASSERT_FALSE(JUtf8String("Ķ‹").contains(invalid));
+  ASSERT_FALSE(JUtf8String("abc").contains(std::vector<JUtf8String>()));
+  ASSERT_TRUE(JUtf8String("aĶb").contains(std::vector<JUtf8String>{ JUtf8String("x"), JUtf8String("Ķb") }));
+  ASSERT_FALSE(JUtf8String("aĶb").contains(std::vector<JUtf8String>{ JUtf8String("x"), JUtf8String("Ķa") }));
+}
+
+TEST_F(JUtf8StringTest, TestSplitAscii)
+{
+  auto parts = JUtf8String("java/lang//Object/").split(JUtf8String("/"));
+  ASSERT_EQ(5u, parts.size());
+  ASSERT_EQ(JUtf8String("java"), parts[0]);
+  ASSERT_EQ(JUtf8String("lang"), parts[1]);
+  ASSERT_EQ(JUtf8String(""), parts[2]);
+  ASSERT_EQ(JUtf8String("Object"), parts[3]);
+  ASSERT_EQ(JUtf8String(""), parts[4]);
+}
 }
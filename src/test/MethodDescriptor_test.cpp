@@ -119,4 +119,59 @@ TEST_F(MethodDescriptorTest, TestMultiDimensionArrayTypes)
   ASSERT_EQ(1u, parameters.size());
   ASSERT_EQ(FieldDescriptor(JUtf8String("[[I")), parameters.at(0));
 }
+
+TEST_F(MethodDescriptorTest, TestMultipleClassParameters)
+{
+  MethodDescriptor d(JUtf8String("(Ljava/lang/String;I[Ljava/lang/Object;)V"));
+  auto parameters = d.getParameters();
+  ASSERT_EQ(3u, parameters.size());
+  ASSERT_EQ(FieldDescriptor(JUtf8String("Ljava/lang/String;")), parameters.at(0));
+  ASSERT_EQ(FieldDescriptor(JUtf8String("I")), parameters.at(1));
+  ASSERT_EQ(FieldDescriptor(JUtf8String("[Ljava/lang/Object;")), parameters.at(2));
+}
+
+TEST_F(MethodDescriptorTest, TestTryParse)
+{
+  auto d = MethodDescriptor::tryParse(JUtf8String("(I)J"));
+  ASSERT_TRUE(d);
+  ASSERT_EQ(1u, d->getParameters().size());
+}
+
+TEST_F(MethodDescriptorTest, TestTryParseInvalid)
+{
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("()")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("(Z")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("([)V")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("()VV")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("<init>")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("")));
+}
+
+TEST_F(MethodDescriptorTest, TestManyParameters)
+{
+  MethodDescriptor d(JUtf8String("(IJLjava/lang/String;[DZBCSF[[Ljava/lang/Object;)I"));
+  auto& parameters = d.getParameters();
+  ASSERT_EQ(10u, parameters.size());
+  ASSERT_EQ(FieldDescriptor(JUtf8String("J")), parameters.at(1));
+  ASSERT_EQ(FieldDescriptor(JUtf8String("[D")), parameters.at(3));
+  ASSERT_EQ(FieldDescriptor(JUtf8String("F")), parameters.at(8));
+  ASSERT_EQ(FieldDescriptor(JUtf8String("[[Ljava/lang/Object;")), parameters.at(9));
+}
+
+TEST_F(MethodDescriptorTest, TestInvalidParameters)
+{
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("([)V")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("(V)V")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("(L;)V")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("(I")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("()VV")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String("()II")));
+}
+
+TEST_F(MethodDescriptorTest, TestParseByteView)
+{
+  std::vector<u1> bytes = { '(', 'I', ')', 'V', 'x' };
+  ASSERT_TRUE(MethodDescriptor::tryParse(parsing::ByteView(bytes.data(), 4)));
+  ASSERT_FALSE(MethodDescriptor::tryParse(parsing::ByteView(bytes)));
+}
 }
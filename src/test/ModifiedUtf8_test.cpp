@@ -0,0 +1,168 @@
+/**
+ * \file ModifiedUtf8_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "test/TestCommon.h"
+#include "ModifiedUtf8.h"
+
+namespace mimic
+{
+
+class ModifiedUtf8Test: public testing::Test
+{
+
+protected:
+  ModifiedUtf8Test()
+  {
+  }
+
+  virtual ~ModifiedUtf8Test()
+  {
+  }
+
+  /**
+   * Validates with both the vector and scalar paths, checking they agree
+   *
+   * @return the offset of the first invalid character, or -1 if valid
+   */
+  long validate(const std::vector<u1>& bytes, std::size_t* characters = nullptr)
+  {
+    std::size_t count = 0;
+    std::size_t scalar_count = 0;
+    const u1* first = bytes.data();
+    const u1* last = first + bytes.size();
+    const u1* invalid = ModifiedUtf8::validate(first, last, count);
+    const u1* scalar_invalid = ModifiedUtf8::validateScalar(first, last, scalar_count);
+    EXPECT_EQ(invalid, scalar_invalid);
+    EXPECT_EQ(count, scalar_count);
+    if (characters)
+      *characters = count;
+    return invalid ? invalid - first : -1;
+  }
+
+  /**
+   * @return bytes, placed after enough ASCII to be checked by the vector path
+   */
+  std::vector<u1> afterAscii(std::vector<u1> bytes, std::size_t ascii = 37)
+  {
+    std::vector<u1> result(ascii, 'a');
+    result.insert(result.end(), bytes.begin(), bytes.end());
+    return result;
+  }
+};
+
+TEST_F(ModifiedUtf8Test, TestAscii)
+{
+  std::size_t characters;
+  std::vector<u1> bytes;
+  for (u1 i = 0x01; i < 0x80; i++)
+    bytes.push_back(i);
+  ASSERT_EQ(-1, validate(bytes, &characters));
+  ASSERT_EQ(bytes.size(), characters);
+  ASSERT_EQ(-1, validate(std::vector<u1>(), &characters));
+  ASSERT_EQ(0u, characters);
+}
+
+TEST_F(ModifiedUtf8Test, TestAsciiPrefix)
+{
+  for (std::size_t length = 0; length < 80; length++)
+  {
+    std::vector<u1> bytes(length, 'x');
+    ASSERT_EQ(length, ModifiedUtf8::asciiPrefix(bytes.data(), bytes.data() + length));
+    bytes.push_back(0x00);
+    bytes.push_back('x');
+    ASSERT_EQ(length, ModifiedUtf8::asciiPrefix(bytes.data(), bytes.data() + bytes.size()));
+    bytes[length] = 0xc4;
+    ASSERT_EQ(length, ModifiedUtf8::asciiPrefix(bytes.data(), bytes.data() + bytes.size()));
+  }
+}
+
+TEST_F(ModifiedUtf8Test, TestNullByteInvalidAtEveryPosition)
+{
+  for (std::size_t position = 0; position < 70; position++)
+  {
+    std::vector<u1> bytes(70, 'b');
+    bytes[position] = 0x00;
+    ASSERT_EQ(static_cast<long>(position), validate(bytes));
+  }
+}
+
+TEST_F(ModifiedUtf8Test, TestTwoByteNull)
+{
+  std::size_t characters;
+  ASSERT_EQ(-1, validate(afterAscii({ 0xc0, 0x80 }), &characters));
+  ASSERT_EQ(38u, characters);
+  ASSERT_EQ(37, validate(afterAscii({ 0xc0, 0x81 })));
+  ASSERT_EQ(37, validate(afterAscii({ 0xc1, 0xbf })));
+}
+
+TEST_F(ModifiedUtf8Test, TestTwoByteCharacters)
+{
+  std::size_t characters;
+  ASSERT_EQ(-1, validate(afterAscii({ 0xc4, 0xb6, 'x', 0xdf, 0xbf }), &characters));
+  ASSERT_EQ(40u, characters);
+  // Missing or wrong continuation byte
+  ASSERT_EQ(37, validate(afterAscii({ 0xc4 })));
+  ASSERT_EQ(37, validate(afterAscii({ 0xc4, 'x' })));
+  ASSERT_EQ(37, validate(afterAscii({ 0xc4, 0xc4, 0xb6 })));
+}
+
+TEST_F(ModifiedUtf8Test, TestThreeByteCharacters)
+{
+  std::size_t characters;
+  ASSERT_EQ(-1, validate(afterAscii({ 0xe2, 0x80, 0xb9, 0xe0, 0xa0, 0x80, 0xef, 0xbf, 0xbf }), &characters));
+  ASSERT_EQ(40u, characters);
+  // Overlong encoding of a two byte character
+  ASSERT_EQ(37, validate(afterAscii({ 0xe0, 0x9f, 0xbf })));
+  // Truncated
+  ASSERT_EQ(37, validate(afterAscii({ 0xe2, 0x80 })));
+  ASSERT_EQ(37, validate(afterAscii({ 0xe2, 0x80, 'x' })));
+}
+
+TEST_F(ModifiedUtf8Test, TestSurrogatePair)
+{
+  std::size_t characters;
+  ASSERT_EQ(-1, validate(afterAscii({ 0xed, 0xa1, 0x80, 0xed, 0xbc, 0x8a, 'x' }), &characters));
+  ASSERT_EQ(39u, characters);
+  std::vector<u1> pair = { 0xed, 0xa1, 0x80, 0xed, 0xbc, 0x8a };
+  ASSERT_TRUE(ModifiedUtf8::isSurrogatePair(pair.data(), pair.data() + pair.size()));
+  ASSERT_EQ(6u, ModifiedUtf8::sequenceLength(pair.data(), pair.data() + pair.size()));
+  ASSERT_FALSE(ModifiedUtf8::isSurrogatePair(pair.data(), pair.data() + 5));
+  // Low surrogate with a bad final byte
+  ASSERT_EQ(40, validate(afterAscii({ 0xed, 0xa1, 0x80, 0xed, 0xbc, 'x' })));
+}
+
+TEST_F(ModifiedUtf8Test, TestLoneSurrogates)
+{
+  std::size_t characters;
+  // High surrogate alone, low surrogate alone, and the two the wrong way round
+  ASSERT_EQ(-1, validate(afterAscii({ 0xed, 0xa1, 0x80, 'x' }), &characters));
+  ASSERT_EQ(39u, characters);
+  ASSERT_EQ(-1, validate(afterAscii({ 0xed, 0xbc, 0x8a }), &characters));
+  ASSERT_EQ(38u, characters);
+  ASSERT_EQ(-1, validate(afterAscii({ 0xed, 0xbc, 0x8a, 0xed, 0xa1, 0x80 }), &characters));
+  ASSERT_EQ(39u, characters);
+}
+
+TEST_F(ModifiedUtf8Test, TestHangulIsNotSurrogate)
+{
+  // U+D55C starts with 0xed but isn't a surrogate
+  std::vector<u1> bytes = { 0xed, 0x95, 0x9c, 0xed, 0x95, 0x9c };
+  std::size_t characters;
+  ASSERT_EQ(-1, validate(bytes, &characters));
+  ASSERT_EQ(2u, characters);
+  ASSERT_EQ(3u, ModifiedUtf8::sequenceLength(bytes.data(), bytes.data() + bytes.size()));
+}
+
+TEST_F(ModifiedUtf8Test, TestInvalidLeadBytes)
+{
+  for (int lead = 0x80; lead < 0xc0; lead++)
+    ASSERT_EQ(37, validate(afterAscii({ static_cast<u1>(lead), 0x80 })));
+  for (int lead = 0xf0; lead <= 0xff; lead++)
+    ASSERT_EQ(37, validate(afterAscii({ static_cast<u1>(lead), 0x80, 0x80, 0x80 })));
+}
+
+}
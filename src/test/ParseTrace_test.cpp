@@ -0,0 +1,131 @@
+/**
+ * \file ParseTrace_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <thread>
+#include "test/TestCommon.h"
+#include "ClassFile.h"
+#include "ParseTrace.h"
+
+namespace mimic
+{
+
+class ParseTraceTest: public testing::Test
+{
+
+protected:
+  ParseTraceTest()
+  {
+    ParseTrace::enable(64);
+    ParseTrace::clear();
+  }
+
+  virtual ~ParseTraceTest()
+  {
+    ParseTrace::disable();
+    ParseTrace::clear();
+  }
+};
+
+TEST_F(ParseTraceTest, TestDisabledRecordsNothing)
+{
+  ParseTrace::disable();
+  ASSERT_EQ(0u, ParseTrace::beginClass(0));
+  ClassFile clazz(fs::path("src/test/resources/HelloWorld.class"));
+  ASSERT_TRUE(ParseTrace::snapshot().empty());
+}
+
+TEST_F(ParseTraceTest, TestRecordsSections)
+{
+  ClassFile clazz(fs::path("src/test/resources/HelloWorld.class"));
+  auto events = ParseTrace::snapshot();
+  std::vector<ParseTrace::event_type> expected = {
+    ParseTrace::class_begin, ParseTrace::version, ParseTrace::constant_pool,
+    ParseTrace::interfaces, ParseTrace::fields, ParseTrace::methods,
+    ParseTrace::constant_pool_validated, ParseTrace::attributes, ParseTrace::class_end };
+  ASSERT_EQ(expected.size(), events.size());
+  for (std::size_t i = 0; i < expected.size(); i++)
+  {
+    EXPECT_EQ(expected[i], events[i].type);
+    EXPECT_EQ(events[0].class_id, events[i].class_id);
+    if (i > 0)
+    {
+      EXPECT_LE(events[i - 1].offset, events[i].offset);
+      EXPECT_LE(events[i - 1].nanoseconds, events[i].nanoseconds);
+    }
+  }
+  EXPECT_EQ((52u << 16), events[1].count);
+  EXPECT_EQ(4u, events[1].offset);
+  EXPECT_EQ(29u, events[2].count);
+  EXPECT_EQ(10u, events[2].offset);
+  EXPECT_EQ(2u, events[5].count);
+  EXPECT_EQ(fs::file_size("src/test/resources/HelloWorld.class"), events[8].offset);
+}
+
+TEST_F(ParseTraceTest, TestRecordsFailure)
+{
+  std::stringstream ss;
+  ss.put(0x12);
+  ss.put(0x34);
+  ss.put(0x56);
+  ss.put(0x78);
+  parsing::ByteConsumer bc(ss);
+  ASSERT_THROW(ClassFile{ bc }, parsing::parse_failure);
+  auto events = ParseTrace::snapshot();
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ(ParseTrace::class_failed, events[1].type);
+}
+
+TEST_F(ParseTraceTest, TestRingBufferKeepsMostRecent)
+{
+  u4 id = ParseTrace::beginClass(0);
+  for (u4 i = 0; i < 100; i++)
+    ParseTrace::record(id, ParseTrace::fields, i, i);
+  auto events = ParseTrace::snapshot();
+  ASSERT_EQ(64u, events.size());
+  EXPECT_EQ(36u, events.front().count);
+  EXPECT_EQ(99u, events.back().count);
+}
+
+TEST_F(ParseTraceTest, TestConcurrentWritersAroundTheRing)
+{
+  const u4 threads = 4;
+  const u4 count = 10000;
+  std::vector<std::thread> writers;
+  for (u4 t = 0; t < threads; t++)
+  {
+    writers.emplace_back([count]() {
+      u4 id = ParseTrace::beginClass(0);
+      for (u4 i = 0; i < count; i++)
+        ParseTrace::record(id, ParseTrace::fields, id, id * count + i);
+    });
+  }
+  for (auto& writer : writers)
+    writer.join();
+  // Events can be dropped, but what's kept is never torn
+  auto events = ParseTrace::snapshot();
+  EXPECT_GE(64u, events.size());
+  for (auto& e : events)
+  {
+    if (e.type == ParseTrace::fields)
+    {
+      EXPECT_EQ(e.class_id, e.offset);
+      EXPECT_EQ(e.class_id, e.count / count);
+    }
+  }
+}
+
+TEST_F(ParseTraceTest, TestDump)
+{
+  u4 id = ParseTrace::beginClass(0);
+  ParseTrace::record(id, ParseTrace::constant_pool, 10, 29);
+  std::stringstream ss;
+  ParseTrace::dump(ss);
+  EXPECT_THAT(ss.str(), testing::HasSubstr("constant_pool"));
+  EXPECT_THAT(ss.str(), testing::HasSubstr("offset 10 count 29"));
+}
+
+}
@@ -0,0 +1,127 @@
+/**
+ * \file RuntimeClass_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <sstream>
+#include "test/TestCommon.h"
+#include "test/ClassBuilder.h"
+#include "RuntimeClass.h"
+#include "VirtualMachine.h"
+
+namespace mimic
+{
+
+typedef Bytecode B;
+
+class RuntimeClassTest: public testing::Test
+{
+
+protected:
+  std::ostringstream out;
+  VirtualMachine vm;
+
+  RuntimeClassTest()
+    : vm(ClassPath(), out)
+  {
+  }
+
+  virtual ~RuntimeClassTest()
+  {
+  }
+
+  /**
+   * Defines a class whose methods all return a constant
+   */
+  RuntimeClass* define(const std::string& name, const std::string& super, const std::vector<std::string>& methods,
+                       const std::vector<std::string>& interfaces = {}, u2 flags = ClassFile::acc_public)
+  {
+    ClassBuilder builder(name, super, flags);
+    for (auto& interface : interfaces)
+      builder.implement(interface);
+    for (auto& m : methods)
+    {
+      if (flags & ClassFile::acc_interface)
+        builder.method(ClassFile::acc_public | ClassFile::acc_abstract, m, "()I");
+      else
+        builder.method(ClassFile::acc_public, m, "()I", 1, 1, CodeBuilder().op(B::op_iconst_0).op(B::op_ireturn));
+    }
+    return vm.define(builder.build());
+  }
+
+  static const RuntimeClass::method* methodOf(const RuntimeClass* clazz, const char* name)
+  {
+    return clazz->findMethod(Symbol::intern(JUtf8String(name)), Symbol::intern(JUtf8String("()I")));
+  }
+};
+
+TEST_F(RuntimeClassTest, TestVtableOverridesKeepTheirIndex)
+{
+  RuntimeClass* object = vm.findClass("java/lang/Object");
+  RuntimeClass* base = define("Base", "java/lang/Object", {"a", "b"});
+  RuntimeClass* derived = define("Derived", "Base", {"b", "c"});
+
+  auto base_b = methodOf(base, "b");
+  auto derived_b = methodOf(derived, "b");
+  ASSERT_NE(base_b, derived_b);
+  EXPECT_EQ(base_b->table_index, derived_b->table_index);
+  EXPECT_EQ(object->getVtableSize() + 2, base->getVtableSize());
+  EXPECT_EQ(object->getVtableSize() + 3, derived->getVtableSize());
+  EXPECT_EQ(derived_b, derived->getVirtual(base_b->table_index));
+  EXPECT_EQ(base_b, base->getVirtual(base_b->table_index));
+  EXPECT_EQ(methodOf(base, "a"), derived->getVirtual(methodOf(base, "a")->table_index));
+  EXPECT_EQ(object->getVtableSize() + 2, methodOf(derived, "c")->table_index);
+
+  // Object's methods are inherited, arrays included
+  auto hash_code = object->findDeclaredMethod(Symbol::intern(JUtf8String("hashCode")),
+                                              Symbol::intern(JUtf8String("()I")));
+  EXPECT_EQ(hash_code, derived->getVirtual(hash_code->table_index));
+  EXPECT_EQ(hash_code, vm.findClass("[I")->getVirtual(hash_code->table_index));
+}
+
+TEST_F(RuntimeClassTest, TestConstructorsAndStaticsArentVirtual)
+{
+  ClassBuilder builder("Statics");
+  builder.method(ClassFile::acc_public, "<init>", "()V", 1, 1, CodeBuilder().op(B::op_return));
+  builder.method(ClassFile::acc_static, "s", "()V", 1, 1, CodeBuilder().op(B::op_return));
+  builder.method(ClassFile::acc_private, "p", "()V", 1, 1, CodeBuilder().op(B::op_return));
+  RuntimeClass* clazz = vm.define(builder.build());
+
+  for (auto& m : clazz->getMethods())
+    EXPECT_EQ(RuntimeClass::no_table_index, m.table_index) << m.name.str();
+  EXPECT_EQ(vm.findClass("java/lang/Object")->getVtableSize(), clazz->getVtableSize());
+}
+
+TEST_F(RuntimeClassTest, TestItables)
+{
+  u2 interface_flags = ClassFile::acc_public | ClassFile::acc_interface | ClassFile::acc_abstract;
+  RuntimeClass* named = define("Named", "java/lang/Object", {"name"}, {}, interface_flags);
+  RuntimeClass* sized = define("Sized", "java/lang/Object", {"width", "height"}, {"Named"}, interface_flags);
+  RuntimeClass* other = define("Other", "java/lang/Object", {"other"}, {}, interface_flags);
+  EXPECT_EQ(0u, methodOf(sized, "width")->table_index);
+  EXPECT_EQ(1u, methodOf(sized, "height")->table_index);
+  EXPECT_EQ(0u, methodOf(named, "name")->table_index);
+
+  // Box implements Sized, and so Named, but leaves height to its subclass
+  RuntimeClass* box = define("Box", "java/lang/Object", {"width", "name"}, {"Sized"},
+                             ClassFile::acc_public | ClassFile::acc_abstract);
+  RuntimeClass* tall_box = define("TallBox", "Box", {"height", "name"});
+
+  auto box_sized = box->getItable(sized);
+  ASSERT_NE(nullptr, box_sized);
+  EXPECT_EQ(methodOf(box, "width"), (*box_sized)[0]);
+  EXPECT_TRUE((*box_sized)[1]->isAbstract());
+  ASSERT_NE(nullptr, box->getItable(named));
+  EXPECT_EQ(methodOf(box, "name"), (*box->getItable(named))[0]);
+  EXPECT_EQ(nullptr, box->getItable(other));
+
+  auto tall_sized = tall_box->getItable(sized);
+  ASSERT_NE(nullptr, tall_sized);
+  EXPECT_EQ(methodOf(box, "width"), (*tall_sized)[0]);
+  EXPECT_EQ(tall_box, (*tall_sized)[1]->owner);
+  EXPECT_EQ(tall_box, (*tall_box->getItable(named))[0]->owner);
+}
+
+}
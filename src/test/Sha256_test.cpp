@@ -0,0 +1,60 @@
+/**
+ * \file Sha256_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <cstdio>
+#include <string>
+#include "test/TestCommon.h"
+#include "Sha256.h"
+
+namespace mimic
+{
+
+class Sha256Test: public testing::Test
+{
+
+protected:
+  Sha256Test()
+  {
+  }
+
+  virtual ~Sha256Test()
+  {
+  }
+
+  static std::string hex(const std::string& message)
+  {
+    auto digest = Sha256::hash(parsing::ByteView(reinterpret_cast<const u1*>(message.data()), message.size()));
+    std::string result;
+    char buffer[3];
+    for (u1 b : digest)
+    {
+      std::snprintf(buffer, sizeof(buffer), "%02x", b);
+      result += buffer;
+    }
+    return result;
+  }
+};
+
+TEST_F(Sha256Test, TestKnownDigests)
+{
+  // From FIPS 180-4's examples
+  EXPECT_EQ("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", hex(""));
+  EXPECT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", hex("abc"));
+  EXPECT_EQ("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+            hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+  EXPECT_EQ("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", hex(std::string(1000000, 'a')));
+}
+
+TEST_F(Sha256Test, TestPaddingBoundaries)
+{
+  // 55 bytes fit in one padded block, 56 need two
+  EXPECT_EQ("9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318", hex(std::string(55, 'a')));
+  EXPECT_EQ("b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a", hex(std::string(56, 'a')));
+  EXPECT_EQ("ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb", hex(std::string(64, 'a')));
+}
+
+}
@@ -0,0 +1,117 @@
+/**
+ * \file SignatureShape_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <thread>
+#include "test/TestCommon.h"
+#include "MethodDescriptor.h"
+#include "SignatureShape.h"
+
+namespace mimic
+{
+
+class SignatureShapeTest: public testing::Test
+{
+
+protected:
+  SignatureShapeTest()
+  {
+  }
+
+  virtual ~SignatureShapeTest()
+  {
+  }
+
+  const SignatureShape& shapeOf(const char* descriptor)
+  {
+    return MethodDescriptor(JUtf8String(descriptor)).getShape();
+  }
+};
+
+TEST_F(SignatureShapeTest, TestNoArguments)
+{
+  auto& shape = shapeOf("()V");
+  ASSERT_EQ(0, shape.getArgumentSlots());
+  ASSERT_EQ(0, shape.getParameterCount());
+  ASSERT_EQ(SignatureShape::kind_void, shape.getReturnKind());
+}
+
+TEST_F(SignatureShapeTest, TestWideArgumentsTakeTwoSlots)
+{
+  auto& shape = shapeOf("(JIDLjava/lang/Object;)J");
+  ASSERT_EQ(6, shape.getArgumentSlots());
+  ASSERT_EQ(4, shape.getParameterCount());
+  ASSERT_EQ(SignatureShape::kind_long, shape.getReturnKind());
+  for (u1 slot = 0; slot < 5; slot++)
+    ASSERT_FALSE(shape.isReference(slot));
+  ASSERT_TRUE(shape.isReference(5));
+}
+
+TEST_F(SignatureShapeTest, TestReturnKinds)
+{
+  ASSERT_EQ(SignatureShape::kind_int, shapeOf("()Z").getReturnKind());
+  ASSERT_EQ(SignatureShape::kind_int, shapeOf("()B").getReturnKind());
+  ASSERT_EQ(SignatureShape::kind_int, shapeOf("()C").getReturnKind());
+  ASSERT_EQ(SignatureShape::kind_int, shapeOf("()S").getReturnKind());
+  ASSERT_EQ(SignatureShape::kind_int, shapeOf("()I").getReturnKind());
+  ASSERT_EQ(SignatureShape::kind_float, shapeOf("()F").getReturnKind());
+  ASSERT_EQ(SignatureShape::kind_double, shapeOf("()D").getReturnKind());
+  ASSERT_EQ(SignatureShape::kind_reference, shapeOf("()Ljava/lang/String;").getReturnKind());
+  ASSERT_EQ(SignatureShape::kind_reference, shapeOf("()[J").getReturnKind());
+}
+
+TEST_F(SignatureShapeTest, TestArraysAreReferences)
+{
+  auto& shape = shapeOf("([IJ[[D)V");
+  ASSERT_EQ(4, shape.getArgumentSlots());
+  ASSERT_TRUE(shape.isReference(0));
+  ASSERT_FALSE(shape.isReference(1));
+  ASSERT_FALSE(shape.isReference(2));
+  ASSERT_TRUE(shape.isReference(3));
+}
+
+TEST_F(SignatureShapeTest, TestSameShapeIsShared)
+{
+  ASSERT_EQ(&shapeOf("(Ljava/lang/String;I)V"), &shapeOf("(Ljava/lang/String;I)V"));
+  // Different descriptors with the same calling convention share too
+  ASSERT_EQ(&shapeOf("(Ljava/lang/String;I)V"), &shapeOf("([BZ)V"));
+  ASSERT_NE(&shapeOf("(Ljava/lang/String;I)V"), &shapeOf("(ILjava/lang/String;)V"));
+  ASSERT_NE(&shapeOf("(Ljava/lang/String;I)V"), &shapeOf("(Ljava/lang/String;I)I"));
+  // Only the slots matter for arguments, so int and float are alike
+  ASSERT_EQ(&shapeOf("(I)V"), &shapeOf("(F)V"));
+  ASSERT_NE(&shapeOf("(I)V"), &shapeOf("(D)V"));
+}
+
+TEST_F(SignatureShapeTest, TestMaximumSlots)
+{
+  std::string descriptor = "(";
+  for (int i = 0; i < 127; i++)
+    descriptor += "J";
+  auto& shape = shapeOf((descriptor + "Ljava/lang/Object;)V").c_str());
+  ASSERT_EQ(255, shape.getArgumentSlots());
+  ASSERT_TRUE(shape.isReference(254));
+  ASSERT_FALSE(shape.isReference(253));
+  ASSERT_EQ(u8(1) << 62, shape.getReferenceMap()[3]);
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String(descriptor + "J)V")));
+  ASSERT_FALSE(MethodDescriptor::tryParse(JUtf8String(descriptor + "II)V")));
+}
+
+TEST_F(SignatureShapeTest, TestConcurrentInternIsShared)
+{
+  const char* descriptor = "(Ljava/lang/Object;JLjava/lang/Object;FLjava/lang/Object;)D";
+  std::vector<const SignatureShape*> shapes(4);
+  std::vector<std::thread> threads;
+  for (std::size_t i = 0; i < shapes.size(); i++)
+    threads.emplace_back([&shapes, i, descriptor]() {
+      shapes[i] = &MethodDescriptor(JUtf8String(descriptor)).getShape();
+    });
+  for (auto& t : threads)
+    t.join();
+  for (auto shape : shapes)
+    ASSERT_EQ(shapes[0], shape);
+}
+
+}
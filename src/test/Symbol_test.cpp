@@ -0,0 +1,140 @@
+/**
+ * \file Symbol_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include <thread>
+#include "test/TestCommon.h"
+#include "ClassFile.h"
+#include "Symbol.h"
+
+namespace mimic
+{
+
+class SymbolTest: public testing::Test
+{
+
+protected:
+  SymbolTest()
+  {
+  }
+
+  virtual ~SymbolTest()
+  {
+  }
+};
+
+TEST_F(SymbolTest, TestInternIsShared)
+{
+  std::vector<u1> first = { 'j', 'a', 'v', 'a', '/', 'l', 'a', 'n', 'g', '/', 'O', 'b', 'j', 'e', 'c', 't' };
+  std::vector<u1> second(first);
+  Symbol a = Symbol::intern(parsing::ByteView(first));
+  Symbol b = Symbol::intern(parsing::ByteView(second));
+  ASSERT_EQ(a, b);
+  ASSERT_EQ(a.view().data(), b.view().data());
+  ASSERT_NE(first.data(), a.view().data());
+  ASSERT_EQ(a, Symbol::intern(JUtf8String("java/lang/Object")));
+  ASSERT_NE(a, Symbol::intern(JUtf8String("java/lang/Objects")));
+}
+
+TEST_F(SymbolTest, TestProperties)
+{
+  Symbol symbol = Symbol::intern(JUtf8String(u8"café"));
+  EXPECT_EQ(5u, symbol.size());
+  EXPECT_EQ(4u, symbol.length());
+  EXPECT_EQ(std::hash<Symbol>()(symbol), symbol.hash());
+  EXPECT_EQ(JUtf8String(u8"café"), symbol.string());
+  EXPECT_TRUE(symbol.string().isBorrowed());
+  std::stringstream ss;
+  ss << symbol;
+  EXPECT_EQ(u8"café", ss.str());
+}
+
+TEST_F(SymbolTest, TestEmpty)
+{
+  Symbol empty;
+  EXPECT_EQ(0u, empty.size());
+  EXPECT_EQ(0u, empty.length());
+  EXPECT_EQ(empty, Symbol::intern(parsing::ByteView()));
+  EXPECT_EQ(JUtf8String(), empty.string());
+}
+
+TEST_F(SymbolTest, TestManySymbols)
+{
+  std::vector<Symbol> symbols;
+  for (int i = 0; i < 10000; i++)
+    symbols.push_back(Symbol::intern(JUtf8String("TestManySymbols" + std::to_string(i))));
+  for (int i = 0; i < 10000; i++)
+  {
+    ASSERT_EQ(symbols[i], Symbol::intern(JUtf8String("TestManySymbols" + std::to_string(i))));
+    ASSERT_EQ(JUtf8String("TestManySymbols" + std::to_string(i)), symbols[i].string());
+  }
+}
+
+TEST_F(SymbolTest, TestConcurrentIntern)
+{
+  const int thread_count = 4;
+  const int symbol_count = 2000;
+  std::vector<std::vector<Symbol>> results(thread_count);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; t++)
+  {
+    threads.emplace_back([t, &results]() {
+      for (int i = 0; i < symbol_count; i++)
+      {
+        std::string name = "TestConcurrentIntern" + std::to_string(i);
+        results[t].push_back(Symbol::intern(parsing::ByteView(reinterpret_cast<const u1*>(name.data()), name.size())));
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  for (int t = 1; t < thread_count; t++)
+    ASSERT_EQ(results[0], results[t]);
+}
+
+TEST_F(SymbolTest, TestClassFilesShareSymbols)
+{
+  fs::path path("src/test/resources/HelloWorld.class");
+  ClassFile first(path);
+  ClassFile second(path, ConstantPool::lazy);
+  auto& first_cp = first.getConstantPool();
+  auto& second_cp = second.getConstantPool();
+  // #7 "<init>"
+  ASSERT_EQ(first_cp.getSymbol(7), second_cp.getSymbol(7));
+  ASSERT_EQ(Symbol::intern(JUtf8String("<init>")), first_cp.getSymbol(7));
+  ASSERT_EQ(first_cp.get<const JUtf8String>(7).view().data(), second_cp.get<const JUtf8String>(7).view().data());
+  ASSERT_THROW(first_cp.getSymbol(1), std::exception);
+}
+
+TEST_F(SymbolTest, TestDescriptorClassNames)
+{
+  FieldDescriptor field(JUtf8String("Ljava/lang/String;"));
+  MethodDescriptor method(JUtf8String("(Ljava/lang/String;)V"));
+  ASSERT_EQ(Symbol::intern(JUtf8String("java/lang/String")), field.getClassSymbol());
+  ASSERT_EQ(field.getClassSymbol(), method.getParameters().at(0).getClassSymbol());
+}
+
+TEST_F(SymbolTest, TestTooLong)
+{
+  std::vector<u1> bytes(JUtf8String::max_size, 'a');
+  ASSERT_EQ(JUtf8String::max_size, Symbol::intern(parsing::ByteView(bytes)).size());
+  bytes.push_back('a');
+  ASSERT_THROW(Symbol::intern(parsing::ByteView(bytes)), std::runtime_error);
+}
+
+TEST_F(SymbolTest, TestMarks)
+{
+  Symbol symbol = Symbol::intern(JUtf8String("TestMarks"));
+  ASSERT_EQ(0u, symbol.getMarks());
+  symbol.addMarks(0x05);
+  symbol.addMarks(0x02);
+  ASSERT_EQ(0x07u, symbol.getMarks());
+  // Marks belong to the interned string, not the handle
+  ASSERT_EQ(0x07u, Symbol::intern(JUtf8String("TestMarks")).getMarks());
+  ASSERT_EQ(0u, Symbol::intern(JUtf8String("TestMarks2")).getMarks());
+}
+
+}
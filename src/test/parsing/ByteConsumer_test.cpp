@@ -172,6 +172,59 @@ TEST_F(ByteConsumerTest, TestReadEmptyStreamBytes)
 	ASSERT_THROW(bc2.readBytes(1), parse_failure);
 }
 
+TEST_F(ByteConsumerTest, TestReadEmptyStreamZeroBytes)
+{
+	std::stringstream ss2;
+	ByteConsumer bc2(ss2);
+	EXPECT_TRUE(bc2.readBytes(0).empty());
+}
+
+TEST_F(ByteConsumerTest, TestUnknownStreamLengthKnownAfterFirstRead)
+{
+	std::stringstream ss2;
+	ss2.put(0x01);
+	ss2.put(0x02);
+	ss2.put(0x03);
+	ByteConsumer bc2(ss2);
+	EXPECT_EQ(1u, bc2.readU1());
+	EXPECT_EQ(2u, bc2.bytesRemaining());
+}
+
+TEST_F(ByteConsumerTest, TestReadBufferReadsInPlace)
+{
+	const u1 data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09 };
+	ByteConsumer bc2(data, sizeof(data));
+	EXPECT_EQ(9u, bc2.bytesRemaining());
+	EXPECT_EQ(1u, bc2.readU1());
+	EXPECT_EQ(515u, bc2.readU2());
+	EXPECT_EQ(67438087u, bc2.readU4());
+	ByteView bytes = bc2.readBytes(2);
+	EXPECT_EQ(&data[7], bytes.data());
+	EXPECT_EQ(2u, bytes.size());
+	EXPECT_EQ(0u, bc2.bytesRemaining());
+	EXPECT_EQ(9u, bc2.position());
+}
+
+TEST_F(ByteConsumerTest, TestReadPastEndOfBuffer)
+{
+	const u1 data[] = { 0x01, 0x02, 0x03 };
+	ByteConsumer bc2(data, sizeof(data));
+	ASSERT_THROW(bc2.readU4(), parse_failure);
+	EXPECT_EQ(3u, bc2.bytesRemaining());
+	ASSERT_THROW(bc2.readBytes(4), parse_failure);
+	EXPECT_EQ(258u, bc2.readU2());
+	ASSERT_THROW(bc2.readU2(), parse_failure);
+	EXPECT_EQ(3u, bc2.readU1());
+	ASSERT_THROW(bc2.readU1(), parse_failure);
 }
+
+TEST_F(ByteConsumerTest, TestReadBufferLengthLimitsReads)
+{
+	const u1 data[] = { 0x01, 0x02, 0x03, 0x04 };
+	ByteConsumer bc2(data, 2);
+	ASSERT_THROW(bc2.readU4(), parse_failure);
+	EXPECT_EQ(258u, bc2.readU2());
 }
 
+}
+}
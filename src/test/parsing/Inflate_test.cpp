@@ -0,0 +1,87 @@
+/**
+ * \file Inflate_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "test/TestCommon.h"
+#include "parsing/Inflate.h"
+
+namespace mimic
+{
+namespace parsing
+{
+
+class InflateTest: public testing::Test
+{
+
+protected:
+	InflateTest()
+	{
+	}
+
+	virtual ~InflateTest()
+	{
+	}
+
+	std::vector<u1> bytes(const char* str)
+	{
+		return std::vector<u1>(str, str + std::strlen(str));
+	}
+};
+
+TEST_F(InflateTest, TestFixedHuffman)
+{
+	std::vector<u1> compressed = { 0x4b, 0x4c, 0x4a, 0x06, 0x00 };
+	EXPECT_EQ(bytes("abc"), Inflate::inflate(compressed, 3));
+}
+
+TEST_F(InflateTest, TestOverlappingMatch)
+{
+	std::vector<u1> compressed = { 0x4b, 0x4c, 0x4a, 0x4e, 0x44, 0x42, 0x00 };
+	EXPECT_EQ(bytes("abcabcabcabcabc"), Inflate::inflate(compressed, 15));
+}
+
+TEST_F(InflateTest, TestEmpty)
+{
+	std::vector<u1> compressed = { 0x03, 0x00 };
+	EXPECT_TRUE(Inflate::inflate(compressed, 0).empty());
+}
+
+TEST_F(InflateTest, TestStoredBlock)
+{
+	// Final stored block holding "hi"
+	std::vector<u1> compressed = { 0x01, 0x02, 0x00, 0xfd, 0xff, 'h', 'i' };
+	EXPECT_EQ(bytes("hi"), Inflate::inflate(compressed, 2));
+	compressed[3] = 0x00;
+	EXPECT_THROW(Inflate::inflate(compressed, 2), parse_failure);
+}
+
+TEST_F(InflateTest, TestWrongSize)
+{
+	std::vector<u1> compressed = { 0x4b, 0x4c, 0x4a, 0x06, 0x00 };
+	EXPECT_THROW(Inflate::inflate(compressed, 2), parse_failure);
+	EXPECT_THROW(Inflate::inflate(compressed, 4), parse_failure);
+}
+
+TEST_F(InflateTest, TestCorrupt)
+{
+	// Reserved block type
+	EXPECT_THROW(Inflate::inflate(std::vector<u1>{ 0x07 }, 0), parse_failure);
+	// Truncated
+	EXPECT_THROW(Inflate::inflate(std::vector<u1>{ 0x4b, 0x4c }, 3), parse_failure);
+	EXPECT_THROW(Inflate::inflate(std::vector<u1>(), 0), parse_failure);
+	// A match before the start of the output: a fixed block that starts with
+	// length 3 at distance 1
+	EXPECT_THROW(Inflate::inflate(std::vector<u1>{ 0x03, 0x02, 0x00, 0x00 }, 3), parse_failure);
+}
+
+TEST_F(InflateTest, TestCrc32)
+{
+	EXPECT_EQ(0u, Inflate::crc32(ByteView()));
+	EXPECT_EQ(0xcbf43926u, Inflate::crc32(bytes("123456789")));
+}
+
+}
+}
@@ -0,0 +1,54 @@
+/**
+ * \file MappedFile_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "test/TestCommon.h"
+#include "parsing/ByteConsumer.h"
+#include "parsing/MappedFile.h"
+
+namespace mimic
+{
+namespace parsing
+{
+
+class MappedFileTest: public testing::Test
+{
+
+protected:
+	MappedFileTest()
+	{
+	}
+
+	virtual ~MappedFileTest()
+	{
+	}
+};
+
+TEST_F(MappedFileTest, TestMapsWholeFile)
+{
+	fs::path path("src/test/resources/HelloWorld.class");
+	MappedFile file(path);
+	ASSERT_EQ(fs::file_size(path), file.size());
+	std::vector<u1> magic = { 0xca, 0xfe, 0xba, 0xbe };
+	EXPECT_EQ(magic, ByteView(file.data(), 4));
+}
+
+TEST_F(MappedFileTest, TestMissingFileThrows)
+{
+	ASSERT_THROW(MappedFile(fs::path("src/test/resources/NoSuchFile.class")), std::runtime_error);
+}
+
+TEST_F(MappedFileTest, TestByteConsumerRetainsMapping)
+{
+	auto file = MappedFile::open(fs::path("src/test/resources/HelloWorld.class"));
+	ByteConsumer bc(file->data(), file->size(), file);
+	EXPECT_EQ(file, bc.getBacking());
+	EXPECT_EQ(0xcafebabeu, bc.readU4());
+	EXPECT_EQ(file->size() - 4, bc.bytesRemaining());
+}
+
+}
+}
@@ -0,0 +1,109 @@
+/**
+ * \file ZipArchive_test.cpp
+ *
+ *  Created on: 18 Oct 2026
+ *      Author: Julian Cromarty
+ */
+
+#include "test/TestCommon.h"
+#include "ClassFile.h"
+#include "parsing/ZipArchive.h"
+
+namespace mimic
+{
+namespace parsing
+{
+
+class ZipArchiveTest: public testing::Test
+{
+
+protected:
+	ZipArchive jar;
+
+	ZipArchiveTest() :
+			jar(fs::path("src/test/resources/Classes.jar"))
+	{
+	}
+
+	virtual ~ZipArchiveTest()
+	{
+	}
+
+	std::vector<u1> helloWorld()
+	{
+		MappedFile file(fs::path("src/test/resources/HelloWorld.class"));
+		return file.view();
+	}
+};
+
+TEST_F(ZipArchiveTest, TestEntries)
+{
+	ASSERT_EQ(9u, jar.getEntries().size());
+	EXPECT_TRUE(jar.find("META-INF/")->isDirectory());
+	EXPECT_FALSE(jar.find("META-INF/MANIFEST.MF")->isDirectory());
+	EXPECT_EQ(nullptr, jar.find("NoSuchEntry"));
+	EXPECT_EQ(nullptr, jar.find("HelloWorld"));
+	EXPECT_EQ(&jar.getEntries()[2], jar.findClass("HelloWorld"));
+}
+
+TEST_F(ZipArchiveTest, TestStoredEntryIsNotCopied)
+{
+	auto e = jar.findClass("stored/HelloWorld");
+	ASSERT_NE(nullptr, e);
+	EXPECT_EQ(ZipArchive::stored, e->method);
+	auto contents = jar.read(*e);
+	EXPECT_EQ(helloWorld(), contents.bytes);
+	// The view points into the mapping of the archive, before the central
+	// directory where the names are
+	std::size_t archive_size = fs::file_size(fs::path("src/test/resources/Classes.jar"));
+	EXPECT_LT(contents.bytes.data(), e->name.data());
+	EXPECT_GT(contents.bytes.data() + archive_size, e->name.data());
+	EXPECT_EQ(contents.bytes.data(), jar.read(*e).bytes.data());
+}
+
+TEST_F(ZipArchiveTest, TestDeflatedEntry)
+{
+	auto e = jar.findClass("HelloWorld");
+	ASSERT_NE(nullptr, e);
+	EXPECT_EQ(ZipArchive::deflated, e->method);
+	EXPECT_LT(e->compressed_size, e->size);
+	EXPECT_EQ(helloWorld(), jar.read(*e).bytes);
+}
+
+TEST_F(ZipArchiveTest, TestLargeDeflatedEntries)
+{
+	// The same text at two compression levels, and data that deflate stores
+	auto best = jar.read(*jar.find("text.txt"));
+	auto fast = jar.read(*jar.find("fast.txt"));
+	EXPECT_EQ(137134u, best.bytes.size());
+	EXPECT_EQ(best.bytes, fast.bytes);
+	EXPECT_EQ(3000u, jar.read(*jar.find("random.bin")).bytes.size());
+	auto runs = jar.read(*jar.find("runs.bin"));
+	ASSERT_EQ(12024u, runs.bytes.size());
+	EXPECT_EQ('a', runs.bytes[4999]);
+	EXPECT_EQ('b', runs.bytes[5001]);
+	EXPECT_EQ(255, runs.bytes[12023]);
+	EXPECT_TRUE(jar.read(*jar.find("empty.txt")).bytes.empty());
+}
+
+TEST_F(ZipArchiveTest, TestParseClassFromEntry)
+{
+	for (auto name : { "HelloWorld", "stored/HelloWorld" })
+	{
+		auto bc = jar.open(*jar.findClass(name));
+		ClassFile clazz(*bc, ConstantPool::lazy);
+		EXPECT_EQ(52, clazz.getMajorVersion());
+		// The constant pool keeps the entry's bytes alive once the consumer has gone
+		bc.reset();
+		EXPECT_EQ(JUtf8String("<init>"), clazz.getConstantPool().get<const JUtf8String>(7));
+	}
+}
+
+TEST_F(ZipArchiveTest, TestNotAnArchive)
+{
+	EXPECT_THROW(ZipArchive(fs::path("src/test/resources/HelloWorld.class")), parse_failure);
+	EXPECT_THROW(ZipArchive(fs::path("src/test/resources/NoSuchFile.jar")), std::runtime_error);
+}
+
+}
+}